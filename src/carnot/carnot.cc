@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -32,6 +33,45 @@
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_exec_threads, gflags::Int32FromEnv("PL_CARNOT_EXEC_THREADS", 1),
+             "The number of threads that a query fragment may use to run its sources in parallel. "
+             "Operators fed by several sources, such as unions and the aggregates and joins after "
+             "them, still process one batch at a time. 1 runs sources one at a time on the query "
+             "thread.");
+DEFINE_int32(carnot_query_memory_limit_mb,
+             gflags::Int32FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_MB", 0),
+             "The maximum memory a single query may hold in Arrow buffers. 0 means no limit.");
+DEFINE_int32(carnot_spill_threshold_mb, gflags::Int32FromEnv("PL_CARNOT_SPILL_THRESHOLD_MB", 0),
+             "The state a blocking aggregate or join may hold before it spills to disk. 0 uses "
+             "half of --carnot_query_memory_limit_mb, and disables spilling if there's no limit.");
+DEFINE_string(carnot_spill_dir, gflags::StringFromEnv("PL_CARNOT_SPILL_DIR", ""),
+              "The directory that spilled query state is written to. Defaults to the temp dir.");
+DEFINE_string(carnot_grpc_sink_compression,
+              gflags::StringFromEnv("PL_CARNOT_GRPC_SINK_COMPRESSION", "none"),
+              "The gRPC compression of row batches sent to other Carnot instances: none, deflate "
+              "or gzip.");
+DEFINE_int32(carnot_grpc_source_buffer_mb,
+             gflags::Int32FromEnv("PL_CARNOT_GRPC_SOURCE_BUFFER_MB", 64),
+             "The row batches each GRPC source may have buffered before Carnot stops reading from "
+             "the sending instance and lets gRPC flow control push back. 0 means no limit.");
+DEFINE_int32(carnot_otel_export_batch_kb,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_BATCH_KB", 1024),
+             "The size an OTel export request may grow to before it is sent to the collector.");
+DEFINE_int32(carnot_otel_export_flush_ms,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_FLUSH_MS", 1000),
+             "The longest an OTel export sink holds on to rows before sending them.");
+DEFINE_int32(carnot_otel_export_max_in_flight,
+             gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_MAX_IN_FLIGHT", 4),
+             "The number of export RPCs each OTel export sink may have in flight at once.");
+DEFINE_int32(carnot_otel_export_threads, gflags::Int32FromEnv("PL_CARNOT_OTEL_EXPORT_THREADS", 8),
+             "The number of threads that send the export RPCs of every OTel export sink.");
+DEFINE_int32(carnot_agg_cache_max_mb, gflags::Int32FromEnv("PL_CARNOT_AGG_CACHE_MAX_MB", 256),
+             "The memory that the aggregate state of closed time buckets may use when it's cached "
+             "for repeated runs of the same plan. 0 disables the cache.");
+DEFINE_bool(carnot_fused_expressions, gflags::BoolFromEnv("PL_CARNOT_FUSED_EXPRESSIONS", true),
+            "Whether to evaluate builtin comparisons, arithmetic and boolean logic over numeric "
+            "values with fused kernels instead of calling the UDFs.");
+
 namespace px {
 namespace carnot {
 
@@ -99,6 +139,9 @@ class CarnotImpl final : public Carnot {
   std::unique_ptr<grpc::Server> grpc_server_;
   std::unique_ptr<exec::GRPCRouter> grpc_router_;
   int grpc_server_port_;
+  // Shared by the queries of this instance, null if disabled.
+  std::unique_ptr<exec::AggStateCache> agg_state_cache_;
+  std::unique_ptr<exec::OTelExportPool> otel_export_pool_;
 
   // The id of the agent that owns this Carnot instance.
   sole::uuid agent_id_;
@@ -113,7 +156,16 @@ Status CarnotImpl::Init(const sole::uuid& agent_id, std::unique_ptr<udf::Registr
   agent_id_ = agent_id;
   grpc_server_creds_ = grpc_server_creds;
   grpc_server_port_ = grpc_server_port;
-  grpc_router_ = std::make_unique<exec::GRPCRouter>();
+  grpc_router_ = std::make_unique<exec::GRPCRouter>(
+      static_cast<int64_t>(FLAGS_carnot_grpc_source_buffer_mb) * 1024 * 1024);
+  if (FLAGS_carnot_agg_cache_max_mb > 0) {
+    agg_state_cache_ = std::make_unique<exec::AggStateCache>(
+        static_cast<int64_t>(FLAGS_carnot_agg_cache_max_mb) * 1024 * 1024);
+  }
+  // The pool's timer flushes rows that sinks have held for longer than the flush interval.
+  otel_export_pool_ = std::make_unique<exec::OTelExportPool>(
+      FLAGS_carnot_otel_export_threads,
+      std::chrono::milliseconds(FLAGS_carnot_otel_export_flush_ms));
   if (grpc_server_port_ > 0) {
     grpc_server_thread_ = std::make_unique<std::thread>(&CarnotImpl::GRPCServerFunc, this);
   }
@@ -224,6 +276,19 @@ void CarnotImpl::GRPCServerFunc() {
   grpc_server_->Wait();
 }
 
+StatusOr<grpc_compression_algorithm> ParseGRPCCompression(const std::string& name) {
+  if (name.empty() || name == "none") {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (name == "deflate") {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  if (name == "gzip") {
+    return GRPC_COMPRESS_GZIP;
+  }
+  return error::InvalidArgument("Unknown gRPC sink compression '$0'", name);
+}
+
 Status SendFinalExecutionStatsToOutgoingConns(
     const sole::uuid& query_id,
     const absl::flat_hash_map<std::string, carnotpb::ResultSinkService::StubInterface*>&
@@ -274,6 +339,49 @@ Status SendFinalExecutionStatsToOutgoingConns(
   return Status::OK();
 }
 
+// Sends the error that stopped the query to the destination of every result table sink in the
+// plan, so the query broker can tell the client why the query failed. Cancelled queries are not
+// reported, since whoever cancelled them already knows.
+void SendExecutionErrorToResultSinks(
+    const sole::uuid& query_id, const planpb::Plan& logical_plan, exec::ExecState* exec_state,
+    std::function<void(grpc::ClientContext*)> add_auth_to_grpc_context_func, const Status& error) {
+  if (error.code() == statuspb::CANCELLED) {
+    return;
+  }
+  // Result tables that go to the same address share one message.
+  absl::flat_hash_map<std::string, std::string> result_addresses;
+  for (const auto& fragment : logical_plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() != planpb::GRPC_SINK_OPERATOR ||
+          !node.op().grpc_sink_op().has_output_table()) {
+        continue;
+      }
+      const auto& sink = node.op().grpc_sink_op();
+      result_addresses.try_emplace(sink.address(), sink.connection_options().ssl_targetname());
+    }
+  }
+
+  ::px::carnotpb::TransferResultChunkRequest req;
+  ToProto(query_id, req.mutable_query_id());
+  error.ToProto(req.mutable_execution_error());
+  for (const auto& [addr, ssl_targetname] : result_addresses) {
+    ::px::carnotpb::TransferResultChunkResponse resp;
+    req.set_address(addr);
+    grpc::ClientContext context;
+    add_auth_to_grpc_context_func(&context);
+    context.set_deadline(std::chrono::system_clock::now() + kRPCResultTimeout);
+    auto* server = exec_state->ResultSinkServiceStub(addr, ssl_targetname);
+    auto writer = server->TransferResultChunk(&context, &resp);
+    writer->Write(req);
+    writer->WritesDone();
+    auto status = writer->Finish();
+    if (!status.ok()) {
+      LOG(ERROR) << absl::Substitute("Failed to send the error of query $0 to $1: $2",
+                                     query_id.str(), addr, status.error_message());
+    }
+  }
+}
+
 Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uuid& query_id,
                                bool analyze) {
   auto timer = ElapsedTimer();
@@ -284,6 +392,29 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // For each of the plan fragments in the plan, execute the query.
   std::vector<std::string> output_table_strs;
   auto exec_state = engine_state_->CreateExecState(query_id);
+  exec_state->query_mem_pool()->set_limit_bytes(
+      static_cast<int64_t>(FLAGS_carnot_query_memory_limit_mb) * 1024 * 1024);
+  exec_state->set_spill_threshold_bytes(
+      FLAGS_carnot_spill_threshold_mb > 0
+          ? static_cast<int64_t>(FLAGS_carnot_spill_threshold_mb) * 1024 * 1024
+          : exec_state->query_mem_pool()->limit_bytes() / 2);
+  if (!FLAGS_carnot_spill_dir.empty()) {
+    exec_state->set_spill_dir(FLAGS_carnot_spill_dir);
+  }
+  exec_state->set_fused_expressions_enabled(FLAGS_carnot_fused_expressions);
+  PL_ASSIGN_OR_RETURN(auto grpc_sink_compression,
+                      ParseGRPCCompression(FLAGS_carnot_grpc_sink_compression));
+  exec_state->set_grpc_sink_compression(grpc_sink_compression);
+  exec_state->set_otel_export_batch_bytes(static_cast<int64_t>(FLAGS_carnot_otel_export_batch_kb) *
+                                          1024);
+  exec_state->set_otel_export_flush_interval(
+      std::chrono::milliseconds(FLAGS_carnot_otel_export_flush_ms));
+  exec_state->set_otel_export_max_in_flight(FLAGS_carnot_otel_export_max_in_flight);
+  exec_state->set_otel_export_pool(otel_export_pool_.get());
+  if (agg_state_cache_ != nullptr) {
+    exec_state->set_agg_state_cache(agg_state_cache_.get());
+    exec_state->set_plan_fingerprint(plan::PlanFingerprint(logical_plan));
+  }
 
   // TODO(michellenguyen/zasgar, PP-2579): We should periodically update the metadata state for
   // long-running queries after a certain time duration or number of row batches processed. For now,
@@ -308,6 +439,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
       plan::PlanWalker()
           .OnPlanFragment([&](auto* pf) {
             auto exec_graph = exec::ExecutionGraph();
+            exec_graph.set_num_threads(FLAGS_carnot_exec_threads);
             PL_RETURN_IF_ERROR(exec_graph.Init(schema.get(), plan_state.get(), exec_state.get(), pf,
                                                /* collect_exec_node_stats */ analyze));
             PL_RETURN_IF_ERROR(exec_graph.Execute());
@@ -337,6 +469,17 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
                 stats_pb->set_records_output(stats->rows_output);
                 stats_pb->set_total_execution_time_ns(total_time_ns);
                 stats_pb->set_self_execution_time_ns(self_time_ns);
+                stats_pb->set_peak_memory_bytes(stats->PeakMemoryBytes());
+                stats_pb->set_num_allocations(stats->NumAllocations());
+                stats_pb->set_bytes_allocated(stats->BytesAllocated());
+                PerfCounterValues counters = stats->SelfPerfCounters();
+                stats_pb->set_cpu_cycles(counters.cycles);
+                stats_pb->set_instructions(counters.instructions);
+                stats_pb->set_cache_misses(counters.cache_misses);
+                stats_pb->set_branch_misses(counters.branch_misses);
+                if (counters.multiplexed) {
+                  stats->AddExtraInfo("perf_counters", "multiplexed");
+                }
 
                 for (const auto& [k, v] : stats->extra_metrics) {
                   (*stats_pb->mutable_extra_metrics())[k] = v;
@@ -350,7 +493,11 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
             return Status::OK();
           })
           .Walk(&plan);
-  PL_RETURN_IF_ERROR(s);
+  if (!s.ok()) {
+    SendExecutionErrorToResultSinks(query_id, logical_plan, exec_state.get(),
+                                    engine_state_->add_auth_to_grpc_context_func(), s);
+    return s;
+  }
 
   std::vector<uuidpb::UUID> incoming_agents;
   for (const auto& id : logical_plan.incoming_agent_ids()) {
@@ -33,6 +33,8 @@
 #include "src/common/testing/testing.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_int32(carnot_exec_threads);
+
 namespace px {
 namespace carnot {
 
@@ -609,6 +611,49 @@ TEST_F(CarnotTest, group_by_col_agg_test) {
   EXPECT_EQ(expected, actual);
 }
 
+TEST_F(CarnotTest, parallel_union_agg_matches_serial) {
+  gflags::FlagSaver flag_saver;
+  // Sources that read the same table are merged, so each source gets its own copy of it. Each
+  // source of the union then runs on its own thread when there are enough threads.
+  table_store_->AddTable("big_test_table_2", CarnotTestUtils::BigTestTable());
+  table_store_->AddTable("big_test_table_3", CarnotTestUtils::BigTestTable());
+  auto query = absl::StrJoin(
+      {
+          "import px",
+          "df1 = px.DataFrame(table='big_test_table', select=['col3', 'num_groups'])",
+          "df2 = px.DataFrame(table='big_test_table_2', select=['col3', 'num_groups'])",
+          "df3 = px.DataFrame(table='big_test_table_3', select=['col3', 'num_groups'])",
+          "df = df1.append(objs=[df2, df3])",
+          "aggDF = df.groupby('num_groups').agg(sum=('col3', px.sum), count=('col3', px.count))",
+          "px.display(aggDF, '$0')",
+      },
+      "\n");
+
+  FLAGS_carnot_exec_threads = 1;
+  ASSERT_OK(carnot_->ExecuteQuery(absl::Substitute(query, "serial"), sole::uuid4(), 0));
+  FLAGS_carnot_exec_threads = 4;
+  ASSERT_OK(carnot_->ExecuteQuery(absl::Substitute(query, "parallel"), sole::uuid4(), 0));
+
+  auto group_values = [&](const std::string& table_name) {
+    std::map<int64_t, std::pair<int64_t, int64_t>> values;
+    for (const auto& rb : result_server_->query_results(table_name)) {
+      auto groups = static_cast<arrow::Int64Array*>(rb.ColumnAt(0).get());
+      auto sums = static_cast<arrow::Int64Array*>(rb.ColumnAt(1).get());
+      auto counts = static_cast<arrow::Int64Array*>(rb.ColumnAt(2).get());
+      for (int i = 0; i < rb.num_rows(); ++i) {
+        values[groups->Value(i)] = {sums->Value(i), counts->Value(i)};
+      }
+    }
+    return values;
+  };
+  auto serial = group_values("serial");
+  EXPECT_EQ(3, serial.size());
+  EXPECT_EQ(3 * 13, serial[1].first);
+  EXPECT_EQ(3 * 129, serial[2].first);
+  EXPECT_EQ(3 * 24, serial[3].first);
+  EXPECT_EQ(serial, group_values("parallel"));
+}
+
 TEST_F(CarnotTest, multiple_group_by_test) {
   auto query = absl::StrJoin(
       {
@@ -1181,6 +1226,121 @@ TEST_F(CarnotTest, empty_source_test) {
   }
 }
 
+// Counts the rows of big_test_table per time bucket, reusing cached buckets before 10ns. The
+// aggregate cache starts out empty, so those buckets are never there.
+constexpr char kCachedBucketsPlan[] = R"proto(
+dag {
+  nodes {
+    id: 1
+  }
+}
+nodes {
+  id: 1
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_parents: 1
+      sorted_children: 3
+    }
+    nodes {
+      id: 3
+      sorted_parents: 2
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "big_test_table"
+        column_idxs: 0
+        column_idxs: 1
+        column_names: "time_"
+        column_names: "col2"
+        column_types: TIME64NS
+        column_types: FLOAT64
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "count"
+          args {
+            column {
+              node: 1
+              index: 1
+            }
+          }
+          args_data_types: FLOAT64
+        }
+        groups {
+          node: 1
+          index: 0
+        }
+        group_names: "bucket"
+        value_names: "count"
+        result_cache {
+          bucket_group_index: 0
+          bucket_size_ns: 10
+          range_start_ns: 0
+          input_start_ns: 10
+          closed_before_ns: 10
+        }
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: GRPC_SINK_OPERATOR
+      grpc_sink_op {
+        address: "result_addr"
+        output_table {
+          table_name: "out_table"
+          column_names: "bucket"
+          column_names: "count"
+          column_types: TIME64NS
+          column_types: INT64
+        }
+        connection_options {
+          ssl_targetname: "result_ssltarget"
+        }
+      }
+    }
+  }
+}
+)proto";
+
+TEST_F(CarnotTest, execution_error_sent_to_result_sinks) {
+  planpb::Plan plan;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kCachedBucketsPlan, &plan));
+
+  auto s = carnot_->ExecutePlan(plan, sole::uuid4());
+  ASSERT_NOT_OK(s);
+  EXPECT_EQ(statuspb::NOT_FOUND, s.code());
+
+  auto results = result_server_->raw_query_results();
+  std::vector<carnotpb::TransferResultChunkRequest> errors;
+  for (const auto& req : results) {
+    EXPECT_FALSE(req.has_query_result() && req.query_result().has_row_batch());
+    if (req.has_execution_error()) {
+      errors.push_back(req);
+    }
+  }
+  ASSERT_EQ(1, errors.size());
+  EXPECT_EQ("result_addr", errors[0].address());
+  EXPECT_EQ(statuspb::NOT_FOUND, errors[0].execution_error().err_code());
+}
+
 const char kPxCluster[] = R"pxl(
 import px
 
@@ -23,7 +23,9 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <map>
 
+#include <absl/strings/str_cat.h>
 #include <magic_enum.hpp>
 
 #include "src/carnot/exec/expression_evaluator.h"
@@ -41,40 +43,20 @@ namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
 constexpr int64_t kAggCompactionThreshold = 512;
+// UDA state is opaque, so each group is charged this much on top of the bytes of its key when
+// deciding whether to spill and when charging cached buckets against the cache's budget.
+constexpr int64_t kAggEstimatedGroupStateBytes = 256;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 namespace {
 template <types::DataType DT>
-void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
-  auto num_rows = col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*group_args)[row_idx].rt, col, rt_col_idx, row_idx);
-  }
-}
-
-template <types::DataType DT>
-void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx) {
-  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  auto status =
-      static_cast<ArrowBuilder*>(builder)->Append(udf::UnWrap(rt->GetValue<ValueType>(rt_idx)));
-  PL_DCHECK_OK(status);
-  PL_UNUSED(status);
-}
-
-template <types::DataType DT>
-void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
-                            const table_store::schema::RowBatch& rb, size_t col_idx,
-                            size_t rb_col_idx) {
-  size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
-  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
-    auto arr = rb.ColumnAt(rb_col_idx).get();
-    types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
+void AppendSelectedToColumnWrapper(types::ColumnWrapper* wrapper, const arrow::Array* arr,
+                                   const int64_t* rows_begin, const int64_t* rows_end) {
+  auto* typed_wrapper = static_cast<typename types::ColumnWrapperType<DT>::type*>(wrapper);
+  for (const int64_t* row = rows_begin; row != rows_end; ++row) {
+    typed_wrapper->Append(types::GetValueFromArrowArray<DT>(arr, *row));
   }
 }
 
@@ -127,6 +109,7 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     DCHECK(group.idx < input_descriptor_->size());
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
+  group_table_ = std::make_unique<GroupByHashTable>(group_data_types_);
 
   auto values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
@@ -140,6 +123,13 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
 
 Status AggNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
+  // Windowed aggregates emit at every window, so only blocking aggregates spill.
+  spill_threshold_bytes_ = exec_state->spill_threshold_bytes();
+  spill_enabled_ = spill_threshold_bytes_ > 0 && !HasNoGroups() && !plan_node_->windowed();
+  if (plan_node_->has_result_cache()) {
+    result_cache_ = exec_state->agg_state_cache();
+    plan_fingerprint_ = exec_state->plan_fingerprint();
+  }
   return Status::OK();
 }
 
@@ -147,10 +137,18 @@ Status AggNode::OpenImpl(ExecState* exec_state) {
   if (HasNoGroups()) {
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
+  if (plan_node_->has_result_cache()) {
+    return MergeCachedBuckets(exec_state);
+  }
   return Status::OK();
 }
 
 Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  // Only grouped aggregates resolve a selection in place, the others run on the selected rows.
+  if (rb.has_selection() && HasNoGroups()) {
+    PL_ASSIGN_OR_RETURN(auto dense_rb, rb.Materialize(exec_state->exec_mem_pool()));
+    return ConsumeNextImpl(exec_state, *dense_rb, 0);
+  }
   if (HasNoGroups()) {
     return AggregateGroupByNone(exec_state, rb);
   }
@@ -159,9 +157,12 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
 
 Status AggNode::CloseImpl(ExecState*) {
   udas_no_groups_.clear();
-  group_args_chunk_.clear();
-  group_args_pool_.Clear();
+  if (group_table_ != nullptr) {
+    group_table_->Clear();
+  }
+  group_values_.clear();
   udas_pool_.Clear();
+  spill_partitions_.reset();
 
   return Status::OK();
 }
@@ -174,8 +175,12 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
   if (HasNoGroups()) {
     udas_no_groups_.clear();
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+    return Status::OK();
   }
-  agg_hash_map_.clear();
+  group_table_->Clear();
+  group_values_.clear();
+  batch_slot_of_group_.clear();
+  udas_pool_.Clear();
   return Status::OK();
 }
 
@@ -206,125 +211,111 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
   return Status::OK();
 }
 
-Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
-  // Grow the group_args_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (group_args_chunk_.size() < num_rows) {
-    int prev_size = group_args_chunk_.size();
-    group_args_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
-    }
-  }
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
-    auto grp = plan_node_->groups()[idx];
+void AggNode::ResolveGroups(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
     DCHECK(grp.idx < input_descriptor_->size());
-    DCHECK(idx < group_data_types_.size());
-    auto dt = group_data_types_[idx];
-    auto col = rb.ColumnAt(grp.idx).get();
+    key_cols.push_back(rb.ColumnAt(grp.idx).get());
+  }
+  const std::vector<int64_t>* selection = rb.has_selection() ? rb.selection().get() : nullptr;
+  if (spill_partitions_ == nullptr) {
+    group_table_->FindOrInsert(key_cols, &group_ids_, selection);
+  } else {
+    // Only the groups that are already in memory keep aggregating, the other rows are spilled.
+    group_table_->Find(key_cols, &group_ids_, selection);
+  }
 
-#define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
-    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+  size_t num_groups = group_table_->num_groups();
+  while (group_values_.size() < num_groups) {
+    group_values_.push_back(CreateAggHashValue(exec_state));
   }
-  return Status::OK();
-}
+  batch_slot_of_group_.resize(num_groups, -1);
 
-Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PL_UNUSED(exec_state);
-  // Loop through all the row and basically store the values into column chunk based on which
-  // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
+  // Count the rows of each group in this batch.
+  batch_groups_.clear();
+  selection_offsets_.clear();
+  for (int64_t group_id : group_ids_) {
+    if (group_id < 0) {
+      continue;
+    }
+    int64_t slot = batch_slot_of_group_[group_id];
+    if (slot < 0) {
+      slot = batch_groups_.size();
+      batch_slot_of_group_[group_id] = slot;
+      batch_groups_.push_back(group_id);
+      selection_offsets_.push_back(0);
     }
-    ga.av = val;
+    ++selection_offsets_[slot];
+  }
+
+  // Turn the counts into offsets and scatter the row indices into per-group selections.
+  size_t offset = 0;
+  for (auto& group_offset : selection_offsets_) {
+    size_t count = group_offset;
+    group_offset = offset;
+    offset += count;
+  }
+  selection_offsets_.push_back(offset);
+  std::vector<size_t> next_selection(selection_offsets_.begin(), selection_offsets_.end() - 1);
+  selection_.resize(offset);
+  for (size_t row_idx = 0; row_idx < group_ids_.size(); ++row_idx) {
+    if (group_ids_[row_idx] < 0) {
+      continue;
+    }
+    selection_[next_selection[batch_slot_of_group_[group_ids_[row_idx]]]++] = row_idx;
   }
 
-  auto values = plan_node_->values();
-  // Now extract the values in the agg hash value.
-  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
-    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
-    const auto& dt = input_descriptor_->type(rb_col_idx);
-
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
-
-    PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+  for (int64_t group_id : batch_groups_) {
+    batch_slot_of_group_[group_id] = -1;
   }
-
-  return Status::OK();
 }
 
-Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
-  PL_UNUSED(exec_state);
-  // TODO(zasgar): This only needs to run for unique groups. We should find
-  // a way to optimize this.
-  for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
-    auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
-    if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
-      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
+void AggNode::AppendSelectedValues(const RowBatch& rb) {
+  // Copy the values that the aggregates need column by column, using the selection of each group.
+  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
+    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
+    auto arr = rb.ColumnAt(rb_col_idx).get();
+    for (size_t slot = 0; slot < batch_groups_.size(); ++slot) {
+      auto col_wrapper = group_values_[batch_groups_[slot]]->agg_cols[i].get();
+      const int64_t* rows_begin = selection_.data() + selection_offsets_[slot];
+      const int64_t* rows_end = selection_.data() + selection_offsets_[slot + 1];
+
+#define TYPE_CASE(_dt_) \
+  AppendSelectedToColumnWrapper<_dt_>(col_wrapper, arr, rows_begin, rows_end);
+      PL_SWITCH_FOREACH_DATATYPE(stored_cols_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
     }
   }
-  return Status::OK();
 }
 
-Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
-  for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
-    group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
+Status AggNode::EvaluatePartialAggregates(ExecState* exec_state) {
+  // Only the groups that received rows in this batch can have grown past the threshold.
+  for (int64_t group_id : batch_groups_) {
+    auto* val = group_values_[group_id];
+    if (val->agg_cols[0]->Size() > kAggCompactionThreshold) {
+      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
-  PL_UNUSED(exec_state);
+Status AggNode::ConvertGroupsToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
   DCHECK(output_rb != nullptr);
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
-  for (const auto& group_dt : group_data_types_) {
-    group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    auto builder = types::MakeArrowBuilder(group_data_types_[i], exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(group_table_->AppendKeyColumn(i, builder.get()));
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
   }
+
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
   for (const auto& value_data_type : value_data_types_) {
     value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
   }
-
-  // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
-
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
-
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PL_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
-    // Actually Finalize the UDA based on the column wrapper chunks.
+  // Finalize the UDAs of every group, in group id order to line up with the keys.
+  for (auto* val : group_values_) {
     PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
     for (size_t i = 0; i < val->udas.size(); ++i) {
       const auto& uda_info = val->udas[i];
@@ -332,13 +323,6 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
                                                      value_builders[i].get()));
     }
   }
-
-  for (const auto& group_builder : group_builders) {
-    std::shared_ptr<arrow::Array> arr;
-    PL_RETURN_IF_ERROR(group_builder->Finish(&arr));
-    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-  }
-
   for (const auto& value_builder : value_builders) {
     std::shared_ptr<arrow::Array> arr;
     PL_RETURN_IF_ERROR(value_builder->Finish(&arr));
@@ -348,29 +332,198 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
   return Status::OK();
 }
 
+Status AggNode::AggregateBatch(ExecState* exec_state, const RowBatch& rb) {
+  // The batch is processed a column at a time:
+  // 1. Hash and encode the group columns and resolve the group id of every row.
+  // 2. If spilling, write the rows of groups that aren't in memory to their partitions.
+  // 3. Bucket the rows by group and copy the aggregate inputs of each group.
+  // 4. If a group's buffered inputs are large then run its aggregates and compact.
+  ResolveGroups(exec_state, rb);
+  if (spill_partitions_ != nullptr) {
+    PL_RETURN_IF_ERROR(SpillUnresolvedRows(rb));
+  }
+  if (!stored_cols_data_types_.empty()) {
+    AppendSelectedValues(rb);
+    PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state));
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> AggNode::GroupsToRowBatch(ExecState* exec_state) {
+  auto output_rb = std::make_unique<RowBatch>(*output_descriptor_, group_table_->num_groups());
+  PL_RETURN_IF_ERROR(ConvertGroupsToRowBatch(exec_state, output_rb.get()));
+  PL_RETURN_IF_ERROR(ClearAggState(exec_state));
+  return output_rb;
+}
+
+int64_t AggNode::EstimatedStateBytes() const {
+  return group_table_->arena_bytes() + group_table_->num_groups() * kAggEstimatedGroupStateBytes;
+}
+
+Status AggNode::SpillUnresolvedRows(const RowBatch& rb) {
+  const auto& hashes = group_table_->batch_hashes();
+  row_partitions_.resize(group_ids_.size());
+  for (size_t row_idx = 0; row_idx < group_ids_.size(); ++row_idx) {
+    row_partitions_[row_idx] = group_ids_[row_idx] == GroupByHashTable::kMissingGroup
+                                   ? SpillPartitionOf(hashes[row_idx])
+                                   : kNoSpillPartition;
+  }
+  return spill_partitions_->Append(rb, row_partitions_);
+}
+
+Status AggNode::AggregateSpilledPartitions(ExecState* exec_state, bool eow, bool eos) {
+  // The groups that stayed in memory have seen all of their rows, so they go out first. Each
+  // output batch is held back until the next one is ready, so that the last one carries eow/eos.
+  PL_ASSIGN_OR_RETURN(auto pending_rb, GroupsToRowBatch(exec_state));
+
+  // A group's rows all land in one partition, so each partition is aggregated on its own.
+  auto partitions = std::move(spill_partitions_);
+  PL_RETURN_IF_ERROR(partitions->StartReading());
+  stats()->AddExtraInfo("spilled_bytes", absl::StrCat(partitions->bytes_written()));
+  for (size_t i = 0; i < kNumSpillPartitions; ++i) {
+    while (true) {
+      PL_ASSIGN_OR_RETURN(auto spilled_rb, partitions->partition(i)->ReadNext());
+      if (spilled_rb == nullptr) {
+        break;
+      }
+      PL_RETURN_IF_ERROR(AggregateBatch(exec_state, *spilled_rb));
+    }
+    if (group_table_->num_groups() == 0) {
+      continue;
+    }
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *pending_rb));
+    PL_ASSIGN_OR_RETURN(pending_rb, GroupsToRowBatch(exec_state));
+  }
+  pending_rb->set_eow(eow);
+  pending_rb->set_eos(eos);
+  return SendRowBatchToChildren(exec_state, *pending_rb);
+}
+
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
-  // Extracts the row tuples (column wise).
-  // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
-  // is large. The process is as follows:
-  // 1. Extract each column into the appropriate part of the row tuple.
-  // 2. Hash row batch and update agg values.
-  // 3. If the agg values are large then run aggregate and compact.
-  // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
-  PL_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
-  PL_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
-  if (plan_node_->values().size() > 0) {
-    PL_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
-  }
-  PL_RETURN_IF_ERROR(ResetGroupArgs());
+  PL_RETURN_IF_ERROR(AggregateBatch(exec_state, rb));
+  if (spill_enabled_ && spill_partitions_ == nullptr && !rb.eos() &&
+      EstimatedStateBytes() > spill_threshold_bytes_) {
+    spill_partitions_ =
+        std::make_unique<SpillPartitions>(*input_descriptor_, exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(spill_partitions_->Init(exec_state->spill_dir()));
+  }
+  // If it's the last batch then emit the values.
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PL_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PL_RETURN_IF_ERROR(ClearAggState(exec_state));
+    if (spill_partitions_ != nullptr) {
+      return AggregateSpilledPartitions(exec_state, rb.eow(), rb.eos());
+    }
+    if (result_cache_ != nullptr) {
+      PL_RETURN_IF_ERROR(CacheClosedBuckets(exec_state));
+    }
+    PL_ASSIGN_OR_RETURN(auto output_rb, GroupsToRowBatch(exec_state));
+    output_rb->set_eow(rb.eow());
+    output_rb->set_eos(rb.eos());
+    return SendRowBatchToChildren(exec_state, *output_rb);
+  }
+  return Status::OK();
+}
+
+Status AggNode::MergeCachedBuckets(ExecState* exec_state) {
+  const auto& spec = plan_node_->result_cache();
+  if (spec.input_start_ns() == spec.range_start_ns()) {
+    return Status::OK();
+  }
+  if (result_cache_ == nullptr) {
+    return error::FailedPrecondition(
+        "Aggregate $0 needs cached buckets, but this Carnot instance has no aggregate cache",
+        plan_node_->id());
+  }
+
+  int64_t buckets_merged = 0;
+  for (int64_t start = spec.range_start_ns(); start < spec.input_start_ns();
+       start += spec.bucket_size_ns()) {
+    auto state = result_cache_->Get({plan_fingerprint_, plan_node_->id(), start});
+    if (state == nullptr) {
+      return error::NotFound(
+          "Aggregate $0 has no cached state for the bucket at $1, the query must read its whole "
+          "time range",
+          plan_node_->id(), start);
+    }
+    std::vector<const arrow::Array*> key_cols;
+    key_cols.reserve(state->keys.size());
+    for (const auto& key : state->keys) {
+      key_cols.push_back(key.get());
+    }
+    group_table_->FindOrInsert(key_cols, &group_ids_);
+    while (group_values_.size() < static_cast<size_t>(group_table_->num_groups())) {
+      group_values_.push_back(CreateAggHashValue(exec_state));
+    }
+    for (int64_t row = 0; row < state->num_groups(); ++row) {
+      auto* val = group_values_[group_ids_[row]];
+      for (size_t i = 0; i < val->udas.size(); ++i) {
+        const auto& uda_info = val->udas[i];
+        PL_RETURN_IF_ERROR(uda_info.def->Merge(uda_info.uda.get(), state->udas[row][i].get(),
+                                               function_ctx_.get()));
+      }
+    }
+    ++buckets_merged;
+  }
+  batch_slot_of_group_.resize(group_table_->num_groups(), -1);
+  stats()->AddExtraInfo("cached_buckets_merged", absl::StrCat(buckets_merged));
+  return Status::OK();
+}
+
+Status AggNode::CacheClosedBuckets(ExecState* exec_state) {
+  const auto& spec = plan_node_->result_cache();
+  int64_t num_groups = group_table_->num_groups();
+  // The cached keys outlive the query, so they aren't charged to its memory pool.
+  std::vector<std::shared_ptr<arrow::Array>> key_cols;
+  for (size_t i = 0; i < group_data_types_.size(); ++i) {
+    auto builder = types::MakeArrowBuilder(group_data_types_[i], arrow::default_memory_pool());
+    PL_RETURN_IF_ERROR(group_table_->AppendKeyColumn(i, builder.get()));
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    key_cols.push_back(arr);
+  }
+
+  // Only buckets that are closed and entirely covered by the input are cached. The buckets
+  // before input_start came from the cache already, or only partly overlap the query.
+  std::map<int64_t, std::vector<int64_t>> groups_of_bucket;
+  const arrow::Array* bucket_col = key_cols[spec.bucket_group_index()].get();
+  for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+    int64_t time = types::GetValueFromArrowArray<types::TIME64NS>(bucket_col, group_id);
+    int64_t size = spec.bucket_size_ns();
+    int64_t start = time - ((time % size) + size) % size;
+    if (start >= spec.input_start_ns() && start + size <= spec.closed_before_ns()) {
+      groups_of_bucket[start].push_back(group_id);
+    }
+  }
+
+  for (const auto& [start, group_ids] : groups_of_bucket) {
+    auto state = std::make_shared<AggStateCache::BucketState>();
+    for (size_t i = 0; i < group_data_types_.size(); ++i) {
+      auto wrapper = types::ColumnWrapper::Make(group_data_types_[i], 0);
+#define TYPE_CASE(_dt_)                                                                    \
+  AppendSelectedToColumnWrapper<_dt_>(wrapper.get(), key_cols[i].get(), group_ids.data(), \
+                                      group_ids.data() + group_ids.size());
+      PL_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+      state->bytes += wrapper->Bytes();
+      state->keys.push_back(wrapper->ConvertToArrow(arrow::default_memory_pool()));
+    }
+    state->bytes += static_cast<int64_t>(group_ids.size()) * kAggEstimatedGroupStateBytes;
+    // The cache gets its own copy of each group's state, by merging it into fresh UDAs.
+    for (int64_t group_id : group_ids) {
+      auto* val = group_values_[group_id];
+      PL_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+      std::vector<UDAInfo> copies;
+      PL_RETURN_IF_ERROR(CreateUDAInfoValues(&copies, exec_state));
+      std::vector<std::unique_ptr<udf::UDA>> udas;
+      for (size_t i = 0; i < copies.size(); ++i) {
+        PL_RETURN_IF_ERROR(copies[i].def->Merge(copies[i].uda.get(), val->udas[i].uda.get(),
+                                                function_ctx_.get()));
+        udas.push_back(std::move(copies[i].uda));
+      }
+      state->udas.push_back(std::move(udas));
+    }
+    result_cache_->Put({plan_fingerprint_, plan_node_->id(), start}, std::move(state));
   }
+  stats()->AddExtraInfo("cached_buckets_stored", absl::StrCat(groups_of_bucket.size()));
   return Status::OK();
 }
 
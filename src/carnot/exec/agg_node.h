@@ -24,10 +24,12 @@
 #include <utility>
 #include <vector>
 
+#include "src/carnot/exec/agg_state_cache.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/group_by_hash_table.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -57,19 +59,13 @@ struct AggHashValue {
   std::vector<types::SharedColumnWrapper> agg_cols;
 };
 
-struct GroupArgs {
-  explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
-  RowTuple* rt;
-  AggHashValue* av;
-};
-
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  bool AcceptsSelection() const override { return true; }
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -83,7 +79,6 @@ class AggNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
@@ -121,32 +116,57 @@ class AggNode : public ProcessingNode {
   // 3. The data type of the stored colums, by the index they are stored at.
   std::vector<types::DataType> stored_cols_data_types_;
 
-  ObjectPool group_args_pool_{"group_args_pool"};
   ObjectPool udas_pool_{"udas_pool"};
 
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
 
-  // We construct row-tuples in a batch, chunked by each column.
-  // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
-
-  std::vector<GroupArgs> group_args_chunk_;
+  // Maps the group by columns of each row to a dense group id.
+  std::unique_ptr<GroupByHashTable> group_table_;
+  // The aggregate state of each group, indexed by group id. Owned by udas_pool_.
+  std::vector<AggHashValue*> group_values_;
+
+  // Per batch scratch space. The rows of the batch are bucketed by group: the rows of the group
+  // batch_groups_[i] are selection_[selection_offsets_[i]] to selection_[selection_offsets_[i+1]].
+  std::vector<int64_t> group_ids_;
+  std::vector<int64_t> batch_groups_;
+  std::vector<size_t> selection_offsets_;
+  std::vector<int64_t> selection_;
+  // The index into batch_groups_ of each group, or -1 if the group isn't in the current batch.
+  std::vector<int64_t> batch_slot_of_group_;
+
+  // Blocking aggregates spill once their groups grow past the spill threshold. From then on the
+  // groups in memory keep aggregating, and the rows of every other group are written to spill
+  // partitions by key, which are aggregated one at a time at eos.
+  bool spill_enabled_ = false;
+  int64_t spill_threshold_bytes_ = 0;
+  std::unique_ptr<SpillPartitions> spill_partitions_;
+  std::vector<size_t> row_partitions_;
+
+  // Set when the plan asks to cache the closed time buckets of this aggregate. The cached buckets
+  // before the start of the input are merged in at Open, and the closed buckets of the input are
+  // cached at eos (unless the aggregate spilled).
+  AggStateCache* result_cache_ = nullptr;
+  uint64_t plan_fingerprint_ = 0;
   // END: Variables specific to GroupBy Agg.
 
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
-  Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
-  Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
-  Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
-                                     table_store::schema::RowBatch* output_rb);
+  void ResolveGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status AggregateBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Builds the output batch of the current groups and clears them.
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> GroupsToRowBatch(ExecState* exec_state);
+  int64_t EstimatedStateBytes() const;
+  Status SpillUnresolvedRows(const table_store::schema::RowBatch& rb);
+  Status AggregateSpilledPartitions(ExecState* exec_state, bool eow, bool eos);
+  Status MergeCachedBuckets(ExecState* exec_state);
+  Status CacheClosedBuckets(ExecState* exec_state);
+  void AppendSelectedValues(const table_store::schema::RowBatch& rb);
+  Status EvaluatePartialAggregates(ExecState* exec_state);
+  Status ConvertGroupsToRowBatch(ExecState* exec_state, table_store::schema::RowBatch* output_rb);
 
   AggHashValue* CreateAggHashValue(ExecState* exec_state);
-  RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
-  }
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
 };
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 
+#include <absl/strings/substitute.h>
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -270,6 +271,42 @@ agg_op {
   value_names: "value1"
 })";
 
+// Groups by the time bucket in column 0 and caches the buckets of 10ns that close before $1,
+// starting at $0.
+constexpr char kBlockingCachedBucketAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "minsum"
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 2
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "bucket"
+  value_names: "value1"
+  result_cache {
+    bucket_group_index: 0
+    bucket_size_ns: 10
+    range_start_ns: 0
+    input_start_ns: $0
+    closed_before_ns: $1
+  }
+})";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -383,6 +420,37 @@ TEST_F(AggNodeTest, single_group_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_blocking_selection) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Unselected rows don't create groups or contribute to them.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .Select({0, 2, 3})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .Select({0, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 5})
+                          .AddColumn<types::Int64Value>({1, 3, 3, 1})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_blocking) {
   auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
@@ -611,6 +679,107 @@ TEST_F(AggNodeTest, single_group_blocking_init_args) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_blocking_spills) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // Spill as soon as there is any group state.
+  exec_state_->set_spill_threshold_bytes(1);
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Group 1 stays in memory. The rows of group 2 arrive after the spill starts and are
+  // aggregated from their partition at eos.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1})
+                       .AddColumn<types::Int64Value>({5, 0})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({2, 1, 2})
+                       .AddColumn<types::Int64Value>({7, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({2, 1})
+                       .AddColumn<types::Int64Value>({4, 9})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({3})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({2})
+                          .AddColumn<types::Int64Value>({5})
+                          .get())
+      .Close();
+}
+
+TEST_F(AggNodeTest, cached_buckets_blocking) {
+  RowDescriptor input_rd(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  AggStateCache cache(/*max_bytes*/ 1024 * 1024);
+  exec_state_->set_agg_state_cache(&cache);
+
+  // The first run reads the whole range, and caches the buckets at 0 and 10.
+  auto first_plan_node = PlanNodeFromPbtxt(absl::Substitute(kBlockingCachedBucketAgg, 0, 20));
+  auto first_tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *first_plan_node, output_rd, {input_rd}, exec_state_.get());
+  first_tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({0, 0, 10, 20})
+                       .AddColumn<types::Int64Value>({1, 5, 1, 2})
+                       .AddColumn<types::Int64Value>({3, 3, 4, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Time64NSValue>({0, 10, 20})
+                          .AddColumn<types::Int64Value>({4, 1, 2})
+                          .get(),
+                      false)
+      .Close();
+  EXPECT_EQ(2, cache.num_buckets());
+
+  // The second run only reads the rows from 20 on, and merges the cached buckets.
+  auto second_plan_node = PlanNodeFromPbtxt(absl::Substitute(kBlockingCachedBucketAgg, 20, 30));
+  auto second_tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *second_plan_node, output_rd, {input_rd}, exec_state_.get());
+  second_tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({20, 20})
+                       .AddColumn<types::Int64Value>({7, 1})
+                       .AddColumn<types::Int64Value>({3, 9})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Time64NSValue>({0, 10, 20})
+                          .AddColumn<types::Int64Value>({4, 1, 4})
+                          .get(),
+                      false)
+      .Close();
+  EXPECT_EQ(3, cache.num_buckets());
+}
+
+TEST_F(AggNodeTest, cached_buckets_missing) {
+  RowDescriptor input_rd(
+      {types::DataType::TIME64NS, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  AggStateCache cache(/*max_bytes*/ 1024 * 1024);
+  exec_state_->set_agg_state_cache(&cache);
+
+  auto plan_node = PlanNodeFromPbtxt(absl::Substitute(kBlockingCachedBucketAgg, 20, 30));
+  AggNode node;
+  ASSERT_OK(node.Init(*plan_node, output_rd, {input_rd}));
+  ASSERT_OK(node.Prepare(exec_state_.get()));
+  auto s = node.Open(exec_state_.get());
+  EXPECT_TRUE(error::IsNotFound(s));
+  EXPECT_OK(node.Close(exec_state_.get()));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
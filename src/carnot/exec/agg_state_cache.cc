@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/agg_state_cache.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+void AggStateCache::Put(const Key& key, std::shared_ptr<BucketState> state) {
+  std::lock_guard<std::mutex> lock(lock_);
+  EraseLocked(key);
+  num_bytes_ += state->bytes;
+  lru_.push_front(key);
+  entries_[key] = Entry{std::move(state), lru_.begin()};
+
+  // Keep the bucket that was just added, even if it's larger than the whole cache on its own.
+  while (num_bytes_ > max_bytes_ && lru_.size() > 1) {
+    EraseLocked(lru_.back());
+  }
+}
+
+std::shared_ptr<AggStateCache::BucketState> AggStateCache::Get(const Key& key) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru_it);
+  return it->second.state;
+}
+
+int64_t AggStateCache::num_bytes() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return num_bytes_;
+}
+
+size_t AggStateCache::num_buckets() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return entries_.size();
+}
+
+void AggStateCache::EraseLocked(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  num_bytes_ -= it->second.state->bytes;
+  lru_.erase(it->second.lru_it);
+  entries_.erase(it);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
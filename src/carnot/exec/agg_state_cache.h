@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/udf/udf.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * AggStateCache holds the aggregate state of the closed time buckets of blocking aggregates (see
+ * planpb::AggregateResultCache), so that later runs of the same plan merge it instead of reading
+ * the input of those buckets again. It is shared by the queries of a Carnot instance and is safe
+ * to use from several threads. Once the buckets take up more than max_bytes, the least recently
+ * used ones are evicted.
+ */
+class AggStateCache : public NotCopyable {
+ public:
+  struct Key {
+    uint64_t plan_fingerprint;
+    int64_t node_id;
+    int64_t bucket_start_ns;
+
+    bool operator==(const Key& other) const {
+      return plan_fingerprint == other.plan_fingerprint && node_id == other.node_id &&
+             bucket_start_ns == other.bucket_start_ns;
+    }
+    template <typename H>
+    friend H AbslHashValue(H h, const Key& key) {
+      return H::combine(std::move(h), key.plan_fingerprint, key.node_id, key.bucket_start_ns);
+    }
+  };
+
+  /**
+   * The state of the groups of a single bucket. It must not be modified once it is in the cache,
+   * other than by UDA Merge calls that read from it.
+   */
+  struct BucketState {
+    // The group by columns, with one row per group.
+    std::vector<std::shared_ptr<arrow::Array>> keys;
+    // The UDAs of each group, in the order of the aggregate's values.
+    std::vector<std::vector<std::unique_ptr<udf::UDA>>> udas;
+
+    // An estimate of the memory used by the keys and the UDAs, set by whoever creates the state.
+    int64_t bytes = 0;
+
+    int64_t num_groups() const { return static_cast<int64_t>(udas.size()); }
+  };
+
+  explicit AggStateCache(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /**
+   * Adds the state of a bucket, replacing any state it already had.
+   */
+  void Put(const Key& key, std::shared_ptr<BucketState> state);
+
+  /**
+   * @return the state of the bucket, or nullptr if it isn't cached.
+   */
+  std::shared_ptr<BucketState> Get(const Key& key);
+
+  int64_t num_bytes() const;
+  size_t num_buckets() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<BucketState> state;
+    // The position of the key in lru_.
+    std::list<Key>::iterator lru_it;
+  };
+
+  // Expects lock_ to be held.
+  void EraseLocked(const Key& key);
+
+  const int64_t max_bytes_;
+  // Guards the members below.
+  mutable std::mutex lock_;
+  // The keys of the cached buckets, most recently used first.
+  std::list<Key> lru_;
+  absl::flat_hash_map<Key, Entry> entries_;
+  int64_t num_bytes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/agg_state_cache.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+std::shared_ptr<AggStateCache::BucketState> MakeBucket(int64_t bytes) {
+  auto state = std::make_shared<AggStateCache::BucketState>();
+  state->bytes = bytes;
+  return state;
+}
+
+}  // namespace
+
+TEST(AggStateCacheTest, put_and_get) {
+  AggStateCache cache(100);
+  auto bucket = MakeBucket(3);
+  cache.Put({1, 2, 0}, bucket);
+
+  EXPECT_EQ(bucket, cache.Get({1, 2, 0}));
+  EXPECT_EQ(nullptr, cache.Get({1, 2, 10}));
+  EXPECT_EQ(nullptr, cache.Get({1, 3, 0}));
+  EXPECT_EQ(nullptr, cache.Get({2, 2, 0}));
+  EXPECT_EQ(3, cache.num_bytes());
+  EXPECT_EQ(1, cache.num_buckets());
+}
+
+TEST(AggStateCacheTest, replaces_existing_bucket) {
+  AggStateCache cache(100);
+  cache.Put({1, 2, 0}, MakeBucket(3));
+  auto bucket = MakeBucket(5);
+  cache.Put({1, 2, 0}, bucket);
+
+  EXPECT_EQ(bucket, cache.Get({1, 2, 0}));
+  EXPECT_EQ(5, cache.num_bytes());
+  EXPECT_EQ(1, cache.num_buckets());
+}
+
+TEST(AggStateCacheTest, evicts_least_recently_used) {
+  AggStateCache cache(10);
+  cache.Put({1, 2, 0}, MakeBucket(4));
+  cache.Put({1, 2, 10}, MakeBucket(4));
+  // Reading the first bucket makes the second one the least recently used.
+  ASSERT_NE(nullptr, cache.Get({1, 2, 0}));
+  cache.Put({1, 2, 20}, MakeBucket(4));
+
+  EXPECT_NE(nullptr, cache.Get({1, 2, 0}));
+  EXPECT_EQ(nullptr, cache.Get({1, 2, 10}));
+  EXPECT_NE(nullptr, cache.Get({1, 2, 20}));
+  EXPECT_EQ(8, cache.num_bytes());
+  EXPECT_EQ(2, cache.num_buckets());
+}
+
+TEST(AggStateCacheTest, keeps_newest_bucket_over_limit) {
+  AggStateCache cache(10);
+  cache.Put({1, 2, 0}, MakeBucket(4));
+  cache.Put({1, 2, 10}, MakeBucket(20));
+
+  EXPECT_EQ(nullptr, cache.Get({1, 2, 0}));
+  EXPECT_NE(nullptr, cache.Get({1, 2, 10}));
+  EXPECT_EQ(20, cache.num_bytes());
+  EXPECT_EQ(1, cache.num_buckets());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -26,6 +26,7 @@
 #include <string>
 #include <utility>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
@@ -115,18 +116,33 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
   return Status::OK();
 }
 
-Status EquijoinNode::InitializeColumnBuilders() {
+std::shared_ptr<JoinKeyFilter> EquijoinNode::CreateProbeKeyFilter() {
+  if (probe_spec_.emit_unmatched_rows) {
+    return nullptr;
+  }
+  if (probe_key_filter_ == nullptr) {
+    probe_key_filter_ = std::make_shared<JoinKeyFilter>(key_data_types_);
+  }
+  return probe_key_filter_;
+}
+
+Status EquijoinNode::InitializeColumnBuilders(ExecState* exec_state) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+        MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
     PL_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
   column_builders_.resize(output_descriptor_->size());
-  PL_RETURN_IF_ERROR(InitializeColumnBuilders());
+  PL_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state));
+
+  // Joining a partition at a time reorders the probe rows, so joins that preserve the order of
+  // the probe table never spill.
+  spill_threshold_bytes_ = exec_state->spill_threshold_bytes();
+  spill_enabled_ = spill_threshold_bytes_ > 0 && !plan_node_->order_by_time();
 
   return Status::OK();
 }
@@ -138,9 +154,28 @@ Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
   build_buffer_.clear();
   probed_keys_.clear();
   key_values_pool_.Clear();
+
+  if (build_partitions_ != nullptr) {
+    stats()->AddExtraInfo("spilled_bytes", absl::StrCat(build_partitions_->bytes_written() +
+                                                        probe_partitions_->bytes_written()));
+  }
+  buffered_build_batches_.clear();
+  build_partitions_.reset();
+  probe_partitions_.reset();
   return Status::OK();
 }
 
+void EquijoinNode::ClearBuildState() {
+  build_buffer_.clear();
+  build_buffer_rows_.clear();
+  probed_keys_.clear();
+  join_keys_chunk_.clear();
+  build_wrappers_chunk_.clear();
+  probe_wrappers_chunk_.clear();
+  key_values_pool_.Clear();
+  column_values_pool_.Clear();
+}
+
 template <types::DataType DT>
 void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
                           int rt_col_idx) {
@@ -272,7 +307,7 @@ Status EquijoinNode::NextOutputBatch(ExecState* exec_state) {
   }
   pending_output_batch_.swap(output_batch);
 
-  return InitializeColumnBuilders();
+  return InitializeColumnBuilders(exec_state);
 }
 
 Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
@@ -410,18 +445,119 @@ Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
   return Status::OK();
 }
 
+Status EquijoinNode::HashBuildBatch(const table_store::schema::RowBatch& rb) {
+  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
+  return HashRowBatch(rb);
+}
+
+Status EquijoinNode::SpillBatch(const table_store::schema::RowBatch& rb, bool is_probe) {
+  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, is_probe));
+  row_partitions_.resize(rb.num_rows());
+  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    row_partitions_[row_idx] = SpillPartitionOf(join_keys_chunk_[row_idx]->Hash());
+  }
+  auto partitions = is_probe ? probe_partitions_.get() : build_partitions_.get();
+  return partitions->Append(rb, row_partitions_);
+}
+
+Status EquijoinNode::BufferOrSpillBuildBatch(ExecState* exec_state,
+                                             const table_store::schema::RowBatch& rb) {
+  if (build_partitions_ != nullptr) {
+    return SpillBatch(rb, /* is_probe */ false);
+  }
+  buffered_build_bytes_ += rb.NumBytes();
+  buffered_build_batches_.push_back(rb);
+  if (buffered_build_bytes_ <= spill_threshold_bytes_) {
+    return Status::OK();
+  }
+
+  // The build side is too large to hash in memory, so switch to partitioning both sides.
+  build_partitions_ = std::make_unique<SpillPartitions>(
+      input_descriptors_[1 - probe_parent_index()], exec_state->exec_mem_pool());
+  PL_RETURN_IF_ERROR(build_partitions_->Init(exec_state->spill_dir()));
+  probe_partitions_ = std::make_unique<SpillPartitions>(input_descriptors_[probe_parent_index()],
+                                                        exec_state->exec_mem_pool());
+  PL_RETURN_IF_ERROR(probe_partitions_->Init(exec_state->spill_dir()));
+  for (const auto& build_rb : buffered_build_batches_) {
+    PL_RETURN_IF_ERROR(SpillBatch(build_rb, /* is_probe */ false));
+  }
+  buffered_build_batches_.clear();
+  buffered_build_bytes_ = 0;
+  return Status::OK();
+}
+
+Status EquijoinNode::JoinSpilledPartitions(ExecState* exec_state) {
+  PL_RETURN_IF_ERROR(build_partitions_->StartReading());
+  PL_RETURN_IF_ERROR(probe_partitions_->StartReading());
+  // A key only ever lands in one partition, so each partition is joined on its own. probe_eos_ is
+  // already set, so DoProbe flushes the output rows of a partition before its state is cleared.
+  for (size_t i = 0; i < kNumSpillPartitions; ++i) {
+    ClearBuildState();
+    while (true) {
+      PL_ASSIGN_OR_RETURN(auto build_rb, build_partitions_->partition(i)->ReadNext());
+      if (build_rb == nullptr) {
+        break;
+      }
+      PL_RETURN_IF_ERROR(HashBuildBatch(*build_rb));
+    }
+    while (true) {
+      PL_ASSIGN_OR_RETURN(auto probe_rb, probe_partitions_->partition(i)->ReadNext());
+      if (probe_rb == nullptr) {
+        break;
+      }
+      PL_RETURN_IF_ERROR(DoProbe(exec_state, *probe_rb));
+    }
+    if (build_spec_.emit_unmatched_rows) {
+      PL_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
+    }
+    DCHECK_EQ(queued_rows_, 0);
+  }
+  return Status::OK();
+}
+
+Status EquijoinNode::ProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
+  if (build_partitions_ == nullptr) {
+    return DoProbe(exec_state, rb);
+  }
+  if (rb.eos()) {
+    probe_eos_ = true;
+  }
+  return SpillBatch(rb, /* is_probe */ true);
+}
+
 Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
   if (rb.eos()) {
     build_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PL_RETURN_IF_ERROR(HashRowBatch(rb));
+  if (spill_enabled_) {
+    PL_RETURN_IF_ERROR(BufferOrSpillBuildBatch(exec_state, rb));
+  } else {
+    PL_RETURN_IF_ERROR(HashBuildBatch(rb));
+  }
+
+  // The build side fit in memory after all.
+  if (build_eos_ && build_partitions_ == nullptr && !buffered_build_batches_.empty()) {
+    for (const auto& build_rb : buffered_build_batches_) {
+      PL_RETURN_IF_ERROR(HashBuildBatch(build_rb));
+    }
+    buffered_build_batches_.clear();
+  }
+
+  // The filter is left unpublished when the build side spilled, so no probe rows are dropped.
+  if (build_eos_ && probe_key_filter_ != nullptr && build_partitions_ == nullptr) {
+    std::vector<const RowTuple*> build_keys;
+    build_keys.reserve(build_buffer_rows_.size());
+    for (const auto& [key, num_rows] : build_buffer_rows_) {
+      build_keys.push_back(key);
+    }
+    PL_RETURN_IF_ERROR(probe_key_filter_->Publish(build_keys));
+  }
 
   if (build_eos_) {
     while (probe_batches_.size()) {
-      PL_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
+      PL_RETURN_IF_ERROR(ProbeBatch(exec_state, probe_batches_.front()));
       probe_batches_.pop();
     }
   }
@@ -434,7 +570,7 @@ Status EquijoinNode::ConsumeProbeBatch(ExecState* exec_state,
     probe_batches_.push(rb);
     return Status::OK();
   }
-  return DoProbe(exec_state, rb);
+  return ProbeBatch(exec_state, rb);
 }
 
 Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
@@ -448,7 +584,9 @@ Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::s
   }
 
   if (build_eos_ && probe_eos_) {
-    if (build_spec_.emit_unmatched_rows) {
+    if (build_partitions_ != nullptr) {
+      PL_RETURN_IF_ERROR(JoinSpilledPartitions(exec_state));
+    } else if (build_spec_.emit_unmatched_rows) {
       PL_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
     }
 
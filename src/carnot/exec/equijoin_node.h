@@ -30,7 +30,9 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/join_key_filter.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -64,6 +66,20 @@ class EquijoinNode : public ProcessingNode {
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  // The index of the parent whose rows are probed against the hash table. Valid after Init.
+  size_t probe_parent_index() const {
+    return probe_table_ == EquijoinNode::JoinInputTable::kLeftTable ? 0 : 1;
+  }
+  // The columns of the probe parent that hold the join keys.
+  const std::vector<int64_t>& probe_key_indices() const { return probe_spec_.key_indices; }
+
+  /**
+   * Returns a filter over the build keys that is published once the build side is complete, or
+   * nullptr if probe rows without a match can't be dropped because the join emits them.
+   * Must be called before Open.
+   */
+  std::shared_ptr<JoinKeyFilter> CreateProbeKeyFilter();
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,7 +90,7 @@ class EquijoinNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  Status InitializeColumnBuilders();
+  Status InitializeColumnBuilders(ExecState* exec_state);
   bool IsProbeTable(size_t parent_index);
   Status FlushChunkedRows(ExecState* exec_state);
   Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
@@ -89,6 +105,12 @@ class EquijoinNode : public ProcessingNode {
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status ProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status HashBuildBatch(const table_store::schema::RowBatch& rb);
+  Status BufferOrSpillBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status SpillBatch(const table_store::schema::RowBatch& rb, bool is_probe);
+  Status JoinSpilledPartitions(ExecState* exec_state);
+  void ClearBuildState();
 
   bool build_eos_ = false;
   bool probe_eos_ = false;
@@ -154,6 +176,20 @@ class EquijoinNode : public ProcessingNode {
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
 
+  // Filter over the build keys for the probe side source, if one was requested.
+  std::shared_ptr<JoinKeyFilter> probe_key_filter_;
+
+  // When spilling is enabled, build batches are buffered as they arrive and hashed at build eos.
+  // If they grow past the spill threshold, the build and probe rows are instead partitioned by
+  // key into spill files and joined one partition at a time once both sides are complete.
+  bool spill_enabled_ = false;
+  int64_t spill_threshold_bytes_ = 0;
+  int64_t buffered_build_bytes_ = 0;
+  std::vector<table_store::schema::RowBatch> buffered_build_batches_;
+  std::unique_ptr<SpillPartitions> build_partitions_;
+  std::unique_ptr<SpillPartitions> probe_partitions_;
+  std::vector<size_t> row_partitions_;
+
   std::unique_ptr<plan::JoinOperator> plan_node_;
 };
 
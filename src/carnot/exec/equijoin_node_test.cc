@@ -525,6 +525,159 @@ TEST_F(JoinNodeTest, unordered_no_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_left_join_spills) {
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:Int64]
+  // Output table: [left_1:Int64, right_0:Int64]
+  // Left outer join on left_0=right_1, with the left table as the build side.
+  const char* proto = R"(
+  type: LEFT_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // Spill as soon as any build rows arrive.
+  exec_state_->set_spill_threshold_bytes(1);
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd, input_rd}, exec_state_.get());
+
+  // The matches of key 1 and the unmatched build row of key 7 come from separate partitions.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 1, 7})
+                       .AddColumn<types::Int64Value>({10, 11, 70})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({100, 101, 200})
+                       .AddColumn<types::Int64Value>({1, 1, 2})
+                       .get(),
+                   1, 2)
+      .ExpectRowBatchesData(RowBatchBuilder(output_rd, 5, true, true)
+                                .AddColumn<types::Int64Value>({10, 11, 10, 11, 70})
+                                .AddColumn<types::Int64Value>({100, 100, 101, 101, 0})
+                                .get(),
+                            2)
+      .Close();
+}
+
+TEST_F(JoinNodeTest, probe_key_filter) {
+  // Inner join on left_0=right_1. The right table is probed, so the filter is over left_0.
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  EXPECT_EQ(1UL, tester.node()->probe_parent_index());
+  EXPECT_THAT(tester.node()->probe_key_indices(), ::testing::ElementsAre(1));
+
+  auto filter = tester.node()->CreateProbeKeyFilter();
+  ASSERT_NE(nullptr, filter);
+  EXPECT_FALSE(filter->published());
+
+  tester.ConsumeNext(RowBatchBuilder(input_rd_0, 3, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::StringValue>({"a", "b", "a"})
+                         .AddColumn<types::Int64Value>({1, 2, 3})
+                         .get(),
+                     0, 0);
+  EXPECT_TRUE(filter->published());
+
+  auto probe_rb = RowBatchBuilder(input_rd_1, 8, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7, 8})
+                      .AddColumn<types::StringValue>({"a", "x", "b", "y", "z", "a", "w", "v"})
+                      .get();
+  auto filtered_or_s = filter->Filter(probe_rb, {1}, arrow::default_memory_pool());
+  ASSERT_OK(filtered_or_s);
+  auto filtered = filtered_or_s.ConsumeValueOrDie();
+  EXPECT_TRUE(filtered->eow());
+  EXPECT_TRUE(filtered->eos());
+  // Bloom filters can have false positives, but never drop a matching key.
+  EXPECT_EQ(filtered->num_rows() + filter->rows_dropped(), 8);
+  EXPECT_GE(filter->rows_dropped(), 3);
+  auto ints = std::static_pointer_cast<arrow::Int64Array>(filtered->ColumnAt(0));
+  std::vector<int64_t> kept(ints->raw_values(), ints->raw_values() + ints->length());
+  EXPECT_THAT(kept, ::testing::IsSupersetOf({1, 3, 6}));
+}
+
+TEST_F(JoinNodeTest, probe_key_filter_float_zero) {
+  std::vector<types::DataType> key_types({types::DataType::FLOAT64});
+  JoinKeyFilter filter(key_types);
+  RowTuple build_key(&key_types);
+  build_key.SetValue(0, types::Float64Value(-0.0));
+  ASSERT_OK(filter.Publish({&build_key}));
+
+  RowDescriptor probe_rd({types::DataType::FLOAT64});
+  auto probe_rb = RowBatchBuilder(probe_rd, 2, /*eow*/ true, /*eos*/ true)
+                      .AddColumn<types::Float64Value>({0.0, -0.0})
+                      .get();
+  auto filtered_or_s = filter.Filter(probe_rb, {0}, arrow::default_memory_pool());
+  ASSERT_OK(filtered_or_s);
+  EXPECT_EQ(2, filtered_or_s.ConsumeValueOrDie()->num_rows());
+  EXPECT_EQ(0, filter.rows_dropped());
+}
+
+TEST_F(JoinNodeTest, no_probe_key_filter_for_full_outer_join) {
+  const char* proto = R"(
+  type: FULL_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 0
+  }
+  column_names: "left_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd, input_rd}, exec_state_.get());
+  EXPECT_EQ(nullptr, tester.node()->CreateProbeKeyFilter());
+}
+
 TEST_F(JoinNodeTest, zero_row_row_batch_right) {
   // Left table input: [left_0:String, left_1:Int64]
   // Right table input: [right_0:Int64, right_1:String]
@@ -19,9 +19,11 @@
 #include "src/carnot/exec/exec_graph.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/empty_source_node.h"
@@ -36,6 +38,8 @@
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/rolling_node.h"
+#include "src/carnot/exec/sort_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -73,19 +77,30 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
       })
       .OnMemorySource([&](auto& node) {
+        memory_sources_.insert(node.id());
         return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
       })
       .OnFilter([&](auto& node) {
-        return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
+        PL_RETURN_IF_ERROR(OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors));
+        MaybePushDownFilterToMemorySource(node);
+        return Status::OK();
       })
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnSort([&](auto& node) {
+        return OnOperatorImpl<plan::SortOperator, SortNode>(node, &descriptors);
+      })
+      .OnRolling([&](auto& node) {
+        return OnOperatorImpl<plan::RollingOperator, RollingNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
       .OnJoin([&](auto& node) {
-        return OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors);
+        PL_RETURN_IF_ERROR(OnOperatorImpl<plan::JoinOperator, EquijoinNode>(node, &descriptors));
+        MaybePushDownJoinKeyFilter(node);
+        return Status::OK();
       })
       .OnGRPCSource([&](auto& node) {
         auto s = OnOperatorImpl<plan::GRPCSourceOperator, GRPCSourceNode>(node, &descriptors);
@@ -111,6 +126,68 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .Walk(pf_);
 }
 
+void ExecutionGraph::MaybePushDownFilterToMemorySource(const plan::FilterOperator& filter) {
+  auto parents = pf_->dag().ParentsOf(filter.id());
+  if (parents.size() != 1 || !memory_sources_.contains(parents[0])) {
+    return;
+  }
+  // The predicates are only valid for the source if every row it outputs goes through the filter.
+  if (pf_->dag().DependenciesOf(parents[0]).size() != 1) {
+    return;
+  }
+  auto predicates = ZoneMapPredicatesFromExpression(*filter.expression());
+  if (predicates.empty()) {
+    return;
+  }
+  static_cast<MemorySourceNode*>(nodes_[parents[0]])->PushDownZoneMapPredicates(predicates);
+}
+
+void ExecutionGraph::MaybePushDownJoinKeyFilter(const plan::JoinOperator& join) {
+  auto* join_node = static_cast<EquijoinNode*>(nodes_[join.id()]);
+  auto parents = pf_->dag().ParentsOf(join.id());
+  if (parents.size() != 2) {
+    return;
+  }
+  int64_t node_id = parents[join_node->probe_parent_index()];
+  std::vector<int64_t> key_cols = join_node->probe_key_indices();
+  while (!memory_sources_.contains(node_id)) {
+    // Dropping rows is only safe if everything downstream of the node goes through the join.
+    if (pf_->dag().DependenciesOf(node_id).size() != 1) {
+      return;
+    }
+    plan::Operator* op = pf_->nodes()[node_id].get();
+    if (op->op_type() == planpb::FILTER_OPERATOR) {
+      auto selected_cols = static_cast<plan::FilterOperator*>(op)->selected_cols();
+      for (auto& col : key_cols) {
+        col = selected_cols[col];
+      }
+    } else if (op->op_type() == planpb::MAP_OPERATOR) {
+      const auto& exprs = static_cast<plan::MapOperator*>(op)->expressions();
+      for (auto& col : key_cols) {
+        if (exprs[col]->ExpressionType() != plan::Expression::kColumn) {
+          return;
+        }
+        col = static_cast<const plan::Column*>(exprs[col].get())->Index();
+      }
+    } else {
+      return;
+    }
+    auto op_parents = pf_->dag().ParentsOf(node_id);
+    if (op_parents.size() != 1) {
+      return;
+    }
+    node_id = op_parents[0];
+  }
+  if (pf_->dag().DependenciesOf(node_id).size() != 1) {
+    return;
+  }
+  auto filter = join_node->CreateProbeKeyFilter();
+  if (filter == nullptr) {
+    return;
+  }
+  static_cast<MemorySourceNode*>(nodes_[node_id])->PushDownJoinKeyFilter(filter, key_cols);
+}
+
 bool ExecutionGraph::YieldWithTimeout() {
   std::unique_lock<std::mutex> lock(execution_mutex_);
   if (continue_) {
@@ -174,6 +251,56 @@ Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
   return Status::OK();
 }
 
+StatusOr<bool> ExecutionGraph::RunSource(SourceNode* source, int64_t source_id) {
+  if (grpc_sources_.contains(source_id)) {
+    auto s = CheckUpstreamGRPCConnectionHealth(static_cast<GRPCSourceNode*>(source));
+    if (!s.ok()) {
+      LOG(ERROR) << absl::Substitute(
+          "GRPCSourceNode connection to remote sink not healthy, terminating that source and "
+          "proceeding with the rest of the query. Message: $0",
+          s.msg());
+      PL_RETURN_IF_ERROR(source->SendEndOfStream(exec_state_));
+      return true;
+    }
+  }
+
+  exec_state_->SetCurrentSource(source_id);
+
+  for (auto i = 0; i < consecutive_generate_calls_per_source_; ++i) {
+    if (!source->NextBatchReady() || !exec_state_->keep_running()) {
+      break;
+    }
+    PL_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
+  }
+
+  // keep_running will be set to false when a downstream limit for this particular
+  // source (set in exec_state) has been reached.
+  return !source->HasBatchesRemaining() || !exec_state_->keep_running();
+}
+
+void ExecutionGraph::SerializeSharedNodes() {
+  absl::flat_hash_map<ExecNode*, int64_t> num_sources_reaching_node;
+  for (int64_t source_id : sources_) {
+    absl::flat_hash_set<ExecNode*> visited;
+    std::vector<ExecNode*> stack{nodes_.at(source_id)};
+    while (!stack.empty()) {
+      ExecNode* node = stack.back();
+      stack.pop_back();
+      for (ExecNode* child : node->children()) {
+        if (visited.insert(child).second) {
+          stack.push_back(child);
+        }
+      }
+    }
+    for (ExecNode* node : visited) {
+      // Nodes take each other's locks in the order of the graph, so this can't deadlock.
+      if (++num_sources_reaching_node[node] > 1) {
+        node->SerializeConsumeNext();
+      }
+    }
+  }
+}
+
 Status ExecutionGraph::ExecuteSources() {
   absl::flat_hash_set<SourceNode*> running_sources;
 
@@ -192,34 +319,30 @@ Status ExecutionGraph::ExecuteSources() {
   while (running_sources.size()) {
     absl::flat_hash_set<SourceNode*> completed_sources_execute_loop;
 
-    for (SourceNode* source : running_sources) {
-      if (grpc_sources_.contains(source_to_id.at(source))) {
-        auto s = CheckUpstreamGRPCConnectionHealth(static_cast<GRPCSourceNode*>(source));
-        if (!s.ok()) {
-          LOG(ERROR) << absl::Substitute(
-              "GRPCSourceNode connection to remote sink not healthy, terminating that source and "
-              "proceeding with the rest of the query. Message: $0",
-              s.msg());
-          PL_RETURN_IF_ERROR(source->SendEndOfStream(exec_state_));
-          completed_sources_execute_loop.insert(source);
-          continue;
+    if (worker_pool_ != nullptr && running_sources.size() > 1) {
+      // Give each running source its turn on the worker pool, then wait for all of them.
+      std::vector<SourceNode*> round(running_sources.begin(), running_sources.end());
+      std::vector<char> completed(round.size(), false);
+      std::vector<std::function<Status()>> tasks;
+      for (size_t i = 0; i < round.size(); ++i) {
+        tasks.push_back([this, &round, &completed, &source_to_id, i]() -> Status {
+          PL_ASSIGN_OR_RETURN(completed[i], RunSource(round[i], source_to_id.at(round[i])));
+          return Status::OK();
+        });
+      }
+      PL_RETURN_IF_ERROR(worker_pool_->Run(tasks));
+      for (size_t i = 0; i < round.size(); ++i) {
+        if (completed[i]) {
+          completed_sources_execute_loop.insert(round[i]);
         }
       }
-
-      exec_state_->SetCurrentSource(source_to_id[source]);
-
-      for (auto i = 0; i < consecutive_generate_calls_per_source_; ++i) {
-        if (!source->NextBatchReady() || !exec_state_->keep_running()) {
+    } else {
+      for (SourceNode* source : running_sources) {
+        PL_ASSIGN_OR_RETURN(bool source_completed, RunSource(source, source_to_id.at(source)));
+        if (source_completed) {
+          completed_sources_execute_loop.insert(source);
           break;
         }
-        PL_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
-      }
-
-      // keep_running will be set to false when a downstream limit for this particular
-      // source (set in exec_state) has been reached.
-      if (!source->HasBatchesRemaining() || !exec_state_->keep_running()) {
-        completed_sources_execute_loop.insert(source);
-        break;
       }
     }
     PL_RETURN_IF_ERROR(CheckDownstreamGRPCConnectionsHealth());
@@ -307,9 +430,17 @@ Status ExecutionGraph::Execute() {
     PL_RETURN_IF_ERROR(node->Open(exec_state_));
   }
 
+  if (num_threads_ > 1 && sources_.size() > 1) {
+    SerializeSharedNodes();
+    // The calling thread runs sources too.
+    int num_workers = std::min<int>(num_threads_, sources_.size()) - 1;
+    worker_pool_ = std::make_unique<WorkerPool>(num_workers);
+  }
+
   // We don't PL_RETURN_IF_ERROR here because we want to make sure we close all of our
   // nodes, even if there was an error during execution.
   Status source_status = ExecuteSources();
+  worker_pool_.reset();
   Status close_status = Status::OK();
 
   for (auto node : nodes) {
@@ -32,6 +32,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/worker_pool.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -121,6 +122,16 @@ class ExecutionGraph {
     return node->second;
   }
 
+  /**
+   * Sets how many threads Execute() may use. With more than one thread, the sources of the
+   * graph run concurrently and each of them pushes its batches down its own chain of operators.
+   * Operators that are fed by more than one source process one batch at a time. A single source
+   * is not split up, and aggregates and joins keep a single state, so only graphs with several
+   * sources, such as a Kelvin merging many agents, run in parallel.
+   * @param num_threads The number of threads, including the one that calls Execute().
+   */
+  void set_num_threads(int32_t num_threads) { num_threads_ = num_threads; }
+
   /**
    * Executes the current graph until there is no more work that can be done synchronously.
    */
@@ -209,6 +220,36 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  /**
+   * Runs up to consecutive_generate_calls_per_source_ batches of the given source.
+   * @param source The source to run.
+   * @param source_id The id of the source.
+   * @return Whether the source has completed.
+   */
+  StatusOr<bool> RunSource(SourceNode* source, int64_t source_id);
+
+  /**
+   * Marks the nodes that can be reached from more than one source, so that their ConsumeNext
+   * calls are serialized when sources run on different threads.
+   */
+  void SerializeSharedNodes();
+
+  /**
+   * If the filter's only parent is a MemorySourceNode that feeds nothing else, push the filter's
+   * simple column predicates down into the source so that it can skip table batches.
+   * @param filter The filter operator, whose ExecNode has already been created.
+   */
+  void MaybePushDownFilterToMemorySource(const plan::FilterOperator& filter);
+
+  /**
+   * If the probe side of the join reads from a MemorySourceNode through filters and maps that
+   * pass the join keys through and feed nothing else, push the join's build key filter down into
+   * the source so that it can drop rows that can't match. Only sources in this plan fragment can
+   * be reached, so a probe side that comes in through a GRPCSourceNode is left unfiltered.
+   * @param join The join operator, whose ExecNode has already been created.
+   */
+  void MaybePushDownJoinKeyFilter(const plan::JoinOperator& join);
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
@@ -217,6 +258,7 @@ class ExecutionGraph {
   std::vector<int64_t> sources_;
   absl::flat_hash_set<int64_t> grpc_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
+  absl::flat_hash_set<int64_t> memory_sources_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
   SystemTimePoint query_start_time_;
@@ -234,6 +276,11 @@ class ExecutionGraph {
   // (Doesn't apply if there is only one active source.)
   int32_t consecutive_generate_calls_per_source_ = kDefaultConsecutiveGenerateCallsPerSource;
 
+  // The number of threads that run sources, see set_num_threads().
+  int32_t num_threads_ = 1;
+  // Created by Execute() when sources run in parallel.
+  std::unique_ptr<WorkerPool> worker_pool_;
+
   // Whether or not the graph should continue executing or wait for more work to do.
   bool continue_ = false;
   std::mutex execution_mutex_;
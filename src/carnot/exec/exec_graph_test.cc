@@ -22,6 +22,7 @@
 #include <arrow/memory_pool.h>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -126,6 +127,21 @@ TEST_F(ExecGraphTest, basic) {
   EXPECT_EQ(0, root_children[1]->children()[0]->children().size());
 }
 
+TEST_F(ExecGraphTest, keep_running_without_current_source) {
+  // Threads that don't run a source, like the worker pool's, keep running.
+  EXPECT_TRUE(exec_state_->keep_running());
+
+  exec_state_->SetCurrentSource(1);
+  EXPECT_TRUE(exec_state_->keep_running());
+  exec_state_->StopSource(1);
+  EXPECT_FALSE(exec_state_->keep_running());
+
+  bool other_thread_keep_running = false;
+  std::thread other_thread([&]() { other_thread_keep_running = exec_state_->keep_running(); });
+  other_thread.join();
+  EXPECT_TRUE(other_thread_keep_running);
+}
+
 class ExecGraphExecuteTest : public ExecGraphTest,
                              public ::testing::WithParamInterface<std::tuple<int32_t>> {};
 
@@ -348,7 +364,10 @@ TEST_F(ExecGraphTest, two_limits_dont_interfere) {
   EXPECT_TRUE(out_rb2->ColumnAt(2)->Equals(types::ToArrow(out_col3, arrow::default_memory_pool())));
 }
 
-TEST_F(ExecGraphTest, limit_w_multiple_srcs) {
+class MultipleSourcesExecGraphTest : public ExecGraphTest,
+                                     public ::testing::WithParamInterface<int32_t> {};
+
+TEST_P(MultipleSourcesExecGraphTest, limit_w_multiple_srcs) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kOneLimit3Sources, &pf_pb));
   std::shared_ptr<plan::PlanFragment> plan_fragment_ = std::make_shared<plan::PlanFragment>(1);
@@ -393,6 +412,7 @@ TEST_F(ExecGraphTest, limit_w_multiple_srcs) {
       MockTraceStubGenerator, sole::uuid4(), nullptr);
 
   ExecutionGraph e;
+  e.set_num_threads(GetParam());
   auto s = e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
                   /* collect_exec_node_stats */ false);
 
@@ -409,6 +429,9 @@ TEST_F(ExecGraphTest, limit_w_multiple_srcs) {
   EXPECT_TRUE(out_rb->ColumnAt(2)->Equals(types::ToArrow(out_col3, arrow::default_memory_pool())));
 }
 
+INSTANTIATE_TEST_SUITE_P(MultipleSourcesExecGraphTestSuite, MultipleSourcesExecGraphTest,
+                         ::testing::Values(1, 2, 4));
+
 TEST_F(ExecGraphTest, two_sequential_limits) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kTwoSequentialLimits, &pf_pb));
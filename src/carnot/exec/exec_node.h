@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -46,7 +47,7 @@ struct ExecNodeStats {
     }
     ++batches_output;
     bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    rows_output += rb.num_selected_rows();
   }
 
   void AddInputStats(const table_store::schema::RowBatch& rb) {
@@ -55,7 +56,7 @@ struct ExecNodeStats {
     }
     ++batches_input;
     bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    rows_input += rb.num_selected_rows();
   }
 
   void ResumeChildTimer() {
@@ -63,11 +64,13 @@ struct ExecNodeStats {
       return;
     }
     children_timer.Resume();
+    children_counters.Resume();
   }
   void StopChildTimer() {
     if (!collect_exec_stats) {
       return;
     }
+    children_counters.Stop();
     children_timer.Stop();
   }
   void ResumeTotalTimer() {
@@ -75,11 +78,13 @@ struct ExecNodeStats {
       return;
     }
     total_timer.Resume();
+    total_counters.Resume();
   }
   void StopTotalTimer() {
     if (!collect_exec_stats) {
       return;
     }
+    total_counters.Stop();
     total_timer.Stop();
   }
 
@@ -99,6 +104,24 @@ struct ExecNodeStats {
     extra_info[key] = value;
   }
 
+  // The most bytes of query memory allocated by this node and not yet freed at any one time.
+  int64_t PeakMemoryBytes() const {
+    return memory_tracker == nullptr ? 0 : memory_tracker->peak_bytes();
+  }
+
+  // The allocations the node made from the query's memory pool.
+  int64_t NumAllocations() const {
+    return memory_tracker == nullptr ? 0 : memory_tracker->num_allocations();
+  }
+  int64_t BytesAllocated() const {
+    return memory_tracker == nullptr ? 0 : memory_tracker->total_bytes_allocated();
+  }
+
+  // The hardware events of the node itself, excluding its children.
+  PerfCounterValues SelfPerfCounters() const {
+    return total_counters.values() - children_counters.values();
+  }
+
   int64_t ChildExecTime() const { return children_timer.ElapsedTime_us() * 1000; }
   int64_t TotalExecTime() const { return total_timer.ElapsedTime_us() * 1000; }
   int64_t SelfExecTime() const { return TotalExecTime() - ChildExecTime(); }
@@ -119,8 +142,14 @@ struct ExecNodeStats {
   ElapsedTimer total_timer;
   // Total timer for the children of the ndoe.
   ElapsedTimer children_timer;
+  // Hardware event counts of the node, including its children, like total_timer.
+  PerfCounters total_counters;
+  // Hardware event counts of the children of the node.
+  PerfCounters children_counters;
   // Flag to determine whether to collect stats or not.
   bool collect_exec_stats;
+  // Tracks the query memory allocated by the node. Owned by the query's memory pool.
+  MemoryTracker* memory_tracker = nullptr;
 
   // Extra metrics to store.
   absl::flat_hash_map<std::string, double> extra_metrics;
@@ -160,6 +189,8 @@ class ExecNode {
    */
   Status Prepare(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    stats_->memory_tracker = exec_state->query_mem_pool()->NewTracker();
+    ScopedMemoryTracker scoped_tracker(stats_->memory_tracker);
     return PrepareImpl(exec_state);
   }
 
@@ -170,6 +201,7 @@ class ExecNode {
    */
   Status Open(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    ScopedMemoryTracker scoped_tracker(stats_->memory_tracker);
     return OpenImpl(exec_state);
   }
 
@@ -194,6 +226,7 @@ class ExecNode {
   Status GenerateNext(ExecState* exec_state) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
+    ScopedMemoryTracker scoped_tracker(stats_->memory_tracker);
     stats_->ResumeTotalTimer();
     PL_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
     stats_->StopTotalTimer();
@@ -214,11 +247,16 @@ class ExecNode {
                      size_t parent_index) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSinkNode || type() == ExecNodeType::kProcessingNode);
+    std::unique_lock<std::mutex> lock;
+    if (consume_mutex_ != nullptr) {
+      lock = std::unique_lock<std::mutex>(*consume_mutex_);
+    }
     if (rb.eos() && !rb.eow()) {
       return error::Internal(
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
     stats_->AddInputStats(rb);
+    ScopedMemoryTracker scoped_tracker(stats_->memory_tracker);
     stats_->ResumeTotalTimer();
     PL_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
     stats_->StopTotalTimer();
@@ -240,6 +278,12 @@ class ExecNode {
    */
   bool IsProcessing() { return type() == ExecNodeType::kProcessingNode; }
 
+  /**
+   * Whether the node can consume row batches that carry a selection (see
+   * RowBatch::set_selection). Nodes that don't accept selections are only sent dense batches.
+   */
+  virtual bool AcceptsSelection() const { return false; }
+
   /**
    * Get a debug string for the node.
    * @return the debug string/
@@ -275,6 +319,16 @@ class ExecNode {
 
   ExecNodeStats* stats() const { return stats_.get(); }
 
+  /**
+   * Makes calls to ConsumeNext mutually exclusive. The execution graph calls this for nodes that
+   * are fed by sources running on different threads. Must be called before execution starts.
+   */
+  void SerializeConsumeNext() {
+    if (consume_mutex_ == nullptr) {
+      consume_mutex_ = std::make_unique<std::mutex>();
+    }
+  }
+
  protected:
   /**
    * Send data to children row batches.
@@ -285,6 +339,7 @@ class ExecNode {
   Status SendRowBatchToChildren(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
     stats_->ResumeChildTimer();
     for (size_t i = 0; i < children_.size(); ++i) {
+      DCHECK(!rb.has_selection() || children_[i]->AcceptsSelection());
       PL_RETURN_IF_ERROR(children_[i]->ConsumeNext(exec_state, rb, parent_ids_for_children_[i]));
     }
     stats_->StopChildTimer();
@@ -296,6 +351,18 @@ class ExecNode {
     return Status::OK();
   }
 
+  /**
+   * @return whether every child of the node accepts row batches with a selection.
+   */
+  bool ChildrenAcceptSelection() const {
+    for (const auto* child : children_) {
+      if (!child->AcceptsSelection()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   explicit ExecNode(ExecNodeType type) : type_(type) {}
 
   // Defines the protected implementations of the non-virtual interface functions
@@ -330,6 +397,8 @@ class ExecNode {
   std::vector<size_t> parent_ids_for_children_;
   // Whether Close() has been called on this ExecNode.
   bool is_closed_ = false;
+  // Set when ConsumeNext can be called from several threads, see SerializeConsumeNext().
+  std::unique_ptr<std::mutex> consume_mutex_;
   // The type of execution node.
   ExecNodeType type_;
   // Whether this node has been initialized.
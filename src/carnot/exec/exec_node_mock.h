@@ -41,6 +41,12 @@ class MockExecNode : public ExecNode {
   MOCK_METHOD1(CloseImpl, Status(ExecState* exec_state));
   MOCK_METHOD1(GenerateNextImpl, Status(ExecState*));
   MOCK_METHOD3(ConsumeNextImpl, Status(ExecState*, const table_store::schema::RowBatch&, size_t));
+
+  bool AcceptsSelection() const override { return accepts_selection_; }
+  void set_accepts_selection(bool accepts_selection) { accepts_selection_ = accepts_selection; }
+
+ private:
+  bool accepts_selection_ = false;
 };
 
 class MockSourceNode : public SourceNode {
@@ -20,19 +20,27 @@
 
 #include <arrow/memory_pool.h>
 
+#include <chrono>
+#include <filesystem>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
+#include "src/carnot/exec/agg_state_cache.h"
+#include "src/carnot/exec/otel_export_pool.h"
 #include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/exec/ml/model_pool.h"
+#include "src/carnot/exec/query_memory_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/table_store/table/table_store.h"
 
@@ -60,6 +68,10 @@ using TraceStubGenerator = std::function<
  *
  * The purpose of this class is to keep track of resources required for the query
  * and provide common resources (UDFs, UDA, etc) the operators within the query.
+ *
+ * ExecutionGraph can run the sources of a query on several threads, so the state that is used
+ * while sources are executing (the current source, stopped sources and the stub caches) is safe
+ * to access concurrently. The current source is tracked per thread.
  */
 class ExecState {
  public:
@@ -86,10 +98,9 @@ class ExecState {
       grpc_router_->DeleteQuery(query_id_);
     }
   }
-  arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
-  }
+  // The pool that all of the query's arrow memory is allocated from.
+  arrow::MemoryPool* exec_mem_pool() { return mem_pool_.get(); }
+  QueryMemoryPool* query_mem_pool() { return mem_pool_.get(); }
 
   udf::Registry* func_registry() { return func_registry_; }
 
@@ -99,6 +110,54 @@ class ExecState {
 
   ml::ModelPool* model_pool() { return model_pool_; }
 
+  // Blocking operators whose state grows past this many bytes write it to spill files in
+  // spill_dir() and finish the query a partition at a time. 0 disables spilling.
+  int64_t spill_threshold_bytes() const { return spill_threshold_bytes_; }
+  void set_spill_threshold_bytes(int64_t bytes) { spill_threshold_bytes_ = bytes; }
+  const std::filesystem::path& spill_dir() const { return spill_dir_; }
+  void set_spill_dir(const std::filesystem::path& dir) { spill_dir_ = dir; }
+
+  // The gRPC compression of the streams that GRPCSinks send to other Carnot instances.
+  grpc_compression_algorithm grpc_sink_compression() const { return grpc_sink_compression_; }
+  void set_grpc_sink_compression(grpc_compression_algorithm algorithm) {
+    grpc_sink_compression_ = algorithm;
+  }
+
+  // Whether expression evaluators run supported expressions as fused kernels (see
+  // FusedExpression) instead of calling the UDFs.
+  bool fused_expressions_enabled() const { return fused_expressions_enabled_; }
+  void set_fused_expressions_enabled(bool enabled) { fused_expressions_enabled_ = enabled; }
+
+  // OTelExportSinks accumulate rows into a single export request until it reaches this size, this
+  // much time has passed since its first row, or the input reaches the end of a window.
+  int64_t otel_export_batch_bytes() const { return otel_export_batch_bytes_; }
+  void set_otel_export_batch_bytes(int64_t bytes) { otel_export_batch_bytes_ = bytes; }
+  std::chrono::milliseconds otel_export_flush_interval() const {
+    return otel_export_flush_interval_;
+  }
+  void set_otel_export_flush_interval(std::chrono::milliseconds interval) {
+    otel_export_flush_interval_ = interval;
+  }
+
+  // The cache of the closed time buckets of aggregates, shared across queries. Unowned, and null
+  // if caching is disabled.
+  AggStateCache* agg_state_cache() const { return agg_state_cache_; }
+  void set_agg_state_cache(AggStateCache* cache) { agg_state_cache_ = cache; }
+  // The fingerprint of the plan being executed, see plan::PlanFingerprint.
+  uint64_t plan_fingerprint() const { return plan_fingerprint_; }
+  void set_plan_fingerprint(uint64_t fingerprint) { plan_fingerprint_ = fingerprint; }
+
+  // The threads that OTelExportSinks send their exports on, shared by the queries of a Carnot
+  // instance. Not owned.
+  OTelExportPool* otel_export_pool() const { return otel_export_pool_; }
+  void set_otel_export_pool(OTelExportPool* pool) { otel_export_pool_ = pool; }
+
+  // The number of export RPCs that each OTelExportSink may have queued or running at once.
+  int otel_export_max_in_flight() const { return otel_export_max_in_flight_; }
+  void set_otel_export_max_in_flight(int max_in_flight) {
+    otel_export_max_in_flight_ = max_in_flight;
+  }
+
   Status AddScalarUDF(int64_t id, const std::string& name,
                       const std::vector<types::DataType> arg_types) {
     PL_ASSIGN_OR_RETURN(auto def, func_registry_->GetScalarUDFDefinition(name, arg_types));
@@ -116,6 +175,7 @@ class ExecState {
   // Currently, it will either be a Kelvin instance or a query broker.
   carnotpb::ResultSinkService::StubInterface* ResultSinkServiceStub(
       const std::string& remote_address, const std::string& ssl_targetname) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (result_sink_stub_map_.contains(remote_address)) {
       return result_sink_stub_map_[remote_address];
     }
@@ -130,6 +190,7 @@ class ExecState {
 
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface* MetricsServiceStub(
       const std::string& remote_address, bool insecure) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (metrics_service_stub_map_.contains(remote_address)) {
       return metrics_service_stub_map_[remote_address];
     }
@@ -143,6 +204,7 @@ class ExecState {
   }
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* TraceServiceStub(
       const std::string& remote_address, bool insecure) {
+    std::lock_guard<std::mutex> lock(stubs_lock_);
     if (trace_service_stub_map_.contains(remote_address)) {
       return trace_service_stub_map_[remote_address];
     }
@@ -170,19 +232,27 @@ class ExecState {
 
   // A node (ie. Limit) can call this method to say no more records will be processed for this
   // source. That node is responsible for setting eos.
-  void StopSource(int64_t src_id) { source_id_to_keep_running_map_[src_id] = false; }
+  void StopSource(int64_t src_id) {
+    std::lock_guard<std::mutex> lock(sources_lock_);
+    source_id_to_keep_running_map_[src_id] = false;
+  }
 
   bool keep_running() {
-    DCHECK(current_source_set_);
-    return source_id_to_keep_running_map_[current_source_];
+    std::lock_guard<std::mutex> lock(sources_lock_);
+    auto current_source = current_source_.find(std::this_thread::get_id());
+    if (current_source == current_source_.end()) {
+      // Threads that don't execute a source (eg. the worker pool's threads) are never stopped.
+      return true;
+    }
+    auto keep_running = source_id_to_keep_running_map_.find(current_source->second);
+    return keep_running == source_id_to_keep_running_map_.end() || keep_running->second;
   }
 
   void SetCurrentSource(int64_t source_id) {
-    current_source_ = source_id;
-    current_source_set_ = true;
-    if (source_id_to_keep_running_map_.find(current_source_) ==
-        source_id_to_keep_running_map_.end()) {
-      source_id_to_keep_running_map_[current_source_] = true;
+    std::lock_guard<std::mutex> lock(sources_lock_);
+    current_source_[std::this_thread::get_id()] = source_id;
+    if (source_id_to_keep_running_map_.find(source_id) == source_id_to_keep_running_map_.end()) {
+      source_id_to_keep_running_map_[source_id] = true;
     }
   }
 
@@ -214,12 +284,28 @@ class ExecState {
   const sole::uuid query_id_;
   ml::ModelPool* model_pool_;
   GRPCRouter* grpc_router_ = nullptr;
+  QueryMemoryPoolPtr mem_pool_ = QueryMemoryPool::Create();
+  int64_t spill_threshold_bytes_ = 0;
+  std::filesystem::path spill_dir_ = fs::TempDirectoryPath();
+  bool fused_expressions_enabled_ = true;
+  grpc_compression_algorithm grpc_sink_compression_ = GRPC_COMPRESS_NONE;
+  int64_t otel_export_batch_bytes_ = 1024 * 1024;
+  std::chrono::milliseconds otel_export_flush_interval_{1000};
+  int otel_export_max_in_flight_ = 4;
+  OTelExportPool* otel_export_pool_ = nullptr;
+  AggStateCache* agg_state_cache_ = nullptr;
+  uint64_t plan_fingerprint_ = 0;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
 
-  int64_t current_source_ = 0;
-  bool current_source_set_ = false;
+  // Guards current_source_ and source_id_to_keep_running_map_.
+  std::mutex sources_lock_;
+  // The source that each thread is executing.
+  absl::flat_hash_map<std::thread::id, int64_t> current_source_;
   std::map<int64_t, bool> source_id_to_keep_running_map_;
 
+  // Guards the stub pools and maps below.
+  std::mutex stubs_lock_;
+
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
   absl::flat_hash_map<std::string, carnotpb::ResultSinkService::StubInterface*>
@@ -140,10 +140,36 @@ Status ScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch
   CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
 
   for (const auto& expression : expressions_) {
-    PL_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expression, output));
+    auto* fused = FusedExpressionFor(*expression, input);
+    if (fused == nullptr) {
+      PL_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expression, output));
+      continue;
+    }
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(fused->EvaluateToArrow(input, exec_state->exec_mem_pool(), &arr));
+    PL_RETURN_IF_ERROR(output->AddColumn(arr));
   }
   return Status::OK();
 }
+
+void ScalarExpressionEvaluator::CompileFusedExpressions(ExecState* exec_state) {
+  fused_expressions_.clear();
+  for (const auto& expression : expressions_) {
+    fused_expressions_.push_back(exec_state->fused_expressions_enabled()
+                                     ? FusedExpression::Compile(*expression, exec_state)
+                                     : nullptr);
+  }
+}
+
+FusedExpression* ScalarExpressionEvaluator::FusedExpressionFor(const plan::ScalarExpression& expr,
+                                                               const RowBatch& input) const {
+  for (const auto& [idx, fused] : Enumerate(fused_expressions_)) {
+    if (expressions_[idx].get() == &expr) {
+      return fused != nullptr && fused->MatchesInput(input.desc()) ? fused.get() : nullptr;
+    }
+  }
+  return nullptr;
+}
 std::string ScalarExpressionEvaluator::DebugString() {
   std::vector<std::string> debug_strs(expressions_.size());
   std::transform(begin(expressions_), end(expressions_), begin(debug_strs),
@@ -180,6 +206,7 @@ Status VectorNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (auto expr : expressions_) {
     PL_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
   }
+  CompileFusedExpressions(exec_state);
   return Status::OK();
 }
 
@@ -194,6 +221,13 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   CHECK(exec_state != nullptr);
   CHECK_GT(input.num_columns(), 0);
 
+  auto* fused = FusedExpressionFor(expr, input);
+  if (fused != nullptr) {
+    types::SharedColumnWrapper result;
+    PL_RETURN_IF_ERROR(fused->EvaluateToColumnWrapper(input, &result));
+    return result;
+  }
+
   size_t num_rows = input.num_rows();
 
   // Path for scalar funcs an their dependencies to get evaluated.
@@ -282,6 +316,7 @@ Status ArrowNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (const auto& expr : expressions_) {
     PL_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
   }
+  CompileFusedExpressions(exec_state);
   return Status::OK();
 }
 Status ArrowNativeScalarExpressionEvaluator::Close(ExecState*) {
@@ -320,7 +355,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
         auto udf = id_to_udf_map_[fn.udf_id()].get();
 
-        auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
+        auto output = MakeArrowBuilder(def->exec_return_type(), exec_state->exec_mem_pool());
 
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
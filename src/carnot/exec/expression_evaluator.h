@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
@@ -123,7 +124,16 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
                                           table_store::schema::RowBatch* output) = 0;
   Status InitFuncsInExpression(ExecState* exec_state,
                                std::shared_ptr<const plan::ScalarExpression> expr);
+  // Lowers the expressions that can be fused into kernels, if fused expressions are enabled.
+  void CompileFusedExpressions(ExecState* exec_state);
+  // The fused expression of the given expression, or nullptr if it wasn't fused or can't run on
+  // the input.
+  FusedExpression* FusedExpressionFor(const plan::ScalarExpression& expr,
+                                      const table_store::schema::RowBatch& input) const;
+
   plan::ConstScalarExpressionVector expressions_;
+  // Parallel to expressions_.
+  std::vector<std::unique_ptr<FusedExpression>> fused_expressions_;
   udf::FunctionContext* function_ctx_ = nullptr;
   std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> id_to_udf_map_;
 };
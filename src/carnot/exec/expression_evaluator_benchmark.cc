@@ -29,6 +29,7 @@
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
 #include "src/carnot/exec/test_utils.h"
+#include "src/carnot/funcs/builtins/math_ops.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
@@ -51,41 +52,78 @@ using px::carnot::exec::MockResultSinkStubGenerator;
 using px::carnot::exec::MockTraceStubGenerator;
 using px::carnot::exec::ScalarExpressionEvaluator;
 using px::carnot::exec::ScalarExpressionEvaluatorType;
+using px::carnot::exec::VectorNativeScalarExpressionEvaluator;
 using px::carnot::planpb::testutils::kAddScalarFuncNestedPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncPbtxt;
 using px::carnot::planpb::testutils::kColumnReferencePbtxt;
 using px::carnot::planpb::testutils::kScalarInt64ValuePbtxt;
-using px::carnot::udf::FunctionContext;
 using px::carnot::udf::Registry;
-using px::carnot::udf::ScalarUDF;
 using px::table_store::schema::RowBatch;
 using px::table_store::schema::RowDescriptor;
 using px::types::DataType;
 using px::types::Int64Value;
 using px::types::ToArrow;
 
-class AddUDF : public ScalarUDF {
- public:
-  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
-};
+// (col0 > 100) && (col1 < 200), the shape of a typical filter predicate.
+constexpr char kRangePredicatePbtxt[] = R"(
+func {
+  name: "logicalAnd"
+  id: 3
+  args {
+    func {
+      name: "greaterThan"
+      id: 1
+      args { column { index: 0 } }
+      args { constant { data_type: INT64 int64_value: 100 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args {
+    func {
+      name: "lessThan"
+      id: 2
+      args { column { index: 1 } }
+      args { constant { data_type: INT64 int64_value: 200 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})";
 
-// NOLINTNEXTLINE : runtime/references.
-void BM_ScalarExpressionTwoCols(benchmark::State& state,
-                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt) {
+std::shared_ptr<ScalarExpression> ScalarExpressionOf(const char* pbtxt) {
   px::carnot::planpb::ScalarExpression se_pb;
-  size_t data_size = state.range(0);
-
   google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb);
   auto s_or_se = px::carnot::plan::ScalarExpression::FromProto(se_pb);
   CHECK(s_or_se.ok());
-  std::shared_ptr<ScalarExpression> se = s_or_se.ConsumeValueOrDie();
+  return s_or_se.ConsumeValueOrDie();
+}
 
-  auto func_registry = std::make_unique<Registry>("test_registry");
+std::unique_ptr<ExecState> MakeExecState(Registry* func_registry, bool fused) {
+  px::carnot::funcs::builtins::RegisterMathOpsOrDie(func_registry);
   auto table_store = std::make_shared<px::table_store::TableStore>();
-  PL_CHECK_OK(func_registry->Register<AddUDF>("add"));
   auto exec_state = std::make_unique<ExecState>(
-      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      func_registry, table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
       MockTraceStubGenerator, sole::uuid4(), nullptr);
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "add", {DataType::INT64, DataType::INT64}));
+  PL_CHECK_OK(exec_state->AddScalarUDF(1, "greaterThan", {DataType::INT64, DataType::INT64}));
+  PL_CHECK_OK(exec_state->AddScalarUDF(2, "lessThan", {DataType::INT64, DataType::INT64}));
+  PL_CHECK_OK(exec_state->AddScalarUDF(3, "logicalAnd", {DataType::BOOLEAN, DataType::BOOLEAN}));
+  exec_state->set_fused_expressions_enabled(fused);
+  return exec_state;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_ScalarExpressionTwoCols(benchmark::State& state,
+                                const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt,
+                                bool fused) {
+  size_t data_size = state.range(0);
+  std::shared_ptr<ScalarExpression> se = ScalarExpressionOf(pbtxt);
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto exec_state = MakeExecState(func_registry.get(), fused);
 
   auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
   auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
@@ -112,37 +150,84 @@ void BM_ScalarExpressionTwoCols(benchmark::State& state,
 }
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_col_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kColumnReferencePbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kColumnReferencePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_col_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kColumnReferencePbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kColumnReferencePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_const_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kScalarInt64ValuePbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kScalarInt64ValuePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, eval_const_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kScalarInt64ValuePbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kScalarInt64ValuePbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_native,
-                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_arrow,
-                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt, false)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
-                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt, false)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_arrow_fused,
+                  ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncPbtxt, true)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector_fused,
+                  ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncPbtxt, true)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+// Evaluates a predicate the way FilterNode does, into a column wrapper.
+// NOLINTNEXTLINE : runtime/references.
+void BM_FilterPredicate(benchmark::State& state, bool fused) {
+  size_t data_size = state.range(0);
+  std::shared_ptr<ScalarExpression> se = ScalarExpressionOf(kRangePredicatePbtxt);
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto exec_state = MakeExecState(func_registry.get(), fused);
+
+  auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
+  auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
+  RowDescriptor rd({DataType::INT64, DataType::INT64});
+  auto input_rb = std::make_unique<RowBatch>(rd, in1.size());
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+
+  auto function_ctx = std::make_unique<px::carnot::udf::FunctionContext>(nullptr, nullptr);
+  VectorNativeScalarExpressionEvaluator evaluator({se}, function_ctx.get());
+  PL_CHECK_OK(evaluator.Open(exec_state.get()));
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto pred_or_s = evaluator.EvaluateSingleExpression(exec_state.get(), *input_rb, *se);
+    PL_CHECK_OK(pred_or_s);
+    auto pred = pred_or_s.ConsumeValueOrDie();
+    benchmark::DoNotOptimize(pred);
+    CHECK_EQ(pred->Size(), data_size);
+  }
+  PL_CHECK_OK(evaluator.Close(exec_state.get()));
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * in1.size() * sizeof(int64_t));
+}
+
+BENCHMARK_CAPTURE(BM_FilterPredicate, range_predicate_udf, false)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_FilterPredicate, range_predicate_fused, true)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
@@ -46,6 +46,10 @@ namespace exec {
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
+// When fewer than this fraction of the rows pass, the filter copies them into dense columns
+// instead of sending a selection, so that downstream operators don't skip over mostly dead rows.
+constexpr double kFilterMinSelectionDensity = 0.25;
+
 std::string FilterNode::DebugStringImpl() {
   return absl::Substitute("Exec::FilterNode<$0>", evaluator_->DebugString());
 }
@@ -77,11 +81,11 @@ Status FilterNode::CloseImpl(ExecState* exec_state) {
 
 template <types::DataType T>
 Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
+                           arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
   DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
   size_t num_output_records = output_rb->num_rows();
   size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto output_col_builder_generic = MakeArrowBuilder(T, mem_pool);
   auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
       output_col_builder_generic.get());
   PL_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
@@ -98,7 +102,8 @@ Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arro
 
 template <>
 Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
+                                          const arrow::Array* input_col,
+                                          arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
   DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
   size_t num_output_records = output_rb->num_rows();
   size_t num_input_records = input_col->length();
@@ -106,7 +111,7 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
       100;  // This can be an arbritrary number, since we do exponential doubling below.
   size_t total_size = 0;
 
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
+  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, mem_pool);
   auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
       output_col_builder_generic.get());
 
@@ -129,6 +134,27 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
   return Status::OK();
 }
 
+Status FilterNode::SendSelectedRows(ExecState* exec_state, const RowBatch& rb,
+                                    const types::BoolValueColumnWrapper& pred, bool all_pass) {
+  RowBatch output_rb(*output_descriptor_, rb.num_rows());
+  DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
+  for (int64_t input_col_idx : plan_node_->selected_cols()) {
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+  }
+  if (!all_pass) {
+    auto selection = std::make_shared<std::vector<int64_t>>();
+    for (size_t i = 0; i < pred.Size(); ++i) {
+      if (pred[i].val) {
+        selection->push_back(i);
+      }
+    }
+    output_rb.set_selection(std::move(selection));
+  }
+  output_rb.set_eow(rb.eow());
+  output_rb.set_eos(rb.eos());
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
@@ -152,14 +178,23 @@ Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, si
     }
   }
 
+  // If every row passes, the input columns are forwarded. If the children can consume a
+  // selection and enough rows pass, they're forwarded along with the indices of the passing rows.
+  bool all_pass = num_output_records == num_pred;
+  if (all_pass || (num_output_records >= kFilterMinSelectionDensity * num_pred &&
+                   ChildrenAcceptSelection())) {
+    return SendSelectedRows(exec_state, rb, pred_col_wrapper, all_pass);
+  }
+
   RowBatch output_rb(*output_descriptor_, num_output_records);
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
 
   for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
     auto input_col = rb.ColumnAt(input_col_idx);
     auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PL_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
+#define TYPE_CASE(_dt_)                                                           \
+  PL_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), \
+                                               exec_state->exec_mem_pool(), &output_rb));
     PL_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
 #undef TYPE_CASE
   }
@@ -30,6 +30,7 @@
 #include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
+#include "src/shared/types/column_wrapper.h"
 #include "src/table_store/table_store.h"
 
 namespace px {
@@ -51,6 +52,10 @@ class FilterNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
+  // Sends the input columns on without copying them, restricted to the rows that passed.
+  Status SendSelectedRows(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                          const types::BoolValueColumnWrapper& pred, bool all_pass);
+
   std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator_;
   std::unique_ptr<plan::FilterOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
@@ -111,6 +111,45 @@ TEST_F(FilterNodeTest, basic) {
       .Close();
 }
 
+TEST_F(FilterNodeTest, selection_to_accepting_child) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ChildAcceptsSelection()
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                       .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                       .get(),
+                   0)
+      .ExpectSelection(true)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Int64Value>({1, 1})
+                          .AddColumn<types::Int64Value>({1, 3})
+                          .AddColumn<types::StringValue>({"ABC", "DEF"})
+                          .get())
+      // Too few rows pass for a selection to be worth it, so they're copied.
+      .ConsumeNext(RowBatchBuilder(input_rd, 5, true, true)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5})
+                       .AddColumn<types::Int64Value>({1, 4, 6, 8, 10})
+                       .AddColumn<types::StringValue>({"Hello", "world", "now", "and", "then"})
+                       .get(),
+                   0)
+      .ExpectSelection(false)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::StringValue>({"Hello"})
+                          .get())
+      .Close();
+}
+
 TEST_F(FilterNodeTest, column_selection) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
@@ -0,0 +1,586 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "src/carnot/udf/udf_definition.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using KernelFn = FusedExpression::KernelFn;
+using NativeKind = FusedExpression::NativeKind;
+
+namespace {
+
+// The number of rows that each kernel processes at a time. Small enough that the scratch buffers
+// of an expression stay in cache, and large enough to amortize the per-chunk dispatch.
+constexpr int64_t kFusedChunkRows = 1024;
+
+StatusOr<NativeKind> NativeKindOf(types::DataType data_type) {
+  switch (data_type) {
+    case types::BOOLEAN:
+      return NativeKind::kBool;
+    case types::INT64:
+    case types::TIME64NS:
+      return NativeKind::kInt64;
+    case types::FLOAT64:
+      return NativeKind::kFloat64;
+    default:
+      return error::Unimplemented("Fused expressions don't support $0 values",
+                                  types::ToString(data_type));
+  }
+}
+
+struct AddOp {
+  template <typename L, typename R>
+  static auto Apply(L l, R r) {
+    return l + r;
+  }
+};
+struct SubtractOp {
+  template <typename L, typename R>
+  static auto Apply(L l, R r) {
+    return l - r;
+  }
+};
+struct MultiplyOp {
+  template <typename L, typename R>
+  static auto Apply(L l, R r) {
+    return l * r;
+  }
+};
+struct EqualOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l == r;
+  }
+};
+struct NotEqualOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l != r;
+  }
+};
+struct LessThanOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l < r;
+  }
+};
+struct LessThanEqualOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l <= r;
+  }
+};
+struct GreaterThanOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l > r;
+  }
+};
+struct GreaterThanEqualOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l >= r;
+  }
+};
+struct LogicalAndOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l && r;
+  }
+};
+struct LogicalOrOp {
+  template <typename L, typename R>
+  static bool Apply(L l, R r) {
+    return l || r;
+  }
+};
+struct LogicalNotOp {
+  template <typename T>
+  static bool Apply(T v) {
+    return !v;
+  }
+};
+struct NegateOp {
+  template <typename T>
+  static T Apply(T v) {
+    return -v;
+  }
+};
+
+// The loops have no branches or calls, so the compiler can vectorize them.
+template <typename TOp, typename TOut, typename TL, typename TR, bool kLScalar, bool kRScalar>
+void BinaryKernel(const void* lhs, const void* rhs, void* out, int64_t n) {
+  const TL* l = static_cast<const TL*>(lhs);
+  const TR* r = static_cast<const TR*>(rhs);
+  TOut* o = static_cast<TOut*>(out);
+  for (int64_t i = 0; i < n; ++i) {
+    o[i] = static_cast<TOut>(TOp::Apply(l[kLScalar ? 0 : i], r[kRScalar ? 0 : i]));
+  }
+}
+
+template <typename TOp, typename TOut, typename TIn, bool kScalar>
+void UnaryKernel(const void* in, const void*, void* out, int64_t n) {
+  const TIn* v = static_cast<const TIn*>(in);
+  TOut* o = static_cast<TOut*>(out);
+  for (int64_t i = 0; i < n; ++i) {
+    o[i] = static_cast<TOut>(TOp::Apply(v[kScalar ? 0 : i]));
+  }
+}
+
+template <typename TOp, typename TOut, typename TL, typename TR>
+KernelFn ShapedBinaryKernel(bool l_scalar, bool r_scalar) {
+  if (l_scalar && r_scalar) {
+    return &BinaryKernel<TOp, TOut, TL, TR, true, true>;
+  }
+  if (l_scalar) {
+    return &BinaryKernel<TOp, TOut, TL, TR, true, false>;
+  }
+  if (r_scalar) {
+    return &BinaryKernel<TOp, TOut, TL, TR, false, true>;
+  }
+  return &BinaryKernel<TOp, TOut, TL, TR, false, false>;
+}
+
+template <typename TOp, typename TOut, typename TIn>
+KernelFn ShapedUnaryKernel(bool scalar) {
+  return scalar ? &UnaryKernel<TOp, TOut, TIn, true> : &UnaryKernel<TOp, TOut, TIn, false>;
+}
+
+// The kernels of each family of ops, for the argument kinds that the builtins accept.
+
+template <typename TOp, typename TL>
+KernelFn ArithmeticKernel(NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (r) {
+    case NativeKind::kInt64:
+      return ShapedBinaryKernel<TOp, decltype(TL() + int64_t()), TL, int64_t>(l_scalar, r_scalar);
+    case NativeKind::kFloat64:
+      return ShapedBinaryKernel<TOp, double, TL, double>(l_scalar, r_scalar);
+    default:
+      return nullptr;
+  }
+}
+
+template <typename TOp>
+KernelFn ArithmeticKernel(NativeKind l, NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (l) {
+    case NativeKind::kInt64:
+      return ArithmeticKernel<TOp, int64_t>(r, l_scalar, r_scalar);
+    case NativeKind::kFloat64:
+      return ArithmeticKernel<TOp, double>(r, l_scalar, r_scalar);
+    default:
+      return nullptr;
+  }
+}
+
+template <typename TOp, typename TL>
+KernelFn CompareKernel(NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (r) {
+    case NativeKind::kBool:
+      return ShapedBinaryKernel<TOp, uint8_t, TL, uint8_t>(l_scalar, r_scalar);
+    case NativeKind::kInt64:
+      return ShapedBinaryKernel<TOp, uint8_t, TL, int64_t>(l_scalar, r_scalar);
+    case NativeKind::kFloat64:
+      return ShapedBinaryKernel<TOp, uint8_t, TL, double>(l_scalar, r_scalar);
+  }
+  return nullptr;
+}
+
+template <typename TOp>
+KernelFn CompareKernel(NativeKind l, NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (l) {
+    case NativeKind::kBool:
+      return CompareKernel<TOp, uint8_t>(r, l_scalar, r_scalar);
+    case NativeKind::kInt64:
+      return CompareKernel<TOp, int64_t>(r, l_scalar, r_scalar);
+    case NativeKind::kFloat64:
+      return CompareKernel<TOp, double>(r, l_scalar, r_scalar);
+  }
+  return nullptr;
+}
+
+template <typename TOp, typename TL>
+KernelFn LogicalKernel(NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (r) {
+    case NativeKind::kBool:
+      return ShapedBinaryKernel<TOp, uint8_t, TL, uint8_t>(l_scalar, r_scalar);
+    case NativeKind::kInt64:
+      return ShapedBinaryKernel<TOp, uint8_t, TL, int64_t>(l_scalar, r_scalar);
+    default:
+      return nullptr;
+  }
+}
+
+template <typename TOp>
+KernelFn LogicalKernel(NativeKind l, NativeKind r, bool l_scalar, bool r_scalar) {
+  switch (l) {
+    case NativeKind::kBool:
+      return LogicalKernel<TOp, uint8_t>(r, l_scalar, r_scalar);
+    case NativeKind::kInt64:
+      return LogicalKernel<TOp, int64_t>(r, l_scalar, r_scalar);
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * Picks the kernel of a binary builtin for the given argument kinds.
+ * @return the kernel, or nullptr if the builtin isn't fused for these arguments.
+ */
+KernelFn SelectBinaryKernel(const std::string& name, NativeKind l, NativeKind r, bool l_scalar,
+                            bool r_scalar, NativeKind* out_kind) {
+  if (name == "add" || name == "subtract" || name == "multiply") {
+    *out_kind = l == NativeKind::kFloat64 || r == NativeKind::kFloat64 ? NativeKind::kFloat64
+                                                                       : NativeKind::kInt64;
+    if (name == "add") {
+      return ArithmeticKernel<AddOp>(l, r, l_scalar, r_scalar);
+    }
+    if (name == "subtract") {
+      return ArithmeticKernel<SubtractOp>(l, r, l_scalar, r_scalar);
+    }
+    return ArithmeticKernel<MultiplyOp>(l, r, l_scalar, r_scalar);
+  }
+
+  *out_kind = NativeKind::kBool;
+  if (name == "equal" || name == "notEqual") {
+    // Two floats are compared approximately by the builtins.
+    if (l == NativeKind::kFloat64 && r == NativeKind::kFloat64) {
+      return nullptr;
+    }
+    return name == "equal" ? CompareKernel<EqualOp>(l, r, l_scalar, r_scalar)
+                           : CompareKernel<NotEqualOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "lessThan") {
+    return CompareKernel<LessThanOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "lessThanEqual") {
+    return CompareKernel<LessThanEqualOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "greaterThan") {
+    return CompareKernel<GreaterThanOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "greaterThanEqual") {
+    return CompareKernel<GreaterThanEqualOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "logicalAnd") {
+    return LogicalKernel<LogicalAndOp>(l, r, l_scalar, r_scalar);
+  }
+  if (name == "logicalOr") {
+    return LogicalKernel<LogicalOrOp>(l, r, l_scalar, r_scalar);
+  }
+  return nullptr;
+}
+
+KernelFn SelectUnaryKernel(const std::string& name, NativeKind kind, bool scalar,
+                           NativeKind* out_kind) {
+  if (name == "logicalNot") {
+    *out_kind = NativeKind::kBool;
+    switch (kind) {
+      case NativeKind::kBool:
+        return ShapedUnaryKernel<LogicalNotOp, uint8_t, uint8_t>(scalar);
+      case NativeKind::kInt64:
+        return ShapedUnaryKernel<LogicalNotOp, uint8_t, int64_t>(scalar);
+      default:
+        return nullptr;
+    }
+  }
+  if (name == "negate") {
+    *out_kind = kind;
+    switch (kind) {
+      case NativeKind::kInt64:
+        return ShapedUnaryKernel<NegateOp, int64_t, int64_t>(scalar);
+      case NativeKind::kFloat64:
+        return ShapedUnaryKernel<NegateOp, double, double>(scalar);
+      default:
+        return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+template <typename TBuilder, typename TNative>
+Status AppendChunk(arrow::ArrayBuilder* builder, const void* values, int64_t n) {
+  return static_cast<TBuilder*>(builder)->AppendValues(static_cast<const TNative*>(values), n);
+}
+
+template <types::DataType DT, typename TNative>
+void CopyChunkToWrapper(types::ColumnWrapper* wrapper, int64_t offset, const void* values,
+                        int64_t n) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  auto* data = static_cast<types::ColumnWrapperTmpl<ValueType>*>(wrapper)->UnsafeRawData();
+  const auto* src = static_cast<const TNative*>(values);
+  for (int64_t i = 0; i < n; ++i) {
+    data[offset + i].val = src[i];
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<FusedExpression> FusedExpression::Compile(const plan::ScalarExpression& expr,
+                                                          ExecState* exec_state) {
+  // Columns and constants are already passed through without any per-row work.
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return nullptr;
+  }
+  std::unique_ptr<FusedExpression> fused(new FusedExpression());
+  if (!fused->Lower(expr, types::DATA_TYPE_UNKNOWN, exec_state).ok()) {
+    return nullptr;
+  }
+  fused->output_type_ =
+      exec_state
+          ->GetScalarUDFDefinition(static_cast<const plan::ScalarFunc&>(expr).udf_id())
+          ->exec_return_type();
+  return fused;
+}
+
+FusedExpression::Operand FusedExpression::AddConstant(const plan::ScalarValue& val,
+                                                      NativeKind kind) {
+  Constant constant;
+  switch (kind) {
+    case NativeKind::kBool:
+      constant.bool_value = val.BoolValue();
+      break;
+    case NativeKind::kInt64:
+      constant.int_value =
+          val.DataType() == types::TIME64NS ? val.Time64NSValue() : val.Int64Value();
+      break;
+    case NativeKind::kFloat64:
+      constant.float_value = val.Float64Value();
+      break;
+  }
+  constants_.push_back(constant);
+  return Operand{Source::kConstant, kind, static_cast<int64_t>(constants_.size() - 1)};
+}
+
+StatusOr<FusedExpression::Operand> FusedExpression::Lower(const plan::ScalarExpression& expr,
+                                                          types::DataType arg_type,
+                                                          ExecState* exec_state) {
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn: {
+      PL_ASSIGN_OR_RETURN(NativeKind kind, NativeKindOf(arg_type));
+      int64_t col_idx = static_cast<const plan::Column&>(expr).Index();
+      if (kind == NativeKind::kBool) {
+        slots_.emplace_back(kFusedChunkRows);
+        int64_t slot = slots_.size() - 1;
+        bool_column_slots_.emplace_back(col_idx, slot);
+        return Operand{Source::kSlot, kind, slot};
+      }
+      columns_.push_back(col_idx);
+      column_kinds_.push_back(kind);
+      return Operand{Source::kColumn, kind, static_cast<int64_t>(columns_.size() - 1)};
+    }
+    case plan::Expression::kConstant: {
+      const auto& val = static_cast<const plan::ScalarValue&>(expr);
+      PL_ASSIGN_OR_RETURN(NativeKind kind, NativeKindOf(val.DataType()));
+      return AddConstant(val, kind);
+    }
+    case plan::Expression::kFunc:
+      break;
+    default:
+      return error::Unimplemented("Only functions, columns and constants are fused");
+  }
+
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  auto* def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  if (def == nullptr || !fn.init_arguments().empty()) {
+    return error::Unimplemented("Function $0 can't be fused", fn.name());
+  }
+  PL_ASSIGN_OR_RETURN(NativeKind return_kind, NativeKindOf(def->exec_return_type()));
+  const auto& arg_types = fn.registry_arg_types();
+  if (arg_types.size() != fn.arg_deps().size()) {
+    return error::Internal("Function $0 has $1 args, but $2 arg types", fn.name(),
+                           fn.arg_deps().size(), arg_types.size());
+  }
+
+  std::vector<Operand> args;
+  for (const auto& [idx, arg] : Enumerate(fn.arg_deps())) {
+    PL_ASSIGN_OR_RETURN(auto operand, Lower(*arg, arg_types[idx], exec_state));
+    args.push_back(operand);
+  }
+
+  KernelFn kernel = nullptr;
+  NativeKind out_kind = return_kind;
+  if (args.size() == 1) {
+    kernel = SelectUnaryKernel(fn.name(), args[0].kind, args[0].source == Source::kConstant,
+                               &out_kind);
+  } else if (args.size() == 2) {
+    kernel = SelectBinaryKernel(fn.name(), args[0].kind, args[1].kind,
+                                args[0].source == Source::kConstant,
+                                args[1].source == Source::kConstant, &out_kind);
+  }
+  if (kernel == nullptr || out_kind != return_kind) {
+    return error::Unimplemented("Function $0 can't be fused", fn.name());
+  }
+
+  slots_.emplace_back(kFusedChunkRows);
+  int64_t out_slot = slots_.size() - 1;
+  instructions_.push_back(Instruction{kernel, std::move(args), out_slot});
+  return Operand{Source::kSlot, out_kind, out_slot};
+}
+
+bool FusedExpression::MatchesInput(const table_store::schema::RowDescriptor& desc) const {
+  for (const auto& [idx, col_idx] : Enumerate(columns_)) {
+    if (static_cast<size_t>(col_idx) >= desc.size()) {
+      return false;
+    }
+    auto kind_or_s = NativeKindOf(desc.type(col_idx));
+    if (!kind_or_s.ok() || kind_or_s.ValueOrDie() != column_kinds_[idx]) {
+      return false;
+    }
+  }
+  for (const auto& [col_idx, slot] : bool_column_slots_) {
+    if (static_cast<size_t>(col_idx) >= desc.size() || desc.type(col_idx) != types::BOOLEAN) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const void* FusedExpression::OperandValues(const Operand& operand, int64_t offset) const {
+  switch (operand.source) {
+    case Source::kColumn:
+      return column_values_[operand.index] + offset * sizeof(int64_t);
+    case Source::kConstant: {
+      const auto& constant = constants_[operand.index];
+      switch (operand.kind) {
+        case NativeKind::kBool:
+          return &constant.bool_value;
+        case NativeKind::kInt64:
+          return &constant.int_value;
+        case NativeKind::kFloat64:
+          return &constant.float_value;
+      }
+      return nullptr;
+    }
+    case Source::kSlot:
+      return slots_[operand.index].data();
+  }
+  return nullptr;
+}
+
+Status FusedExpression::Run(const RowBatch& input,
+                            const std::function<Status(const void* values, int64_t n)>& emit) {
+  // Int64, time and float columns are read in place, they all have 8 byte values.
+  column_values_.resize(columns_.size());
+  for (const auto& [idx, col_idx] : Enumerate(columns_)) {
+    const auto* arr = static_cast<const arrow::PrimitiveArray*>(input.ColumnAt(col_idx).get());
+    column_values_[idx] =
+        reinterpret_cast<const char*>(arr->values()->data()) + arr->offset() * sizeof(int64_t);
+  }
+
+  int64_t num_rows = input.num_rows();
+  for (int64_t offset = 0; offset < num_rows; offset += kFusedChunkRows) {
+    int64_t n = std::min(kFusedChunkRows, num_rows - offset);
+    for (const auto& [col_idx, slot] : bool_column_slots_) {
+      const auto* arr = static_cast<const arrow::BooleanArray*>(input.ColumnAt(col_idx).get());
+      auto* values = reinterpret_cast<uint8_t*>(slots_[slot].data());
+      for (int64_t i = 0; i < n; ++i) {
+        values[i] = arr->Value(offset + i);
+      }
+    }
+    for (const auto& instruction : instructions_) {
+      const void* lhs = OperandValues(instruction.args[0], offset);
+      const void* rhs =
+          instruction.args.size() > 1 ? OperandValues(instruction.args[1], offset) : nullptr;
+      instruction.fn(lhs, rhs, slots_[instruction.out_slot].data(), n);
+    }
+    PL_RETURN_IF_ERROR(emit(slots_[instructions_.back().out_slot].data(), n));
+  }
+  return Status::OK();
+}
+
+Status FusedExpression::EvaluateToArrow(const RowBatch& input, arrow::MemoryPool* mem_pool,
+                                        std::shared_ptr<arrow::Array>* output) {
+  auto builder = types::MakeArrowBuilder(output_type_, mem_pool);
+  PL_RETURN_IF_ERROR(builder->Reserve(input.num_rows()));
+  std::function<Status(const void*, int64_t)> append;
+  switch (output_type_) {
+    case types::BOOLEAN:
+      append = [&](const void* values, int64_t n) {
+        return AppendChunk<arrow::BooleanBuilder, uint8_t>(builder.get(), values, n);
+      };
+      break;
+    case types::INT64:
+      append = [&](const void* values, int64_t n) {
+        return AppendChunk<arrow::Int64Builder, int64_t>(builder.get(), values, n);
+      };
+      break;
+    case types::TIME64NS:
+      append = [&](const void* values, int64_t n) {
+        using TimeBuilder = types::DataTypeTraits<types::TIME64NS>::arrow_builder_type;
+        return AppendChunk<TimeBuilder, int64_t>(builder.get(), values, n);
+      };
+      break;
+    case types::FLOAT64:
+      append = [&](const void* values, int64_t n) {
+        return AppendChunk<arrow::DoubleBuilder, double>(builder.get(), values, n);
+      };
+      break;
+    default:
+      return error::Internal("Unexpected fused output type $0", types::ToString(output_type_));
+  }
+  PL_RETURN_IF_ERROR(Run(input, append));
+  PL_RETURN_IF_ERROR(builder->Finish(output));
+  return Status::OK();
+}
+
+Status FusedExpression::EvaluateToColumnWrapper(const RowBatch& input,
+                                                types::SharedColumnWrapper* output) {
+  auto wrapper = types::ColumnWrapper::Make(output_type_, input.num_rows());
+  int64_t offset = 0;
+  auto copy = [&](const void* values, int64_t n) {
+    switch (output_type_) {
+      case types::BOOLEAN:
+        CopyChunkToWrapper<types::BOOLEAN, uint8_t>(wrapper.get(), offset, values, n);
+        break;
+      case types::INT64:
+        CopyChunkToWrapper<types::INT64, int64_t>(wrapper.get(), offset, values, n);
+        break;
+      case types::TIME64NS:
+        CopyChunkToWrapper<types::TIME64NS, int64_t>(wrapper.get(), offset, values, n);
+        break;
+      case types::FLOAT64:
+        CopyChunkToWrapper<types::FLOAT64, double>(wrapper.get(), offset, values, n);
+        break;
+      default:
+        return error::Internal("Unexpected fused output type $0", types::ToString(output_type_));
+    }
+    offset += n;
+    return Status::OK();
+  };
+  PL_RETURN_IF_ERROR(Run(input, copy));
+  *output = std::move(wrapper);
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * FusedExpression evaluates a scalar expression made of builtin comparisons, arithmetic and
+ * boolean logic over numeric columns and constants, without calling the UDFs.
+ *
+ * The expression is lowered to a list of typed kernels, each picked at compile time for the types
+ * of its arguments and for whether they're constants. The kernels run over raw Arrow buffers a
+ * chunk of rows at a time, so intermediate results stay in small scratch buffers rather than being
+ * materialized into a column wrapper per expression node.
+ *
+ * The kernels reproduce the semantics of the builtin UDFs of the same name, so only functions that
+ * resolve to those builtins may be fused.
+ */
+class FusedExpression : public NotCopyable {
+ public:
+  /**
+   * Lowers the expression into kernels.
+   * @return the fused expression, or nullptr if the expression can't be fused.
+   */
+  static std::unique_ptr<FusedExpression> Compile(const plan::ScalarExpression& expr,
+                                                  ExecState* exec_state);
+
+  types::DataType output_type() const { return output_type_; }
+
+  /**
+   * The kernels were picked for the argument types in the plan. Batches whose columns have other
+   * types must be evaluated with the UDFs.
+   */
+  bool MatchesInput(const table_store::schema::RowDescriptor& desc) const;
+
+  Status EvaluateToArrow(const table_store::schema::RowBatch& input, arrow::MemoryPool* mem_pool,
+                         std::shared_ptr<arrow::Array>* output);
+  Status EvaluateToColumnWrapper(const table_store::schema::RowBatch& input,
+                                 types::SharedColumnWrapper* output);
+
+  // Where a kernel argument comes from: an input column, a constant or an earlier kernel's output.
+  enum class Source : uint8_t { kColumn, kConstant, kSlot };
+  // The native representation of values in the kernels. Booleans are one byte per value.
+  enum class NativeKind : uint8_t { kBool, kInt64, kFloat64 };
+
+  struct Operand {
+    Source source;
+    NativeKind kind;
+    // The index into columns_, constants_ or slots_.
+    int64_t index;
+  };
+
+  // A kernel reads its arguments as arrays of n values, or as a single value if it was specialized
+  // for a constant argument, and writes n values to out.
+  using KernelFn = void (*)(const void* lhs, const void* rhs, void* out, int64_t n);
+
+ private:
+  struct Instruction {
+    KernelFn fn;
+    std::vector<Operand> args;
+    int64_t out_slot;
+  };
+  // Constants are stored in the representation of their kind.
+  struct Constant {
+    int64_t int_value = 0;
+    double float_value = 0;
+    uint8_t bool_value = 0;
+  };
+
+  FusedExpression() = default;
+
+  StatusOr<Operand> Lower(const plan::ScalarExpression& expr, types::DataType arg_type,
+                          ExecState* exec_state);
+  Operand AddConstant(const plan::ScalarValue& val, NativeKind kind);
+  const void* OperandValues(const Operand& operand, int64_t offset) const;
+  // Runs the kernels over the input and calls emit with the output values of each chunk.
+  Status Run(const table_store::schema::RowBatch& input,
+             const std::function<Status(const void* values, int64_t n)>& emit);
+
+  std::vector<Instruction> instructions_;
+  std::vector<Constant> constants_;
+  // Boolean input columns are bit packed, so they are unpacked into a slot at the start of each
+  // chunk.
+  std::vector<std::pair<int64_t, int64_t>> bool_column_slots_;
+  std::vector<std::vector<int64_t>> slots_;
+  types::DataType output_type_ = types::DataType::DATA_TYPE_UNKNOWN;
+
+  // The input columns that kernels read directly, and the start of their values in the current
+  // batch.
+  std::vector<int64_t> columns_;
+  std::vector<NativeKind> column_kinds_;
+  std::vector<const char*> column_values_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
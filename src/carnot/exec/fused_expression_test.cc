@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/memory_pool.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/funcs/builtins/math_ops.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::ToArrow;
+
+// (col0 > 2) && col2
+constexpr char kGreaterThanAndPbtxt[] = R"(
+func {
+  name: "logicalAnd"
+  id: 1
+  args {
+    func {
+      name: "greaterThan"
+      id: 0
+      args { column { index: 0 } }
+      args { constant { data_type: INT64 int64_value: 2 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args { column { index: 2 } }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})";
+
+// (col0 + col1) * 1.5
+constexpr char kAddMultiplyPbtxt[] = R"(
+func {
+  name: "multiply"
+  id: 3
+  args {
+    func {
+      name: "add"
+      id: 2
+      args { column { index: 0 } }
+      args { column { index: 1 } }
+      args_data_types: INT64
+      args_data_types: FLOAT64
+    }
+  }
+  args { constant { data_type: FLOAT64 float64_value: 1.5 } }
+  args_data_types: FLOAT64
+  args_data_types: FLOAT64
+})";
+
+// col1 == col1, which the builtin compares approximately.
+constexpr char kFloatEqualPbtxt[] = R"(
+func {
+  name: "equal"
+  id: 4
+  args { column { index: 1 } }
+  args { column { index: 1 } }
+  args_data_types: FLOAT64
+  args_data_types: FLOAT64
+})";
+
+class FusedExpressionTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    funcs::builtins::RegisterMathOpsOrDie(func_registry_.get());
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state_->AddScalarUDF(0, "greaterThan", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(1, "logicalAnd", {types::BOOLEAN, types::BOOLEAN}));
+    EXPECT_OK(exec_state_->AddScalarUDF(2, "add", {types::INT64, types::FLOAT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(3, "multiply", {types::FLOAT64, types::FLOAT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(4, "equal", {types::FLOAT64, types::FLOAT64}));
+
+    // More rows than a single chunk of the fused kernels.
+    std::vector<types::Int64Value> in1;
+    std::vector<types::Float64Value> in2;
+    std::vector<types::BoolValue> in3;
+    for (int64_t i = 0; i < 2500; ++i) {
+      in1.push_back(i % 7);
+      in2.push_back(i * 0.25);
+      in3.push_back(i % 3 != 0);
+    }
+    RowDescriptor rd({types::DataType::INT64, types::DataType::FLOAT64, types::DataType::BOOLEAN});
+    input_rb_ = std::make_unique<RowBatch>(rd, in1.size());
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in3, arrow::default_memory_pool())));
+  }
+
+ protected:
+  std::shared_ptr<const plan::ScalarExpression> ScalarExpressionOf(const std::string& pbtxt) {
+    planpb::ScalarExpression se_pb;
+    EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb));
+    auto se_or_s = plan::ScalarExpression::FromProto(se_pb);
+    EXPECT_OK(se_or_s);
+    return se_or_s.ConsumeValueOrDie();
+  }
+
+  // Evaluates the expression with either the fused kernels or the UDFs.
+  std::shared_ptr<arrow::Array> Evaluate(const std::shared_ptr<const plan::ScalarExpression>& se,
+                                         types::DataType output_type, bool fused) {
+    exec_state_->set_fused_expressions_enabled(fused);
+    udf::FunctionContext function_ctx(nullptr, nullptr);
+    auto evaluator = ScalarExpressionEvaluator::Create(
+        {se}, ScalarExpressionEvaluatorType::kArrowNative, &function_ctx);
+    RowBatch output_rb(RowDescriptor({output_type}), input_rb_->num_rows());
+    EXPECT_OK(evaluator->Open(exec_state_.get()));
+    EXPECT_OK(evaluator->Evaluate(exec_state_.get(), *input_rb_, &output_rb));
+    EXPECT_OK(evaluator->Close(exec_state_.get()));
+    return output_rb.ColumnAt(0);
+  }
+
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<RowBatch> input_rb_;
+};
+
+TEST_F(FusedExpressionTest, comparison_and_logic) {
+  auto se = ScalarExpressionOf(kGreaterThanAndPbtxt);
+  auto fused = FusedExpression::Compile(*se, exec_state_.get());
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(types::BOOLEAN, fused->output_type());
+
+  auto expected = Evaluate(se, types::BOOLEAN, /* fused */ false);
+  auto actual = Evaluate(se, types::BOOLEAN, /* fused */ true);
+  EXPECT_TRUE(expected->Equals(actual));
+
+  auto* bools = static_cast<arrow::BooleanArray*>(actual.get());
+  EXPECT_FALSE(bools->Value(0));
+  EXPECT_FALSE(bools->Value(3));
+  EXPECT_TRUE(bools->Value(4));
+  EXPECT_TRUE(bools->Value(2498));
+}
+
+TEST_F(FusedExpressionTest, mixed_arithmetic) {
+  auto se = ScalarExpressionOf(kAddMultiplyPbtxt);
+  ASSERT_NE(nullptr, FusedExpression::Compile(*se, exec_state_.get()));
+
+  auto expected = Evaluate(se, types::FLOAT64, /* fused */ false);
+  auto actual = Evaluate(se, types::FLOAT64, /* fused */ true);
+  EXPECT_TRUE(expected->Equals(actual));
+  EXPECT_DOUBLE_EQ((6 + 6 * 0.25) * 1.5, static_cast<arrow::DoubleArray*>(actual.get())->Value(6));
+}
+
+TEST_F(FusedExpressionTest, column_wrapper_output) {
+  auto se = ScalarExpressionOf(kGreaterThanAndPbtxt);
+  auto fused = FusedExpression::Compile(*se, exec_state_.get());
+  ASSERT_NE(nullptr, fused);
+
+  types::SharedColumnWrapper wrapper;
+  ASSERT_OK(fused->EvaluateToColumnWrapper(*input_rb_, &wrapper));
+  ASSERT_EQ(2500UL, wrapper->Size());
+  auto expected = Evaluate(se, types::BOOLEAN, /* fused */ false);
+  EXPECT_TRUE(expected->Equals(wrapper->ConvertToArrow(arrow::default_memory_pool())));
+}
+
+TEST_F(FusedExpressionTest, unsupported_expressions) {
+  EXPECT_EQ(nullptr, FusedExpression::Compile(*ScalarExpressionOf(kFloatEqualPbtxt),
+                                              exec_state_.get()));
+  // Plain columns aren't fused, since they're passed through as is.
+  EXPECT_EQ(nullptr, FusedExpression::Compile(*ScalarExpressionOf("column { index: 0 }"),
+                                              exec_state_.get()));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/group_by_hash_table.h"
+
+#include <farmhash.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+constexpr size_t kArenaBlockSize = 64 * 1024;
+
+// Strings store their length in the fixed width part of the row.
+using StringLength = uint32_t;
+
+template <types::DataType DT>
+constexpr size_t EncodedWidth() {
+  if constexpr (DT == types::DataType::STRING) {
+    return sizeof(StringLength);
+  } else {
+    return sizeof(typename types::DataTypeTraits<DT>::native_type);
+  }
+}
+
+size_t EncodedWidth(types::DataType dt) {
+#define TYPE_CASE(_dt_) return EncodedWidth<_dt_>();
+  PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  return 0;
+}
+
+StringLength ReadStringLength(const char* src) {
+  StringLength len;
+  std::memcpy(&len, src, sizeof(len));
+  return len;
+}
+
+template <types::DataType DT>
+void EncodeKeyColumn(const arrow::Array* col, size_t fixed_offset,
+                     const std::vector<size_t>& row_offsets, std::vector<size_t>* string_offsets,
+                     char* keys, std::vector<uint64_t>* hashes) {
+  int64_t num_rows = col->length();
+  if constexpr (DT == types::DataType::STRING) {
+    for (int64_t i = 0; i < num_rows; ++i) {
+      std::string_view val = types::GetStringViewFromArrowArray(col, i);
+      StringLength len = val.size();
+      std::memcpy(keys + row_offsets[i] + fixed_offset, &len, sizeof(len));
+      std::memcpy(keys + (*string_offsets)[i], val.data(), len);
+      (*string_offsets)[i] += len;
+      (*hashes)[i] = HashCombine((*hashes)[i], ::util::Hash64(val.data(), val.size()));
+    }
+  } else {
+    using ValueType = typename types::DataTypeTraits<DT>::value_type;
+    using NativeType = typename types::DataTypeTraits<DT>::native_type;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      ValueType value = types::GetValueFromArrowArray<DT>(col, i);
+      NativeType val = value.val;
+      std::memcpy(keys + row_offsets[i] + fixed_offset, &val, sizeof(val));
+      (*hashes)[i] = HashCombine(
+          (*hashes)[i], ::util::Hash64(reinterpret_cast<const char*>(&val), sizeof(val)));
+    }
+  }
+}
+
+template <types::DataType DT>
+Status AppendKeys(const std::vector<std::string_view>& keys, size_t fixed_offset,
+                  size_t fixed_width, const std::vector<size_t>& preceding_string_offsets,
+                  arrow::ArrayBuilder* builder) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+  for (const auto& key : keys) {
+    const char* row = key.data();
+    if constexpr (DT == types::DataType::STRING) {
+      // The bytes of this string follow the bytes of the strings before it in the row.
+      size_t start = fixed_width;
+      for (size_t offset : preceding_string_offsets) {
+        start += ReadStringLength(row + offset);
+      }
+      StringLength len = ReadStringLength(row + fixed_offset);
+      PL_RETURN_IF_ERROR(typed_builder->Append(row + start, len));
+    } else {
+      typename types::DataTypeTraits<DT>::native_type val;
+      std::memcpy(&val, row + fixed_offset, sizeof(val));
+      PL_RETURN_IF_ERROR(typed_builder->Append(val));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+GroupByHashTable::GroupByHashTable(const std::vector<types::DataType>& key_types)
+    : key_types_(key_types) {
+  for (const auto& dt : key_types_) {
+    fixed_offsets_.push_back(fixed_width_);
+    fixed_width_ += EncodedWidth(dt);
+    has_strings_ |= dt == types::DataType::STRING;
+  }
+}
+
+void GroupByHashTable::LayoutBatchKeys(const std::vector<const arrow::Array*>& key_cols,
+                                       int64_t num_rows) {
+  // Row sizes are computed column by column, starting from the fixed width part.
+  row_offsets_.assign(num_rows + 1, fixed_width_);
+  if (has_strings_) {
+    for (size_t k = 0; k < key_types_.size(); ++k) {
+      if (key_types_[k] != types::DataType::STRING) {
+        continue;
+      }
+      auto* col = static_cast<const arrow::StringArray*>(key_cols[k]);
+      for (int64_t i = 0; i < num_rows; ++i) {
+        row_offsets_[i] += col->value_length(i);
+      }
+    }
+  }
+  // Turn the row sizes into offsets.
+  size_t offset = 0;
+  for (int64_t i = 0; i <= num_rows; ++i) {
+    size_t size = row_offsets_[i];
+    row_offsets_[i] = offset;
+    offset += size;
+  }
+  batch_keys_.resize(row_offsets_[num_rows]);
+
+  row_string_offsets_.resize(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    row_string_offsets_[i] = row_offsets_[i] + fixed_width_;
+  }
+}
+
+void GroupByHashTable::FindOrInsert(const std::vector<const arrow::Array*>& key_cols,
+                                    std::vector<int64_t>* group_ids,
+                                    const std::vector<int64_t>* selection) {
+  Resolve(key_cols, /* insert */ true, selection, group_ids);
+}
+
+void GroupByHashTable::Find(const std::vector<const arrow::Array*>& key_cols,
+                            std::vector<int64_t>* group_ids,
+                            const std::vector<int64_t>* selection) {
+  Resolve(key_cols, /* insert */ false, selection, group_ids);
+}
+
+void GroupByHashTable::Resolve(const std::vector<const arrow::Array*>& key_cols, bool insert,
+                               const std::vector<int64_t>* selection,
+                               std::vector<int64_t>* group_ids) {
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  DCHECK(!key_cols.empty());
+  int64_t num_rows = key_cols[0]->length();
+
+  LayoutBatchKeys(key_cols, num_rows);
+  hashes_.assign(num_rows, 0);
+  for (size_t k = 0; k < key_types_.size(); ++k) {
+#define TYPE_CASE(_dt_)                                                                    \
+  EncodeKeyColumn<_dt_>(key_cols[k], fixed_offsets_[k], row_offsets_, &row_string_offsets_, \
+                        batch_keys_.data(), &hashes_);
+    PL_SWITCH_FOREACH_DATATYPE(key_types_[k], TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  auto resolve_row = [&](int64_t i) {
+    KeyRef key{std::string_view(batch_keys_.data() + row_offsets_[i],
+                                row_offsets_[i + 1] - row_offsets_[i]),
+               hashes_[i]};
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+      (*group_ids)[i] = it->second;
+      return;
+    }
+    if (!insert) {
+      (*group_ids)[i] = kMissingGroup;
+      return;
+    }
+    key.bytes = CopyToArena(key.bytes);
+    int64_t group_id = group_keys_.size();
+    group_keys_.push_back(key.bytes);
+    map_.emplace(key, group_id);
+    (*group_ids)[i] = group_id;
+  };
+
+  // The keys of unselected rows are encoded along with the others, but never looked up, so they
+  // can't create groups.
+  if (selection == nullptr) {
+    group_ids->resize(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      resolve_row(i);
+    }
+  } else {
+    group_ids->assign(num_rows, kUnselectedRow);
+    for (int64_t i : *selection) {
+      resolve_row(i);
+    }
+  }
+}
+
+std::string_view GroupByHashTable::CopyToArena(std::string_view key) {
+  if (arena_.empty() || arena_block_used_ + key.size() > arena_block_size_) {
+    arena_block_size_ = std::max(kArenaBlockSize, key.size());
+    arena_.push_back(std::make_unique<char[]>(arena_block_size_));
+    arena_block_used_ = 0;
+    arena_bytes_ += arena_block_size_;
+  }
+  char* dst = arena_.back().get() + arena_block_used_;
+  std::memcpy(dst, key.data(), key.size());
+  arena_block_used_ += key.size();
+  return std::string_view(dst, key.size());
+}
+
+Status GroupByHashTable::AppendKeyColumn(size_t key_idx, arrow::ArrayBuilder* builder) const {
+  DCHECK_LT(key_idx, key_types_.size());
+  std::vector<size_t> preceding_string_offsets;
+  for (size_t k = 0; k < key_idx; ++k) {
+    if (key_types_[k] == types::DataType::STRING) {
+      preceding_string_offsets.push_back(fixed_offsets_[k]);
+    }
+  }
+  PL_RETURN_IF_ERROR(builder->Reserve(group_keys_.size()));
+
+#define TYPE_CASE(_dt_)                                                                      \
+  return AppendKeys<_dt_>(group_keys_, fixed_offsets_[key_idx], fixed_width_,               \
+                          preceding_string_offsets, builder);
+  PL_SWITCH_FOREACH_DATATYPE(key_types_[key_idx], TYPE_CASE);
+#undef TYPE_CASE
+  return Status::OK();
+}
+
+void GroupByHashTable::Clear() {
+  map_.clear();
+  group_keys_.clear();
+  arena_.clear();
+  arena_block_used_ = 0;
+  arena_block_size_ = 0;
+  arena_bytes_ = 0;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
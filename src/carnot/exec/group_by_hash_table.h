@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/builder.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * GroupByHashTable assigns dense group ids to the distinct keys of a set of group by columns.
+ *
+ * Keys are resolved a row batch at a time. The key columns are hashed and encoded column by
+ * column into a normalized byte row per input row. Each key column takes a fixed width slot in
+ * that row (strings store their length there), and string bytes follow the fixed width part. The
+ * bytes of every distinct key are copied once into an arena that backs the hash table, so no
+ * per-row objects are allocated.
+ */
+class GroupByHashTable : public NotCopyable {
+ public:
+  // The group id of a row whose key isn't in the table, from Find.
+  static constexpr int64_t kMissingGroup = -1;
+  // The group id of a row that's not in the selection.
+  static constexpr int64_t kUnselectedRow = -2;
+
+  explicit GroupByHashTable(const std::vector<types::DataType>& key_types);
+
+  /**
+   * Looks up the group id of every row, inserting keys that have not been seen before. New groups
+   * get the next unused id, so the ids of a table are always [0, num_groups()).
+   * @param key_cols The key columns, in the order of the key types.
+   * @param group_ids Output of the group id of each row.
+   * @param selection If set, only these rows are looked up and the others get kUnselectedRow.
+   */
+  void FindOrInsert(const std::vector<const arrow::Array*>& key_cols,
+                    std::vector<int64_t>* group_ids,
+                    const std::vector<int64_t>* selection = nullptr);
+
+  /**
+   * Looks up the group id of every row without inserting new keys. Rows whose key has not been
+   * seen get kMissingGroup.
+   */
+  void Find(const std::vector<const arrow::Array*>& key_cols, std::vector<int64_t>* group_ids,
+            const std::vector<int64_t>* selection = nullptr);
+
+  // The hash of the key of each row from the last call to FindOrInsert or Find.
+  const std::vector<uint64_t>& batch_hashes() const { return hashes_; }
+
+  /**
+   * Appends the values of one key column of every group to the builder, in group id order.
+   * @param key_idx The index of the key column.
+   * @param builder A builder of the key's data type.
+   */
+  Status AppendKeyColumn(size_t key_idx, arrow::ArrayBuilder* builder) const;
+
+  int64_t num_groups() const { return static_cast<int64_t>(group_keys_.size()); }
+
+  // Bytes held by the arena of distinct keys.
+  int64_t arena_bytes() const { return arena_bytes_; }
+
+  /**
+   * Removes all of the groups.
+   */
+  void Clear();
+
+ private:
+  struct KeyRef {
+    std::string_view bytes;
+    uint64_t hash;
+  };
+  struct KeyRefHash {
+    size_t operator()(const KeyRef& k) const { return k.hash; }
+  };
+  struct KeyRefEq {
+    bool operator()(const KeyRef& k1, const KeyRef& k2) const { return k1.bytes == k2.bytes; }
+  };
+
+  // Computes the size of each encoded row and lays the rows out in batch_keys_.
+  void LayoutBatchKeys(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows);
+  void Resolve(const std::vector<const arrow::Array*>& key_cols, bool insert,
+               const std::vector<int64_t>* selection, std::vector<int64_t>* group_ids);
+  // Copies a new key into the arena and returns a view of the copy.
+  std::string_view CopyToArena(std::string_view key);
+
+  std::vector<types::DataType> key_types_;
+  // The offset of each key column within the fixed width part of a row.
+  std::vector<size_t> fixed_offsets_;
+  // The size of the fixed width part of a row.
+  size_t fixed_width_ = 0;
+  bool has_strings_ = false;
+
+  absl::flat_hash_map<KeyRef, int64_t, KeyRefHash, KeyRefEq> map_;
+  // The encoded key of each group, indexed by group id. Points into arena_.
+  std::vector<std::string_view> group_keys_;
+  std::vector<std::unique_ptr<char[]>> arena_;
+  size_t arena_block_used_ = 0;
+  size_t arena_block_size_ = 0;
+  int64_t arena_bytes_ = 0;
+
+  // Scratch space for the batch being resolved.
+  std::string batch_keys_;
+  std::vector<size_t> row_offsets_;
+  std::vector<size_t> row_string_offsets_;
+  std::vector<uint64_t> hashes_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
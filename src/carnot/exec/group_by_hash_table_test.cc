@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/group_by_hash_table.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+TEST(GroupByHashTableTest, find_or_insert_and_append_keys) {
+  GroupByHashTable table(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::STRING,
+       types::DataType::BOOLEAN});
+
+  auto* pool = arrow::default_memory_pool();
+  std::vector<types::StringValue> svc1 = {"a", "bb", "a", "", "a"};
+  std::vector<types::Int64Value> code1 = {200, 200, 200, 500, 500};
+  std::vector<types::StringValue> pod1 = {"pod", "pod", "pod", "x", "pod"};
+  std::vector<types::BoolValue> ok1 = {true, true, true, false, true};
+  auto svc_arr1 = types::ToArrow(svc1, pool);
+  auto code_arr1 = types::ToArrow(code1, pool);
+  auto pod_arr1 = types::ToArrow(pod1, pool);
+  auto ok_arr1 = types::ToArrow(ok1, pool);
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({svc_arr1.get(), code_arr1.get(), pod_arr1.get(), ok_arr1.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 3));
+  EXPECT_EQ(4, table.num_groups());
+
+  // String lengths differ between columns, but the concatenated bytes are the same, so the keys
+  // must still be told apart.
+  std::vector<types::StringValue> svc2 = {"ab", "a", "bb"};
+  std::vector<types::Int64Value> code2 = {200, 200, 200};
+  std::vector<types::StringValue> pod2 = {"od", "pod", "pod"};
+  std::vector<types::BoolValue> ok2 = {true, true, true};
+  auto svc_arr2 = types::ToArrow(svc2, pool);
+  auto code_arr2 = types::ToArrow(code2, pool);
+  auto pod_arr2 = types::ToArrow(pod2, pool);
+  auto ok_arr2 = types::ToArrow(ok2, pool);
+  table.FindOrInsert({svc_arr2.get(), code_arr2.get(), pod_arr2.get(), ok_arr2.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(4, 0, 1));
+  EXPECT_EQ(5, table.num_groups());
+
+  std::vector<types::StringValue> expected_svc = {"a", "bb", "", "a", "ab"};
+  std::vector<types::Int64Value> expected_code = {200, 200, 500, 500, 200};
+  std::vector<types::StringValue> expected_pod = {"pod", "pod", "x", "pod", "od"};
+  std::vector<types::BoolValue> expected_ok = {true, true, false, true, true};
+  std::vector<std::shared_ptr<arrow::Array>> expected = {
+      types::ToArrow(expected_svc, pool), types::ToArrow(expected_code, pool),
+      types::ToArrow(expected_pod, pool), types::ToArrow(expected_ok, pool)};
+  std::vector<types::DataType> key_types = {types::DataType::STRING, types::DataType::INT64,
+                                            types::DataType::STRING, types::DataType::BOOLEAN};
+  for (size_t i = 0; i < key_types.size(); ++i) {
+    auto builder = types::MakeArrowBuilder(key_types[i], pool);
+    ASSERT_OK(table.AppendKeyColumn(i, builder.get()));
+    std::shared_ptr<arrow::Array> out;
+    ASSERT_TRUE(builder->Finish(&out).ok());
+    EXPECT_TRUE(out->Equals(expected[i])) << "key column " << i;
+  }
+
+  table.Clear();
+  EXPECT_EQ(0, table.num_groups());
+  EXPECT_EQ(0, table.arena_bytes());
+  table.FindOrInsert({svc_arr2.get(), code_arr2.get(), pod_arr2.get(), ok_arr2.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 2));
+}
+
+TEST(GroupByHashTableTest, fixed_width_keys) {
+  GroupByHashTable table({types::DataType::TIME64NS, types::DataType::FLOAT64});
+  auto* pool = arrow::default_memory_pool();
+  std::vector<types::Time64NSValue> times = {10, 20, 10, 10};
+  std::vector<types::Float64Value> values = {1.5, 1.5, 1.5, 2.5};
+  auto times_arr = types::ToArrow(times, pool);
+  auto values_arr = types::ToArrow(values, pool);
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({times_arr.get(), values_arr.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2));
+
+  auto builder = types::MakeArrowBuilder(types::DataType::FLOAT64, pool);
+  ASSERT_OK(table.AppendKeyColumn(1, builder.get()));
+  std::shared_ptr<arrow::Array> out;
+  ASSERT_TRUE(builder->Finish(&out).ok());
+  std::vector<types::Float64Value> expected = {1.5, 1.5, 2.5};
+  EXPECT_TRUE(out->Equals(types::ToArrow(expected, pool)));
+}
+
+TEST(GroupByHashTableTest, find_does_not_insert) {
+  GroupByHashTable table({types::DataType::INT64});
+  auto* pool = arrow::default_memory_pool();
+  auto arr1 = types::ToArrow(std::vector<types::Int64Value>{7, 8}, pool);
+  auto arr2 = types::ToArrow(std::vector<types::Int64Value>{8, 9, 7}, pool);
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsert({arr1.get()}, &group_ids);
+  table.Find({arr2.get()}, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(1, -1, 0));
+  EXPECT_EQ(2, table.num_groups());
+  EXPECT_EQ(3UL, table.batch_hashes().size());
+}
+
+TEST(GroupByHashTableTest, selection_skips_rows) {
+  GroupByHashTable table({types::DataType::INT64});
+  auto* pool = arrow::default_memory_pool();
+  auto arr = types::ToArrow(std::vector<types::Int64Value>{7, 8, 9, 7}, pool);
+
+  std::vector<int64_t> group_ids;
+  std::vector<int64_t> selection{1, 3};
+  table.FindOrInsert({arr.get()}, &group_ids, &selection);
+  EXPECT_THAT(group_ids, ElementsAre(GroupByHashTable::kUnselectedRow, 0,
+                                     GroupByHashTable::kUnselectedRow, 1));
+  EXPECT_EQ(2, table.num_groups());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -29,12 +29,63 @@
 
 #include "src/carnot/exec/grpc_source_node.h"
 #include "src/common/base/base.h"
+#include "src/common/metrics/metrics.h"
 #include "src/common/uuid/uuid.h"
 
 namespace px {
 namespace carnot {
 namespace exec {
 
+QueryBacklogGauge::QueryBacklogGauge(const sole::uuid& query_id)
+    : family_(&prometheus::BuildGauge()
+                   .Name("carnot_grpc_router_backlog_bytes")
+                   .Help("Bytes of row batches received for a query but not yet consumed by its "
+                         "GRPC sources")
+                   .Register(GetMetricsRegistry())),
+      gauge_(&family_->Add({{"query_id", query_id.str()}})) {}
+
+QueryBacklogGauge::~QueryBacklogGauge() { family_->Remove(gauge_); }
+
+void RowBatchCredits::Take(int64_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    buffered_bytes_ += bytes;
+  }
+  backlog_gauge_->Increment(bytes);
+}
+
+void RowBatchCredits::Return(int64_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    buffered_bytes_ -= bytes;
+  }
+  backlog_gauge_->Decrement(bytes);
+  credit_available_.notify_all();
+}
+
+bool RowBatchCredits::WaitForCredit(std::chrono::milliseconds timeout) {
+  if (budget_bytes_ <= 0) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lock(mu_);
+  return credit_available_.wait_for(lock, timeout,
+                                    [this] { return buffered_bytes_ < budget_bytes_; });
+}
+
+int64_t RowBatchCredits::buffered_bytes() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return buffered_bytes_;
+}
+
+std::shared_ptr<RowBatchCredits> GRPCRouter::GetCredits(QueryTracker* query_tracker,
+                                                        SourceNodeTracker* snt) {
+  if (snt->credits == nullptr) {
+    snt->credits =
+        std::make_shared<RowBatchCredits>(source_buffer_bytes_, query_tracker->backlog_gauge);
+  }
+  return snt->credits;
+}
+
 GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* query_tracker,
                                                                 int64_t source_id) {
   absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
@@ -42,7 +93,8 @@ GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* qu
 }
 
 Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
-                                   std::unique_ptr<carnotpb::TransferResultChunkRequest> req) {
+                                   std::unique_ptr<carnotpb::TransferResultChunkRequest> req,
+                                   std::shared_ptr<RowBatchCredits>* credits) {
   if (!req->has_query_result() || !req->query_result().has_row_batch() ||
       req->query_result().destination_case() !=
           carnotpb::TransferResultChunkRequest_SinkResult::DestinationCase::kGrpcSourceId) {
@@ -54,6 +106,9 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
   auto snt = GetSourceNodeTracker(query_tracker, req->query_result().grpc_source_id());
   {
     absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
+    *credits = GetCredits(query_tracker, snt);
+    // The source node returns these bytes when it pops the batch, using the size cached here.
+    (*credits)->Take(req->ByteSizeLong());
     // It's possible that we see row batches before we have gotten information about the query. To
     // solve this race, We store a backlog of all the pending batches.
     if (snt->source_node == nullptr) {
@@ -117,7 +172,6 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
     ::grpc::ServerContext* context,
     ::grpc::ServerReader<::px::carnotpb::TransferResultChunkRequest>* reader,
     ::px::carnotpb::TransferResultChunkResponse* response) {
-  PL_UNUSED(context);
   auto rb = std::make_unique<carnotpb::TransferResultChunkRequest>();
 
   // If this is a query result stream, these are used to track whether or not this particular
@@ -142,7 +196,7 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
         // If its an initiate_result_stream request then we can create a new QueryTracker.
         // Otherwise, we return an error since this is likely after the QueryTracker was deleted.
         if (rb->has_query_result() && rb->query_result().initiate_result_stream()) {
-          query_node_map_[query_id] = std::make_shared<QueryTracker>();
+          query_node_map_[query_id] = std::make_shared<QueryTracker>(query_id);
         } else {
           result_status = ::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
                                          "Attempting to TransferResultChunk for finished query.");
@@ -170,11 +224,24 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
         break;
       }
     } else if (rb->has_query_result() && rb->query_result().has_row_batch()) {
-      auto s = EnqueueRowBatch(query_tracker.get(), std::move(rb));
+      std::shared_ptr<RowBatchCredits> credits;
+      auto s = EnqueueRowBatch(query_tracker.get(), std::move(rb), &credits);
       if (!s.ok()) {
         result_status = ::grpc::Status(grpc::StatusCode::INTERNAL, "failed to enqueue batch");
         break;
       }
+      // Stop reading while the source is over its budget. The unread messages fill up the gRPC
+      // flow control window, which blocks the writes of the sending GRPCSinkNode.
+      while (!credits->WaitForCredit(kCreditWaitInterval)) {
+        if (context->IsCancelled()) {
+          result_status = ::grpc::Status(grpc::StatusCode::CANCELLED,
+                                         "Query cancelled while waiting for source to drain");
+          break;
+        }
+      }
+      if (!result_status.ok()) {
+        break;
+      }
     } else if (rb->has_query_result() && rb->query_result().initiate_result_stream()) {
       if (rb->query_result().destination_case() !=
           carnotpb::TransferResultChunkRequest_SinkResult::DestinationCase::kGrpcSourceId) {
@@ -256,7 +323,7 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
   {
     absl::base_internal::SpinLockHolder lock(&query_node_map_lock_);
     if (!query_node_map_.contains(query_id)) {
-      query_node_map_[query_id] = std::make_shared<QueryTracker>();
+      query_node_map_[query_id] = std::make_shared<QueryTracker>(query_id);
     }
     query_tracker = query_node_map_[query_id];
   }
@@ -269,6 +336,7 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
   snt->source_node = source_node;
+  source_node->set_credits(GetCredits(query_tracker.get(), snt));
   if (snt->connection_initiated_by_sink) {
     source_node->set_upstream_initiated_connection();
   }
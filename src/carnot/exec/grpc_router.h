@@ -20,8 +20,11 @@
 
 #include <stdint.h>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
@@ -31,6 +34,8 @@
 #include <absl/container/node_hash_map.h>
 #include <absl/hash/hash.h>
 #include <grpcpp/grpcpp.h>
+#include <prometheus/family.h>
+#include <prometheus/gauge.h>
 #include <sole.hpp>
 
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
@@ -45,12 +50,79 @@ namespace exec {
 // Forward declaration needed to break circular dependency.
 class GRPCSourceNode;
 
+/**
+ * QueryBacklogGauge exports the bytes of row batches buffered in the GRPCRouter and its
+ * GRPCSourceNodes for a single query. The gauge is removed from the registry on destruction.
+ */
+class QueryBacklogGauge {
+ public:
+  explicit QueryBacklogGauge(const sole::uuid& query_id);
+  ~QueryBacklogGauge();
+
+  void Increment(int64_t bytes) { gauge_->Increment(static_cast<double>(bytes)); }
+  void Decrement(int64_t bytes) { gauge_->Decrement(static_cast<double>(bytes)); }
+
+ private:
+  prometheus::Family<prometheus::Gauge>* family_;
+  prometheus::Gauge* gauge_;
+};
+
+/**
+ * RowBatchCredits tracks the bytes of row batches that have been received for a single
+ * GRPCSourceNode but not yet consumed by it. Once the byte budget is used up, the
+ * TransferResultChunk stream feeding the source stops reading, which lets gRPC flow control push
+ * back on the sending GRPCSinkNode. A budget of 0 disables the limit.
+ */
+class RowBatchCredits {
+ public:
+  RowBatchCredits(int64_t budget_bytes, std::shared_ptr<QueryBacklogGauge> backlog_gauge)
+      : budget_bytes_(budget_bytes), backlog_gauge_(std::move(backlog_gauge)) {}
+
+  /**
+   * Records that a row batch of the given size is now buffered for the source.
+   */
+  void Take(int64_t bytes);
+
+  /**
+   * Records that the source consumed a row batch of the given size.
+   */
+  void Return(int64_t bytes);
+
+  /**
+   * Blocks until the buffered bytes are within the budget, or until the timeout expires.
+   * @return true if there is credit available to read the next row batch.
+   */
+  bool WaitForCredit(std::chrono::milliseconds timeout);
+
+  int64_t buffered_bytes() const;
+  int64_t budget_bytes() const { return budget_bytes_; }
+
+ private:
+  const int64_t budget_bytes_;
+  std::shared_ptr<QueryBacklogGauge> backlog_gauge_;
+
+  mutable std::mutex mu_;
+  std::condition_variable credit_available_;
+  int64_t buffered_bytes_ GUARDED_BY(mu_) = 0;
+};
+
 /**
  * GRPCRouter tracks incoming Kelvin connections and routes them to the appropriate Carnot source
  * node.
  */
 class GRPCRouter final : public carnotpb::ResultSinkService::Service {
  public:
+  static constexpr int64_t kDefaultSourceBufferBytes = 64 * 1024 * 1024;
+  // How often a stream that is out of credit checks whether its query was cancelled.
+  static constexpr std::chrono::milliseconds kCreditWaitInterval{100};
+
+  /**
+   * @param source_buffer_bytes the number of bytes each GRPC source can have buffered before the
+   * router stops reading from the stream that feeds it. 0 means unbounded.
+   */
+  explicit GRPCRouter(int64_t source_buffer_bytes = kDefaultSourceBufferBytes)
+      : source_buffer_bytes_(source_buffer_bytes) {}
+
   /**
    * TransferResultChunk implements the RPC method.
    */
@@ -116,6 +188,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     bool connection_closed_by_sink GUARDED_BY(node_lock) = false;
     std::vector<std::unique_ptr<::px::carnotpb::TransferResultChunkRequest>> response_backlog
         GUARDED_BY(node_lock);
+    // Shared with the source node, which returns credits as it consumes row batches.
+    std::shared_ptr<RowBatchCredits> credits GUARDED_BY(node_lock);
     absl::base_internal::SpinLock node_lock;
   };
 
@@ -123,7 +197,9 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
    * Query tracker tracks execution of a single query.
    */
   struct QueryTracker {
-    QueryTracker() : create_time(std::chrono::steady_clock::now()) {}
+    explicit QueryTracker(const sole::uuid& query_id)
+        : create_time(std::chrono::steady_clock::now()),
+          backlog_gauge(std::make_shared<QueryBacklogGauge>(query_id)) {}
     absl::node_hash_map<int64_t, SourceNodeTracker> source_node_trackers GUARDED_BY(query_lock);
     const std::chrono::steady_clock::time_point create_time GUARDED_BY(query_lock);
     std::function<void()> restart_execution_func_ GUARDED_BY(query_lock);
@@ -132,6 +208,7 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     absl::flat_hash_set<::grpc::ServerContext*> active_agent_contexts GUARDED_BY(query_lock);
     // The execution stats for agents that are clients to this service.
     std::vector<queryresultspb::AgentExecutionStats> agent_exec_stats GUARDED_BY(query_lock);
+    const std::shared_ptr<QueryBacklogGauge> backlog_gauge;
     absl::base_internal::SpinLock query_lock;
 
     void ResetRestartExecutionFunc() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
@@ -151,8 +228,13 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     }
   };
 
+  /**
+   * Routes the row batch to its source node (or the backlog) and takes credit for its bytes.
+   * The credits of the destination source are returned in credits.
+   */
   Status EnqueueRowBatch(QueryTracker* query_tracker,
-                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req);
+                         std::unique_ptr<carnotpb::TransferResultChunkRequest> req,
+                         std::shared_ptr<RowBatchCredits>* credits);
 
   Status MarkResultStreamInitiated(QueryTracker* query_tracker, int64_t source_id);
   Status MarkResultStreamClosed(QueryTracker* query_tracker, int64_t source_id);
@@ -160,7 +242,10 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   void MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
                                          ::grpc::ServerContext* context);
   SourceNodeTracker* GetSourceNodeTracker(QueryTracker* query_tracker, int64_t source_id);
+  std::shared_ptr<RowBatchCredits> GetCredits(QueryTracker* query_tracker, SourceNodeTracker* snt)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(snt->node_lock);
 
+  const int64_t source_buffer_bytes_;
   absl::node_hash_map<sole::uuid, std::shared_ptr<QueryTracker>> query_node_map_
       GUARDED_BY(query_node_map_lock_);
   mutable absl::base_internal::SpinLock query_node_map_lock_;
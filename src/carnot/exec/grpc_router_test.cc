@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
 #include <utility>
@@ -801,6 +802,90 @@ TEST_F(GRPCRouterTest, continue_func_segfault) {
   server_->Shutdown();
 }
 
+TEST(RowBatchCreditsTest, blocks_until_credit_returned) {
+  RowBatchCredits credits(/*budget_bytes*/ 100, std::make_shared<QueryBacklogGauge>(sole::uuid4()));
+  credits.Take(60);
+  EXPECT_TRUE(credits.WaitForCredit(std::chrono::milliseconds(1)));
+  credits.Take(60);
+  EXPECT_EQ(120, credits.buffered_bytes());
+  EXPECT_FALSE(credits.WaitForCredit(std::chrono::milliseconds(1)));
+
+  std::thread return_thread([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    credits.Return(60);
+  });
+  EXPECT_TRUE(credits.WaitForCredit(std::chrono::seconds(10)));
+  return_thread.join();
+  EXPECT_EQ(60, credits.buffered_bytes());
+}
+
+TEST(RowBatchCreditsTest, zero_budget_is_unbounded) {
+  RowBatchCredits credits(/*budget_bytes*/ 0, std::make_shared<QueryBacklogGauge>(sole::uuid4()));
+  credits.Take(1024);
+  EXPECT_TRUE(credits.WaitForCredit(std::chrono::milliseconds(1)));
+}
+
+TEST(GRPCRouterBackpressureTest, stops_reading_when_source_over_budget) {
+  // A single batch uses up the budget of the source.
+  GRPCRouter router(/*source_buffer_bytes*/ 1);
+  ServerBuilder builder;
+  builder.AddListeningPort("localhost:0", InsecureServerCredentials());
+  builder.RegisterService(&router);
+  auto server = builder.BuildAndStart();
+  grpc::ChannelArguments args;
+  auto stub = carnotpb::ResultSinkService::NewStub(server->InProcessChannel(args));
+
+  int64_t grpc_source_node_id = 1;
+  uint64_t ab = 0xea8aa095697f49f1, cd = 0xb127d50e5b6e2645;
+  auto query_uuid = sole::rebuild(ab, cd);
+  RowDescriptor input_rd({types::DataType::INT64});
+
+  // The fake source never pops its batches, so it never returns its credits.
+  auto op_proto = planpb::testutils::CreateTestGRPCSource1PB();
+  std::unique_ptr<px::carnot::plan::Operator> plan_node =
+      plan::GRPCSourceOperator::FromProto(op_proto, grpc_source_node_id);
+  auto source_node = FakeGRPCSourceNode();
+  ASSERT_OK(source_node.Init(*plan_node, input_rd, {}));
+  ASSERT_OK(router.AddGRPCSourceNode(query_uuid, grpc_source_node_id, &source_node, [] {}));
+
+  px::carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub->TransferResultChunk(&context, &response);
+  ::grpc::Status finish_status;
+  std::thread write_thread([&] {
+    carnotpb::TransferResultChunkRequest initiate_req;
+    initiate_req.mutable_query_id()->set_high_bits(ab);
+    initiate_req.mutable_query_id()->set_low_bits(cd);
+    initiate_req.mutable_query_result()->set_grpc_source_id(grpc_source_node_id);
+    initiate_req.mutable_query_result()->set_initiate_result_stream(true);
+    writer->Write(initiate_req);
+    for (int64_t idx = 0; idx < 3; ++idx) {
+      auto rb = RowBatchBuilder(input_rd, 1, /*eow*/ idx == 2, /*eos*/ idx == 2)
+                    .AddColumn<types::Int64Value>({idx})
+                    .get();
+      carnotpb::TransferResultChunkRequest rb_req;
+      EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+      rb_req.mutable_query_result()->set_grpc_source_id(grpc_source_node_id);
+      rb_req.mutable_query_id()->set_high_bits(ab);
+      rb_req.mutable_query_id()->set_low_bits(cd);
+      writer->Write(rb_req);
+    }
+    writer->WritesDone();
+    finish_status = writer->Finish();
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_TRUE(source_node.upstream_initiated_connection());
+  EXPECT_EQ(1, source_node.row_batches.size());
+
+  // Cancelling the query releases the stream that is waiting for credit.
+  router.DeleteQuery(query_uuid);
+  write_thread.join();
+  EXPECT_EQ(grpc::StatusCode::CANCELLED, finish_status.error_code());
+  EXPECT_EQ(1, source_node.row_batches.size());
+  server->Shutdown();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -83,7 +83,7 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   PL_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PL_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PL_RETURN_IF_ERROR(SerializeRowBatch(*rb, req.mutable_query_result()->mutable_row_batch()));
 
   PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
   return Status::OK();
@@ -126,6 +126,9 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, bool send
   if (plan_node_->has_table_name()) {
     // Adding auth to GRPC client.
     exec_state->AddAuthToGRPCClientContext(context_.get());
+  } else if (exec_state->grpc_sink_compression() != GRPC_COMPRESS_NONE) {
+    // Only other Carnot instances are known to accept compressed messages.
+    context_->set_compression_algorithm(exec_state->grpc_sink_compression());
   }
 
   response_.Clear();
@@ -139,7 +142,7 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, bool send
     // initiate_result_stream request.
     PL_ASSIGN_OR_RETURN(
         auto rb, RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-    PL_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+    PL_RETURN_IF_ERROR(SerializeRowBatch(*rb, req.mutable_query_result()->mutable_row_batch()));
   }
 
   if (!writer_->Write(req)) {
@@ -150,6 +153,14 @@ Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, bool send
   return Status::OK();
 }
 
+Status GRPCSinkNode::SerializeRowBatch(const RowBatch& rb,
+                                       table_store::schemapb::RowBatchData* proto) const {
+  if (plan_node_->packed_columns()) {
+    return rb.ToPackedProto(proto);
+  }
+  return rb.ToProto(proto);
+}
+
 Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
   cancelled_ = true;
   return error::Cancelled(
@@ -311,6 +322,11 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
 
 Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
   if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
+    if (rb.has_selection()) {
+      // Splitting works on dense rows, and the batch may well fit once it's compacted.
+      PL_ASSIGN_OR_RETURN(auto dense_rb, rb.Materialize(exec_state->exec_mem_pool()));
+      return ConsumeNextImpl(exec_state, *dense_rb, parent_idx);
+    }
     return SplitAndSendBatch(exec_state, rb, parent_idx);
   }
   return ConsumeNextImplNoSplit(exec_state, rb, parent_idx);
@@ -319,7 +335,7 @@ Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb,
 Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
   PL_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
   // Serialize the RowBatch.
-  PL_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
+  PL_RETURN_IF_ERROR(SerializeRowBatch(rb, req.mutable_query_result()->mutable_row_batch()));
 
   PL_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
 
@@ -58,6 +58,9 @@ class GRPCSinkNode : public SinkNode {
   GRPCSinkNode() : GRPCSinkNode(kMaxBatchSize, kBatchSizeFactor) {}
   virtual ~GRPCSinkNode() = default;
 
+  // Selected rows are serialized directly, so the sink doesn't need them copied out first.
+  bool AcceptsSelection() const override { return true; }
+
   // Used to check the downstream connection after connection_check_timeout_ has elapsed.
   Status OptionallyCheckConnection(ExecState* exec_state);
 
@@ -91,6 +94,8 @@ class GRPCSinkNode : public SinkNode {
                                     size_t n_retries);
   Status CancelledByServer(ExecState* exec_state);
   Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  Status SerializeRowBatch(const table_store::schema::RowBatch& rb,
+                           table_store::schemapb::RowBatchData* proto) const;
 
   bool cancelled_ = false;
 
@@ -231,6 +231,47 @@ TEST_F(GRPCSinkNodeTest, internal_result) {
   EXPECT_FALSE(add_metadata_called_);
 }
 
+TEST_F(GRPCSinkNodeTest, internal_result_packed_columns) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  op_proto.mutable_grpc_sink_op()->set_packed_columns(true);
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  auto s = plan_node->Init(op_proto.grpc_sink_op());
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> actual_protos(2);
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _))
+      .Times(2)
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[0]), Return(true)))
+      .WillOnce(DoAll(SaveArg<0>(&actual_protos[1]), Return(true)));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  auto rb = RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2})
+                .AddColumn<types::StringValue>({"abc", "de"})
+                .get();
+  tester.ConsumeNext(rb, 5, 0);
+  tester.Close();
+
+  EXPECT_TRUE(actual_protos[0].query_result().initiate_result_stream());
+  const auto& row_batch = actual_protos[1].query_result().row_batch();
+  ASSERT_EQ(2, row_batch.cols_size());
+  EXPECT_TRUE(row_batch.cols(0).has_packed_data());
+  EXPECT_TRUE(row_batch.cols(1).has_packed_data());
+  ASSERT_OK_AND_ASSIGN(auto received_rb, RowBatch::FromProto(row_batch));
+  EXPECT_TRUE(received_rb->eos());
+  EXPECT_EQ(rb.DebugString(), received_rb->DebugString());
+}
+
 constexpr char kExpectedExternalInitialization[] = R"proto(
 address: "localhost:1234"
 query_id {
@@ -72,6 +72,10 @@ Status GRPCSourceNode::PopRowBatch() {
         "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
         "queue.");
   }
+  if (credits_ != nullptr) {
+    // The router sized the request before enqueueing it, so the cached size matches what it took.
+    credits_->Return(rb_request->GetCachedSize());
+  }
   if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
     return error::Internal(
         "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
@@ -21,11 +21,13 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/grpc_router.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/table_store/table_store.h"
@@ -56,6 +58,10 @@ class GRPCSourceNode : public SourceNode {
   void set_upstream_closed_connection() { upstream_closed_connection_ = true; }
   bool upstream_closed_connection() const { return upstream_closed_connection_; }
 
+  // Credits held by the GRPCRouter for the row batches queued on this source. They are returned
+  // as batches are popped so that the router can resume reading from the stream.
+  void set_credits(std::shared_ptr<RowBatchCredits> credits) { credits_ = std::move(credits); }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,6 +80,7 @@ class GRPCSourceNode : public SourceNode {
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
   bool upstream_initiated_connection_ = false;
   bool upstream_closed_connection_ = false;
+  std::shared_ptr<RowBatchCredits> credits_;
 };
 
 }  // namespace exec
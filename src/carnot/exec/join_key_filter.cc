@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_key_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+// Appends a key value to an encoded key. Strings are length prefixed so that multi-column keys
+// can't collide by shifting bytes between columns. Floats are encoded by their bits, so -0.0 is
+// turned into 0.0 first to keep keys that compare equal from hashing differently.
+template <types::DataType DT>
+void AppendKeyValue(const typename types::DataTypeTraits<DT>::native_type& val, std::string* key) {
+  if constexpr (DT == types::DataType::STRING) {
+    uint32_t len = val.size();
+    key->append(reinterpret_cast<const char*>(&len), sizeof(len));
+    key->append(val);
+  } else if constexpr (DT == types::DataType::FLOAT64) {
+    double normalized = val == 0.0 ? 0.0 : val;
+    key->append(reinterpret_cast<const char*>(&normalized), sizeof(normalized));
+  } else {
+    key->append(reinterpret_cast<const char*>(&val), sizeof(val));
+  }
+}
+
+template <types::DataType DT>
+void AppendRowTupleValue(const RowTuple& rt, size_t idx, std::string* key) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  if constexpr (DT == types::DataType::STRING) {
+    AppendKeyValue<DT>(rt.GetValue<ValueType>(idx), key);
+  } else {
+    AppendKeyValue<DT>(rt.GetValue<ValueType>(idx).val, key);
+  }
+}
+
+template <types::DataType DT>
+void AppendArrowValue(const arrow::Array* col, int64_t row, std::string* key) {
+  AppendKeyValue<DT>(types::GetValueFromArrowArray<DT>(col, row), key);
+}
+
+}  // namespace
+
+Status JoinKeyFilter::Publish(const std::vector<const RowTuple*>& keys) {
+  DCHECK(!published());
+  if (static_cast<int64_t>(keys.size()) > kJoinKeyFilterMaxEntries) {
+    return Status::OK();
+  }
+  PL_ASSIGN_OR_RETURN(bloom_filter_,
+                      bloomfilter::XXHash64BloomFilter::Create(
+                          std::max<int64_t>(1, keys.size()), kJoinKeyFilterErrorRate));
+  std::string key;
+  for (const RowTuple* rt : keys) {
+    key.clear();
+    for (size_t i = 0; i < key_types_.size(); ++i) {
+#define TYPE_CASE(_dt_) AppendRowTupleValue<_dt_>(*rt, i, &key);
+      PL_SWITCH_FOREACH_DATATYPE(key_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    bloom_filter_->Insert(key);
+  }
+  published_.store(true, std::memory_order_release);
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> JoinKeyFilter::Filter(const RowBatch& rb,
+                                                          const std::vector<int64_t>& key_cols,
+                                                          arrow::MemoryPool* mem_pool) const {
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  if (!published() || bloom_filter_ == nullptr || rb.num_rows() == 0) {
+    return std::make_unique<RowBatch>(rb);
+  }
+
+  std::vector<const arrow::Array*> cols;
+  for (int64_t col_idx : key_cols) {
+    cols.push_back(rb.ColumnAt(col_idx).get());
+  }
+  std::vector<int64_t> kept_rows;
+  kept_rows.reserve(rb.num_rows());
+  std::string key;
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    key.clear();
+    for (size_t i = 0; i < key_types_.size(); ++i) {
+#define TYPE_CASE(_dt_) AppendArrowValue<_dt_>(cols[i], row, &key);
+      PL_SWITCH_FOREACH_DATATYPE(key_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    if (bloom_filter_->Contains(key)) {
+      kept_rows.push_back(row);
+    }
+  }
+  if (static_cast<int64_t>(kept_rows.size()) == rb.num_rows()) {
+    return std::make_unique<RowBatch>(rb);
+  }
+  rows_dropped_.fetch_add(rb.num_rows() - kept_rows.size(), std::memory_order_relaxed);
+
+  const auto& desc = rb.desc();
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+  for (size_t col_idx = 0; col_idx < desc.size(); ++col_idx) {
+    auto builder = types::MakeArrowBuilder(desc.type(col_idx), mem_pool);
+    PL_RETURN_IF_ERROR(builder->Reserve(kept_rows.size()));
+    const arrow::Array* col = rb.ColumnAt(col_idx).get();
+    for (int64_t row : kept_rows) {
+#define TYPE_CASE(_dt_)                                    \
+  PL_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
+      builder.get(), types::GetValueFromArrowArray<_dt_>(col, row)));
+      PL_SWITCH_FOREACH_DATATYPE(desc.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    builders.push_back(std::move(builder));
+  }
+  return RowBatch::FromColumnBuilders(desc, rb.eow(), rb.eos(), &builders);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
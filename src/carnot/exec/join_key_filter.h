@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/row_tuple.h"
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// The false positive rate of the bloom filter over the build keys of a join.
+constexpr double kJoinKeyFilterErrorRate = 0.01;
+// Joins with more distinct build keys than this don't publish a filter. A filter that large
+// costs more to check than probing the hash table would.
+constexpr int64_t kJoinKeyFilterMaxEntries = 1 << 22;
+
+/**
+ * JoinKeyFilter is a bloom filter over the distinct build keys of an equijoin. The join publishes
+ * it once its build side is complete, and the source feeding the probe side uses it to drop rows
+ * that can't have a match before they are sent any further.
+ *
+ * The filter is published and read from different sources, which may run on different threads.
+ * Until it is published (or if the build side was too large), Filter lets every row through.
+ *
+ * The filter is shared in memory, so it only reaches sources in the same plan fragment as the
+ * join. When the probe side arrives over GRPC from another Carnot instance (e.g. PEM fragments
+ * feeding a join on a Kelvin), the rows aren't filtered.
+ */
+class JoinKeyFilter : public NotCopyable {
+ public:
+  explicit JoinKeyFilter(const std::vector<types::DataType>& key_types) : key_types_(key_types) {}
+
+  /**
+   * Builds the bloom filter from the distinct build keys and makes it visible to Filter.
+   * @param keys The build keys, with values in the order of the key types.
+   */
+  Status Publish(const std::vector<const RowTuple*>& keys);
+
+  bool published() const { return published_.load(std::memory_order_acquire); }
+
+  /**
+   * Returns the rows of the row batch whose keys may be among the build keys.
+   * @param rb The probe side row batch.
+   * @param key_cols The columns of rb that hold the keys, in the order of the key types.
+   * @param mem_pool The pool to allocate the filtered columns from.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> Filter(
+      const table_store::schema::RowBatch& rb, const std::vector<int64_t>& key_cols,
+      arrow::MemoryPool* mem_pool) const;
+
+  // The number of rows dropped by Filter so far.
+  int64_t rows_dropped() const { return rows_dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  std::vector<types::DataType> key_types_;
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter_;
+  std::atomic<bool> published_ = false;
+  mutable std::atomic<int64_t> rows_dropped_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
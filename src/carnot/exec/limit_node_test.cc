@@ -200,6 +200,39 @@ TEST_F(LimitNodeTest, limits_exact_boundary) {
       .Close();
 }
 
+TEST_F(LimitNodeTest, limits_selected_records) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<LimitNode, plan::LimitOperator>(*plan_node_, output_rd,
+                                                                     {input_rd}, exec_state_.get());
+  // Only the selected rows count towards the limit.
+  tester.ChildAcceptsSelection()
+      .ConsumeNext(RowBatchBuilder(input_rd, 8, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7, 8})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9, 12, 15, 18, 21})
+                       .Select({0, 2, 3, 5, 6, 7})
+                       .get(),
+                   0)
+      .ExpectSelection(true)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, false, false)
+                          .AddColumn<types::Int64Value>({1, 3, 4, 6, 7, 8})
+                          .AddColumn<types::Int64Value>({1, 6, 9, 15, 18, 21})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 8, false, false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7, 8})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9, 12, 15, 18, 21})
+                       .Select({1, 2, 4, 5, 6, 7})
+                       .get(),
+                   0)
+      .ExpectSelection(true)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Int64Value>({2, 3, 5, 6})
+                          .AddColumn<types::Int64Value>({3, 6, 12, 15})
+                          .get())
+      .Close();
+}
+
 TEST_F(LimitNodeTest, child_fail) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
@@ -42,6 +42,13 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
   const auto* map_plan_node = static_cast<const plan::MapOperator*>(&plan_node);
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::MapOperator>(*map_plan_node);
+  passes_selection_through_ = true;
+  for (const auto& expr : plan_node_->expressions()) {
+    if (expr->ExpressionType() == plan::Expression::kFunc ||
+        expr->ExpressionType() == plan::Expression::kAgg) {
+      passes_selection_through_ = false;
+    }
+  }
   return Status::OK();
 }
 Status MapNode::PrepareImpl(ExecState* exec_state) {
@@ -62,8 +69,17 @@ Status MapNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.has_selection() && !passes_selection_through_) {
+    // Functions are only evaluated on the selected rows, since the rows a filter dropped may be
+    // invalid inputs to them.
+    PL_ASSIGN_OR_RETURN(auto dense_rb, rb.Materialize(exec_state->exec_mem_pool()));
+    return ConsumeNextImpl(exec_state, *dense_rb, 0);
+  }
   RowBatch output_rb(*output_descriptor_, rb.num_rows());
   PL_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, &output_rb));
+  if (rb.has_selection()) {
+    output_rb.set_selection(rb.selection());
+  }
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
@@ -41,6 +41,8 @@ class MapNode : public ProcessingNode {
   MapNode() = default;
   virtual ~MapNode() = default;
 
+  bool AcceptsSelection() const override { return ChildrenAcceptSelection(); }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -51,6 +53,9 @@ class MapNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
+  // Whether every expression is a column or a constant, in which case the output columns line up
+  // with the input rows and a selection can be passed through as is.
+  bool passes_selection_through_ = false;
   std::unique_ptr<ExpressionEvaluator> evaluator_;
   std::unique_ptr<plan::MapOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
@@ -99,6 +99,26 @@ TEST_F(MapNodeTest, basic) {
       .Close();
 }
 
+TEST_F(MapNodeTest, selection_with_function) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node_, output_rd, {},
+                                                                 exec_state_.get());
+  // Functions only see the selected rows, so the output is dense.
+  tester.ChildAcceptsSelection()
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                       .Select({1, 3})
+                       .get(),
+                   0)
+      .ExpectSelection(false)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, true, true).AddColumn<types::Int64Value>({5, 13}).get())
+      .Close();
+}
+
 TEST_F(MapNodeTest, zero_row_row_batch) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64});
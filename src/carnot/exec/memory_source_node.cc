@@ -19,10 +19,14 @@
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/table_store/table/table.h"
 
+#include <algorithm>
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
@@ -35,6 +39,122 @@ namespace exec {
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
 
+namespace {
+
+std::optional<ColumnPredicate::Op> PredicateOpFromFuncName(const std::string& name) {
+  if (name == "equal") {
+    return ColumnPredicate::kEqual;
+  }
+  if (name == "notEqual") {
+    return ColumnPredicate::kNotEqual;
+  }
+  if (name == "lessThan") {
+    return ColumnPredicate::kLessThan;
+  }
+  if (name == "lessThanEqual") {
+    return ColumnPredicate::kLessThanEqual;
+  }
+  if (name == "greaterThan") {
+    return ColumnPredicate::kGreaterThan;
+  }
+  if (name == "greaterThanEqual") {
+    return ColumnPredicate::kGreaterThanEqual;
+  }
+  return std::nullopt;
+}
+
+// Returns the op such that `a <op> b` is equivalent to `b <flipped op> a`.
+ColumnPredicate::Op FlipPredicateOp(ColumnPredicate::Op op) {
+  switch (op) {
+    case ColumnPredicate::kLessThan:
+      return ColumnPredicate::kGreaterThan;
+    case ColumnPredicate::kLessThanEqual:
+      return ColumnPredicate::kGreaterThanEqual;
+    case ColumnPredicate::kGreaterThan:
+      return ColumnPredicate::kLessThan;
+    case ColumnPredicate::kGreaterThanEqual:
+      return ColumnPredicate::kLessThanEqual;
+    default:
+      return op;
+  }
+}
+
+std::optional<table_store::internal::ZoneMapValue> ZoneMapValueFromScalar(
+    const plan::ScalarValue& value) {
+  if (value.IsNull()) {
+    return std::nullopt;
+  }
+  switch (value.DataType()) {
+    case types::DataType::BOOLEAN:
+      return value.BoolValue();
+    case types::DataType::INT64:
+      return value.Int64Value();
+    case types::DataType::TIME64NS:
+      return value.Time64NSValue();
+    case types::DataType::UINT128:
+      return value.UInt128Value();
+    case types::DataType::FLOAT64:
+      return value.Float64Value();
+    case types::DataType::STRING:
+      return value.StringValue();
+    default:
+      return std::nullopt;
+  }
+}
+
+void AddZoneMapPredicates(const plan::ScalarExpression& expr,
+                          std::vector<ColumnPredicate>* predicates) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if (func.name() == "logicalAnd") {
+    for (const auto& arg : args) {
+      AddZoneMapPredicates(*arg, predicates);
+    }
+    return;
+  }
+  auto op = PredicateOpFromFuncName(func.name());
+  if (!op.has_value() || args.size() != 2) {
+    return;
+  }
+
+  const plan::Column* col = nullptr;
+  const plan::ScalarValue* literal = nullptr;
+  if (args[0]->ExpressionType() == plan::Expression::kColumn &&
+      args[1]->ExpressionType() == plan::Expression::kConstant) {
+    col = static_cast<const plan::Column*>(args[0].get());
+    literal = static_cast<const plan::ScalarValue*>(args[1].get());
+  } else if (args[0]->ExpressionType() == plan::Expression::kConstant &&
+             args[1]->ExpressionType() == plan::Expression::kColumn) {
+    col = static_cast<const plan::Column*>(args[1].get());
+    literal = static_cast<const plan::ScalarValue*>(args[0].get());
+    op = FlipPredicateOp(op.value());
+  } else {
+    return;
+  }
+
+  // Float equality is approximate in Carnot, so exact zone map ranges can't be used for it.
+  if (literal->DataType() == types::DataType::FLOAT64 &&
+      (op == ColumnPredicate::kEqual || op == ColumnPredicate::kNotEqual)) {
+    return;
+  }
+  auto value = ZoneMapValueFromScalar(*literal);
+  if (!value.has_value()) {
+    return;
+  }
+  predicates->push_back(ColumnPredicate{col->Index(), op.value(), std::move(value.value())});
+}
+
+}  // namespace
+
+std::vector<ColumnPredicate> ZoneMapPredicatesFromExpression(const plan::ScalarExpression& expr) {
+  std::vector<ColumnPredicate> predicates;
+  AddZoneMapPredicates(expr, &predicates);
+  return predicates;
+}
+
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
                           output_descriptor_->DebugString());
@@ -51,6 +171,22 @@ Status MemorySourceNode::InitImpl(const plan::Operator& plan_node) {
 
 Status MemorySourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
+void MemorySourceNode::PushDownZoneMapPredicates(const std::vector<ColumnPredicate>& predicates) {
+  const auto& columns = plan_node_->Columns();
+  for (auto predicate : predicates) {
+    if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(columns.size())) {
+      continue;
+    }
+    predicate.col_idx = columns[predicate.col_idx];
+    zone_map_predicates_.push_back(std::move(predicate));
+  }
+}
+
+void MemorySourceNode::PushDownJoinKeyFilter(std::shared_ptr<JoinKeyFilter> filter,
+                                             const std::vector<int64_t>& key_cols) {
+  join_key_filters_.push_back({std::move(filter), key_cols});
+}
+
 Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   table_ = exec_state->table_store()->GetTable(plan_node_->TableName(), plan_node_->Tablet());
   DCHECK(table_ != nullptr);
@@ -79,20 +215,66 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
     // Determine table_end at Open() time because Stirling may be pushing to the table
     stop_spec.type = StopSpec::StopType::CurrentEndOfTable;
   }
+  if (plan_node_->HasSkippedTime() && plan_node_->HasStartTime() && !infinite_stream_) {
+    // The rows of the skipped range are accounted for downstream, so read around them.
+    if (plan_node_->skip_start_time() > plan_node_->start_time()) {
+      StopSpec head_stop_spec;
+      head_stop_spec.type = StopSpec::StopType::StopAtTime;
+      head_stop_spec.stop_time = plan_node_->skip_start_time() - 1;
+      head_cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, head_stop_spec);
+    }
+    start_spec.start_time = std::max(plan_node_->start_time(), plan_node_->skip_stop_time());
+  }
   cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
+  if (!zone_map_predicates_.empty()) {
+    cursor_->SetZoneMapPredicates(zone_map_predicates_);
+    if (head_cursor_ != nullptr) {
+      head_cursor_->SetZoneMapPredicates(zone_map_predicates_);
+    }
+  }
 
   return Status::OK();
 }
 
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("infinite_stream", infinite_stream_ ? "true" : "false");
+  if (cursor_ != nullptr && !zone_map_predicates_.empty()) {
+    int64_t batches_skipped = cursor_->BatchesSkipped();
+    int64_t rows_skipped = cursor_->RowsSkipped();
+    if (head_cursor_ != nullptr) {
+      batches_skipped += head_cursor_->BatchesSkipped();
+      rows_skipped += head_cursor_->RowsSkipped();
+    }
+    stats()->AddExtraInfo("zone_map_batches_skipped", absl::StrCat(batches_skipped));
+    stats()->AddExtraInfo("zone_map_rows_skipped", absl::StrCat(rows_skipped));
+  }
+  if (plan_node_->HasSkippedTime()) {
+    stats()->AddExtraInfo("skipped_time_range",
+                          absl::StrCat("[", plan_node_->skip_start_time(), ", ",
+                                       plan_node_->skip_stop_time(), ")"));
+  }
+  if (!join_key_filters_.empty()) {
+    int64_t rows_dropped = 0;
+    for (const auto& pushed_down : join_key_filters_) {
+      rows_dropped += pushed_down.filter->rows_dropped();
+    }
+    stats()->AddExtraInfo("join_key_filter_rows_dropped", absl::StrCat(rows_dropped));
+  }
   return Status::OK();
 }
 
+Table::Cursor* MemorySourceNode::CurrentCursor() {
+  if (head_cursor_ != nullptr && !head_cursor_->Done()) {
+    return head_cursor_.get();
+  }
+  return cursor_.get();
+}
+
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
   DCHECK(table_ != nullptr);
+  Table::Cursor* cursor = CurrentCursor();
 
-  if (!cursor_->NextBatchReady()) {
+  if (!cursor->NextBatchReady()) {
     // If the NextBatch is not ready, but the cursor is not yet exhausted, then we need to output
     // 0-row row batches, while we wait for more data to be added. This currently only occurs in the
     // case of an infinite stream. In the future, it should also occur when a stop time is set in
@@ -102,7 +284,7 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
                                   /* eos */ cursor_->Done());
   }
 
-  PL_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+  PL_ASSIGN_OR_RETURN(auto row_batch, cursor->GetNextRowBatch(plan_node_->Columns()));
 
   rows_processed_ += row_batch->num_rows();
   bytes_processed_ += row_batch->NumBytes();
@@ -110,7 +292,7 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
   // If infinite stream is set, we don't send Eow or Eos. Infinite streams therefore never cause
   // HasBatchesRemaining to be false. Instead the outer loop that calls GenerateNext() is
   // responsible for managing whether we continue the stream or end it.
-  if (cursor_->Done() && !infinite_stream_) {
+  if (CurrentCursor()->Done() && !infinite_stream_) {
     row_batch->set_eow(true);
     row_batch->set_eos(true);
   }
@@ -119,6 +301,10 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
 
 Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   PL_ASSIGN_OR_RETURN(auto row_batch, GetNextRowBatch(exec_state));
+  for (const auto& pushed_down : join_key_filters_) {
+    PL_ASSIGN_OR_RETURN(row_batch, pushed_down.filter->Filter(*row_batch, pushed_down.key_cols,
+                                                              exec_state->exec_mem_pool()));
+  }
   PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *row_batch));
   return Status::OK();
 }
@@ -25,7 +25,9 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/join_key_filter.h"
 #include "src/carnot/plan/operators.h"
+#include "src/carnot/plan/scalar_expression.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
 #include "src/table_store/schema/row_batch.h"
@@ -36,9 +38,20 @@ namespace px {
 namespace carnot {
 namespace exec {
 
+using table_store::ColumnPredicate;
 using table_store::Table;
 using table_store::schema::RowBatch;
 
+/**
+ * Extracts the conjunctive `column <op> literal` terms of a filter expression as ColumnPredicates,
+ * so that they can be pushed down to a MemorySourceNode. Terms that can't be represented (eg. UDF
+ * calls on columns, disjunctions) are ignored, so the returned predicates may be weaker than the
+ * expression, but never stronger.
+ * @param expr the filter expression.
+ * @return predicates with column indices relative to the input of the filter.
+ */
+std::vector<ColumnPredicate> ZoneMapPredicatesFromExpression(const plan::ScalarExpression& expr);
+
 class MemorySourceNode : public SourceNode {
  public:
   MemorySourceNode() = default;
@@ -46,6 +59,23 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * Pushes down predicates from a downstream filter, which are used to skip table batches that
+   * can't match. Must be called before Open.
+   * @param predicates conjunction of predicates, with column indices relative to this node's
+   * output.
+   */
+  void PushDownZoneMapPredicates(const std::vector<ColumnPredicate>& predicates);
+
+  /**
+   * Pushes down the build key filter of a downstream join, which is used to drop rows that can't
+   * match once the join has published it. Must be called before Open.
+   * @param filter the join's filter.
+   * @param key_cols the columns of this node's output that hold the join keys.
+   */
+  void PushDownJoinKeyFilter(std::shared_ptr<JoinKeyFilter> filter,
+                             const std::vector<int64_t>& key_cols);
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -57,11 +87,24 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  // The cursor to read the next batch from: the head cursor until it's done, then cursor_.
+  Table::Cursor* CurrentCursor();
   // Whether this memory source will stream infinitely. Can be stopped by the
   // exec_state_->keep_running() call in exec_graph.
   bool infinite_stream_ = false;
 
   std::unique_ptr<Table::Cursor> cursor_;
+  // Set when the plan skips a time range: reads the rows before it, while cursor_ reads the rows
+  // after it.
+  std::unique_ptr<Table::Cursor> head_cursor_;
+  // Predicates with column indices into the table's relation.
+  std::vector<ColumnPredicate> zone_map_predicates_;
+
+  struct PushedDownJoinKeyFilter {
+    std::shared_ptr<JoinKeyFilter> filter;
+    std::vector<int64_t> key_cols;
+  };
+  std::vector<PushedDownJoinKeyFilter> join_key_filters_;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
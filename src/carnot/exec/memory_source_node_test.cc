@@ -25,6 +25,7 @@
 
 #include <absl/strings/substitute.h>
 #include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
@@ -105,6 +106,34 @@ TEST_F(MemorySourceNodeTest, basic) {
   EXPECT_EQ(sizeof(int64_t) * 5, tester.node()->BytesProcessed());
 }
 
+TEST_F(MemorySourceNodeTest, join_key_filter) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  auto filter = std::make_shared<JoinKeyFilter>(std::vector<types::DataType>{types::TIME64NS});
+  tester.node()->PushDownJoinKeyFilter(filter, {0});
+
+  // Rows go through untouched until the join publishes its filter.
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 3, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({1, 2, 3})
+          .get());
+
+  // The build side had no keys, so none of the remaining rows can match.
+  ASSERT_OK(filter->Publish({}));
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(2, filter->rows_dropped());
+  EXPECT_EQ(5, tester.node()->RowsProcessed());
+}
+
 TEST_F(MemorySourceNodeTest, empty_table) {
   auto op_proto = planpb::testutils::CreateTestSource1PB("empty");
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -183,6 +212,32 @@ TEST_F(MemorySourceNodeTest, range) {
   tester.Close();
 }
 
+TEST_F(MemorySourceNodeTest, skipped_range) {
+  auto op_proto = planpb::testutils::CreateTestSourceRangePB();
+  auto* mem_source_op = op_proto.mutable_mem_source_op();
+  mem_source_op->mutable_start_time()->set_value(1);
+  mem_source_op->mutable_skip_start_time()->set_value(2);
+  mem_source_op->mutable_skip_stop_time()->set_value(5);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({1})
+          .get());
+  EXPECT_TRUE(tester.node()->HasBatchesRemaining());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 2, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({5, 6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(3, tester.node()->RowsProcessed());
+}
+
 TEST_F(MemorySourceNodeTest, empty_range) {
   auto op_proto = planpb::testutils::CreateTestSourceEmptyRangePB();
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -414,6 +469,79 @@ TEST_F(MemorySourceNodeTest, table_compact_between_open_and_exec) {
   tester.Close();
 }
 
+constexpr char kZoneMapFilterExprPbtxt[] = R"(
+func {
+  name: "logicalAnd"
+  args {
+    func {
+      name: "equal"
+      args {
+        column {
+          node: 0
+          index: 1
+        }
+      }
+      args {
+        constant {
+          data_type: INT64
+          int64_value: 10
+        }
+      }
+    }
+  }
+  args {
+    func {
+      name: "lessThan"
+      args {
+        constant {
+          data_type: TIME64NS
+          time64_ns_value: 5
+        }
+      }
+      args {
+        column {
+          node: 0
+          index: 0
+        }
+      }
+    }
+  }
+  args {
+    func {
+      name: "equal"
+      args {
+        column {
+          node: 0
+          index: 2
+        }
+      }
+      args {
+        constant {
+          data_type: FLOAT64
+          float64_value: 1.5
+        }
+      }
+    }
+  }
+})";
+
+TEST(ZoneMapPredicatesFromExpression, extracts_column_literal_comparisons) {
+  planpb::ScalarExpression se_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kZoneMapFilterExprPbtxt, &se_pb));
+  ASSERT_OK_AND_ASSIGN(auto expr, plan::ScalarExpression::FromProto(se_pb));
+
+  auto predicates = ZoneMapPredicatesFromExpression(*expr);
+  // The float equality can't be pushed down, since carnot uses approximate float equality.
+  ASSERT_EQ(2, predicates.size());
+  EXPECT_EQ(1, predicates[0].col_idx);
+  EXPECT_EQ(ColumnPredicate::kEqual, predicates[0].op);
+  EXPECT_EQ(table_store::internal::ZoneMapValue(int64_t{10}), predicates[0].value);
+  // The comparison is flipped so that the column is on the left hand side.
+  EXPECT_EQ(0, predicates[1].col_idx);
+  EXPECT_EQ(ColumnPredicate::kGreaterThan, predicates[1].op);
+  EXPECT_EQ(table_store::internal::ZoneMapValue(int64_t{5}), predicates[1].value);
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/otel_export_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+OTelExportPool::OTelExportPool(int num_threads, std::chrono::milliseconds flush_tick)
+    : flush_tick_(std::max(flush_tick, std::chrono::milliseconds(1))) {
+  for (int i = 0; i < std::max(num_threads, 1); ++i) {
+    threads_.emplace_back(&OTelExportPool::WorkerLoop, this);
+  }
+  timer_thread_ = std::thread(&OTelExportPool::TimerLoop, this);
+}
+
+OTelExportPool::~OTelExportPool() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stopped_ = true;
+  }
+  work_cv_.notify_all();
+  timer_cv_.notify_all();
+  timer_thread_.join();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void OTelExportPool::Submit(ExportFunc export_func, DoneFunc done_func) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    pending_.emplace_back(std::move(export_func), std::move(done_func));
+  }
+  work_cv_.notify_one();
+}
+
+int64_t OTelExportPool::RegisterFlush(FlushFunc flush_func) {
+  std::lock_guard<std::mutex> lock(flush_lock_);
+  int64_t id = next_flush_id_++;
+  flush_funcs_.emplace(id, std::move(flush_func));
+  return id;
+}
+
+void OTelExportPool::UnregisterFlush(int64_t id) {
+  std::lock_guard<std::mutex> lock(flush_lock_);
+  flush_funcs_.erase(id);
+}
+
+void OTelExportPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    work_cv_.wait(lock, [this]() { return stopped_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    auto [export_func, done_func] = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    Status s = export_func();
+    int64_t latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    done_func(s, latency_ns);
+
+    lock.lock();
+  }
+}
+
+void OTelExportPool::TimerLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (!timer_cv_.wait_for(lock, flush_tick_, [this]() { return stopped_; })) {
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> flush_lock(flush_lock_);
+      for (const auto& [id, flush_func] : flush_funcs_) {
+        flush_func();
+      }
+    }
+    lock.lock();
+  }
+}
+
+OTelExportQueue::OTelExportQueue(OTelExportPool* pool, int max_in_flight)
+    : pool_(pool), max_in_flight_(std::max(max_in_flight, 1)) {}
+
+OTelExportQueue::~OTelExportQueue() { PL_UNUSED(Wait()); }
+
+void OTelExportQueue::Submit(OTelExportPool::ExportFunc export_func) {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    done_cv_.wait(lock, [this]() { return outstanding_ < max_in_flight_; });
+    ++outstanding_;
+  }
+  SubmitToPool(std::move(export_func));
+}
+
+bool OTelExportQueue::TrySubmit(OTelExportPool::ExportFunc export_func) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (outstanding_ >= max_in_flight_) {
+      return false;
+    }
+    ++outstanding_;
+  }
+  SubmitToPool(std::move(export_func));
+  return true;
+}
+
+void OTelExportQueue::SubmitToPool(OTelExportPool::ExportFunc export_func) {
+  pool_->Submit(std::move(export_func),
+                [this](Status s, int64_t latency_ns) { ExportDone(s, latency_ns); });
+}
+
+void OTelExportQueue::ExportDone(Status s, int64_t latency_ns) {
+  // Notify while holding the lock: once Wait() sees the last export finish, the queue may be
+  // destroyed.
+  std::lock_guard<std::mutex> lock(lock_);
+  --outstanding_;
+  ++num_exports_;
+  total_latency_ns_ += latency_ns;
+  max_latency_ns_ = std::max(max_latency_ns_, latency_ns);
+  if (!s.ok()) {
+    ++num_failures_;
+    if (status_.ok()) {
+      status_ = s;
+    }
+  }
+  done_cv_.notify_all();
+}
+
+Status OTelExportQueue::Wait() {
+  std::unique_lock<std::mutex> lock(lock_);
+  done_cv_.wait(lock, [this]() { return outstanding_ == 0; });
+  return status_;
+}
+
+Status OTelExportQueue::status() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return status_;
+}
+
+int64_t OTelExportQueue::num_exports() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return num_exports_;
+}
+
+int64_t OTelExportQueue::num_failures() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return num_failures_;
+}
+
+int64_t OTelExportQueue::total_latency_ns() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return total_latency_ns_;
+}
+
+int64_t OTelExportQueue::max_latency_ns() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return max_latency_ns_;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
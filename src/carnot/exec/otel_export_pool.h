@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Runs the export RPCs of every OTelExportSinkNode of a Carnot instance on a shared set of
+ * threads. Queries don't wait for a collector round trip on every export, and the number of
+ * threads doesn't grow with the number of sinks.
+ *
+ * A timer thread also calls the registered flush callbacks once per flush tick, so that sinks send
+ * the rows they have held for too long even when no new input arrives.
+ */
+class OTelExportPool : public NotCopyable {
+ public:
+  using ExportFunc = std::function<Status()>;
+  // Called on a pool thread once an export has finished, with its status and latency.
+  using DoneFunc = std::function<void(Status, int64_t latency_ns)>;
+  using FlushFunc = std::function<void()>;
+
+  OTelExportPool(int num_threads, std::chrono::milliseconds flush_tick);
+  // Runs the exports that are still queued before returning.
+  ~OTelExportPool();
+
+  void Submit(ExportFunc export_func, DoneFunc done_func);
+
+  // Calls flush_func on the timer thread every flush tick until it's unregistered. flush_func must
+  // not block on the thread that unregisters it.
+  int64_t RegisterFlush(FlushFunc flush_func);
+  // Returns once a running call of the flush func has finished, after which it is never called.
+  void UnregisterFlush(int64_t id);
+
+ private:
+  void WorkerLoop();
+  void TimerLoop();
+
+  const std::chrono::milliseconds flush_tick_;
+  std::vector<std::thread> threads_;
+  std::thread timer_thread_;
+
+  std::mutex lock_;
+  std::condition_variable work_cv_;
+  std::condition_variable timer_cv_;
+  bool stopped_ = false;
+  std::deque<std::pair<ExportFunc, DoneFunc>> pending_;
+
+  // Held while the flush funcs run, so that UnregisterFlush waits for them.
+  std::mutex flush_lock_;
+  std::map<int64_t, FlushFunc> flush_funcs_;
+  int64_t next_flush_id_ = 0;
+};
+
+/**
+ * The exports of a single OTelExportSinkNode in the shared pool. At most max_in_flight of them are
+ * queued or running at once, Submit() blocks while that many are outstanding.
+ */
+class OTelExportQueue : public NotCopyable {
+ public:
+  OTelExportQueue(OTelExportPool* pool, int max_in_flight);
+  // Waits for the outstanding exports, which call back into the queue.
+  ~OTelExportQueue();
+
+  void Submit(OTelExportPool::ExportFunc export_func);
+  // Like Submit(), but returns false instead of blocking when max_in_flight are outstanding.
+  bool TrySubmit(OTelExportPool::ExportFunc export_func);
+
+  /**
+   * Blocks until every submitted export has finished.
+   * @return the first error returned by an export, or OK if all of them succeeded.
+   */
+  Status Wait();
+
+  // The first error returned by a finished export, or OK.
+  Status status();
+
+  int64_t num_exports();
+  int64_t num_failures();
+  int64_t total_latency_ns();
+  int64_t max_latency_ns();
+
+ private:
+  void SubmitToPool(OTelExportPool::ExportFunc export_func);
+  void ExportDone(Status s, int64_t latency_ns);
+
+  OTelExportPool* pool_;
+  const size_t max_in_flight_;
+
+  std::mutex lock_;
+  std::condition_variable done_cv_;
+  size_t outstanding_ = 0;
+  Status status_;
+  int64_t num_exports_ = 0;
+  int64_t num_failures_ = 0;
+  int64_t total_latency_ns_ = 0;
+  int64_t max_latency_ns_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/otel_export_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(OTelExportQueueTest, collects_status_and_stats) {
+  OTelExportPool pool(/*num_threads*/ 2, std::chrono::milliseconds(10));
+  OTelExportQueue queue(&pool, /*max_in_flight*/ 2);
+  for (int i = 0; i < 5; ++i) {
+    queue.Submit([i]() { return i == 3 ? error::Internal("export $0 failed", i) : Status::OK(); });
+  }
+  auto s = queue.Wait();
+  ASSERT_NOT_OK(s);
+  EXPECT_EQ("export 3 failed", s.msg());
+  EXPECT_EQ(5, queue.num_exports());
+  EXPECT_EQ(1, queue.num_failures());
+  EXPECT_GE(queue.total_latency_ns(), queue.max_latency_ns());
+}
+
+TEST(OTelExportQueueTest, try_submit_respects_max_in_flight) {
+  OTelExportPool pool(/*num_threads*/ 2, std::chrono::milliseconds(10));
+  OTelExportQueue queue(&pool, /*max_in_flight*/ 1);
+
+  std::mutex lock;
+  std::condition_variable cv;
+  bool released = false;
+  queue.Submit([&]() {
+    std::unique_lock<std::mutex> l(lock);
+    cv.wait(l, [&]() { return released; });
+    return Status::OK();
+  });
+  EXPECT_FALSE(queue.TrySubmit([]() { return Status::OK(); }));
+  {
+    std::lock_guard<std::mutex> l(lock);
+    released = true;
+  }
+  cv.notify_all();
+
+  ASSERT_OK(queue.Wait());
+  EXPECT_TRUE(queue.TrySubmit([]() { return Status::OK(); }));
+  ASSERT_OK(queue.Wait());
+  EXPECT_EQ(2, queue.num_exports());
+}
+
+TEST(OTelExportPoolTest, calls_flush_until_unregistered) {
+  OTelExportPool pool(/*num_threads*/ 1, std::chrono::milliseconds(1));
+  std::mutex lock;
+  std::condition_variable cv;
+  int calls = 0;
+  auto id = pool.RegisterFlush([&]() {
+    std::lock_guard<std::mutex> l(lock);
+    ++calls;
+    cv.notify_all();
+  });
+  {
+    std::unique_lock<std::mutex> l(lock);
+    ASSERT_TRUE(cv.wait_for(l, std::chrono::seconds(10), [&]() { return calls >= 2; }));
+  }
+  pool.UnregisterFlush(id);
+
+  int calls_after_unregister;
+  {
+    std::lock_guard<std::mutex> l(lock);
+    calls_after_unregister = calls;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::lock_guard<std::mutex> l(lock);
+  EXPECT_EQ(calls_after_unregister, calls);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
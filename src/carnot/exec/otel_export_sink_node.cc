@@ -19,6 +19,7 @@
 #include "src/carnot/exec/otel_export_sink_node.h"
 
 #include <rapidjson/document.h>
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <queue>
@@ -47,6 +48,12 @@ using table_store::schema::RowDescriptor;
 const int64_t kOTelSpanIDLength = 8;
 const int64_t kOTelTraceIDLength = 16;
 
+OTelExportSinkNode::~OTelExportSinkNode() {
+  if (flush_id_ >= 0) {
+    export_pool_->UnregisterFlush(flush_id_);
+  }
+}
+
 std::string OTelExportSinkNode::DebugStringImpl() {
   return absl::Substitute("Exec::OTelExportSinkNode: $0", plan_node_->DebugString());
 }
@@ -74,20 +81,123 @@ Status OTelExportSinkNode::OpenImpl(ExecState* exec_state) {
   if (plan_node_->spans().size()) {
     trace_service_stub_ = exec_state->TraceServiceStub(plan_node_->url(), plan_node_->insecure());
   }
+  batch_bytes_ = exec_state->otel_export_batch_bytes();
+  flush_interval_ = exec_state->otel_export_flush_interval();
+  export_pool_ = exec_state->otel_export_pool();
+  if (export_pool_ == nullptr) {
+    return error::Internal("OTelExportSinkNode $0 requires an OTel export pool", plan_node_->id());
+  }
+  export_queue_ =
+      std::make_unique<OTelExportQueue>(export_pool_, exec_state->otel_export_max_in_flight());
+  flush_id_ = export_pool_->RegisterFlush([this]() { FlushIfStale(); });
   return Status::OK();
 }
 
 Status OTelExportSinkNode::CloseImpl(ExecState* exec_state) {
+  if (export_queue_ == nullptr) {
+    return Status::OK();
+  }
+  // Stop the timed flushes before the rows of this node are flushed one last time.
+  export_pool_->UnregisterFlush(flush_id_);
+  flush_id_ = -1;
   if (sent_eos_) {
+    RecordExportStats();
     return Status::OK();
   }
 
   LOG(INFO) << absl::Substitute("Closing OTelExportSinkNode $0 in query $1 before receiving EOS",
                                 plan_node_->id(), exec_state->query_id().str());
+  // Send the rows received so far, as they would have been if each batch was exported directly.
+  {
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    FlushPending(/*wait*/ true);
+  }
+  Status s = export_queue_->Wait();
+  RecordExportStats();
+  return s;
+}
+
+void OTelExportSinkNode::RecordExportStats() {
+  int64_t num_exports = export_queue_->num_exports();
+  stats()->AddExtraMetric("export_requests", num_exports);
+  stats()->AddExtraMetric("export_failures", export_queue_->num_failures());
+  if (num_exports > 0) {
+    stats()->AddExtraMetric("export_latency_avg_ms",
+                            export_queue_->total_latency_ns() / 1e6 / num_exports);
+    stats()->AddExtraMetric("export_latency_max_ms", export_queue_->max_latency_ns() / 1e6);
+  }
+}
+
+void OTelExportSinkNode::SetUpContext(grpc::ClientContext* context) const {
+  for (const auto& header : plan_node_->endpoint_headers()) {
+    context->AddMetadata(header.first, header.second);
+  }
+  context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+}
 
+Status OTelExportSinkNode::ExportStatus(const grpc::Status& status) const {
+  if (!status.ok()) {
+    return error::Internal(absl::Substitute(
+        "OTelExportSinkNode $0 encountered error code $1 "
+        "exporting data, message: $2 $3",
+        plan_node_->id(), status.error_code(), status.error_message(), status.error_details()));
+  }
   return Status::OK();
 }
 
+void OTelExportSinkNode::FlushPending(bool wait) {
+  if (pending_metrics_.resource_metrics_size() > 0) {
+    auto request =
+        std::make_shared<opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest>(
+            std::move(pending_metrics_));
+    pending_metrics_.Clear();
+    auto export_func = [this, request]() {
+      grpc::ClientContext context;
+      SetUpContext(&context);
+      opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse response;
+      return ExportStatus(metrics_service_stub_->Export(&context, *request, &response));
+    };
+    if (wait) {
+      export_queue_->Submit(std::move(export_func));
+    } else if (!export_queue_->TrySubmit(std::move(export_func))) {
+      pending_metrics_ = std::move(*request);
+    }
+  }
+  if (pending_spans_.resource_spans_size() > 0) {
+    auto request =
+        std::make_shared<opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest>(
+            std::move(pending_spans_));
+    pending_spans_.Clear();
+    auto export_func = [this, request]() {
+      grpc::ClientContext context;
+      SetUpContext(&context);
+      opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse response;
+      return ExportStatus(trace_service_stub_->Export(&context, *request, &response));
+    };
+    if (wait) {
+      export_queue_->Submit(std::move(export_func));
+    } else if (!export_queue_->TrySubmit(std::move(export_func))) {
+      pending_spans_ = std::move(*request);
+    }
+  }
+  if (pending_metrics_.resource_metrics_size() == 0 && pending_spans_.resource_spans_size() == 0) {
+    pending_bytes_ = 0;
+  }
+}
+
+void OTelExportSinkNode::FlushIfStale() {
+  // If the query thread holds the lock, it's adding rows and checks the flush interval itself.
+  std::unique_lock<std::mutex> lock(pending_lock_, std::try_to_lock);
+  if (!lock.owns_lock() || pending_bytes_ == 0) {
+    return;
+  }
+  if (std::chrono::steady_clock::now() - pending_since_ < flush_interval_) {
+    return;
+  }
+  // The timer is shared by every sink, so it doesn't wait for the exports of this one.
+  FlushPending(/*wait*/ false);
+}
+
 template <typename C>
 void AddAttributes(google::protobuf::RepeatedPtrField<::opentelemetry::proto::common::v1::KeyValue>*
                        mutable_attributes,
@@ -195,15 +305,6 @@ void ReplicateData(const std::vector<planpb::OTelAttribute>& attributes_spec,
 
 using ::opentelemetry::proto::metrics::v1::ResourceMetrics;
 Status OTelExportSinkNode::ConsumeMetrics(const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
-  }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest request;
-
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     ::opentelemetry::proto::metrics::v1::ResourceMetrics resource_metrics;
     auto resource = resource_metrics.mutable_resource();
@@ -263,19 +364,12 @@ Status OTelExportSinkNode::ConsumeMetrics(const RowBatch& rb) {
     }
     ReplicateData<ResourceMetrics>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceMetrics metrics) {
-          *request.add_resource_metrics() = std::move(metrics);
+        [this](ResourceMetrics metrics) {
+          pending_bytes_ += metrics.ByteSizeLong();
+          *pending_metrics_.add_resource_metrics() = std::move(metrics);
         },
         std::move(resource_metrics), rb, row_idx);
   }
-
-  grpc::Status status = metrics_service_stub_->Export(&context, request, &metrics_response_);
-  if (!status.ok()) {
-    return error::Internal(absl::Substitute(
-        "OTelExportSinkNode $0 encountered error code $1 "
-        "exporting data, message: $2 $3",
-        plan_node_->id(), status.error_code(), status.error_message(), status.error_details()));
-  }
   return Status::OK();
 }
 
@@ -305,15 +399,6 @@ std::string GenerateID(uint64_t num_bytes) {
 
 using ::opentelemetry::proto::trace::v1::ResourceSpans;
 Status OTelExportSinkNode::ConsumeSpans(const RowBatch& rb) {
-  grpc::ClientContext context;
-  for (const auto& header : plan_node_->endpoint_headers()) {
-    context.AddMetadata(header.first, header.second);
-  }
-  context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-  metrics_response_.Clear();
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest request;
-
   for (int64_t row_idx = 0; row_idx < rb.ColumnAt(0)->length(); ++row_idx) {
     // TODO(philkuz) aggregate spans by resource.
     ::opentelemetry::proto::trace::v1::ResourceSpans resource_spans;
@@ -382,29 +467,38 @@ Status OTelExportSinkNode::ConsumeSpans(const RowBatch& rb) {
 
     ReplicateData<ResourceSpans>(
         plan_node_->resource_attributes_optional_json_encoded(),
-        [&request](ResourceSpans span) { *request.add_resource_spans() = std::move(span); },
+        [this](ResourceSpans span) {
+          pending_bytes_ += span.ByteSizeLong();
+          *pending_spans_.add_resource_spans() = std::move(span);
+        },
         std::move(resource_spans), rb, row_idx);
   }
-
-  grpc::Status status = trace_service_stub_->Export(&context, request, &trace_response_);
-  if (!status.ok()) {
-    return error::Internal(absl::Substitute(
-        "OTelExportSinkNode $0 encountered error code $1 "
-        "exporting data, message: $2 $3",
-        plan_node_->id(), status.error_code(), status.error_message(), status.error_details()));
-  }
   return Status::OK();
 }
 
 Status OTelExportSinkNode::ConsumeNextImpl(ExecState*, const RowBatch& rb, size_t) {
+  // Surface the failures of earlier exports instead of continuing to send to a broken collector.
+  PL_RETURN_IF_ERROR(export_queue_->status());
+
+  std::lock_guard<std::mutex> lock(pending_lock_);
+  bool had_pending = pending_bytes_ > 0;
   if (plan_node_->metrics().size()) {
     PL_RETURN_IF_ERROR(ConsumeMetrics(rb));
   }
   if (plan_node_->spans().size()) {
     PL_RETURN_IF_ERROR(ConsumeSpans(rb));
   }
+  auto now = std::chrono::steady_clock::now();
+  if (!had_pending) {
+    pending_since_ = now;
+  }
+  if (rb.eow() || rb.eos() || pending_bytes_ >= batch_bytes_ ||
+      now - pending_since_ >= flush_interval_) {
+    FlushPending(/*wait*/ true);
+  }
   if (rb.eos()) {
     sent_eos_ = true;
+    PL_RETURN_IF_ERROR(export_queue_->Wait());
   }
   return Status::OK();
 }
@@ -18,13 +18,17 @@
 #pragma once
 
 #include <grpcpp/grpcpp.h>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.grpc.pb.h"
 #include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
 
 #include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/otel_export_pool.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/types.h"
@@ -39,7 +43,7 @@ struct SpanConfig {
 
 class OTelExportSinkNode : public SinkNode {
  public:
-  virtual ~OTelExportSinkNode() = default;
+  virtual ~OTelExportSinkNode();
 
  protected:
   std::string DebugStringImpl() override;
@@ -51,18 +55,41 @@ class OTelExportSinkNode : public SinkNode {
                          size_t parent_index) override;
 
  private:
+  // Add the rows of rb to the pending export requests.
   Status ConsumeMetrics(const table_store::schema::RowBatch& rb);
   Status ConsumeSpans(const table_store::schema::RowBatch& rb);
+  // Hands the pending export requests to the export queue. Unless wait is set, the requests that
+  // would have to wait for an earlier export to finish stay pending.
+  void FlushPending(bool wait);
+  // Called by the export pool's timer, flushes the pending requests once they are older than the
+  // flush interval.
+  void FlushIfStale();
+  void SetUpContext(grpc::ClientContext* context) const;
+  Status ExportStatus(const grpc::Status& status) const;
+  void RecordExportStats();
 
   std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
-  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse metrics_response_;
   opentelemetry::proto::collector::metrics::v1::MetricsService::StubInterface*
       metrics_service_stub_;
-  opentelemetry::proto::collector::trace::v1::ExportTraceServiceResponse trace_response_;
   opentelemetry::proto::collector::trace::v1::TraceService::StubInterface* trace_service_stub_;
   std::unique_ptr<plan::OTelExportSinkOperator> plan_node_;
 
   std::unique_ptr<SpanConfig> span_config_;
+
+  // Guards the pending requests, which the export pool's timer may flush.
+  std::mutex pending_lock_;
+  opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest pending_metrics_;
+  opentelemetry::proto::collector::trace::v1::ExportTraceServiceRequest pending_spans_;
+  // The serialized size of the pending requests, and when their first row was added.
+  int64_t pending_bytes_ = 0;
+  std::chrono::steady_clock::time_point pending_since_;
+  int64_t batch_bytes_ = 0;
+  std::chrono::milliseconds flush_interval_{0};
+
+  OTelExportPool* export_pool_ = nullptr;
+  int64_t flush_id_ = -1;
+  // Declared last so that in-flight exports finish before the state they use is destroyed.
+  std::unique_ptr<OTelExportQueue> export_queue_;
 };
 
 }  // namespace exec
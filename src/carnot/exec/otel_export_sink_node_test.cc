@@ -18,9 +18,17 @@
 
 #include "src/carnot/exec/otel_export_sink_node.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include <grpcpp/grpcpp.h>
 #include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -34,6 +42,7 @@
 
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/carnotpb/carnot_mock.grpc.pb.h"
+#include "src/carnot/exec/otel_export_pool.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/carnot/planpb/test_proto.h"
@@ -88,10 +97,12 @@ class OTelExportSinkNodeTest : public ::testing::Test {
           return std::move(trace_mock_unique_);
         },
         sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {});
+    exec_state_->set_otel_export_pool(&export_pool_);
   }
 
  protected:
   std::string url_;
+  OTelExportPool export_pool_{/*num_threads*/ 2, std::chrono::milliseconds(10)};
   std::unique_ptr<ExecState> exec_state_;
   std::unique_ptr<udf::Registry> func_registry_;
   otelmetricscollector::MockMetricsServiceStub* metrics_mock_;
@@ -142,6 +153,8 @@ metrics {
                  .AddColumn<types::Float64Value>({1.0})
                  .get();
   tester.ConsumeNext(rb1, 1, 0);
+  // The batch isn't the end of a window, so it's only exported once the node closes.
+  tester.Close();
 
   EXPECT_EQ(url_, "otlp.px.dev");
 }
@@ -515,6 +528,7 @@ cols { int64_data { data: 150 } }
 num_rows: 1
 eow: true
 eos: true)pb"},
+                              // Rows are accumulated into one request until the end of the window.
                               {R"pb(
 resource_metrics {
   resource {}
@@ -529,8 +543,7 @@ resource_metrics {
       }
     }
   }
-})pb",
-                               R"pb(
+}
 resource_metrics {
   resource {}
   instrumentation_library_metrics {
@@ -1467,6 +1480,210 @@ eos: true)pb",
     }),
     [](const ::testing::TestParamInfo<SpanIDTestCase>& info) { return info.param.name; });
 
+// A local collector that records the exports it receives. While it's held, exports block until
+// Release() is called, so that tests can observe how many of them overlap.
+class FakeMetricsCollector final : public otelmetricscollector::MetricsService::Service {
+ public:
+  ::grpc::Status Export(::grpc::ServerContext*,
+                        const otelmetricscollector::ExportMetricsServiceRequest* request,
+                        otelmetricscollector::ExportMetricsServiceResponse*) override {
+    std::unique_lock<std::mutex> lock(lock_);
+    ++in_flight_;
+    max_in_flight_ = std::max(max_in_flight_, in_flight_);
+    cv_.notify_all();
+    cv_.wait(lock, [this]() { return !held_; });
+    --in_flight_;
+    requests_.push_back(*request);
+    cv_.notify_all();
+    if (fail) {
+      return ::grpc::Status(::grpc::StatusCode::UNAVAILABLE, "collector unavailable");
+    }
+    return ::grpc::Status::OK;
+  }
+
+  void Hold() {
+    std::lock_guard<std::mutex> lock(lock_);
+    held_ = true;
+  }
+  void Release() {
+    std::lock_guard<std::mutex> lock(lock_);
+    held_ = false;
+    cv_.notify_all();
+  }
+
+  // Returns whether in_flight exports were running at once before the timeout.
+  bool WaitForInFlight(int in_flight, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return cv_.wait_for(lock, timeout, [&]() { return in_flight_ >= in_flight; });
+  }
+  // Returns whether num_requests exports were received before the timeout.
+  bool WaitForRequests(size_t num_requests, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return cv_.wait_for(lock, timeout, [&]() { return requests_.size() >= num_requests; });
+  }
+
+  std::vector<otelmetricscollector::ExportMetricsServiceRequest> requests() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return requests_;
+  }
+  int max_in_flight() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return max_in_flight_;
+  }
+
+  bool fail = false;
+
+ private:
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool held_ = false;
+  int in_flight_ = 0;
+  int max_in_flight_ = 0;
+  std::vector<otelmetricscollector::ExportMetricsServiceRequest> requests_;
+};
+
+class OTelExportFakeCollectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials());
+    builder.RegisterService(&collector_);
+    server_ = builder.BuildAndStart();
+
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    exec_state_ = std::make_unique<ExecState>(
+        func_registry_.get(), std::make_shared<table_store::TableStore>(),
+        MockResultSinkStubGenerator,
+        [this](const std::string&,
+               bool) -> std::unique_ptr<otelmetricscollector::MetricsService::StubInterface> {
+          return otelmetricscollector::MetricsService::NewStub(
+              server_->InProcessChannel(grpc::ChannelArguments()));
+        },
+        [](const std::string&,
+           bool) -> std::unique_ptr<oteltracecollector::TraceService::StubInterface> {
+          return nullptr;
+        },
+        sole::uuid4(), nullptr, nullptr, [](grpc::ClientContext*) {});
+    exec_state_->set_otel_export_pool(&export_pool_);
+
+    planpb::OTelExportSinkOperator otel_sink_op;
+    EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(R"pb(
+metrics {
+  name: "http.resp.latency"
+  time_column_index: 0
+  gauge { int_column_index: 1 }
+})pb",
+                                                              &otel_sink_op));
+    plan_node_ = std::make_unique<plan::OTelExportSinkOperator>(1);
+    EXPECT_OK(plan_node_->Init(otel_sink_op));
+  }
+
+  void TearDown() override { server_->Shutdown(); }
+
+  std::unique_ptr<OTelExportSinkNode> OpenNode() {
+    auto node = std::make_unique<OTelExportSinkNode>();
+    EXPECT_OK(node->Init(*plan_node_, RowDescriptor({}), {input_rd_}, /*collect_exec_stats*/ true));
+    EXPECT_OK(node->Prepare(exec_state_.get()));
+    EXPECT_OK(node->Open(exec_state_.get()));
+    return node;
+  }
+
+  RowBatch MakeBatch(int64_t time, bool eos) {
+    return RowBatchBuilder(input_rd_, 1, /*eow*/ eos, /*eos*/ eos)
+        .AddColumn<types::Time64NSValue>({time})
+        .AddColumn<types::Int64Value>({time * 10})
+        .get();
+  }
+
+  FakeMetricsCollector collector_;
+  OTelExportPool export_pool_{/*num_threads*/ 4, std::chrono::milliseconds(10)};
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<plan::OTelExportSinkOperator> plan_node_;
+  RowDescriptor input_rd_{{types::TIME64NS, types::INT64}};
+};
+
+TEST_F(OTelExportFakeCollectorTest, concurrent_exports) {
+  // Export every batch on its own, with up to 4 exports at a time.
+  exec_state_->set_otel_export_batch_bytes(1);
+  exec_state_->set_otel_export_max_in_flight(4);
+  auto node = OpenNode();
+
+  // The first 4 exports don't block the node, and all of them reach the collector at once.
+  collector_.Hold();
+  for (int64_t time = 0; time < 4; ++time) {
+    auto rb = MakeBatch(time, /*eos*/ false);
+    ASSERT_OK(node->ConsumeNext(exec_state_.get(), rb, 0));
+  }
+  ASSERT_TRUE(collector_.WaitForInFlight(4, std::chrono::seconds(10)));
+  collector_.Release();
+
+  for (int64_t time = 4; time < 8; ++time) {
+    auto rb = MakeBatch(time, /*eos*/ time == 7);
+    ASSERT_OK(node->ConsumeNext(exec_state_.get(), rb, 0));
+  }
+  // EOS waits for all of the exports to finish.
+  auto requests = collector_.requests();
+  ASSERT_EQ(8, requests.size());
+  EXPECT_EQ(4, collector_.max_in_flight());
+  std::vector<int64_t> times;
+  for (const auto& request : requests) {
+    ASSERT_EQ(1, request.resource_metrics_size());
+    times.push_back(request.resource_metrics(0)
+                        .instrumentation_library_metrics(0)
+                        .metrics(0)
+                        .gauge()
+                        .data_points(0)
+                        .time_unix_nano());
+  }
+  std::sort(times.begin(), times.end());
+  EXPECT_THAT(times, ::testing::ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+
+  ASSERT_OK(node->Close(exec_state_.get()));
+  EXPECT_EQ(8, node->stats()->extra_metrics["export_requests"]);
+  EXPECT_EQ(0, node->stats()->extra_metrics["export_failures"]);
+}
+
+TEST_F(OTelExportFakeCollectorTest, flushes_stale_rows_without_input) {
+  exec_state_->set_otel_export_flush_interval(std::chrono::milliseconds(20));
+  auto node = OpenNode();
+
+  // The batch doesn't end a window, so only the pool's timer can flush it.
+  auto rb = MakeBatch(0, /*eos*/ false);
+  ASSERT_OK(node->ConsumeNext(exec_state_.get(), rb, 0));
+  ASSERT_TRUE(collector_.WaitForRequests(1, std::chrono::seconds(10)));
+
+  ASSERT_OK(node->Close(exec_state_.get()));
+  EXPECT_EQ(1, node->stats()->extra_metrics["export_requests"]);
+}
+
+TEST_F(OTelExportFakeCollectorTest, accumulates_until_end_of_window) {
+  auto node = OpenNode();
+  for (int64_t time = 0; time < 3; ++time) {
+    auto rb = MakeBatch(time, /*eos*/ time == 2);
+    ASSERT_OK(node->ConsumeNext(exec_state_.get(), rb, 0));
+  }
+  auto requests = collector_.requests();
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ(3, requests[0].resource_metrics_size());
+  ASSERT_OK(node->Close(exec_state_.get()));
+  EXPECT_EQ(1, node->stats()->extra_metrics["export_requests"]);
+}
+
+TEST_F(OTelExportFakeCollectorTest, export_failure) {
+  collector_.fail = true;
+  auto node = OpenNode();
+  auto rb = MakeBatch(0, /*eos*/ true);
+  auto s = node->ConsumeNext(exec_state_.get(), rb, 0);
+  ASSERT_NOT_OK(s);
+  EXPECT_THAT(s.msg(), ::testing::HasSubstr("collector unavailable"));
+
+  ASSERT_OK(node->Close(exec_state_.get()));
+  EXPECT_EQ(1, node->stats()->extra_metrics["export_requests"]);
+  EXPECT_EQ(1, node->stats()->extra_metrics["export_failures"]);
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+#include <absl/strings/substitute.h>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+thread_local MemoryTracker* current_tracker = nullptr;
+
+struct AllocationHeader {
+  MemoryTracker* tracker;
+};
+static_assert(sizeof(AllocationHeader) <= QueryMemoryPool::kHeaderBytes);
+
+AllocationHeader* HeaderOf(uint8_t* buffer) {
+  return reinterpret_cast<AllocationHeader*>(buffer - QueryMemoryPool::kHeaderBytes);
+}
+
+}  // namespace
+
+ScopedMemoryTracker::ScopedMemoryTracker(MemoryTracker* tracker) : prev_(current_tracker) {
+  current_tracker = tracker;
+}
+
+ScopedMemoryTracker::~ScopedMemoryTracker() { current_tracker = prev_; }
+
+MemoryTracker* QueryMemoryPool::NewTracker() {
+  std::lock_guard<std::mutex> lock(trackers_lock_);
+  return &trackers_.emplace_back();
+}
+
+arrow::Status QueryMemoryPool::Reserve(int64_t bytes) {
+  int64_t allocated = bytes_allocated_.fetch_add(bytes) + bytes;
+  int64_t limit = limit_bytes_.load();
+  if (limit > 0 && bytes > 0 && allocated > limit) {
+    bytes_allocated_.fetch_sub(bytes);
+    return arrow::Status::OutOfMemory(absl::Substitute(
+        "Query memory limit of $0 bytes exceeded: allocating $1 bytes with $2 bytes in use",
+        limit, bytes, allocated - bytes));
+  }
+  int64_t peak = peak_bytes_.load();
+  while (allocated > peak && !peak_bytes_.compare_exchange_weak(peak, allocated)) {
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status QueryMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  ARROW_RETURN_NOT_OK(Reserve(size));
+  uint8_t* raw;
+  arrow::Status s = parent_->Allocate(size + kHeaderBytes, &raw);
+  if (!s.ok()) {
+    bytes_allocated_.fetch_sub(size);
+    return s;
+  }
+  refs_.fetch_add(1);
+  *out = raw + kHeaderBytes;
+  HeaderOf(*out)->tracker = current_tracker;
+  if (current_tracker != nullptr) {
+    current_tracker->Consume(size);
+    current_tracker->CountAllocation(size);
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status QueryMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  ARROW_RETURN_NOT_OK(Reserve(new_size - old_size));
+  uint8_t* raw = *ptr - kHeaderBytes;
+  arrow::Status s = parent_->Reallocate(old_size + kHeaderBytes, new_size + kHeaderBytes, &raw);
+  if (!s.ok()) {
+    bytes_allocated_.fetch_sub(new_size - old_size);
+    return s;
+  }
+  *ptr = raw + kHeaderBytes;
+  // The allocation stays charged to the tracker that made it.
+  MemoryTracker* tracker = HeaderOf(*ptr)->tracker;
+  if (tracker != nullptr) {
+    tracker->Consume(new_size - old_size);
+    if (new_size > old_size) {
+      tracker->CountAllocation(new_size - old_size);
+    }
+  }
+  return arrow::Status::OK();
+}
+
+void QueryMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  MemoryTracker* tracker = HeaderOf(buffer)->tracker;
+  if (tracker != nullptr) {
+    tracker->Release(size);
+  }
+  parent_->Free(buffer - kHeaderBytes, size + kHeaderBytes);
+  bytes_allocated_.fetch_sub(size);
+  Unref();
+}
+
+void QueryMemoryPool::Release() { Unref(); }
+
+void QueryMemoryPool::Unref() {
+  if (refs_.fetch_sub(1) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
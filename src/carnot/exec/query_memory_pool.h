@@ -0,0 +1,152 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * MemoryTracker counts the bytes currently allocated on behalf of one ExecNode, and the peak of
+ * that count. Allocations are charged to the tracker that is active on the allocating thread, and
+ * given back to the same tracker when they are freed, whichever node frees them.
+ */
+class MemoryTracker : public NotCopyable {
+ public:
+  void Consume(int64_t bytes) {
+    int64_t current = current_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (current > peak &&
+           !peak_bytes_.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+  }
+  void Release(int64_t bytes) { current_bytes_.fetch_sub(bytes, std::memory_order_relaxed); }
+  // Counts an allocation call, separately from the bytes held, so that nodes that churn through
+  // many short-lived buffers stand out.
+  void CountAllocation(int64_t bytes) {
+    num_allocations_.fetch_add(1, std::memory_order_relaxed);
+    total_bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  int64_t current_bytes() const { return current_bytes_.load(std::memory_order_relaxed); }
+  int64_t peak_bytes() const { return peak_bytes_.load(std::memory_order_relaxed); }
+  int64_t num_allocations() const { return num_allocations_.load(std::memory_order_relaxed); }
+  int64_t total_bytes_allocated() const {
+    return total_bytes_allocated_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> current_bytes_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+  std::atomic<int64_t> num_allocations_ = 0;
+  std::atomic<int64_t> total_bytes_allocated_ = 0;
+};
+
+/**
+ * ScopedMemoryTracker makes a tracker the active one on the calling thread for its lifetime, and
+ * restores the previously active tracker afterwards. A null tracker charges nothing.
+ */
+class ScopedMemoryTracker : public NotCopyable {
+ public:
+  explicit ScopedMemoryTracker(MemoryTracker* tracker);
+  ~ScopedMemoryTracker();
+
+ private:
+  MemoryTracker* prev_;
+};
+
+/**
+ * QueryMemoryPool is the arrow::MemoryPool of a single query. It allocates from a parent pool,
+ * counts the bytes the query holds, and fails allocations that would take the query past its
+ * limit, so that a runaway query errors out instead of running the agent out of memory.
+ *
+ * Each allocation is prefixed with a small header that records the MemoryTracker it was charged
+ * to. Buffers that a query writes to the table store outlive the query, so the pool can't be
+ * destroyed with the query. Instead, the owner calls Release() and the pool deletes itself once
+ * its last buffer is freed. Use QueryMemoryPool::Create() and QueryMemoryPoolPtr to manage it.
+ */
+class QueryMemoryPool : public arrow::ProxyMemoryPool {
+ public:
+  // Size of the per-allocation header. Keeps the returned memory 64 byte aligned, like arrow's.
+  static constexpr int64_t kHeaderBytes = 64;
+
+  struct Releaser {
+    void operator()(QueryMemoryPool* pool) const { pool->Release(); }
+  };
+
+  static std::unique_ptr<QueryMemoryPool, Releaser> Create(
+      arrow::MemoryPool* parent = arrow::default_memory_pool()) {
+    return std::unique_ptr<QueryMemoryPool, Releaser>(new QueryMemoryPool(parent));
+  }
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+  int64_t bytes_allocated() const override { return bytes_allocated_.load(); }
+  int64_t max_memory() const override { return peak_bytes_.load(); }
+
+  /**
+   * Sets the most bytes the query may hold at once. 0 means no limit.
+   */
+  void set_limit_bytes(int64_t limit_bytes) { limit_bytes_.store(limit_bytes); }
+  int64_t limit_bytes() const { return limit_bytes_.load(); }
+
+  /**
+   * Returns a new tracker for an ExecNode. Trackers are owned by the pool, so they stay valid
+   * for as long as any buffer charged to them.
+   */
+  MemoryTracker* NewTracker();
+
+ private:
+  explicit QueryMemoryPool(arrow::MemoryPool* parent)
+      : arrow::ProxyMemoryPool(parent), parent_(parent) {}
+  ~QueryMemoryPool() override = default;
+
+  // Drops the owner's reference. The pool is deleted once no buffers reference it either.
+  void Release();
+  void Unref();
+  arrow::Status Reserve(int64_t bytes);
+
+  arrow::MemoryPool* parent_;
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+  std::atomic<int64_t> limit_bytes_ = 0;
+  // One reference for the owner and one for each live allocation.
+  std::atomic<int64_t> refs_ = 1;
+
+  // Guards trackers_.
+  std::mutex trackers_lock_;
+  std::deque<MemoryTracker> trackers_;
+};
+
+using QueryMemoryPoolPtr = std::unique_ptr<QueryMemoryPool, QueryMemoryPool::Releaser>;
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/query_memory_pool.h"
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(QueryMemoryPoolTest, counts_and_limits_bytes) {
+  QueryMemoryPoolPtr pool = QueryMemoryPool::Create();
+  pool->set_limit_bytes(1024);
+
+  uint8_t* a;
+  ASSERT_TRUE(pool->Allocate(512, &a).ok());
+  EXPECT_EQ(512, pool->bytes_allocated());
+
+  uint8_t* b;
+  auto s = pool->Allocate(768, &b);
+  EXPECT_TRUE(s.IsOutOfMemory());
+  EXPECT_EQ(512, pool->bytes_allocated());
+
+  ASSERT_TRUE(pool->Reallocate(512, 1024, &a).ok());
+  EXPECT_TRUE(pool->Reallocate(1024, 1025, &a).IsOutOfMemory());
+  EXPECT_EQ(1024, pool->bytes_allocated());
+
+  pool->Free(a, 1024);
+  EXPECT_EQ(0, pool->bytes_allocated());
+  EXPECT_EQ(1024, pool->max_memory());
+}
+
+TEST(QueryMemoryPoolTest, charges_the_active_tracker) {
+  QueryMemoryPoolPtr pool = QueryMemoryPool::Create();
+  MemoryTracker* producer = pool->NewTracker();
+  MemoryTracker* consumer = pool->NewTracker();
+
+  uint8_t* buf;
+  {
+    ScopedMemoryTracker scope(producer);
+    ASSERT_TRUE(pool->Allocate(256, &buf).ok());
+    ASSERT_TRUE(pool->Reallocate(256, 512, &buf).ok());
+  }
+  EXPECT_EQ(512, producer->current_bytes());
+  EXPECT_EQ(0, consumer->current_bytes());
+
+  // Freeing from another node gives the bytes back to the node that allocated them.
+  {
+    ScopedMemoryTracker scope(consumer);
+    pool->Free(buf, 512);
+  }
+  EXPECT_EQ(0, producer->current_bytes());
+  EXPECT_EQ(512, producer->peak_bytes());
+  EXPECT_EQ(0, consumer->peak_bytes());
+  // The allocation and its growth are both counted.
+  EXPECT_EQ(2, producer->num_allocations());
+  EXPECT_EQ(512, producer->total_bytes_allocated());
+  EXPECT_EQ(0, consumer->num_allocations());
+}
+
+TEST(QueryMemoryPoolTest, outlives_owner_until_last_free) {
+  QueryMemoryPoolPtr pool = QueryMemoryPool::Create();
+  MemoryTracker* tracker = pool->NewTracker();
+  QueryMemoryPool* raw_pool = pool.get();
+
+  uint8_t* buf;
+  {
+    ScopedMemoryTracker scope(tracker);
+    ASSERT_TRUE(raw_pool->Allocate(128, &buf).ok());
+  }
+  // The query ends while a table store buffer is still alive.
+  pool.reset();
+  buf[127] = 1;
+  EXPECT_EQ(128, tracker->current_bytes());
+  raw_pool->Free(buf, 128);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
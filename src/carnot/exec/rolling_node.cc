@@ -0,0 +1,429 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/rolling_node.h"
+
+#include <arrow/array.h>
+#include <arrow/array/builder_base.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+#include <magic_enum.hpp>
+
+#include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+template <types::DataType DT>
+void AppendRowsToColumnWrapper(types::ColumnWrapper* wrapper, const arrow::Array* arr,
+                               const int64_t* rows_begin, const int64_t* rows_end) {
+  auto* typed_wrapper = static_cast<typename types::ColumnWrapperType<DT>::type*>(wrapper);
+  for (const int64_t* row = rows_begin; row != rows_end; ++row) {
+    typed_wrapper->Append(types::GetValueFromArrowArray<DT>(arr, *row));
+  }
+}
+
+}  // namespace
+
+std::string RollingNode::DebugStringImpl() {
+  return absl::Substitute("Exec::RollingNode<$0>", plan_node_->DebugString());
+}
+
+Status RollingNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::ROLLING_OPERATOR);
+  const auto* rolling_plan_node = static_cast<const plan::RollingOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::RollingOperator>(*rolling_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Rolling operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
+
+  auto window_col = plan_node_->window_col();
+  if (window_col < 0 || static_cast<size_t>(window_col) >= input_descriptor_->size() ||
+      input_descriptor_->type(window_col) != types::TIME64NS) {
+    return error::InvalidArgument("Rolling operator window column $0 must be a TIME64NS column",
+                                  window_col);
+  }
+  for (const auto& value : plan_node_->values()) {
+    if (value->ExpressionType() != plan::Expression::kAgg) {
+      return error::InvalidArgument("Rolling operator can only use aggregate expressions");
+    }
+  }
+
+  // The output is the window start, then the groups, then the values.
+  size_t groups_size = plan_node_->groups().size();
+  size_t output_size = 1 + groups_size + plan_node_->values().size();
+  if (output_size != output_descriptor_->size()) {
+    return error::InvalidArgument("Output size mismatch in rolling aggregate");
+  }
+  for (const auto& group : plan_node_->groups()) {
+    DCHECK(group.idx < input_descriptor_->size());
+    group_data_types_.emplace_back(input_descriptor_->type(group.idx));
+  }
+  for (size_t i = 1 + groups_size; i < output_size; ++i) {
+    value_data_types_.emplace_back(output_descriptor_->type(i));
+  }
+  return CreateColumnMapping();
+}
+
+Status RollingNode::PrepareImpl(ExecState* exec_state) {
+  function_ctx_ = exec_state->CreateFunctionContext();
+  return Status::OK();
+}
+
+Status RollingNode::OpenImpl(ExecState*) {
+  max_time_ = std::numeric_limits<int64_t>::min();
+  watermark_ = std::numeric_limits<int64_t>::min();
+  late_rows_ = 0;
+  for (const auto& dt : stored_cols_data_types_) {
+    stored_cols_.emplace_back(types::ColumnWrapper::Make(dt, 0));
+  }
+  return Status::OK();
+}
+
+Status RollingNode::CloseImpl(ExecState*) {
+  windows_.clear();
+  stored_cols_.clear();
+  if (late_rows_ > 0) {
+    stats()->AddExtraInfo("late_rows", absl::StrCat(late_rows_));
+  }
+  return Status::OK();
+}
+
+int64_t RollingNode::WindowStart(int64_t time) const {
+  int64_t size = plan_node_->window_size();
+  // Round towards negative infinity, so that windows also line up for times before the epoch.
+  return time - (((time % size) + size) % size);
+}
+
+Status RollingNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  auto time_col = rb.ColumnAt(plan_node_->window_col()).get();
+  int64_t window_size = plan_node_->window_size();
+
+  // Bucket the rows by the window they fall in, dropping the rows of windows that are closed.
+  for (auto& [start, rows] : rows_by_window_) {
+    rows.clear();
+  }
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    int64_t time = types::GetValueFromArrowArray<types::TIME64NS>(time_col, row_idx);
+    int64_t start = WindowStart(time);
+    if (watermark_ != std::numeric_limits<int64_t>::min() && start + window_size <= watermark_) {
+      ++late_rows_;
+      continue;
+    }
+    rows_by_window_[start].push_back(row_idx);
+    max_time_ = std::max(max_time_, time);
+  }
+
+  for (auto it = rows_by_window_.begin(); it != rows_by_window_.end();) {
+    if (it->second.empty()) {
+      it = rows_by_window_.erase(it);
+      continue;
+    }
+    PL_ASSIGN_OR_RETURN(auto* window, GetOrCreateWindow(exec_state, it->first));
+    PL_RETURN_IF_ERROR(AggregateWindowRows(exec_state, rb, it->second, window));
+    ++it;
+  }
+
+  UpdateWatermark();
+  if (rb.eow() || rb.eos()) {
+    return EmitWindowsBefore(exec_state, std::numeric_limits<int64_t>::max(), rb.eow(), rb.eos());
+  }
+  if (watermark_ == std::numeric_limits<int64_t>::min()) {
+    return Status::OK();
+  }
+  return EmitWindowsBefore(exec_state, watermark_, false, false);
+}
+
+void RollingNode::UpdateWatermark() {
+  if (max_time_ == std::numeric_limits<int64_t>::min()) {
+    return;
+  }
+  int64_t lateness = plan_node_->allowed_lateness();
+  // Saturate rather than overflow for times close to the minimum.
+  if (max_time_ < std::numeric_limits<int64_t>::min() + lateness) {
+    return;
+  }
+  watermark_ = std::max(watermark_, max_time_ - lateness);
+}
+
+StatusOr<RollingNode::Window*> RollingNode::GetOrCreateWindow(ExecState* exec_state,
+                                                                int64_t start) {
+  auto it = windows_.find(start);
+  if (it != windows_.end()) {
+    return it->second.get();
+  }
+  auto window = std::make_unique<Window>();
+  if (HasNoGroups()) {
+    window->group_udas.emplace_back();
+    PL_RETURN_IF_ERROR(CreateUDAInfoValues(&window->group_udas.back(), exec_state));
+  } else {
+    window->group_table = std::make_unique<GroupByHashTable>(group_data_types_);
+  }
+  auto* window_ptr = window.get();
+  windows_.emplace(start, std::move(window));
+  return window_ptr;
+}
+
+void RollingNode::BucketRowsByGroup(const RowBatch& rb, const std::vector<int64_t>& rows,
+                                    Window* window) {
+  batch_groups_.clear();
+  selection_offsets_.clear();
+  if (HasNoGroups()) {
+    batch_groups_.push_back(0);
+    selection_offsets_ = {0, rows.size()};
+    selection_ = rows;
+    return;
+  }
+
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
+    key_cols.push_back(rb.ColumnAt(grp.idx).get());
+  }
+  window->group_table->FindOrInsert(key_cols, &group_ids_, &rows);
+  batch_slot_of_group_.resize(window->group_table->num_groups(), -1);
+
+  // Count the rows of each group, then scatter the rows into per-group selections.
+  for (int64_t row_idx : rows) {
+    int64_t group_id = group_ids_[row_idx];
+    int64_t slot = batch_slot_of_group_[group_id];
+    if (slot < 0) {
+      slot = batch_groups_.size();
+      batch_slot_of_group_[group_id] = slot;
+      batch_groups_.push_back(group_id);
+      selection_offsets_.push_back(0);
+    }
+    ++selection_offsets_[slot];
+  }
+  size_t offset = 0;
+  for (auto& group_offset : selection_offsets_) {
+    size_t count = group_offset;
+    group_offset = offset;
+    offset += count;
+  }
+  selection_offsets_.push_back(offset);
+  std::vector<size_t> next_selection(selection_offsets_.begin(), selection_offsets_.end() - 1);
+  selection_.resize(offset);
+  for (int64_t row_idx : rows) {
+    selection_[next_selection[batch_slot_of_group_[group_ids_[row_idx]]]++] = row_idx;
+  }
+
+  for (int64_t group_id : batch_groups_) {
+    batch_slot_of_group_[group_id] = -1;
+  }
+}
+
+Status RollingNode::AggregateWindowRows(ExecState* exec_state, const RowBatch& rb,
+                                        const std::vector<int64_t>& rows, Window* window) {
+  BucketRowsByGroup(rb, rows, window);
+  size_t num_groups = HasNoGroups() ? 1 : window->group_table->num_groups();
+  while (window->group_udas.size() < num_groups) {
+    window->group_udas.emplace_back();
+    PL_RETURN_IF_ERROR(CreateUDAInfoValues(&window->group_udas.back(), exec_state));
+  }
+
+  for (size_t slot = 0; slot < batch_groups_.size(); ++slot) {
+    const int64_t* rows_begin = selection_.data() + selection_offsets_[slot];
+    const int64_t* rows_end = selection_.data() + selection_offsets_[slot + 1];
+    for (size_t i = 0; i < stored_cols_.size(); ++i) {
+      auto* col_wrapper = stored_cols_[i].get();
+      col_wrapper->Clear();
+      auto arr = rb.ColumnAt(stored_cols_to_plan_idx_[i]).get();
+#define TYPE_CASE(_dt_) AppendRowsToColumnWrapper<_dt_>(col_wrapper, arr, rows_begin, rows_end);
+      PL_SWITCH_FOREACH_DATATYPE(stored_cols_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    PL_RETURN_IF_ERROR(UpdateGroup(exec_state, &window->group_udas[batch_groups_[slot]],
+                                   rows_end - rows_begin));
+  }
+  return Status::OK();
+}
+
+Status RollingNode::UpdateGroup(ExecState* exec_state, std::vector<UDAInfo>* udas,
+                                size_t num_rows) {
+  const auto& values = plan_node_->values();
+  for (size_t i = 0; i < values.size(); ++i) {
+    const auto& uda_info = (*udas)[i];
+    plan::ExpressionWalker<StatusOr<types::SharedColumnWrapper>> walker;
+    walker.OnScalarValue([&](const plan::ScalarValue& scalar_val,
+                             const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
+                             -> types::SharedColumnWrapper {
+      DCHECK_EQ(children.size(), 0ULL);
+      return EvalScalarToColumnWrapper(exec_state, scalar_val, num_rows);
+    });
+
+    walker.OnColumn([&](const plan::Column& col,
+                        const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
+                        -> types::SharedColumnWrapper {
+      DCHECK_EQ(children.size(), 0ULL);
+      return stored_cols_[plan_cols_to_stored_map_[col.Index()]];
+    });
+
+    walker.OnAggregateExpression(
+        [&](const plan::AggregateExpression& agg,
+            const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
+            -> StatusOr<types::SharedColumnWrapper> {
+          DCHECK(agg.name() == uda_info.def->name());
+          DCHECK(children.size() == uda_info.def->update_arguments().size());
+          std::vector<const types::ColumnWrapper*> raw_children;
+          raw_children.reserve(children.size());
+          for (auto& child : children) {
+            PL_RETURN_IF_ERROR(child);
+            raw_children.push_back(child.ValueOrDie().get());
+          }
+          PL_RETURN_IF_ERROR(
+              uda_info.def->ExecBatchUpdate(uda_info.uda.get(), nullptr /* ctx */, raw_children));
+          return {};
+        });
+    PL_RETURN_IF_ERROR(walker.Walk(*values[i]));
+  }
+  return Status::OK();
+}
+
+Status RollingNode::EmitWindowsBefore(ExecState* exec_state, int64_t end, bool eow, bool eos) {
+  int64_t window_size = plan_node_->window_size();
+  auto last = windows_.begin();
+  int64_t num_rows = 0;
+  // end may be the largest time, so compare against the start to avoid overflowing.
+  while (last != windows_.end() && last->first <= end - window_size) {
+    num_rows += last->second->group_udas.size();
+    ++last;
+  }
+  if (last == windows_.begin() && !eow && !eos) {
+    return Status::OK();
+  }
+
+  RowBatch output_rb(*output_descriptor_, num_rows);
+  types::Time64NSValueColumnWrapper window_starts(0);
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
+  for (const auto& group_data_type : group_data_types_) {
+    group_builders.push_back(types::MakeArrowBuilder(group_data_type, exec_state->exec_mem_pool()));
+  }
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
+  for (const auto& value_data_type : value_data_types_) {
+    value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
+  }
+
+  for (auto it = windows_.begin(); it != last; ++it) {
+    const auto& window = *it->second;
+    for (size_t i = 0; i < group_builders.size(); ++i) {
+      PL_RETURN_IF_ERROR(window.group_table->AppendKeyColumn(i, group_builders[i].get()));
+    }
+    for (const auto& udas : window.group_udas) {
+      window_starts.Append(it->first);
+      for (size_t i = 0; i < udas.size(); ++i) {
+        PL_RETURN_IF_ERROR(udas[i].def->FinalizeArrow(udas[i].uda.get(), function_ctx_.get(),
+                                                      value_builders[i].get()));
+      }
+    }
+  }
+  windows_.erase(windows_.begin(), last);
+
+  PL_RETURN_IF_ERROR(
+      output_rb.AddColumn(window_starts.ConvertToArrow(exec_state->exec_mem_pool())));
+  for (const auto& builder : group_builders) {
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(arr));
+  }
+  for (const auto& builder : value_builders) {
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(output_rb.AddColumn(arr));
+  }
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  return SendRowBatchToChildren(exec_state, output_rb);
+}
+
+StatusOr<types::DataType> RollingNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn: {
+      auto idx = static_cast<const plan::Column*>(&expr)->Index();
+      return input_descriptor_->type(idx);
+    }
+    case plan::Expression::kConstant:
+      return static_cast<const plan::ScalarValue*>(&expr)->DataType();
+    default:
+      return error::InvalidArgument("Invalid expression type in rolling aggregate: $0",
+                                    magic_enum::enum_name(expr.ExpressionType()));
+  }
+}
+
+Status RollingNode::CreateColumnMapping() {
+  for (const auto& expr : plan_node_->values()) {
+    plan::ExpressionWalker<int> walker;
+    walker.OnScalarValue(
+        [&](const plan::ScalarValue&, const std::vector<int>&) -> int { return 0; });
+    walker.OnColumn([&](const plan::Column& col, const std::vector<int>&) -> int {
+      auto plan_col_idx = col.Index();
+      if (plan_cols_to_stored_map_.find(plan_col_idx) == plan_cols_to_stored_map_.end()) {
+        plan_cols_to_stored_map_[plan_col_idx] = stored_cols_to_plan_idx_.size();
+        stored_cols_to_plan_idx_.emplace_back(plan_col_idx);
+        stored_cols_data_types_.emplace_back(input_descriptor_->type(plan_col_idx));
+      }
+      return 0;
+    });
+    walker.OnAggregateExpression(
+        [&](const plan::AggregateExpression&, const std::vector<int>&) -> int { return 0; });
+    PL_RETURN_IF_ERROR(walker.Walk(*expr));
+  }
+  return Status::OK();
+}
+
+Status RollingNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state) {
+  CHECK(val != nullptr);
+  CHECK_EQ(val->size(), 0ULL);
+
+  for (const auto& value : plan_node_->values()) {
+    for (auto* dep : value->Deps()) {
+      PL_RETURN_IF_ERROR(GetTypeOfDep(*dep));
+    }
+    auto def = exec_state->GetUDADefinition(value->uda_id());
+    auto uda = def->Make();
+
+    std::vector<std::shared_ptr<types::BaseValueType>> init_args;
+    for (const auto& arg : value->init_arguments()) {
+      init_args.push_back(arg.ToBaseValueType());
+    }
+    PL_RETURN_IF_ERROR(def->ExecInit(uda.get(), nullptr, init_args));
+    val->emplace_back(std::move(uda), def);
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
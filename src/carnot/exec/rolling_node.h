@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/group_by_hash_table.h"
+#include "src/carnot/plan/operators.h"
+#include "src/carnot/udf/udf_definition.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * RollingNode aggregates its input into fixed size windows of a time column, per group.
+ *
+ * Each open window keeps its own group table and aggregate state, so rows are aggregated once
+ * when they arrive rather than being buffered. The watermark trails the largest time seen so far
+ * by the allowed lateness of the plan node: a window is emitted and dropped as soon as the
+ * watermark reaches its end, and rows that belong to an already emitted window are dropped as
+ * late. Inputs that interleave several sources (e.g. a union of PEMs) are only ordered per
+ * source, so the allowed lateness bounds how far a row may trail the newest row seen. The
+ * remaining windows are emitted at the end of a stream window (eow) or at eos.
+ */
+class RollingNode : public ProcessingNode {
+ public:
+  RollingNode() = default;
+  virtual ~RollingNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  struct Window {
+    // Maps the group by columns to a dense group id. Null when there are no groups, in which
+    // case the window has the single group 0.
+    std::unique_ptr<GroupByHashTable> group_table;
+    // The aggregate state of each group, indexed by group id.
+    std::vector<std::vector<UDAInfo>> group_udas;
+  };
+
+  bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  int64_t WindowStart(int64_t time) const;
+
+  // Moves the watermark to max_time_ minus the allowed lateness. It never moves backwards.
+  void UpdateWatermark();
+  StatusOr<Window*> GetOrCreateWindow(ExecState* exec_state, int64_t start);
+  // Buckets the given rows of the batch by their group in the window.
+  void BucketRowsByGroup(const table_store::schema::RowBatch& rb, const std::vector<int64_t>& rows,
+                         Window* window);
+  Status AggregateWindowRows(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                             const std::vector<int64_t>& rows, Window* window);
+  // Runs the aggregates of a group over the values in stored_cols_.
+  Status UpdateGroup(ExecState* exec_state, std::vector<UDAInfo>* udas, size_t num_rows);
+  // Emits every window that ends at or before end in a single row batch, in order of their start
+  // time. A batch is always sent at eow or eos, even if it's empty.
+  Status EmitWindowsBefore(ExecState* exec_state, int64_t end, bool eow, bool eos);
+
+  Status CreateColumnMapping();
+  Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
+  StatusOr<types::DataType> GetTypeOfDep(const plan::ScalarExpression& expr) const;
+
+  std::unique_ptr<plan::RollingOperator> plan_node_;
+  std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
+  std::unique_ptr<udf::FunctionContext> function_ctx_;
+
+  std::vector<types::DataType> group_data_types_;
+  std::vector<types::DataType> value_data_types_;
+
+  // The input columns that the aggregates read, see AggNode::CreateColumnMapping.
+  std::map<int64_t, int64_t> plan_cols_to_stored_map_;
+  std::vector<int64_t> stored_cols_to_plan_idx_;
+  std::vector<types::DataType> stored_cols_data_types_;
+  // The values of one group in the current batch, which are passed to its aggregates.
+  std::vector<types::SharedColumnWrapper> stored_cols_;
+
+  // The open windows, by start time.
+  std::map<int64_t, std::unique_ptr<Window>> windows_;
+  // The largest time seen so far.
+  int64_t max_time_;
+  // Windows that end at or before the watermark are closed.
+  int64_t watermark_;
+  int64_t late_rows_ = 0;
+
+  // Per batch scratch space, as in AggNode. The rows of the group batch_groups_[i] are
+  // selection_[selection_offsets_[i]] to selection_[selection_offsets_[i+1]].
+  std::map<int64_t, std::vector<int64_t>> rows_by_window_;
+  std::vector<int64_t> group_ids_;
+  std::vector<int64_t> batch_groups_;
+  std::vector<size_t> selection_offsets_;
+  std::vector<int64_t> selection_;
+  std::vector<int64_t> batch_slot_of_group_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/rolling_node.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+using types::Time64NSValue;
+
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+constexpr char kRollingSingleGroup[] = R"(
+op_type: ROLLING_OPERATOR
+rolling_op {
+  window_column {
+    node: 0
+    index: 0
+  }
+  window_size: 10
+  values {
+    name: "sum"
+    args {
+      column {
+        node: 0
+        index: 2
+      }
+    }
+  }
+  groups {
+    node: 0
+    index: 1
+  }
+  group_names: "g1"
+  value_names: "value1"
+})";
+
+constexpr char kRollingNoGroups[] = R"(
+op_type: ROLLING_OPERATOR
+rolling_op {
+  window_column {
+    node: 0
+    index: 0
+  }
+  window_size: 10
+  values {
+    name: "sum"
+    args {
+      column {
+        node: 0
+        index: 1
+      }
+    }
+  }
+  value_names: "value1"
+})";
+
+constexpr char kRollingAllowedLateness[] = R"(
+op_type: ROLLING_OPERATOR
+rolling_op {
+  window_column {
+    node: 0
+    index: 0
+  }
+  window_size: 10
+  allowed_lateness_ns: 10
+  values {
+    name: "sum"
+    args {
+      column {
+        node: 0
+        index: 1
+      }
+    }
+  }
+  value_names: "value1"
+})";
+
+std::unique_ptr<plan::Operator> PlanNodeFromPbtxt(const std::string& pbtxt) {
+  planpb::Operator op_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &op_pb));
+  return plan::RollingOperator::FromProto(op_pb, 1);
+}
+
+class RollingNodeTest : public ::testing::Test {
+ public:
+  RollingNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test");
+    EXPECT_TRUE(func_registry_->Register<SumUDA>("sum").ok());
+
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state_->AddUDA(0, "sum", std::vector<types::DataType>({types::INT64})));
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(RollingNodeTest, windows_close_as_time_advances) {
+  auto plan_node = PlanNodeFromPbtxt(kRollingSingleGroup);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                           types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<RollingNode, plan::RollingOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Time 12 closes the window [0, 10), the window [10, 20) stays open.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Time64NSValue>({1, 5, 12, 3})
+                       .AddColumn<Int64Value>({1, 2, 1, 1})
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<Time64NSValue>({0, 0})
+                          .AddColumn<Int64Value>({1, 2})
+                          .AddColumn<Int64Value>({5, 2})
+                          .get())
+      // The row at time 2 is late and dropped, the open windows are flushed at eos.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, true, true)
+                       .AddColumn<Time64NSValue>({2, 14, 25})
+                       .AddColumn<Int64Value>({1, 2, 1})
+                       .AddColumn<Int64Value>({100, 6, 7})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<Time64NSValue>({10, 10, 20})
+                          .AddColumn<Int64Value>({1, 2, 1})
+                          .AddColumn<Int64Value>({3, 6, 7})
+                          .get())
+      .Close();
+}
+
+TEST_F(RollingNodeTest, state_kept_across_batches) {
+  auto plan_node = PlanNodeFromPbtxt(kRollingSingleGroup);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                           types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<RollingNode, plan::RollingOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Nothing is emitted until a window closes.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Time64NSValue>({1, 2})
+                       .AddColumn<Int64Value>({1, 2})
+                       .AddColumn<Int64Value>({1, 2})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, false, false)
+                       .AddColumn<Time64NSValue>({3, 9})
+                       .AddColumn<Int64Value>({2, 1})
+                       .AddColumn<Int64Value>({3, 4})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, false, false)
+                       .AddColumn<Time64NSValue>({10})
+                       .AddColumn<Int64Value>({3})
+                       .AddColumn<Int64Value>({8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<Time64NSValue>({0, 0})
+                          .AddColumn<Int64Value>({1, 2})
+                          .AddColumn<Int64Value>({5, 5})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 0, true, true)
+                       .AddColumn<Time64NSValue>({})
+                       .AddColumn<Int64Value>({})
+                       .AddColumn<Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<Time64NSValue>({10})
+                          .AddColumn<Int64Value>({3})
+                          .AddColumn<Int64Value>({8})
+                          .get())
+      .Close();
+}
+
+TEST_F(RollingNodeTest, no_groups) {
+  auto plan_node = PlanNodeFromPbtxt(kRollingNoGroups);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<RollingNode, plan::RollingOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<Time64NSValue>({1, 11, 2, -3})
+                       .AddColumn<Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<Time64NSValue>({-10, 0, 10})
+                          .AddColumn<Int64Value>({4, 4, 2})
+                          .get())
+      .Close();
+}
+
+TEST_F(RollingNodeTest, allowed_lateness) {
+  auto plan_node = PlanNodeFromPbtxt(kRollingAllowedLateness);
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<RollingNode, plan::RollingOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // Time 15 would close [0, 10) without lateness, but the watermark is only at 5.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<Time64NSValue>({1, 15})
+                       .AddColumn<Int64Value>({1, 2})
+                       .get(),
+                   0, 0)
+      // A row of another source that trails behind still lands in [0, 10). Time 21 moves the
+      // watermark to 11 and closes it.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, false, false)
+                       .AddColumn<Time64NSValue>({3, 21})
+                       .AddColumn<Int64Value>({4, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, false, false)
+                          .AddColumn<Time64NSValue>({0})
+                          .AddColumn<Int64Value>({5})
+                          .get())
+      // An older row is still dropped once its window has closed, the watermark never moves
+      // backwards.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, true, true)
+                       .AddColumn<Time64NSValue>({9, 12})
+                       .AddColumn<Int64Value>({100, 16})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<Time64NSValue>({10, 20})
+                          .AddColumn<Int64Value>({18, 8})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+// Compact the kept rows of a top-k once the buffered rows exceed this multiple of the limit.
+constexpr int64_t kTopKCompactionFactor = 4;
+constexpr int64_t kTopKMinRowsBeforeCompaction = 4 * kSortOutputBatchRows;
+
+template <types::DataType DT>
+int CompareValues(const arrow::Array* a, int64_t i, const arrow::Array* b, int64_t j) {
+  if constexpr (DT == types::DataType::STRING) {
+    return types::GetStringViewFromArrowArray(a, i).compare(
+        types::GetStringViewFromArrowArray(b, j));
+  } else {
+    auto x = types::GetValueFromArrowArray<DT>(a, i);
+    auto y = types::GetValueFromArrowArray<DT>(b, j);
+    if (x < y) {
+      return -1;
+    }
+    return y < x ? 1 : 0;
+  }
+}
+
+}  // namespace
+
+std::string SortNode::DebugStringImpl() {
+  return absl::Substitute("Exec::SortNode<$0>", plan_node_->DebugString());
+}
+
+Status SortNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::SORT_OPERATOR);
+  const auto* sort_plan_node = static_cast<const plan::SortOperator*>(&plan_node);
+  plan_node_ = std::make_unique<plan::SortOperator>(*sort_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("Sort operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  const auto& input_desc = input_descriptors_[0];
+  for (int64_t col : plan_node_->sort_cols()) {
+    if (col < 0 || col >= static_cast<int64_t>(input_desc.size())) {
+      return error::InvalidArgument("Sort column $0 is out of range", col);
+    }
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(input_desc.type(col), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  all_input_cols_.resize(input_desc.size());
+  std::iota(all_input_cols_.begin(), all_input_cols_.end(), 0);
+  return Status::OK();
+}
+
+Status SortNode::PrepareImpl(ExecState*) { return Status::OK(); }
+
+Status SortNode::OpenImpl(ExecState*) { return Status::OK(); }
+
+Status SortNode::CloseImpl(ExecState*) {
+  ClearWindow();
+  return Status::OK();
+}
+
+bool SortNode::RowLess(const RowRef& a, const RowRef& b) const {
+  const auto& sort_cols = plan_node_->sort_cols();
+  const auto& ascending = plan_node_->ascending();
+  for (size_t i = 0; i < sort_cols.size(); ++i) {
+    int cmp = compare_fns_[i](batches_[a.batch][sort_cols[i]].get(), a.row,
+                              batches_[b.batch][sort_cols[i]].get(), b.row);
+    if (cmp != 0) {
+      return ascending[i] ? cmp < 0 : cmp > 0;
+    }
+  }
+  if (a.batch != b.batch) {
+    return a.batch < b.batch;
+  }
+  return a.row < b.row;
+}
+
+void SortNode::AddToTopK(int64_t batch_idx) {
+  auto less = [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); };
+  auto limit = static_cast<size_t>(plan_node_->limit());
+  int64_t num_rows = batches_[batch_idx][0]->length();
+  bool kept_rows = false;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    RowRef ref{batch_idx, row};
+    if (heap_.size() < limit) {
+      heap_.push_back(ref);
+      std::push_heap(heap_.begin(), heap_.end(), less);
+      kept_rows = true;
+    } else if (RowLess(ref, heap_.front())) {
+      std::pop_heap(heap_.begin(), heap_.end(), less);
+      heap_.back() = ref;
+      std::push_heap(heap_.begin(), heap_.end(), less);
+      kept_rows = true;
+    }
+  }
+  if (!kept_rows) {
+    // None of the rows made it into the top-k, so the batch isn't needed.
+    batches_.pop_back();
+    return;
+  }
+  buffered_rows_ += num_rows;
+}
+
+void SortNode::AddRun(int64_t batch_idx) {
+  int64_t num_rows = batches_[batch_idx][0]->length();
+  std::vector<int64_t> run(num_rows);
+  std::iota(run.begin(), run.end(), 0);
+  std::stable_sort(run.begin(), run.end(), [this, batch_idx](int64_t a, int64_t b) {
+    return RowLess({batch_idx, a}, {batch_idx, b});
+  });
+  runs_.push_back(std::move(run));
+  buffered_rows_ += num_rows;
+}
+
+Status SortNode::CompactTopK(ExecState* exec_state) {
+  std::vector<RowRef> rows = SortedRows();
+  PL_ASSIGN_OR_RETURN(auto rb, MaterializeRows(exec_state, rows, 0, rows.size(), all_input_cols_,
+                                               input_descriptors_[0]));
+  batches_.clear();
+  batches_.push_back(rb->columns());
+  heap_.clear();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    heap_.push_back({0, static_cast<int64_t>(i)});
+  }
+  std::make_heap(heap_.begin(), heap_.end(),
+                 [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); });
+  buffered_rows_ = rows.size();
+  return Status::OK();
+}
+
+std::vector<SortNode::RowRef> SortNode::SortedRows() {
+  if (has_limit()) {
+    std::vector<RowRef> rows = heap_;
+    std::sort_heap(rows.begin(), rows.end(),
+                   [this](const RowRef& a, const RowRef& b) { return RowLess(a, b); });
+    return rows;
+  }
+
+  // Merge the sorted runs of every batch.
+  struct Cursor {
+    int64_t batch;
+    size_t pos;
+  };
+  auto cursor_greater = [this](const Cursor& a, const Cursor& b) {
+    return RowLess({b.batch, runs_[b.batch][b.pos]}, {a.batch, runs_[a.batch][a.pos]});
+  };
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(cursor_greater)> cursors(
+      cursor_greater);
+  for (size_t batch = 0; batch < runs_.size(); ++batch) {
+    if (!runs_[batch].empty()) {
+      cursors.push({static_cast<int64_t>(batch), 0});
+    }
+  }
+  std::vector<RowRef> rows;
+  rows.reserve(buffered_rows_);
+  while (!cursors.empty()) {
+    Cursor cursor = cursors.top();
+    cursors.pop();
+    rows.push_back({cursor.batch, runs_[cursor.batch][cursor.pos]});
+    if (++cursor.pos < runs_[cursor.batch].size()) {
+      cursors.push(cursor);
+    }
+  }
+  return rows;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> SortNode::MaterializeRows(ExecState* exec_state,
+                                                              const std::vector<RowRef>& rows,
+                                                              size_t begin, size_t end,
+                                                              const std::vector<int64_t>& cols,
+                                                              const RowDescriptor& desc) {
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders;
+  for (size_t i = 0; i < cols.size(); ++i) {
+    auto builder = types::MakeArrowBuilder(desc.type(i), exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(builder->Reserve(end - begin));
+    for (size_t r = begin; r < end; ++r) {
+      const arrow::Array* col = batches_[rows[r].batch][cols[i]].get();
+#define TYPE_CASE(_dt_)                                    \
+  PL_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
+      builder.get(), types::GetValueFromArrowArray<_dt_>(col, rows[r].row)));
+      PL_SWITCH_FOREACH_DATATYPE(desc.type(i), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    builders.push_back(std::move(builder));
+  }
+  return RowBatch::FromColumnBuilders(desc, /*eow*/ false, /*eos*/ false, &builders);
+}
+
+Status SortNode::EmitWindow(ExecState* exec_state, bool eow, bool eos) {
+  std::vector<RowRef> rows = SortedRows();
+  if (rows.empty()) {
+    PL_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*output_descriptor_, eow, eos));
+    return SendRowBatchToChildren(exec_state, *rb);
+  }
+  for (size_t begin = 0; begin < rows.size(); begin += kSortOutputBatchRows) {
+    size_t end = std::min(rows.size(), begin + kSortOutputBatchRows);
+    PL_ASSIGN_OR_RETURN(auto rb, MaterializeRows(exec_state, rows, begin, end,
+                                                 plan_node_->selected_cols(), *output_descriptor_));
+    bool last = end == rows.size();
+    rb->set_eow(last && eow);
+    rb->set_eos(last && eos);
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *rb));
+  }
+  return Status::OK();
+}
+
+void SortNode::ClearWindow() {
+  batches_.clear();
+  heap_.clear();
+  runs_.clear();
+  buffered_rows_ = 0;
+}
+
+Status SortNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    int64_t batch_idx = batches_.size();
+    batches_.push_back(rb.columns());
+    if (has_limit()) {
+      AddToTopK(batch_idx);
+      if (buffered_rows_ > std::max(kTopKCompactionFactor * plan_node_->limit(),
+                                    kTopKMinRowsBeforeCompaction)) {
+        PL_RETURN_IF_ERROR(CompactTopK(exec_state));
+      }
+    } else {
+      AddRun(batch_idx);
+    }
+  }
+
+  if (!rb.eow()) {
+    return Status::OK();
+  }
+  PL_RETURN_IF_ERROR(EmitWindow(exec_state, rb.eow(), rb.eos()));
+  ClearWindow();
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
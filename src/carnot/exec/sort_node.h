@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// The number of rows in each output batch of a sort.
+constexpr int64_t kSortOutputBatchRows = 1024;
+
+/**
+ * SortNode orders the rows of each window of its input by the sort columns.
+ *
+ * With a limit, it keeps the first limit rows in a bounded heap (top-k). Input batches that don't
+ * contribute to the heap are dropped right away, and the kept rows are compacted once the
+ * buffered batches get much larger than the limit. Without a limit, every input batch is sorted
+ * into a run when it arrives and the runs are merged when the window ends.
+ */
+class SortNode : public ProcessingNode {
+ public:
+  SortNode() = default;
+  virtual ~SortNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // Compares the value at index i of a with the value at index j of b, returning <0, 0 or >0.
+  using CompareFn = int (*)(const arrow::Array* a, int64_t i, const arrow::Array* b, int64_t j);
+
+  struct RowRef {
+    int64_t batch;
+    int64_t row;
+  };
+
+  // Returns true if row a comes before row b in the output. Ties keep their input order.
+  bool RowLess(const RowRef& a, const RowRef& b) const;
+  bool has_limit() const { return plan_node_->limit() > 0; }
+
+  void AddToTopK(int64_t batch_idx);
+  void AddRun(int64_t batch_idx);
+  Status CompactTopK(ExecState* exec_state);
+  // Returns the rows of the window in output order.
+  std::vector<RowRef> SortedRows();
+  // Builds a row batch out of the given columns of rows [begin, end).
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> MaterializeRows(
+      ExecState* exec_state, const std::vector<RowRef>& rows, size_t begin, size_t end,
+      const std::vector<int64_t>& cols, const table_store::schema::RowDescriptor& desc);
+  Status EmitWindow(ExecState* exec_state, bool eow, bool eos);
+  void ClearWindow();
+
+  std::unique_ptr<plan::SortOperator> plan_node_;
+  std::vector<CompareFn> compare_fns_;
+  // Identity mapping of the input columns, used to compact all of the input columns.
+  std::vector<int64_t> all_input_cols_;
+
+  // The columns of the input batches that are buffered for the current window.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> batches_;
+  int64_t buffered_rows_ = 0;
+  // Top-k: a max heap in output order, so the last of the kept rows is on top.
+  std::vector<RowRef> heap_;
+  // Full sort: the row indices of each buffered batch in output order.
+  std::vector<std::vector<int64_t>> runs_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/sort_node.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/base.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::Int64Value;
+
+class SortNodeTest : public ::testing::Test {
+ public:
+  SortNodeTest() {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  RowDescriptor input_rd_{{types::DataType::INT64, types::DataType::INT64}};
+  RowDescriptor output_rd_{{types::DataType::INT64, types::DataType::INT64}};
+};
+
+TEST_F(SortNodeTest, full_sort_across_batches) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(), 1);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(
+      *plan_node, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({30, 10, 20})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({4, 5})
+                       .AddColumn<types::Int64Value>({10, 40})
+                       .get(),
+                   0)
+      // Ties on the sort column keep their input order.
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 5, true, true)
+                          .AddColumn<types::Int64Value>({2, 4, 3, 1, 5})
+                          .AddColumn<types::Int64Value>({10, 10, 20, 30, 40})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, top_k) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestTopK1PB(), 1);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(
+      *plan_node, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({5, 9, 7})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({6, 5, 4})
+                       .AddColumn<types::Int64Value>({7, 1, 9})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({7, 8})
+                       .AddColumn<types::Int64Value>({0, 2})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 3, true, true)
+                          .AddColumn<types::Int64Value>({2, 4, 3})
+                          .AddColumn<types::Int64Value>({9, 9, 7})
+                          .get())
+      .Close();
+}
+
+TEST_F(SortNodeTest, windows) {
+  auto plan_node = plan::SortOperator::FromProto(planpb::testutils::CreateTestSort1PB(), 1);
+  auto tester = exec::ExecNodeTester<SortNode, plan::SortOperator>(
+      *plan_node, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ true, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({3, 2, 1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 3, true, false)
+                          .AddColumn<types::Int64Value>({3, 2, 1})
+                          .AddColumn<types::Int64Value>({1, 2, 3})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 0, true, true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::Int64Value>({})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
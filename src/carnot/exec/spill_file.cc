@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill_file.h"
+
+#include <string>
+#include <utility>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/common/fs/fs_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+template <types::DataType DT>
+Status CopyRow(arrow::ArrayBuilder* builder, const arrow::Array* arr, int64_t row) {
+  return table_store::schema::CopyValue<DT>(builder, types::GetValueFromArrowArray<DT>(arr, row));
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<SpillFile>> SpillFile::Create(const std::filesystem::path& dir) {
+  auto path = dir / absl::Substitute("carnot-spill-$0", sole::uuid4().str());
+  std::unique_ptr<SpillFile> file(new SpillFile(path));
+  file->out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file->out_.is_open()) {
+    return error::Internal("Could not create spill file $0", path.string());
+  }
+  return file;
+}
+
+SpillFile::~SpillFile() {
+  out_.close();
+  in_.close();
+  auto s = fs::Remove(path_);
+  if (!s.ok()) {
+    LOG(WARNING) << s.msg();
+  }
+}
+
+Status SpillFile::Append(const RowBatch& rb) {
+  table_store::schemapb::RowBatchData rb_pb;
+  PL_RETURN_IF_ERROR(rb.ToProto(&rb_pb));
+  std::string bytes = rb_pb.SerializeAsString();
+  uint64_t size = bytes.size();
+  out_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out_.write(bytes.data(), bytes.size());
+  if (!out_.good()) {
+    return error::Internal("Failed to write $0 bytes to spill file $1", bytes.size(),
+                           path_.string());
+  }
+  ++num_batches_;
+  bytes_written_ += sizeof(size) + bytes.size();
+  return Status::OK();
+}
+
+Status SpillFile::StartReading() {
+  out_.close();
+  in_.open(path_, std::ios::binary);
+  if (!in_.is_open()) {
+    return error::Internal("Could not open spill file $0", path_.string());
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> SpillFile::ReadNext() {
+  uint64_t size;
+  if (!in_.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+    if (in_.eof()) {
+      return std::unique_ptr<RowBatch>();
+    }
+    return error::Internal("Failed to read spill file $0", path_.string());
+  }
+  std::string bytes(size, '\0');
+  if (!in_.read(bytes.data(), size)) {
+    return error::Internal("Spill file $0 is truncated", path_.string());
+  }
+  table_store::schemapb::RowBatchData rb_pb;
+  if (!rb_pb.ParseFromString(bytes)) {
+    return error::Internal("Spill file $0 holds a malformed row batch", path_.string());
+  }
+  return RowBatch::FromProto(rb_pb);
+}
+
+Status SpillPartitions::Init(const std::filesystem::path& dir) {
+  files_.resize(kNumSpillPartitions);
+  builders_.resize(kNumSpillPartitions);
+  buffered_rows_.assign(kNumSpillPartitions, 0);
+  for (size_t i = 0; i < kNumSpillPartitions; ++i) {
+    PL_ASSIGN_OR_RETURN(files_[i], SpillFile::Create(dir));
+    builders_[i].resize(desc_.size());
+    PL_RETURN_IF_ERROR(ResetBuilders(i));
+  }
+  return Status::OK();
+}
+
+Status SpillPartitions::ResetBuilders(size_t partition) {
+  for (size_t col = 0; col < desc_.size(); ++col) {
+    builders_[partition][col] = types::MakeArrowBuilder(desc_.type(col), mem_pool_);
+    PL_RETURN_IF_ERROR(builders_[partition][col]->Reserve(kSpillBatchRows));
+  }
+  buffered_rows_[partition] = 0;
+  return Status::OK();
+}
+
+Status SpillPartitions::FlushPartition(size_t partition) {
+  if (buffered_rows_[partition] == 0) {
+    return Status::OK();
+  }
+  PL_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(desc_, /*eow*/ false, /*eos*/ false,
+                                                            &builders_[partition]));
+  PL_RETURN_IF_ERROR(files_[partition]->Append(*rb));
+  return ResetBuilders(partition);
+}
+
+Status SpillPartitions::Append(const RowBatch& rb, const std::vector<size_t>& partitions) {
+  DCHECK_GE(partitions.size(), static_cast<size_t>(rb.num_rows()));
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    size_t partition = partitions[row];
+    if (partition == kNoSpillPartition) {
+      continue;
+    }
+    for (size_t col = 0; col < desc_.size(); ++col) {
+      auto builder = builders_[partition][col].get();
+      auto arr = rb.ColumnAt(col).get();
+#define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(CopyRow<_dt_>(builder, arr, row));
+      PL_SWITCH_FOREACH_DATATYPE(desc_.type(col), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    if (++buffered_rows_[partition] == kSpillBatchRows) {
+      PL_RETURN_IF_ERROR(FlushPartition(partition));
+    }
+  }
+  return Status::OK();
+}
+
+Status SpillPartitions::StartReading() {
+  for (size_t i = 0; i < kNumSpillPartitions; ++i) {
+    PL_RETURN_IF_ERROR(FlushPartition(i));
+    PL_RETURN_IF_ERROR(files_[i]->StartReading());
+  }
+  return Status::OK();
+}
+
+int64_t SpillPartitions::bytes_written() const {
+  int64_t bytes = 0;
+  for (const auto& file : files_) {
+    bytes += file->bytes_written();
+  }
+  return bytes;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
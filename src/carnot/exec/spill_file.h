@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array/builder_base.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// The number of partitions that a spilling operator splits its input into.
+constexpr size_t kNumSpillPartitions = 16;
+// Marks a row that isn't written to any partition.
+constexpr size_t kNoSpillPartition = kNumSpillPartitions;
+// The number of rows that are buffered for a partition before they are written out as a batch.
+constexpr int64_t kSpillBatchRows = 1024;
+
+/**
+ * Returns the spill partition of a row from the 64 bit hash of its key. The partition is taken
+ * from the high bits so that the keys of one partition still spread over a hash table that is
+ * built from them.
+ */
+inline size_t SpillPartitionOf(uint64_t hash) {
+  static_assert(kNumSpillPartitions == 16);
+  return hash >> 60;
+}
+
+/**
+ * SpillFile is a scratch file of row batches that a blocking operator writes when its state
+ * doesn't fit in memory. Batches are written as length prefixed RowBatchData protos, and read
+ * back in the order they were written. The file is deleted when the SpillFile is destroyed.
+ */
+class SpillFile : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<SpillFile>> Create(const std::filesystem::path& dir);
+  ~SpillFile();
+
+  Status Append(const table_store::schema::RowBatch& rb);
+
+  /**
+   * Finishes writing and starts reading from the first batch.
+   */
+  Status StartReading();
+
+  /**
+   * Returns the next batch, or nullptr when all of the batches have been read.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> ReadNext();
+
+  int64_t num_batches() const { return num_batches_; }
+  int64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  explicit SpillFile(std::filesystem::path path) : path_(std::move(path)) {}
+
+  std::filesystem::path path_;
+  std::ofstream out_;
+  std::ifstream in_;
+  int64_t num_batches_ = 0;
+  int64_t bytes_written_ = 0;
+};
+
+/**
+ * SpillPartitions splits the rows of row batches into kNumSpillPartitions spill files. Rows are
+ * buffered per partition and written out kSpillBatchRows at a time.
+ */
+class SpillPartitions : public NotCopyable {
+ public:
+  SpillPartitions(const table_store::schema::RowDescriptor& desc, arrow::MemoryPool* mem_pool)
+      : desc_(desc), mem_pool_(mem_pool) {}
+
+  Status Init(const std::filesystem::path& dir);
+
+  /**
+   * Appends the rows of the batch to their partitions.
+   * @param rb The rows to write.
+   * @param partitions The partition of each row of rb, or kNoSpillPartition to skip the row.
+   */
+  Status Append(const table_store::schema::RowBatch& rb, const std::vector<size_t>& partitions);
+
+  /**
+   * Writes out the buffered rows and starts reading every partition from the beginning.
+   */
+  Status StartReading();
+
+  SpillFile* partition(size_t i) { return files_[i].get(); }
+
+  int64_t bytes_written() const;
+
+ private:
+  Status ResetBuilders(size_t partition);
+  Status FlushPartition(size_t partition);
+
+  table_store::schema::RowDescriptor desc_;
+  arrow::MemoryPool* mem_pool_;
+  std::vector<std::unique_ptr<SpillFile>> files_;
+  // The builders of the rows buffered for each partition.
+  std::vector<std::vector<std::unique_ptr<arrow::ArrayBuilder>>> builders_;
+  std::vector<int64_t> buffered_rows_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill_file.h"
+
+#include <filesystem>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+class SpillFileTest : public ::testing::Test {
+ protected:
+  bool DirIsEmpty() { return std::filesystem::is_empty(temp_dir_.path()); }
+
+  px::testing::TempDir temp_dir_;
+  RowDescriptor rd_{{types::DataType::INT64, types::DataType::STRING}};
+};
+
+TEST_F(SpillFileTest, round_trip) {
+  auto rb1 = RowBatchBuilder(rd_, 2, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({1, 2})
+                 .AddColumn<types::StringValue>({"a", "bb"})
+                 .get();
+  auto rb2 = RowBatchBuilder(rd_, 1, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({3})
+                 .AddColumn<types::StringValue>({"ccc"})
+                 .get();
+  {
+    ASSERT_OK_AND_ASSIGN(auto file, SpillFile::Create(temp_dir_.path()));
+    ASSERT_OK(file->Append(rb1));
+    ASSERT_OK(file->Append(rb2));
+    EXPECT_EQ(2, file->num_batches());
+    EXPECT_GT(file->bytes_written(), 0);
+
+    ASSERT_OK(file->StartReading());
+    ASSERT_OK_AND_ASSIGN(auto out1, file->ReadNext());
+    ASSERT_NE(nullptr, out1);
+    EXPECT_TRUE(out1->ColumnAt(0)->Equals(rb1.ColumnAt(0)));
+    EXPECT_TRUE(out1->ColumnAt(1)->Equals(rb1.ColumnAt(1)));
+    ASSERT_OK_AND_ASSIGN(auto out2, file->ReadNext());
+    ASSERT_NE(nullptr, out2);
+    EXPECT_TRUE(out2->ColumnAt(1)->Equals(rb2.ColumnAt(1)));
+    ASSERT_OK_AND_ASSIGN(auto end, file->ReadNext());
+    EXPECT_EQ(nullptr, end);
+  }
+  EXPECT_TRUE(DirIsEmpty());
+}
+
+TEST_F(SpillFileTest, partitions) {
+  auto rb = RowBatchBuilder(rd_, 4, /*eow*/ false, /*eos*/ false)
+                .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                .AddColumn<types::StringValue>({"a", "b", "c", "d"})
+                .get();
+  {
+    SpillPartitions partitions(rd_, arrow::default_memory_pool());
+    ASSERT_OK(partitions.Init(temp_dir_.path()));
+    ASSERT_OK(partitions.Append(rb, {3, kNoSpillPartition, 3, 5}));
+    ASSERT_OK(partitions.StartReading());
+
+    ASSERT_OK_AND_ASSIGN(auto part3, partitions.partition(3)->ReadNext());
+    ASSERT_NE(nullptr, part3);
+    EXPECT_TRUE(part3->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Int64Value>{1, 3},
+                                                          arrow::default_memory_pool())));
+    ASSERT_OK_AND_ASSIGN(auto part5, partitions.partition(5)->ReadNext());
+    ASSERT_NE(nullptr, part5);
+    EXPECT_EQ(1, part5->num_rows());
+    ASSERT_OK_AND_ASSIGN(auto part0, partitions.partition(0)->ReadNext());
+    EXPECT_EQ(nullptr, part0);
+  }
+  EXPECT_TRUE(DirIsEmpty());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -283,6 +283,16 @@ class RowBatchBuilder {
     return *this;
   }
 
+  /**
+   * Restrict the rowbatch to a selection of its rows.
+   * @param selection The indices of the selected rows, in increasing order.
+   * @return the RowBatchBuilder, to allow for chaining.
+   */
+  RowBatchBuilder& Select(std::vector<int64_t> selection) {
+    rb_->set_selection(std::make_shared<const std::vector<int64_t>>(std::move(selection)));
+    return *this;
+  }
+
   /**
    * @return The rowbatch.
    */
@@ -357,6 +367,26 @@ class ExecNodeTester {
    */
   TExecNode* node() { return exec_node_.get(); }
 
+  /**
+   * Sets whether the mock child accepts row batches with a selection.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ChildAcceptsSelection(bool accepts_selection = true) {
+    mock_child_.set_accepts_selection(accepts_selection);
+    return *this;
+  }
+
+  /**
+   * Checks whether the next rowbatch output by ConsumeNext/GenerateNext has a selection. Row
+   * batches with a selection are compared by their selected rows.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ExpectSelection(bool has_selection) {
+    DCHECK(current_row_batches_.size());
+    EXPECT_EQ(has_selection, current_row_batches_.front()->has_selection());
+    return *this;
+  }
+
   /**
    * Calls Close on the execution node.
    * @return the ExecNodeTester, to allow for chaining.
@@ -438,6 +468,7 @@ class ExecNodeTester {
    */
   ExecNodeTester& ExpectRowBatch(const table_store::schema::RowBatch& expected_rb,
                                  bool ordered = true, int64_t time_column_idx = -1) {
+    MaterializeFront();
     if (ordered) {
       DCHECK(current_row_batches_.size());
       ValidateRowBatch(expected_rb, *current_row_batches_.front().get());
@@ -462,6 +493,7 @@ class ExecNodeTester {
                                        int64_t num_batches, int64_t time_column_idx = -1) {
     std::vector<table_store::schema::RowBatch> batches;
     for (auto i = 0; i < num_batches; ++i) {
+      MaterializeFront();
       batches.push_back(*current_row_batches_.front().get());
       current_row_batches_.pop();
     }
@@ -477,6 +509,16 @@ class ExecNodeTester {
   }
 
  private:
+  void MaterializeFront() {
+    DCHECK(current_row_batches_.size());
+    auto& rb = current_row_batches_.front();
+    if (rb->has_selection()) {
+      auto dense_rb_or_s = rb->Materialize(arrow::default_memory_pool());
+      EXPECT_OK(dense_rb_or_s);
+      rb = dense_rb_or_s.ConsumeValueOrDie();
+    }
+  }
+
   void ValidateRowBatch(const table_store::schema::RowBatch& expected_rb,
                         const table_store::schema::RowBatch& actual_rb) {
     EXPECT_EQ(actual_rb.num_rows(), expected_rb.num_rows());
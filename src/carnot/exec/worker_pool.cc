@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/worker_pool.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+WorkerPool::WorkerPool(int num_threads) {
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stopped_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+Status WorkerPool::Run(const std::vector<std::function<Status()>>& tasks) {
+  if (tasks.empty()) {
+    return Status::OK();
+  }
+  std::unique_lock<std::mutex> lock(lock_);
+  DCHECK(tasks_ == nullptr) << "WorkerPool::Run is not reentrant.";
+  tasks_ = &tasks;
+  ++generation_;
+  next_task_ = 0;
+  remaining_tasks_ = tasks.size();
+  status_ = Status::OK();
+  work_cv_.notify_all();
+
+  RunTasks(&lock);
+  done_cv_.wait(lock, [this]() { return remaining_tasks_ == 0; });
+
+  tasks_ = nullptr;
+  return status_;
+}
+
+void WorkerPool::RunTasks(std::unique_lock<std::mutex>* lock) {
+  while (tasks_ != nullptr && next_task_ < tasks_->size()) {
+    const auto& task = (*tasks_)[next_task_++];
+    lock->unlock();
+    Status s = task();
+    lock->lock();
+    if (!s.ok() && status_.ok()) {
+      status_ = s;
+    }
+    if (--remaining_tasks_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  int64_t seen_generation = generation_;
+  while (true) {
+    work_cv_.wait(lock, [this, seen_generation]() {
+      return stopped_ || generation_ != seen_generation;
+    });
+    if (stopped_) {
+      return;
+    }
+    seen_generation = generation_;
+    RunTasks(&lock);
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * A fixed set of threads that runs batches of tasks for the execution graph.
+ *
+ * The thread that calls Run() also executes tasks, so a pool with zero threads runs all tasks
+ * serially on the caller.
+ */
+class WorkerPool : public NotCopyable {
+ public:
+  explicit WorkerPool(int num_threads);
+  ~WorkerPool();
+
+  /**
+   * Runs all of the tasks and blocks until they are done.
+   * @param tasks The tasks to run. They may run in any order and on any thread.
+   * @return The first error returned by a task, or OK if all of them succeeded.
+   */
+  Status Run(const std::vector<std::function<Status()>>& tasks);
+
+  size_t num_threads() const { return threads_.size(); }
+
+ private:
+  void WorkerLoop();
+  // Runs tasks from the current batch until there are none left to start. Expects lock to be held
+  // on entry and holds it again on return.
+  void RunTasks(std::unique_lock<std::mutex>* lock);
+
+  std::vector<std::thread> threads_;
+
+  std::mutex lock_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  bool stopped_ = false;
+  // The batch of tasks that is currently running, if any.
+  const std::vector<std::function<Status()>>* tasks_ = nullptr;
+  // Incremented for every batch so that workers can tell a new batch from the previous one.
+  int64_t generation_ = 0;
+  size_t next_task_ = 0;
+  size_t remaining_tasks_ = 0;
+  Status status_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "src/carnot/exec/worker_pool.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(WorkerPoolTest, runs_all_tasks) {
+  WorkerPool pool(3);
+  EXPECT_EQ(3, pool.num_threads());
+
+  std::atomic<int> sum = 0;
+  std::vector<std::function<Status()>> tasks;
+  for (int i = 1; i <= 100; ++i) {
+    tasks.push_back([&sum, i]() {
+      sum += i;
+      return Status::OK();
+    });
+  }
+  // Run the same pool several times to make sure that it can be reused between batches.
+  for (int round = 1; round <= 5; ++round) {
+    EXPECT_OK(pool.Run(tasks));
+    EXPECT_EQ(round * 5050, sum.load());
+  }
+}
+
+TEST(WorkerPoolTest, no_threads_runs_on_caller) {
+  WorkerPool pool(0);
+  int count = 0;
+  std::vector<std::function<Status()>> tasks(10, [&count]() {
+    ++count;
+    return Status::OK();
+  });
+  EXPECT_OK(pool.Run(tasks));
+  EXPECT_EQ(10, count);
+}
+
+TEST(WorkerPoolTest, returns_error) {
+  WorkerPool pool(2);
+  std::atomic<int> count = 0;
+  std::vector<std::function<Status()>> tasks;
+  for (int i = 0; i < 10; ++i) {
+    tasks.push_back([&count, i]() {
+      ++count;
+      if (i == 5) {
+        return error::Internal("task $0 failed", i);
+      }
+      return Status::OK();
+    });
+  }
+  auto s = pool.Run(tasks);
+  EXPECT_NOT_OK(s);
+  EXPECT_EQ("task 5 failed", s.msg());
+  // All of the tasks still run.
+  EXPECT_EQ(10, count.load());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
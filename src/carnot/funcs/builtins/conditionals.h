@@ -43,6 +43,14 @@ class SelectUDF : public udf::ScalarUDF {
     return v2;
   }
 
+  Status ExecBatch(FunctionContext*, const arrow::Array& s, const arrow::Array& v1,
+                   const arrow::Array& v2, arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TArg>(
+        out, [](bool sel, auto lhs, auto rhs) { return sel ? lhs : rhs; },
+        udf::ArrowValueReader<BoolValue>(s), udf::ArrowValueReader<TArg>(v1),
+        udf::ArrowValueReader<TArg>(v2));
+  }
+
   static udf::InfRuleVec SemanticInferenceRules() {
     // Match the 1st and 2nd arg.
     return {udf::InheritTypeFromArgs<SelectUDF>::CreateGeneric({1, 2})};
@@ -34,6 +34,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class AddUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TReturn>(
+        out, [](auto v1, auto v2) { return v1 + v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<AddUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -59,6 +65,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class SubtractUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TReturn>(
+        out, [](auto v1, auto v2) { return v1 - v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<SubtractUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -89,6 +101,12 @@ class DivideUDF : public udf::ScalarUDF {
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) {
     return ReturnValueType(b1.val) / ReturnValueType(b2.val);
   }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TReturn>(
+        out, [](auto v1, auto v2) { return ReturnValueType(v1) / ReturnValueType(v2); },
+        udf::ArrowValueReader<TArg1>(b1), udf::ArrowValueReader<TArg2>(b2));
+  }
 
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<DivideUDF>(types::ST_THROUGHPUT_PER_NS,
@@ -114,6 +132,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TReturn>(
+        out, [](auto v1, auto v2) { return v1 * v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
         .Details("Multiplies the two values together. Accessible using the `*` operator syntax.")
@@ -246,6 +270,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class ModuloUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val % b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TReturn>(
+        out, [](auto v1, auto v2) { return v1 % v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Calculates the remainder of the division of the two numbers")
         .Details(
@@ -267,6 +297,12 @@ template <typename TArg1, typename TArg2>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 || v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -286,6 +322,12 @@ template <typename TArg1, typename TArg2>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 && v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -303,6 +345,10 @@ template <typename TArg1>
 class LogicalNotUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1) { return !b1.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1) { return !v1; }, udf::ArrowValueReader<TArg1>(b1));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean NOTs the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -319,6 +365,10 @@ template <typename TArg1>
 class NegateUDF : public udf::ScalarUDF {
  public:
   TArg1 Exec(FunctionContext*, TArg1 b1) { return -b1.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<TArg1>(
+        out, [](auto v1) { return -v1; }, udf::ArrowValueReader<TArg1>(b1));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Negates the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -375,6 +425,12 @@ template <typename TArg1, typename TArg2>
 class EqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 == v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
         .Details(
@@ -395,6 +451,12 @@ template <typename TArg1, typename TArg2>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 != v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
         .Details(
@@ -442,6 +504,12 @@ template <typename TArg1, typename TArg2>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 > v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -461,6 +529,12 @@ template <typename TArg1, typename TArg2>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 >= v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -481,6 +555,12 @@ template <typename TArg1, typename TArg2>
 class LessThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 < v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
         .Example(R"doc(# Implict call.
@@ -497,6 +577,12 @@ template <typename TArg1, typename TArg2>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out, [](auto v1, auto v2) { return v1 <= v2; }, udf::ArrowValueReader<TArg1>(b1),
+        udf::ArrowValueReader<TArg2>(b2));
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
         .Example(R"doc(
@@ -21,6 +21,7 @@
 #include <absl/strings/strip.h>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -35,6 +36,16 @@ class ContainsUDF : public udf::ScalarUDF {
     return absl::StrContains(b1, b2);
   }
 
+  Status ExecBatch(FunctionContext*, const arrow::Array& b1, const arrow::Array& b2,
+                   arrow::ArrayBuilder* out) {
+    return udf::ExecBatchElementwise<BoolValue>(
+        out,
+        [](std::string_view v1, std::string_view v2) {
+          return v1.find(v2) != std::string_view::npos;
+        },
+        udf::ArrowValueReader<StringValue>(b1), udf::ArrowValueReader<StringValue>(b2));
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the first string contains the second string.")
         .Example("matching_df = matching_df[px.contains(matching_df.svc_names, 'my_svc')]")
@@ -74,6 +74,10 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::SORT_OPERATOR:
+      return CreateOperator<SortOperator>(id, pb.sort_op());
+    case planpb::ROLLING_OPERATOR:
+      return CreateOperator<RollingOperator>(id, pb.rolling_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -214,11 +218,41 @@ Status AggregateOperator::Init(const planpb::AggregateOperator& pb) {
   for (int idx = 0; idx < pb_.groups_size(); ++idx) {
     groups_.emplace_back(GroupInfo{pb_.group_names(idx), pb_.groups(idx).index()});
   }
+  if (pb_.has_result_cache()) {
+    PL_RETURN_IF_ERROR(ValidateResultCache());
+  }
 
   is_initialized_ = true;
   return Status::OK();
 }
 
+Status AggregateOperator::ValidateResultCache() const {
+  const auto& cache = pb_.result_cache();
+  if (pb_.windowed()) {
+    return error::InvalidArgument("Only blocking aggregates can cache their results");
+  }
+  if (cache.bucket_group_index() < 0 || cache.bucket_group_index() >= pb_.groups_size()) {
+    return error::InvalidArgument("Result cache bucket group $0 is out of bounds",
+                                  cache.bucket_group_index());
+  }
+  if (cache.bucket_size_ns() <= 0) {
+    return error::InvalidArgument("Result cache bucket size must be positive, got $0",
+                                  cache.bucket_size_ns());
+  }
+  if (cache.input_start_ns() < cache.range_start_ns()) {
+    return error::InvalidArgument("Result cache input start $0 is before the range start $1",
+                                  cache.input_start_ns(), cache.range_start_ns());
+  }
+  if (cache.input_start_ns() > cache.range_start_ns() &&
+      (cache.range_start_ns() % cache.bucket_size_ns() != 0 ||
+       cache.input_start_ns() % cache.bucket_size_ns() != 0)) {
+    return error::InvalidArgument(
+        "Result cache range start $0 and input start $1 must be aligned to the bucket size $2",
+        cache.range_start_ns(), cache.input_start_ns(), cache.bucket_size_ns());
+  }
+  return Status::OK();
+}
+
 StatusOr<table_store::schema::Relation> AggregateOperator::OutputRelation(
     const table_store::schema::Schema& schema, const PlanState& state,
     const std::vector<int64_t>& input_ids) const {
@@ -247,6 +281,13 @@ StatusOr<table_store::schema::Relation> AggregateOperator::OutputRelation(
     }
     output_relation.AddColumn(input_relation.GetColumnType(col_idx), pb_.group_names(idx));
   }
+  if (pb_.has_result_cache()) {
+    auto bucket_col = pb_.groups(pb_.result_cache().bucket_group_index()).index();
+    if (input_relation.GetColumnType(bucket_col) != types::TIME64NS) {
+      return error::InvalidArgument("Result cache bucket column '$0' must be of type TIME64NS",
+                                    input_relation.GetColumnName(bucket_col));
+    }
+  }
 
   // If this node is a partial aggregate we output a simple schema where the last column has
   // serialized aggregates.
@@ -450,6 +491,164 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * Sort Operator Implementation.
+ */
+std::string SortOperator::DebugString() const {
+  return absl::Substitute("Op:Sort(sort_cols=[$0], ascending=[$1], limit=$2, cols=[$3])",
+                          absl::StrJoin(sort_cols_, ","), absl::StrJoin(ascending_, ","), limit_,
+                          absl::StrJoin(selected_cols_, ","));
+}
+
+Status SortOperator::Init(const planpb::SortOperator& pb) {
+  pb_ = pb;
+  if (pb_.sort_columns_size() == 0) {
+    return error::InvalidArgument("Sort operator needs at least one sort column");
+  }
+  if (pb_.sort_columns_size() != pb_.ascending_size()) {
+    return error::InvalidArgument("Sort operator has $0 sort columns but $1 sort orders",
+                                  pb_.sort_columns_size(), pb_.ascending_size());
+  }
+  if (pb_.limit() < 0) {
+    return error::InvalidArgument("Sort operator limit must not be negative, got $0", pb_.limit());
+  }
+  for (auto i = 0; i < pb_.sort_columns_size(); ++i) {
+    sort_cols_.push_back(pb_.sort_columns(i).index());
+    ascending_.push_back(pb_.ascending(i));
+  }
+  limit_ = pb_.limit();
+  for (auto i = 0; i < pb_.columns_size(); ++i) {
+    selected_cols_.push_back(pb_.columns(i).index());
+  }
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> SortOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Sort operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of SortOperator", input_ids[0]);
+  }
+  PL_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (auto sort_col_idx : sort_cols_) {
+    if (sort_col_idx < 0 || sort_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument(
+          "Sort column index $0 is out of bounds, number of columns is $1", sort_col_idx,
+          input_relation.NumColumns());
+    }
+  }
+
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    if (selected_col_idx < 0 ||
+        selected_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument("Column index $0 is out of bounds, number of columns is $1",
+                                    selected_col_idx, input_relation.NumColumns());
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
+/**
+ * Rolling Operator Implementation.
+ */
+std::string RollingOperator::DebugString() const {
+  const auto& v = values();
+  std::vector<std::string> value_names(v.size());
+  std::transform(begin(v), end(v), begin(value_names), [](auto val) { return val->name(); });
+
+  const auto& g = groups();
+  std::vector<std::string> group_names(g.size());
+  std::transform(begin(g), end(g), begin(group_names), [](auto val) { return val.name; });
+
+  return absl::Substitute(
+      "Op:Rolling(window_col=$0, window_size=$1, allowed_lateness=$2, values=($3), groups=($4))",
+      window_col(), window_size(), allowed_lateness(), absl::StrJoin(value_names, ", "),
+      absl::StrJoin(group_names, ", "));
+}
+
+Status RollingOperator::Init(const planpb::RollingOperator& pb) {
+  pb_ = pb;
+  if (pb_.window_size() <= 0) {
+    return error::InvalidArgument("Rolling operator window size must be positive, got $0",
+                                  pb_.window_size());
+  }
+  if (pb_.allowed_lateness_ns() < 0) {
+    return error::InvalidArgument("Rolling operator allowed lateness must not be negative, got $0",
+                                  pb_.allowed_lateness_ns());
+  }
+  if (pb_.groups_size() != pb_.group_names_size()) {
+    return error::InvalidArgument("group names/exp size mismatch");
+  }
+  if (pb_.values_size() != pb_.value_names_size()) {
+    return error::InvalidArgument("values names/exp size mismatch");
+  }
+  values_.reserve(static_cast<size_t>(pb_.values_size()));
+  for (int i = 0; i < pb_.values_size(); ++i) {
+    auto ae = std::make_shared<AggregateExpression>();
+    PL_RETURN_IF_ERROR(ae->Init(pb_.values(i)));
+    values_.push_back(std::move(ae));
+  }
+  groups_.reserve(pb_.groups_size());
+  for (int idx = 0; idx < pb_.groups_size(); ++idx) {
+    groups_.emplace_back(
+        AggregateOperator::GroupInfo{pb_.group_names(idx), pb_.groups(idx).index()});
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> RollingOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& state,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("Rolling operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of RollingOperator", input_ids[0]);
+  }
+  PL_ASSIGN_OR_RETURN(const auto& input_relation, schema.GetRelation(input_ids[0]));
+  auto num_input_cols = static_cast<int64_t>(input_relation.NumColumns());
+
+  if (window_col() < 0 || window_col() >= num_input_cols) {
+    return error::InvalidArgument(
+        "Window column index $0 is out of bounds, number of columns is $1", window_col(),
+        num_input_cols);
+  }
+  if (input_relation.GetColumnType(window_col()) != types::TIME64NS) {
+    return error::InvalidArgument("Window column '$0' must be of type TIME64NS",
+                                  input_relation.GetColumnName(window_col()));
+  }
+  table_store::schema::Relation output_relation;
+  output_relation.AddColumn(types::TIME64NS, input_relation.GetColumnName(window_col()));
+
+  for (int idx = 0; idx < pb_.groups_size(); ++idx) {
+    int64_t col_idx = pb_.groups(idx).index();
+    if (col_idx < 0 || col_idx >= num_input_cols) {
+      return error::InvalidArgument(
+          "Group column index $0 is out of bounds, number of columns is $1", col_idx,
+          num_input_cols);
+    }
+    output_relation.AddColumn(input_relation.GetColumnType(col_idx), pb_.group_names(idx));
+  }
+  for (const auto& [i, value] : Enumerate(values_)) {
+    PL_ASSIGN_OR_RETURN(auto dt, value->OutputDataType(state, schema));
+    output_relation.AddColumn(dt, pb_.value_names(i));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
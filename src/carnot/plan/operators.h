@@ -94,6 +94,9 @@ class MemorySourceOperator : public Operator {
   bool HasStopTime() const { return pb_.has_stop_time(); }
   int64_t start_time() const { return pb_.start_time().value(); }
   int64_t stop_time() const { return pb_.stop_time().value(); }
+  bool HasSkippedTime() const { return pb_.has_skip_start_time() && pb_.has_skip_stop_time(); }
+  int64_t skip_start_time() const { return pb_.skip_start_time().value(); }
+  int64_t skip_stop_time() const { return pb_.skip_stop_time().value(); }
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool infinite_stream() const { return pb_.streaming(); }
@@ -144,8 +147,12 @@ class AggregateOperator : public Operator {
   const std::vector<GroupInfo>& groups() const { return groups_; }
   const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
   bool windowed() const { return pb_.windowed(); }
+  bool has_result_cache() const { return pb_.has_result_cache(); }
+  const planpb::AggregateResultCache& result_cache() const { return pb_.result_cache(); }
 
  private:
+  Status ValidateResultCache() const;
+
   std::vector<std::shared_ptr<AggregateExpression>> values_;
   std::vector<GroupInfo> groups_;
   planpb::AggregateOperator pb_;
@@ -215,6 +222,9 @@ class GRPCSinkOperator : public Operator {
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
 
+  // Whether row batches are sent with packed columns, see RowBatch::ToPackedProto.
+  bool packed_columns() const { return pb_.packed_columns(); }
+
  private:
   planpb::GRPCSinkOperator pb_;
 };
@@ -262,6 +272,58 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class SortOperator : public Operator {
+ public:
+  explicit SortOperator(int64_t id) : Operator(id, planpb::SORT_OPERATOR) {}
+  ~SortOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::SortOperator& pb);
+  std::string DebugString() const override;
+
+  // The input column indexes to sort by, in order of precedence.
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  const std::vector<bool>& ascending() const { return ascending_; }
+  // The number of rows to keep, or 0 to keep all of them.
+  int64_t limit() const { return limit_; }
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+
+ private:
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> ascending_;
+  int64_t limit_ = 0;
+  std::vector<int64_t> selected_cols_;
+  planpb::SortOperator pb_;
+};
+
+class RollingOperator : public Operator {
+ public:
+  explicit RollingOperator(int64_t id) : Operator(id, planpb::ROLLING_OPERATOR) {}
+  ~RollingOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::RollingOperator& pb);
+  std::string DebugString() const override;
+
+  // The input column index of the time column that assigns rows to windows.
+  int64_t window_col() const { return pb_.window_column().index(); }
+  // The size of each window in nanoseconds.
+  int64_t window_size() const { return pb_.window_size(); }
+  // How far in nanoseconds a row may trail the largest time seen before its window is closed.
+  int64_t allowed_lateness() const { return pb_.allowed_lateness_ns(); }
+  const std::vector<AggregateOperator::GroupInfo>& groups() const { return groups_; }
+  const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
+
+ private:
+  std::vector<std::shared_ptr<AggregateExpression>> values_;
+  std::vector<AggregateOperator::GroupInfo> groups_;
+  planpb::RollingOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
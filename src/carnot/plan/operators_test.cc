@@ -85,12 +85,17 @@ class OperatorTest : public ::testing::Test {
     Relation rel5;
     rel5.AddColumn(types::DataType::INT64, "time_");
 
+    Relation rel6;
+    rel6.AddColumn(types::DataType::TIME64NS, "time_");
+    rel6.AddColumn(types::DataType::INT64, "svc");
+
     schema_.AddRelation(0, rel0);
     schema_.AddRelation(1, rel1);
     schema_.AddRelation(2, rel2);
     schema_.AddRelation(3, rel3);
     schema_.AddRelation(4, rel4);
     schema_.AddRelation(5, rel5);
+    schema_.AddRelation(6, rel6);
   }
 
   ~OperatorTest() override = default;
@@ -176,6 +181,21 @@ TEST_F(OperatorTest, from_proto_windowed_agg) {
   EXPECT_EQ(planpb::OperatorType::AGGREGATE_OPERATOR, agg_op->op_type());
 }
 
+TEST_F(OperatorTest, from_proto_rolling) {
+  auto rolling_pb = planpb::testutils::CreateTestRolling1PB();
+  auto rolling_op = Operator::FromProto(rolling_pb, 1);
+  EXPECT_EQ(1, rolling_op->id());
+  EXPECT_TRUE(rolling_op->is_initialized());
+  EXPECT_EQ(planpb::OperatorType::ROLLING_OPERATOR, rolling_op->op_type());
+
+  const auto* rolling_plan_node = static_cast<const plan::RollingOperator*>(rolling_op.get());
+  EXPECT_EQ(0, rolling_plan_node->window_col());
+  EXPECT_EQ(10, rolling_plan_node->window_size());
+  EXPECT_EQ(5, rolling_plan_node->allowed_lateness());
+  EXPECT_EQ(1ULL, rolling_plan_node->groups().size());
+  EXPECT_EQ(1ULL, rolling_plan_node->values().size());
+}
+
 TEST_F(OperatorTest, from_proto_filter) {
   auto filter_pb = planpb::testutils::CreateTestFilter1PB();
   auto filter_op = Operator::FromProto(filter_pb, 1);
@@ -366,6 +386,28 @@ TEST_F(OperatorTest, output_relation_agg) {
   EXPECT_EQ(expected_relation, rel);
 }
 
+TEST_F(OperatorTest, output_relation_rolling) {
+  auto rolling_pb = planpb::testutils::CreateTestRolling1PB();
+  auto rolling_op = Operator::FromProto(rolling_pb, 1);
+
+  auto rel =
+      rolling_op->OutputRelation(schema_, *state_, std::vector<int64_t>({6})).ConsumeValueOrDie();
+
+  Relation expected_relation;
+  expected_relation.AddColumn(types::DataType::TIME64NS, "time_");
+  expected_relation.AddColumn(types::DataType::INT64, "group1");
+  expected_relation.AddColumn(types::DataType::INT64, "value1");
+  EXPECT_EQ(expected_relation, rel);
+}
+
+TEST_F(OperatorTest, output_relation_rolling_non_time_window_col) {
+  auto rolling_pb = planpb::testutils::CreateTestRolling1PB();
+  auto rolling_op = Operator::FromProto(rolling_pb, 1);
+  auto rel = rolling_op->OutputRelation(schema_, *state_, std::vector<int64_t>({5}));
+  EXPECT_NOT_OK(rel);
+  EXPECT_EQ(rel.msg(), "Window column 'time_' must be of type TIME64NS");
+}
+
 TEST_F(OperatorTest, output_relation_filter) {
   auto filter_pb = planpb::testutils::CreateTestFilter1PB();
   auto filter_op = Operator::FromProto(filter_pb, 2);
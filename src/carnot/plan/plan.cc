@@ -24,7 +24,10 @@
 #include <utility>
 #include <vector>
 
+#include <absl/hash/hash.h>
 #include <absl/strings/str_cat.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
 #include "src/carnot/dag/dag.h"
 #include "src/carnot/plan/plan_fragment.h"
@@ -34,6 +37,36 @@ namespace px {
 namespace carnot {
 namespace plan {
 
+uint64_t PlanFingerprint(const planpb::Plan& plan) {
+  planpb::Plan normalized = plan;
+  for (auto& fragment : *normalized.mutable_nodes()) {
+    for (auto& node : *fragment.mutable_nodes()) {
+      auto* op = node.mutable_op();
+      if (op->has_mem_source_op()) {
+        op->mutable_mem_source_op()->clear_start_time();
+        op->mutable_mem_source_op()->clear_stop_time();
+        op->mutable_mem_source_op()->clear_skip_start_time();
+        op->mutable_mem_source_op()->clear_skip_stop_time();
+      }
+      if (op->has_agg_op() && op->agg_op().has_result_cache()) {
+        auto* cache = op->mutable_agg_op()->mutable_result_cache();
+        cache->clear_range_start_ns();
+        cache->clear_input_start_ns();
+        cache->clear_closed_before_ns();
+      }
+    }
+  }
+
+  std::string bytes;
+  google::protobuf::io::StringOutputStream stream(&bytes);
+  google::protobuf::io::CodedOutputStream coded(&stream);
+  // Map fields would otherwise serialize in an arbitrary order.
+  coded.SetSerializationDeterministic(true);
+  normalized.SerializeToCodedStream(&coded);
+  coded.Trim();
+  return absl::Hash<std::string>()(bytes);
+}
+
 Status PlanWalker::CallWalkFn(PlanFragment* pf) { return on_plan_fragment_walk_fn_(pf); }
 
 Status PlanWalker::Walk(Plan* plan) {
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -33,6 +34,13 @@ namespace plan {
 
 class Plan final : public PlanGraph<planpb::Plan, PlanFragment, planpb::PlanFragment> {};
 
+/**
+ * Computes a fingerprint of the plan that ignores its time range: the start, stop and skipped
+ * times of memory sources and the time fields of aggregate result caches. Runs of the same query
+ * over different time ranges (eg. refreshes of a live view) get the same fingerprint.
+ */
+uint64_t PlanFingerprint(const planpb::Plan& plan);
+
 /**
  * A walker that walks the plan fragments of a plan in a topologically-sorted order.
  * A sample usage is:
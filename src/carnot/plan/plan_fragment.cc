@@ -77,6 +77,12 @@ Status PlanFragmentWalker::CallWalkFn(const Operator& op) {
     case planpb::OperatorType::LIMIT_OPERATOR:
       PL_RETURN_IF_ERROR(CallAs<LimitOperator>(on_limit_walk_fn_, op));
       break;
+    case planpb::OperatorType::SORT_OPERATOR:
+      PL_RETURN_IF_ERROR(CallAs<SortOperator>(on_sort_walk_fn_, op));
+      break;
+    case planpb::OperatorType::ROLLING_OPERATOR:
+      PL_RETURN_IF_ERROR(CallAs<RollingOperator>(on_rolling_walk_fn_, op));
+      break;
     case planpb::OperatorType::JOIN_OPERATOR:
       PL_RETURN_IF_ERROR(CallAs<JoinOperator>(on_join_walk_fn_, op));
       break;
@@ -69,6 +69,8 @@ class PlanFragmentWalker {
   using MemorySinkWalkFn = std::function<Status(const MemorySinkOperator&)>;
   using FilterWalkFn = std::function<Status(const FilterOperator&)>;
   using LimitWalkFn = std::function<Status(const LimitOperator&)>;
+  using SortWalkFn = std::function<Status(const SortOperator&)>;
+  using RollingWalkFn = std::function<Status(const RollingOperator&)>;
   using UnionWalkFn = std::function<Status(const UnionOperator&)>;
   using JoinWalkFn = std::function<Status(const JoinOperator&)>;
   using GRPCSinkWalkFn = std::function<Status(const GRPCSinkOperator&)>;
@@ -137,6 +139,26 @@ class PlanFragmentWalker {
     return *this;
   }
 
+  /**
+   * Register callback for when a sort operator is encountered.
+   * @param fn The function to call when a SortOperator is encountered.
+   * @return self to allow chaining
+   */
+  PlanFragmentWalker& OnSort(const SortWalkFn& fn) {
+    on_sort_walk_fn_ = fn;
+    return *this;
+  }
+
+  /**
+   * Register callback for when a rolling operator is encountered.
+   * @param fn The function to call when a RollingOperator is encountered.
+   * @return self to allow chaining
+   */
+  PlanFragmentWalker& OnRolling(const RollingWalkFn& fn) {
+    on_rolling_walk_fn_ = fn;
+    return *this;
+  }
+
   /**
    * Register callback for when a union operator is encountered.
    * @param fn The function to call when a UnionOperator is encountered.
@@ -199,6 +221,8 @@ class PlanFragmentWalker {
   MemorySinkWalkFn on_memory_sink_walk_fn_;
   FilterWalkFn on_filter_walk_fn_;
   LimitWalkFn on_limit_walk_fn_;
+  SortWalkFn on_sort_walk_fn_;
+  RollingWalkFn on_rolling_walk_fn_;
   UnionWalkFn on_union_walk_fn_;
   JoinWalkFn on_join_walk_fn_;
   GRPCSinkWalkFn on_grpc_sink_walk_fn_;
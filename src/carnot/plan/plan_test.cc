@@ -59,6 +59,76 @@ TEST_F(PlanWalkerTest, basic_tests) {
   EXPECT_EQ(std::vector<int64_t>({1, 2, 3, 4, 5}), pf_order);
 }
 
+constexpr char kFingerprintPlan[] = R"pb(
+nodes {
+  id: 1
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "http_events"
+        column_idxs: 0
+        column_names: "time_"
+        column_types: TIME64NS
+        start_time { value: 100 }
+        stop_time { value: 200 }
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        groups { node: 1 index: 0 }
+        group_names: "time_"
+        result_cache {
+          bucket_group_index: 0
+          bucket_size_ns: 10
+          range_start_ns: 100
+          input_start_ns: 100
+          closed_before_ns: 200
+        }
+      }
+    }
+  }
+}
+)pb";
+
+TEST(PlanFingerprintTest, ignores_time_range) {
+  planpb::Plan plan1;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kFingerprintPlan, &plan1));
+
+  planpb::Plan plan2 = plan1;
+  auto* op2 = plan2.mutable_nodes(0)->mutable_nodes(0)->mutable_op();
+  op2->mutable_mem_source_op()->mutable_start_time()->set_value(150);
+  op2->mutable_mem_source_op()->mutable_stop_time()->set_value(250);
+  op2->mutable_mem_source_op()->mutable_skip_start_time()->set_value(150);
+  op2->mutable_mem_source_op()->mutable_skip_stop_time()->set_value(190);
+  auto* cache2 = plan2.mutable_nodes(0)
+                     ->mutable_nodes(1)
+                     ->mutable_op()
+                     ->mutable_agg_op()
+                     ->mutable_result_cache();
+  cache2->set_input_start_ns(190);
+  cache2->set_closed_before_ns(250);
+  EXPECT_EQ(PlanFingerprint(plan1), PlanFingerprint(plan2));
+
+  planpb::Plan plan3 = plan1;
+  plan3.mutable_nodes(0)->mutable_nodes(0)->mutable_op()->mutable_mem_source_op()->set_name("conn");
+  EXPECT_NE(PlanFingerprint(plan1), PlanFingerprint(plan3));
+
+  planpb::Plan plan4 = plan1;
+  plan4.mutable_nodes(0)
+      ->mutable_nodes(1)
+      ->mutable_op()
+      ->mutable_agg_op()
+      ->mutable_result_cache()
+      ->set_bucket_size_ns(20);
+  EXPECT_NE(PlanFingerprint(plan1), PlanFingerprint(plan4));
+}
+
 }  // namespace plan
 }  // namespace carnot
 }  // namespace px
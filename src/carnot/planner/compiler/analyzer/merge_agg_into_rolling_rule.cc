@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/merge_agg_into_rolling_rule.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+StatusOr<bool> MergeAggIntoRollingRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, OperatorWithParent(BlockingAgg(), Rolling()))) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(ir_node);
+  DCHECK_EQ(agg->parents().size(), 1UL);
+  auto rolling = static_cast<RollingIR*>(agg->parents()[0]);
+  // An agg of an already merged rolling aggregates the output of the windows.
+  if (rolling->has_merged_agg()) {
+    return false;
+  }
+  return MergeAggIntoRolling(rolling, agg);
+}
+
+StatusOr<bool> MergeAggIntoRollingRule::MergeAggIntoRolling(RollingIR* rolling,
+                                                            BlockingAggIR* agg) {
+  DCHECK_EQ(rolling->parents().size(), 1UL);
+  IR* graph = rolling->graph();
+
+  PL_ASSIGN_OR_RETURN(ColumnIR * window_col, graph->CopyNode(rolling->window_col()));
+  PL_ASSIGN_OR_RETURN(ExpressionIR * window_size, graph->CopyNode(rolling->window_size()));
+  PL_ASSIGN_OR_RETURN(RollingIR * merged,
+                      graph->CreateNode<RollingIR>(rolling->ast(), rolling->parents()[0],
+                                                   window_col, window_size));
+
+  // Groups from a groupby before the rolling come first, then the ones of the agg.
+  std::vector<ColumnIR*> groups;
+  for (ColumnIR* group : rolling->groups()) {
+    PL_ASSIGN_OR_RETURN(ColumnIR * new_group, graph->CopyNode(group));
+    groups.push_back(new_group);
+  }
+  for (ColumnIR* group : agg->groups()) {
+    PL_ASSIGN_OR_RETURN(ColumnIR * new_group, graph->CopyNode(group));
+    groups.push_back(new_group);
+  }
+  PL_RETURN_IF_ERROR(merged->SetGroups(groups));
+
+  ColExpressionVector agg_exprs;
+  for (const ColumnExpression& agg_expr : agg->aggregate_expressions()) {
+    PL_ASSIGN_OR_RETURN(ExpressionIR * new_node, graph->CopyNode(agg_expr.node));
+    agg_exprs.emplace_back(agg_expr.name, new_node);
+  }
+  PL_RETURN_IF_ERROR(merged->SetAggExprs(agg_exprs));
+
+  for (OperatorIR* child : agg->Children()) {
+    PL_RETURN_IF_ERROR(child->ReplaceParent(agg, merged));
+  }
+  PL_RETURN_IF_ERROR(DeleteOperator(agg));
+  if (rolling->Children().empty()) {
+    PL_RETURN_IF_ERROR(DeleteOperator(rolling));
+  }
+  return true;
+}
+
+Status MergeAggIntoRollingRule::DeleteOperator(OperatorIR* op) {
+  IR* graph = op->graph();
+  auto op_id = op->id();
+  auto op_children = graph->dag().DependenciesOf(op_id);
+  PL_RETURN_IF_ERROR(graph->DeleteNode(op_id));
+  for (const auto& child_id : op_children) {
+    PL_RETURN_IF_ERROR(graph->DeleteOrphansInSubtree(child_id));
+  }
+  return Status::OK();
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
+#include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief This rule finds every agg that follows a rolling and merges the two into a single
+ * RollingIR that holds the window, the groups of both and the aggregates of the agg.
+ *
+ * df.rolling('2s').agg(...) is written as two operators, but only the merged form can be executed.
+ * Each agg gets its own merged rolling, and the original rolling is removed once every agg that
+ * followed it has been merged. Rolling nodes that are not followed by an agg are left as is and
+ * fail in type resolution.
+ */
+class MergeAggIntoRollingRule : public Rule {
+ public:
+  MergeAggIntoRollingRule()
+      : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  StatusOr<bool> MergeAggIntoRolling(RollingIR* rolling, BlockingAggIR* agg);
+  Status DeleteOperator(OperatorIR* op);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
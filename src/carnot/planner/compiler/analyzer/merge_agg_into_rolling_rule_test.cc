@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/merge_agg_into_rolling_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using ::testing::ElementsAre;
+
+TEST_F(RulesTest, MergeAggIntoRollingRule) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  RollingIR* rolling = MakeRolling(mem_source, MakeColumn("time_", 0), MakeInt(10));
+  // The groups of a groupby before the rolling, as merged by MergeGroupByIntoGroupAcceptorRule.
+  ASSERT_OK(rolling->SetGroups({MakeColumn("col1", 0)}));
+  BlockingAggIR* agg = MakeBlockingAgg(rolling, {MakeColumn("col2", 0)},
+                                       {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MemorySinkIR* sink = MakeMemSink(agg, "");
+  auto rolling_id = rolling->id();
+  auto agg_id = agg->id();
+
+  MergeAggIntoRollingRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  EXPECT_FALSE(graph->HasNode(rolling_id));
+  EXPECT_FALSE(graph->HasNode(agg_id));
+  ASSERT_EQ(sink->parents().size(), 1);
+  ASSERT_MATCH(sink->parents()[0], Rolling());
+  auto merged = static_cast<RollingIR*>(sink->parents()[0]);
+  EXPECT_THAT(merged->parents(), ElementsAre(mem_source));
+  EXPECT_TRUE(merged->has_merged_agg());
+  EXPECT_EQ(merged->window_col()->col_name(), "time_");
+  ASSERT_MATCH(merged->window_size(), Int());
+  EXPECT_EQ(static_cast<IntIR*>(merged->window_size())->val(), 10);
+
+  std::vector<std::string> group_names;
+  for (ColumnIR* g : merged->groups()) {
+    group_names.push_back(g->col_name());
+  }
+  EXPECT_THAT(group_names, ElementsAre("col1", "col2"));
+  ASSERT_EQ(merged->aggregate_expressions().size(), 1);
+  EXPECT_EQ(merged->aggregate_expressions()[0].name, "outcount");
+
+  // A second run doesn't merge the rolling again.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+}
+
+TEST_F(RulesTest, MergeAggIntoRollingRule_MultipleAggs) {
+  MemorySourceIR* mem_source = MakeMemSource();
+  RollingIR* rolling = MakeRolling(mem_source, MakeColumn("time_", 0), MakeInt(10));
+  BlockingAggIR* agg1 =
+      MakeBlockingAgg(rolling, {}, {{"outcount", MakeMeanFunc(MakeColumn("count", 0))}});
+  MemorySinkIR* sink1 = MakeMemSink(agg1, "");
+  BlockingAggIR* agg2 =
+      MakeBlockingAgg(rolling, {}, {{"latency_mean", MakeMeanFunc(MakeColumn("latency", 0))}});
+  MemorySinkIR* sink2 = MakeMemSink(agg2, "");
+  auto rolling_id = rolling->id();
+
+  MergeAggIntoRollingRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  // Each agg gets its own rolling, the original one is gone.
+  EXPECT_FALSE(graph->HasNode(rolling_id));
+  EXPECT_EQ(graph->FindNodesThatMatch(Rolling()).size(), 2);
+  ASSERT_MATCH(sink1->parents()[0], Rolling());
+  ASSERT_MATCH(sink2->parents()[0], Rolling());
+  EXPECT_NE(sink1->parents()[0], sink2->parents()[0]);
+  auto merged2 = static_cast<RollingIR*>(sink2->parents()[0]);
+  ASSERT_EQ(merged2->aggregate_expressions().size(), 1);
+  EXPECT_EQ(merged2->aggregate_expressions()[0].name, "latency_mean");
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
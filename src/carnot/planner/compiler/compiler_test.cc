@@ -2652,14 +2652,13 @@ TEST_F(CompilerTest, TestUnaryOperators) {
   ASSERT_OK(plan_status);
 }
 
-// ENABLE and modify these tests once we know where rolling is getting merged into
 constexpr char kRollingTimeStringQuery[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port'])
-t1 = t1.rolling('3s')
+t1 = t1.rolling('3s').agg(count=('remote_port', px.count))
 px.display(t1)
 )pxl";
-TEST_F(CompilerTest, DISABLED_RollingTimeStringQuery) {
+TEST_F(CompilerTest, RollingTimeStringQuery) {
   auto graph_or_s = compiler_.CompileToIR(kRollingTimeStringQuery, compiler_state_.get());
   ASSERT_OK(graph_or_s);
   auto graph = graph_or_s.ConsumeValueOrDie();
@@ -2673,17 +2672,17 @@ TEST_F(CompilerTest, DISABLED_RollingTimeStringQuery) {
   IntIR* window_size_int = static_cast<IntIR*>(rolling->window_size());
   ASSERT_EQ(window_size_int->val(),
             std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::seconds(3)).count());
-  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "remote_port"});
+  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "count"});
   EXPECT_THAT(*rolling->resolved_table_type(), IsTableType(rolling_relation));
 }
 
 constexpr char kRollingIntQuery[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port'])
-t1 = t1.rolling(3000)
+t1 = t1.rolling(3000).agg(count=('remote_port', px.count))
 px.display(t1)
 )pxl";
-TEST_F(CompilerTest, DISABLED_RollingIntQuery) {
+TEST_F(CompilerTest, RollingIntQuery) {
   auto graph_or_s = compiler_.CompileToIR(kRollingIntQuery, compiler_state_.get());
   ASSERT_OK(graph_or_s);
   auto graph = graph_or_s.ConsumeValueOrDie();
@@ -2696,17 +2695,17 @@ TEST_F(CompilerTest, DISABLED_RollingIntQuery) {
   ASSERT_MATCH(rolling->window_size(), Int());
   IntIR* window_size_int = static_cast<IntIR*>(rolling->window_size());
   ASSERT_EQ(window_size_int->val(), 3000);
-  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "remote_port"});
+  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "count"});
   EXPECT_THAT(*rolling->resolved_table_type(), IsTableType(rolling_relation));
 }
 
 constexpr char kRollingCompileTimeExprEvalQuery[] = R"pxl(
 import px
 t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port'])
-t1 = t1.rolling(1 + px.now())
+t1 = t1.rolling(1 + px.now()).agg(count=('remote_port', px.count))
 px.display(t1)
 )pxl";
-TEST_F(CompilerTest, DISABLED_RollingCompileTimeExprEvalQuery) {
+TEST_F(CompilerTest, RollingCompileTimeExprEvalQuery) {
   auto graph_or_s = compiler_.CompileToIR(kRollingCompileTimeExprEvalQuery, compiler_state_.get());
   ASSERT_OK(graph_or_s);
   auto graph = graph_or_s.ConsumeValueOrDie();
@@ -2719,8 +2718,50 @@ TEST_F(CompilerTest, DISABLED_RollingCompileTimeExprEvalQuery) {
   ASSERT_MATCH(rolling->window_size(), Int());
   IntIR* window_size_int = static_cast<IntIR*>(rolling->window_size());
   ASSERT_EQ(window_size_int->val(), compiler_state_->time_now().val + 1);
-  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "remote_port"});
+  Relation rolling_relation({types::TIME64NS, types::INT64}, {"time_", "count"});
+  EXPECT_THAT(*rolling->resolved_table_type(), IsTableType(rolling_relation));
+}
+
+constexpr char kRollingGroupByQuery[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port', 'resp_latency_ns'])
+t1 = t1.groupby('remote_port').rolling('3s').agg(latency=('resp_latency_ns', px.mean))
+px.display(t1)
+)pxl";
+TEST_F(CompilerTest, RollingGroupByQuery) {
+  auto graph_or_s = compiler_.CompileToIR(kRollingGroupByQuery, compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  std::vector<IRNode*> rolling_nodes = graph->FindNodesOfType(IRNodeType::kRolling);
+  ASSERT_EQ(rolling_nodes.size(), 1);
+  auto rolling = static_cast<RollingIR*>(rolling_nodes[0]);
+  EXPECT_EQ(graph->FindNodesOfType(IRNodeType::kBlockingAgg).size(), 0);
+
+  Relation rolling_relation({types::TIME64NS, types::INT64, types::FLOAT64},
+                            {"time_", "remote_port", "latency"});
   EXPECT_THAT(*rolling->resolved_table_type(), IsTableType(rolling_relation));
+
+  planpb::Operator op;
+  ASSERT_OK(rolling->ToProto(&op));
+  EXPECT_EQ(op.op_type(), planpb::ROLLING_OPERATOR);
+  EXPECT_EQ(op.rolling_op().window_size(), 3000000000);
+  EXPECT_EQ(op.rolling_op().allowed_lateness_ns(), 3000000000);
+  EXPECT_THAT(op.rolling_op().group_names(), ElementsAre("remote_port"));
+  EXPECT_THAT(op.rolling_op().value_names(), ElementsAre("latency"));
+}
+
+constexpr char kRollingWithoutAgg[] = R"pxl(
+import px
+t1 = px.DataFrame(table='http_events', select=['time_', 'remote_port'])
+t1 = t1.rolling('3s')
+px.display(t1)
+)pxl";
+TEST_F(CompilerTest, RollingWithoutAggUnsupported) {
+  auto graph_or_s = compiler_.CompileToIR(kRollingWithoutAgg, compiler_state_.get());
+  ASSERT_NOT_OK(graph_or_s);
+
+  EXPECT_THAT(graph_or_s.status(), HasCompilerError("rolling\\(\\) must be followed by an agg"));
 }
 
 constexpr char kRollingNonTimeColumn[] = R"pxl(
@@ -561,6 +561,11 @@ class OperatorTests : public ::testing::Test {
     return limit;
   }
 
+  SortIR* MakeSort(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+                   const std::vector<bool>& ascending, int64_t limit) {
+    return graph->CreateNode<SortIR>(ast, parent, sort_cols, ascending, limit).ConsumeValueOrDie();
+  }
+
   BlockingAggIR* MakeBlockingAgg(OperatorIR* parent, const std::vector<ColumnIR*>& columns,
                                  const ColExpressionVector& col_agg) {
     BlockingAggIR* agg =
@@ -94,6 +94,15 @@ struct PluginConfig {
   int64_t start_time_ns;
 };
 
+struct ResultCacheConfig {
+  // The buckets in [cached_start_ns, cached_end_ns) of every aggregate that caches its buckets
+  // were cached by an earlier run of the same script. Both are 0 if nothing is cached.
+  int64_t cached_start_ns = 0;
+  int64_t cached_end_ns = 0;
+  // How long after a bucket ends all of its rows are assumed to be in the tables.
+  int64_t allowed_lateness_ns = 0;
+};
+
 using RelationMap = std::unordered_map<std::string, table_store::schema::Relation>;
 using SensitiveColumnMap = absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>;
 class CompilerState : public NotCopyable {
@@ -163,6 +172,12 @@ class CompilerState : public NotCopyable {
   planpb::OTelEndpointConfig* endpoint_config() { return endpoint_config_.get(); }
   PluginConfig* plugin_config() { return plugin_config_.get(); }
 
+  // Null unless aggregates over time buckets should cache their closed buckets.
+  ResultCacheConfig* result_cache_config() { return result_cache_config_.get(); }
+  void set_result_cache_config(std::unique_ptr<ResultCacheConfig> config) {
+    result_cache_config_ = std::move(config);
+  }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
@@ -177,6 +192,7 @@ class CompilerState : public NotCopyable {
   RedactionOptions redaction_options_;
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
+  std::unique_ptr<ResultCacheConfig> result_cache_config_ = nullptr;
 };
 
 }  // namespace planner
@@ -44,6 +44,26 @@ StatusOr<OperatorIR*> LimitOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR
   return new_limit;
 }
 
+StatusOr<OperatorIR*> SortOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PL_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PL_RETURN_IF_ERROR(new_sort->CopyParentsFrom(sort));
+  // The merging sort needs the sort columns, even if they are pruned from the final output.
+  DCHECK(sort->parents()[0]->is_type_resolved());
+  PL_RETURN_IF_ERROR(new_sort->SetResolvedType(sort->parents()[0]->resolved_type()->Copy()));
+  return new_sort;
+}
+
+StatusOr<OperatorIR*> SortOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                           OperatorIR* op) const {
+  DCHECK(Matches(op));
+  SortIR* sort = static_cast<SortIR*>(op);
+  PL_ASSIGN_OR_RETURN(SortIR * new_sort, plan->CopyNode(sort));
+  PL_RETURN_IF_ERROR(new_sort->AddParent(new_parent));
+  return new_sort;
+}
+
 StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
   DCHECK(Matches(op));
   BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
@@ -87,6 +87,24 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief SortOperatorMgr splits a top-k (a sort with a limit) over the boundary. Each PEM keeps
+ * only its own top-k rows, so at most limit rows per PEM cross the network, and the Kelvin merges
+ * them with the same top-k. Sorts without a limit aren't split.
+ */
+class SortOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override {
+    if (!Match(op, Sort())) {
+      return false;
+    }
+    return static_cast<SortIR*>(op)->has_limit();
+  }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
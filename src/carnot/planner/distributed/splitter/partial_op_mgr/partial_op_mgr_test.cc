@@ -68,6 +68,44 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, topk_test) {
+  auto relation = MakeRelation();
+  auto mem_src = MakeMemSource("source", relation);
+  compiler_state_->relation_map()->emplace("source", relation);
+  auto topk = MakeSort(mem_src, {"cpu0"}, {false}, 10);
+  auto sort = MakeSort(mem_src, {"cpu0"}, {false}, 0);
+  MakeMemSink(topk, "out");
+  MakeMemSink(sort, "out2");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  SortOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(topk));
+  EXPECT_FALSE(mgr.Matches(sort));
+
+  auto prepare_sort_or_s = mgr.CreatePrepareOperator(graph.get(), topk);
+  ASSERT_OK(prepare_sort_or_s);
+  OperatorIR* prepare_sort_uncasted = prepare_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_sort_uncasted, Sort());
+  SortIR* prepare_sort = static_cast<SortIR*>(prepare_sort_uncasted);
+  EXPECT_EQ(prepare_sort->limit(), 10);
+  EXPECT_EQ(prepare_sort->sort_cols(), topk->sort_cols());
+  EXPECT_EQ(prepare_sort->ascending(), topk->ascending());
+  EXPECT_EQ(prepare_sort->parents(), topk->parents());
+  EXPECT_NE(prepare_sort, topk);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_sort_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, topk);
+  ASSERT_OK(merge_sort_or_s);
+  OperatorIR* merge_sort_uncasted = merge_sort_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_sort_uncasted, Sort());
+  SortIR* merge_sort = static_cast<SortIR*>(merge_sort_uncasted);
+  EXPECT_EQ(merge_sort->limit(), 10);
+  EXPECT_EQ(merge_sort->parents()[0], mem_src2);
+  EXPECT_NE(merge_sort, topk);
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
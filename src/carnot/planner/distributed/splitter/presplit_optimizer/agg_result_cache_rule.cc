@@ -0,0 +1,152 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/agg_result_cache_rule.h"
+
+#include <algorithm>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+constexpr char kTimeColumn[] = "time_";
+
+// The start of the bucket that holds time.
+int64_t BucketStart(int64_t time, int64_t bucket_size) {
+  return time - ((time % bucket_size) + bucket_size) % bucket_size;
+}
+
+// Returns the bucket size if expr is px.bin(time_, <size>), or 0 otherwise.
+int64_t TimeBucketSize(ExpressionIR* expr) {
+  if (!Match(expr, Func())) {
+    return 0;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  if (func->func_name() != "bin" || func->args().size() != 2 ||
+      !Match(func->args()[0], ColumnNode()) || !Match(func->args()[1], Int())) {
+    return 0;
+  }
+  if (static_cast<ColumnIR*>(func->args()[0])->col_name() != kTimeColumn) {
+    return 0;
+  }
+  return std::max<int64_t>(static_cast<IntIR*>(func->args()[1])->val(), 0);
+}
+
+}  // namespace
+
+StatusOr<bool> AggResultCacheRule::Apply(IRNode* ir_node) {
+  ResultCacheConfig* config = compiler_state_->result_cache_config();
+  if (config == nullptr || !Match(ir_node, BlockingAgg())) {
+    return false;
+  }
+  auto agg = static_cast<BlockingAggIR*>(ir_node);
+  if (agg->has_result_cache()) {
+    return false;
+  }
+
+  // The group columns that may still turn out to be the time bucket.
+  absl::flat_hash_map<std::string, int64_t> candidate_groups;
+  for (const auto& [idx, group] : Enumerate(agg->groups())) {
+    candidate_groups[group->col_name()] = idx;
+  }
+  int64_t bucket_group_index = -1;
+  int64_t bucket_size = 0;
+
+  // Walk up to the memory source. Every operator on the way must only feed this aggregate,
+  // otherwise narrowing the memory source would change the results of its other children.
+  OperatorIR* op = agg;
+  while (!Match(op, MemorySource())) {
+    if (op->parents().size() != 1) {
+      return false;
+    }
+    op = op->parents()[0];
+    if (op->Children().size() != 1) {
+      return false;
+    }
+    if (Match(op, Filter()) || Match(op, MemorySource())) {
+      continue;
+    }
+    if (!Match(op, Map())) {
+      return false;
+    }
+    for (const auto& col_expr : static_cast<MapIR*>(op)->col_exprs()) {
+      if (bucket_size > 0) {
+        // The bucket must have been computed from the memory source's time column.
+        if (col_expr.name == kTimeColumn &&
+            !(Match(col_expr.node, ColumnNode()) &&
+              static_cast<ColumnIR*>(col_expr.node)->col_name() == kTimeColumn)) {
+          return false;
+        }
+        continue;
+      }
+      auto it = candidate_groups.find(col_expr.name);
+      if (it == candidate_groups.end()) {
+        continue;
+      }
+      int64_t size = TimeBucketSize(col_expr.node);
+      if (size > 0) {
+        bucket_group_index = it->second;
+        bucket_size = size;
+      } else {
+        candidate_groups.erase(it);
+      }
+    }
+  }
+
+  auto mem_src = static_cast<MemorySourceIR*>(op);
+  if (bucket_size == 0 || !mem_src->IsTimeSet()) {
+    return false;
+  }
+
+  // Only the buckets that lie entirely inside the time range of the query are cached. The
+  // partial bucket at its start is read from the table on every run.
+  int64_t range_start = BucketStart(mem_src->time_start_ns(), bucket_size);
+  if (range_start < mem_src->time_start_ns()) {
+    range_start += bucket_size;
+  }
+  int64_t end = std::min(compiler_state_->time_now().val - config->allowed_lateness_ns,
+                         mem_src->time_stop_ns());
+  int64_t closed_before = std::max(BucketStart(end, bucket_size), range_start);
+  int64_t input_start = range_start;
+  if (config->cached_end_ns > range_start && config->cached_start_ns <= range_start) {
+    input_start = std::min(BucketStart(config->cached_end_ns, bucket_size), closed_before);
+  }
+
+  planpb::AggregateResultCache result_cache;
+  result_cache.set_bucket_group_index(bucket_group_index);
+  result_cache.set_bucket_size_ns(bucket_size);
+  result_cache.set_range_start_ns(range_start);
+  result_cache.set_input_start_ns(input_start);
+  result_cache.set_closed_before_ns(closed_before);
+  agg->SetResultCache(result_cache);
+  if (input_start > range_start) {
+    mem_src->SetSkippedTimeNS(range_start, input_start);
+  }
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief This rule makes blocking aggregates that group by px.bin(time_, <size>) cache the state
+ * of their closed buckets (see planpb::AggregateResultCache), when the compiler state has a
+ * result cache config.
+ *
+ * The aggregate's memory source then skips the buckets that are already cached, so that repeated
+ * runs of the same script only read the partial bucket at the start of the time range and the
+ * newest rows from the PEMs. Only aggregates whose memory source feeds nothing else, through maps
+ * and filters, are cached.
+ */
+class AggResultCacheRule : public Rule {
+ public:
+  explicit AggResultCacheRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+};
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/agg_result_cache_rule.h"
+#include "src/carnot/planner/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+using testing::proto::EqualsProto;
+
+class AggResultCacheRuleTest : public testutils::DistributedRulesTest {
+ protected:
+  // Builds source -> map(bucket = px.bin(time_, 100)) -> agg by bucket -> sink. The compiler
+  // state's time is 1234.
+  BlockingAggIR* MakeBucketAgg(MemorySourceIR* src, ExpressionIR* bucket_expr) {
+    src->SetTimeValuesNS(150, 1234);
+    MapIR* map = MakeMap(src, {{"bucket", bucket_expr}, {"latency", MakeColumn("latency", 0)}});
+    BlockingAggIR* agg = MakeBlockingAgg(map, {MakeColumn("bucket", 0)},
+                                         {{"mean", MakeMeanFunc(MakeColumn("latency", 0))}});
+    MakeMemSink(agg, "out");
+    return agg;
+  }
+
+  FuncIR* MakeBin(int64_t size) { return MakeFunc("bin", {MakeColumn("time_", 0), MakeInt(size)}); }
+
+  void SetConfig(int64_t cached_start_ns, int64_t cached_end_ns) {
+    compiler_state_->set_result_cache_config(std::unique_ptr<ResultCacheConfig>(
+        new ResultCacheConfig{cached_start_ns, cached_end_ns, /*allowed_lateness_ns*/ 30}));
+  }
+
+  Relation relation_{{types::TIME64NS, types::INT64}, {"time_", "latency"}};
+};
+
+TEST_F(AggResultCacheRuleTest, no_config) {
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+
+  AggResultCacheRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_result_cache());
+  EXPECT_EQ(150, src->time_start_ns());
+}
+
+TEST_F(AggResultCacheRuleTest, nothing_cached) {
+  SetConfig(0, 0);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+
+  AggResultCacheRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_TRUE(agg->has_result_cache());
+  EXPECT_THAT(agg->result_cache(), EqualsProto(R"pb(
+    bucket_group_index: 0
+    bucket_size_ns: 100
+    range_start_ns: 200
+    input_start_ns: 200
+    closed_before_ns: 1200
+  )pb"));
+  // The partial bucket at 100 is read, but never cached.
+  EXPECT_EQ(150, src->time_start_ns());
+  EXPECT_EQ(1234, src->time_stop_ns());
+  EXPECT_FALSE(src->HasSkippedTime());
+}
+
+TEST_F(AggResultCacheRuleTest, reads_around_cached_buckets) {
+  SetConfig(100, 1050);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+
+  AggResultCacheRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  ASSERT_TRUE(agg->has_result_cache());
+  EXPECT_EQ(200, agg->result_cache().range_start_ns());
+  EXPECT_EQ(1000, agg->result_cache().input_start_ns());
+  EXPECT_EQ(1200, agg->result_cache().closed_before_ns());
+  // The start of the query is kept, only the cached buckets are skipped.
+  EXPECT_EQ(150, src->time_start_ns());
+  EXPECT_EQ(1234, src->time_stop_ns());
+  ASSERT_TRUE(src->HasSkippedTime());
+  EXPECT_EQ(200, src->skip_start_ns());
+  EXPECT_EQ(1000, src->skip_stop_ns());
+}
+
+TEST_F(AggResultCacheRuleTest, start_on_bucket_boundary) {
+  SetConfig(100, 1050);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+  src->SetTimeValuesNS(300, 1234);
+
+  AggResultCacheRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  ASSERT_TRUE(agg->has_result_cache());
+  EXPECT_EQ(300, agg->result_cache().range_start_ns());
+  EXPECT_EQ(1000, agg->result_cache().input_start_ns());
+  EXPECT_EQ(300, src->time_start_ns());
+  ASSERT_TRUE(src->HasSkippedTime());
+  EXPECT_EQ(300, src->skip_start_ns());
+  EXPECT_EQ(1000, src->skip_stop_ns());
+}
+
+TEST_F(AggResultCacheRuleTest, cache_starts_after_range) {
+  // The buckets from 200 weren't cached, so the whole range is read.
+  SetConfig(300, 1000);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+
+  AggResultCacheRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  ASSERT_TRUE(agg->has_result_cache());
+  EXPECT_EQ(200, agg->result_cache().input_start_ns());
+  EXPECT_EQ(150, src->time_start_ns());
+  EXPECT_FALSE(src->HasSkippedTime());
+}
+
+TEST_F(AggResultCacheRuleTest, group_not_a_time_bucket) {
+  SetConfig(100, 1000);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeFunc("bin", {MakeColumn("latency", 0), MakeInt(100)}));
+
+  AggResultCacheRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_result_cache());
+  EXPECT_EQ(150, src->time_start_ns());
+}
+
+TEST_F(AggResultCacheRuleTest, source_with_other_children) {
+  SetConfig(100, 1000);
+  auto src = MakeMemSource("source", relation_);
+  auto agg = MakeBucketAgg(src, MakeBin(100));
+  MakeMemSink(src, "raw");
+
+  AggResultCacheRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_FALSE(agg->has_result_cache());
+  EXPECT_EQ(150, src->time_start_ns());
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/distributed/splitter/presplit_optimizer/agg_result_cache_rule.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/filter_push_down_rule.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/limit_push_down_rule.h"
 #include "src/carnot/planner/rules/rule_executor.h"
@@ -59,9 +60,16 @@ class PreSplitOptimizer : public RuleExecutor<IR> {
     filter_pushdown->AddRule<FilterPushdownRule>(compiler_state_);
   }
 
+  void CreateAggResultCacheBatch() {
+    // A single pass caches every aggregate that can be cached.
+    RuleBatch* agg_result_cache = CreateRuleBatch<TryUntilMax>("AggResultCache", 1);
+    agg_result_cache->AddRule<AggResultCacheRule>(compiler_state_);
+  }
+
   Status Init() {
     CreateLimitPushdownBatch();
     CreateFilterPushdownBatch();
+    CreateAggResultCacheBatch();
     return Status::OK();
   }
 
@@ -84,28 +84,6 @@ StatusOr<absl::flat_hash_set<std::string>> BlockingAggIR::PruneOutputColumnsToIm
   return kept_columns;
 }
 
-Status BlockingAggIR::EvaluateAggregateExpression(planpb::AggregateExpression* expr,
-                                                  const ExpressionIR& ir_node) const {
-  DCHECK(ir_node.type() == IRNodeType::kFunc);
-  auto casted_ir = static_cast<const FuncIR&>(ir_node);
-  expr->set_name(casted_ir.func_name());
-  expr->set_id(casted_ir.func_id());
-  for (types::DataType dt : casted_ir.registry_arg_types()) {
-    expr->add_args_data_types(dt);
-  }
-  for (auto ir_arg : casted_ir.args()) {
-    auto arg_pb = expr->add_args();
-    if (ir_arg->IsColumn()) {
-      PL_RETURN_IF_ERROR(static_cast<ColumnIR*>(ir_arg)->ToProto(arg_pb->mutable_column()));
-    } else if (ir_arg->IsData()) {
-      PL_RETURN_IF_ERROR(static_cast<DataIR*>(ir_arg)->ToProto(arg_pb->mutable_constant()));
-    } else {
-      return CreateIRNodeError("$0 is an invalid aggregate value", ir_arg->type_string());
-    }
-  }
-  return Status::OK();
-}
-
 Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   auto pb = op->mutable_agg_op();
   if (finalize_results_ && !partial_agg_) {
@@ -127,6 +105,9 @@ Status BlockingAggIR::ToProto(planpb::Operator* op) const {
   pb->set_windowed(false);
   pb->set_partial_agg(partial_agg_);
   pb->set_finalize_results(finalize_results_);
+  if (has_result_cache_ && finalize_results_) {
+    *pb->mutable_result_cache() = result_cache_;
+  }
 
   op->set_op_type(planpb::AGGREGATE_OPERATOR);
   return Status::OK();
@@ -155,6 +136,8 @@ Status BlockingAggIR::CopyFromNodeImpl(
   finalize_results_ = blocking_agg->finalize_results_;
   partial_agg_ = blocking_agg->partial_agg_;
   pre_split_proto_ = blocking_agg->pre_split_proto_;
+  has_result_cache_ = blocking_agg->has_result_cache_;
+  result_cache_ = blocking_agg->result_cache_;
 
   return Status::OK();
 }
@@ -49,8 +49,6 @@ class BlockingAggIR : public GroupAcceptorIR {
               const ColExpressionVector& agg_expr);
 
   Status ToProto(planpb::Operator*) const override;
-  Status EvaluateAggregateExpression(planpb::AggregateExpression* expr,
-                                     const ExpressionIR& ir_node) const;
 
   Status CopyFromNodeImpl(const IRNode* node,
                           absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
@@ -75,6 +73,15 @@ class BlockingAggIR : public GroupAcceptorIR {
     pre_split_proto_ = pre_split_proto;
   }
 
+  // Set when the aggregate caches the state of its closed time buckets. Only the aggregate that
+  // finalizes the results uses the cache.
+  bool has_result_cache() const { return has_result_cache_; }
+  const planpb::AggregateResultCache& result_cache() const { return result_cache_; }
+  void SetResultCache(const planpb::AggregateResultCache& result_cache) {
+    result_cache_ = result_cache;
+    has_result_cache_ = true;
+  }
+
  protected:
   StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
       const absl::flat_hash_set<std::string>& output_colnames) override;
@@ -87,6 +94,8 @@ class BlockingAggIR : public GroupAcceptorIR {
   // Whether this finalizes the result of a partial aggregate.
   bool finalize_results_ = true;
   planpb::AggregateOperator pre_split_proto_;
+  bool has_result_cache_ = false;
+  planpb::AggregateResultCache result_cache_;
 };
 }  // namespace planner
 }  // namespace carnot
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/group_acceptor_ir.h"
+#include "src/carnot/planner/ir/func_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status GroupAcceptorIR::EvaluateAggregateExpression(planpb::AggregateExpression* expr,
+                                                    const ExpressionIR& ir_node) const {
+  DCHECK(ir_node.type() == IRNodeType::kFunc);
+  auto casted_ir = static_cast<const FuncIR&>(ir_node);
+  expr->set_name(casted_ir.func_name());
+  expr->set_id(casted_ir.func_id());
+  for (types::DataType dt : casted_ir.registry_arg_types()) {
+    expr->add_args_data_types(dt);
+  }
+  for (auto ir_arg : casted_ir.args()) {
+    auto arg_pb = expr->add_args();
+    if (ir_arg->IsColumn()) {
+      PL_RETURN_IF_ERROR(static_cast<ColumnIR*>(ir_arg)->ToProto(arg_pb->mutable_column()));
+    } else if (ir_arg->IsData()) {
+      PL_RETURN_IF_ERROR(static_cast<DataIR*>(ir_arg)->ToProto(arg_pb->mutable_constant()));
+    } else {
+      return CreateIRNodeError("$0 is an invalid aggregate value", ir_arg->type_string());
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -53,6 +53,10 @@ class GroupAcceptorIR : public OperatorIR {
     return Status::OK();
   }
 
+  // Writes the aggregate function call ir_node into expr.
+  Status EvaluateAggregateExpression(planpb::AggregateExpression* expr,
+                                     const ExpressionIR& ir_node) const;
+
  private:
   std::vector<ColumnIR*> groups_;
 };
@@ -18,6 +18,11 @@
 
 #include "src/carnot/planner/ir/grpc_sink_ir.h"
 
+DEFINE_bool(planner_grpc_sink_packed_columns,
+            gflags::BoolFromEnv("PL_PLANNER_GRPC_SINK_PACKED_COLUMNS", false),
+            "Whether internal GRPC sinks send packed columns. Only enable once every Carnot "
+            "instance in the cluster can read them.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -62,6 +67,8 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
     return CreateIRNodeError("No agent ID '$0' found in grpc sink '$1'", agent_id, DebugString());
   }
   pb->set_grpc_source_id(agent_id_to_destination_id_.find(agent_id)->second);
+  // The destination is always another Carnot instance, but older ones can't read packed columns.
+  pb->set_packed_columns(FLAGS_planner_grpc_sink_packed_columns);
   return Status::OK();
 }
 
@@ -31,6 +31,8 @@
 #include "src/shared/metadatapb/metadata.pb.h"
 #include "src/shared/types/types.h"
 
+DECLARE_bool(planner_grpc_sink_packed_columns);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -1209,6 +1209,7 @@ constexpr char kExpectedInternalGRPCSinkPb[] = R"proto(
     connection_options {
       ssl_targetname: "$2"
     }
+    packed_columns: $3
   }
 )proto";
 
@@ -1227,7 +1228,15 @@ TEST_F(ToProtoTests, internal_grpc_sink_ir) {
   ASSERT_OK(grpc_sink->ToProto(&pb, agent_id));
 
   EXPECT_THAT(pb, EqualsProto(absl::Substitute(kExpectedInternalGRPCSinkPb, grpc_address,
-                                               destination_id + 1, ssl_targetname)));
+                                               destination_id + 1, ssl_targetname, "false")));
+
+  gflags::FlagSaver flag_saver;
+  FLAGS_planner_grpc_sink_packed_columns = true;
+  planpb::Operator packed_pb;
+  ASSERT_OK(grpc_sink->ToProto(&packed_pb, agent_id));
+
+  EXPECT_THAT(packed_pb, EqualsProto(absl::Substitute(kExpectedInternalGRPCSinkPb, grpc_address,
+                                                      destination_id + 1, ssl_targetname, "true")));
 }
 
 constexpr char kExpectedExternalGRPCSinkPb[] = R"proto(
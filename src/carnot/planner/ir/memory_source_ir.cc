@@ -55,6 +55,10 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
     stop_time->set_value(time_stop_ns_);
     pb->set_allocated_stop_time(stop_time);
   }
+  if (HasSkippedTime()) {
+    pb->mutable_skip_start_time()->set_value(skip_start_ns_);
+    pb->mutable_skip_stop_time()->set_value(skip_stop_ns_);
+  }
 
   if (HasTablet()) {
     pb->set_tablet(tablet_value());
@@ -130,6 +134,9 @@ Status MemorySourceIR::CopyFromNodeImpl(
   time_set_ = source_ir->time_set_;
   time_start_ns_ = source_ir->time_start_ns_;
   time_stop_ns_ = source_ir->time_stop_ns_;
+  skip_set_ = source_ir->skip_set_;
+  skip_start_ns_ = source_ir->skip_start_ns_;
+  skip_stop_ns_ = source_ir->skip_stop_ns_;
   column_names_ = source_ir->column_names_;
   column_index_map_set_ = source_ir->column_index_map_set_;
   column_index_map_ = source_ir->column_index_map_;
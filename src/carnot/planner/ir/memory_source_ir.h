@@ -86,6 +86,19 @@ class MemorySourceIR : public OperatorIR {
   int64_t time_start_ns() const { return time_start_ns_; }
   int64_t time_stop_ns() const { return time_stop_ns_; }
 
+  /**
+   * @brief Sets a time range, inside the time range of the memory source, whose rows aren't
+   * read because a downstream aggregate has their state cached.
+   */
+  void SetSkippedTimeNS(int64_t skip_start_ns, int64_t skip_stop_ns) {
+    skip_start_ns_ = skip_start_ns;
+    skip_stop_ns_ = skip_stop_ns;
+    skip_set_ = true;
+  }
+  bool HasSkippedTime() const { return skip_set_; }
+  int64_t skip_start_ns() const { return skip_start_ns_; }
+  int64_t skip_stop_ns() const { return skip_stop_ns_; }
+
   const std::vector<int64_t>& column_index_map() const { return column_index_map_; }
   bool column_index_map_set() const { return column_index_map_set_; }
   void SetColumnIndexMap(const std::vector<int64_t>& column_index_map) {
@@ -137,6 +150,10 @@ class MemorySourceIR : public OperatorIR {
   int64_t time_start_ns_ = 0;
   int64_t time_stop_ns_ = 0;
 
+  bool skip_set_ = false;
+  int64_t skip_start_ns_ = 0;
+  int64_t skip_stop_ns_ = 0;
+
   // Hold of columns in the order that they are selected.
   std::vector<std::string> column_names_;
 
@@ -158,6 +158,7 @@ inline ClassMatch<IRNodeType::kEmptySource> EmptySource() {
   return ClassMatch<IRNodeType::kEmptySource>();
 }
 inline ClassMatch<IRNodeType::kLimit> Limit() { return ClassMatch<IRNodeType::kLimit>(); }
+inline ClassMatch<IRNodeType::kSort> Sort() { return ClassMatch<IRNodeType::kSort>(); }
 
 inline ClassMatch<IRNodeType::kGRPCSource> GRPCSource() {
   return ClassMatch<IRNodeType::kGRPCSource>();
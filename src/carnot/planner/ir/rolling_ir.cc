@@ -17,6 +17,7 @@
  */
 
 #include "src/carnot/planner/ir/rolling_ir.h"
+#include "src/carnot/planner/ir/int_ir.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/ir/pattern_match.h"
 
@@ -69,20 +70,119 @@ Status RollingIR::CopyFromNodeImpl(const IRNode* source,
     PL_ASSIGN_OR_RETURN(ColumnIR * new_column, graph()->CopyNode(column, copied_nodes_map));
     new_groups.push_back(new_column);
   }
-  return SetGroups(new_groups);
+  PL_RETURN_IF_ERROR(SetGroups(new_groups));
+
+  ColExpressionVector new_agg_exprs;
+  for (const ColumnExpression& col_expr : rolling_node->aggregate_expressions_) {
+    PL_ASSIGN_OR_RETURN(ExpressionIR * new_node,
+                        graph()->CopyNode(col_expr.node, copied_nodes_map));
+    new_agg_exprs.push_back({col_expr.name, new_node});
+  }
+  PL_RETURN_IF_ERROR(SetAggExprs(new_agg_exprs));
+  has_merged_agg_ = rolling_node->has_merged_agg_;
+  return Status::OK();
 }
 
-Status RollingIR::ToProto(planpb::Operator* /* op */) const {
-  return CreateIRNodeError("Rolling operator not yet implemented");
+Status RollingIR::SetAggExprs(const ColExpressionVector& agg_exprs) {
+  auto old_agg_expressions = aggregate_expressions_;
+  for (const ColumnExpression& agg_expr : aggregate_expressions_) {
+    PL_RETURN_IF_ERROR(graph()->DeleteEdge(this, agg_expr.node));
+  }
+  aggregate_expressions_.clear();
+
+  for (const auto& agg_expr : agg_exprs) {
+    PL_ASSIGN_OR_RETURN(auto updated_expr, graph()->OptionallyCloneWithEdge(this, agg_expr.node));
+    aggregate_expressions_.emplace_back(agg_expr.name, updated_expr);
+  }
+
+  for (const auto& old_agg_expr : old_agg_expressions) {
+    PL_RETURN_IF_ERROR(graph()->DeleteOrphansInSubtree(old_agg_expr.node->id()));
+  }
+  has_merged_agg_ = true;
+  return Status::OK();
+}
+
+Status RollingIR::ToProto(planpb::Operator* op) const {
+  if (!Match(window_size_, Int())) {
+    return window_size_->CreateIRNodeError("Rolling window size must be an integer, got $0",
+                                           window_size_->type_string());
+  }
+  int64_t window_size = static_cast<IntIR*>(window_size_)->val();
+
+  auto pb = op->mutable_rolling_op();
+  PL_RETURN_IF_ERROR(window_col_->ToProto(pb->mutable_window_column()));
+  pb->set_window_size(window_size);
+  // The input of a rolling operator is the union of the PEM streams, which are only ordered per
+  // agent. One window of slack keeps the rows of a slower agent in the window they belong to.
+  pb->set_allowed_lateness_ns(window_size);
+  for (const auto& agg_expr : aggregate_expressions_) {
+    auto expr = pb->add_values();
+    PL_RETURN_IF_ERROR(EvaluateAggregateExpression(expr, *agg_expr.node));
+    pb->add_value_names(agg_expr.name);
+  }
+  for (ColumnIR* group : groups()) {
+    auto group_pb = pb->add_groups();
+    PL_RETURN_IF_ERROR(group->ToProto(group_pb));
+    pb->add_group_names(group->col_name());
+  }
+
+  op->set_op_type(planpb::ROLLING_OPERATOR);
+  return Status::OK();
 }
 
 StatusOr<std::vector<absl::flat_hash_set<std::string>>> RollingIR::RequiredInputColumns() const {
-  return error::Unimplemented("Rolling operator doesn't support RequiredInputColumns.");
+  absl::flat_hash_set<std::string> required{window_col_->col_name()};
+  for (const auto& group : groups()) {
+    required.insert(group->col_name());
+  }
+  for (const auto& agg_expr : aggregate_expressions_) {
+    PL_ASSIGN_OR_RETURN(auto ret, agg_expr.node->InputColumnNames());
+    required.insert(ret.begin(), ret.end());
+  }
+  return std::vector<absl::flat_hash_set<std::string>>{required};
 }
 
 StatusOr<absl::flat_hash_set<std::string>> RollingIR::PruneOutputColumnsToImpl(
-    const absl::flat_hash_set<std::string>& /* output_colnames */) {
-  return error::Unimplemented("Rolling operator doesn't support PruneOutputColumntTo.");
+    const absl::flat_hash_set<std::string>& output_colnames) {
+  absl::flat_hash_set<std::string> kept_columns = output_colnames;
+
+  ColExpressionVector new_aggs;
+  for (const auto& expr : aggregate_expressions_) {
+    if (output_colnames.contains(expr.name)) {
+      new_aggs.push_back(expr);
+    }
+  }
+  PL_RETURN_IF_ERROR(SetAggExprs(new_aggs));
+
+  // The window and group columns define the output rows, so they are always kept.
+  kept_columns.insert(window_col_->col_name());
+  for (const ColumnIR* group : groups()) {
+    kept_columns.insert(group->col_name());
+  }
+  return kept_columns;
+}
+
+Status RollingIR::ResolveType(CompilerState* compiler_state) {
+  DCHECK_EQ(1, parent_types().size());
+  if (!has_merged_agg_) {
+    return CreateIRNodeError("rolling() must be followed by an agg()");
+  }
+  auto new_table = TableType::Create();
+  PL_RETURN_IF_ERROR(ResolveExpressionType(window_col_, compiler_state, parent_types()));
+  if (window_col_->EvaluatedDataType() != types::TIME64NS) {
+    return window_col_->CreateIRNodeError("Rolling window column '$0' must be of type TIME64NS",
+                                          window_col_->col_name());
+  }
+  new_table->AddColumn(window_col_->col_name(), window_col_->resolved_type());
+  for (const auto& group_col : groups()) {
+    PL_RETURN_IF_ERROR(ResolveExpressionType(group_col, compiler_state, parent_types()));
+    new_table->AddColumn(group_col->col_name(), group_col->resolved_type());
+  }
+  for (const auto& col_expr : aggregate_expressions_) {
+    PL_RETURN_IF_ERROR(ResolveExpressionType(col_expr.node, compiler_state, parent_types()));
+    new_table->AddColumn(col_expr.name, col_expr.node->resolved_type());
+  }
+  return SetResolvedType(new_table);
 }
 }  // namespace planner
 }  // namespace carnot
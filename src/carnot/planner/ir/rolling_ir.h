@@ -30,6 +30,7 @@
 #include <vector>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/column_expression.h"
 #include "src/carnot/planner/ir/group_acceptor_ir.h"
 #include "src/carnot/planner/ir/operator_ir.h"
 #include "src/carnot/planner/types/types.h"
@@ -41,6 +42,13 @@ namespace px {
 namespace carnot {
 namespace planner {
 
+/**
+ * @brief The RollingIR is the IR representation for the Rolling operator.
+ *
+ * df.rolling() creates the node without aggregates. MergeAggIntoRollingRule later moves the
+ * groups and aggregate_expressions() of the agg that follows it into a new RollingIR, which is
+ * the only form that can be lowered to a planpb::RollingOperator.
+ */
 class RollingIR : public GroupAcceptorIR {
  public:
   RollingIR() = delete;
@@ -54,9 +62,20 @@ class RollingIR : public GroupAcceptorIR {
   Status CopyFromNodeImpl(const IRNode* source,
                           absl::flat_hash_map<const IRNode*, IRNode*>* copied_nodes_map) override;
 
+  // Windows are only meaningful over the data of every agent, so rolling runs after the PEM
+  // results have been merged.
+  inline bool IsBlocking() const override { return true; }
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
   Status ReplaceWindowSize(ExpressionIR* new_window_size);
 
+  Status SetAggExprs(const ColExpressionVector& agg_exprs);
+  ColExpressionVector aggregate_expressions() const { return aggregate_expressions_; }
+  // Whether the aggregate that follows df.rolling() has been merged into this node.
+  bool has_merged_agg() const { return has_merged_agg_; }
+
+  Status ResolveType(CompilerState* compiler_state);
+
  protected:
   StatusOr<absl::flat_hash_set<std::string>> PruneOutputColumnsToImpl(
       const absl::flat_hash_set<std::string>& kept_columns) override;
@@ -67,6 +86,9 @@ class RollingIR : public GroupAcceptorIR {
 
   ColumnIR* window_col_;
   ExpressionIR* window_size_;
+  // The map from value_names to values.
+  ColExpressionVector aggregate_expressions_;
+  bool has_merged_agg_ = false;
 };
 }  // namespace planner
 }  // namespace carnot
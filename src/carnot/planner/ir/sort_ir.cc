@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/sort_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status SortIR::Init(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+                    const std::vector<bool>& ascending, int64_t limit) {
+  if (sort_cols.empty()) {
+    return CreateIRNodeError("sort expects at least one column to sort by");
+  }
+  if (sort_cols.size() != ascending.size()) {
+    return CreateIRNodeError("sort expects one ascending value per column, got $0 for $1 columns",
+                             ascending.size(), sort_cols.size());
+  }
+  if (limit < 0) {
+    return CreateIRNodeError("sort limit must be non-negative, got $0", limit);
+  }
+  PL_RETURN_IF_ERROR(AddParent(parent));
+  sort_cols_ = sort_cols;
+  ascending_ = ascending;
+  limit_ = limit;
+  return Status::OK();
+}
+
+Status SortIR::ResolveType(CompilerState* /* compiler_state */) {
+  DCHECK_EQ(1U, parent_types().size());
+  auto parent_table_type = std::static_pointer_cast<TableType>(parent_types()[0]);
+  for (const auto& col_name : sort_cols_) {
+    if (!parent_table_type->HasColumn(col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", col_name);
+    }
+  }
+  return SetResolvedType(parent_types()[0]->Copy());
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> SortIR::RequiredInputColumns() const {
+  DCHECK(is_type_resolved());
+  absl::flat_hash_set<std::string> required(resolved_table_type()->ColumnNames().begin(),
+                                            resolved_table_type()->ColumnNames().end());
+  required.insert(sort_cols_.begin(), sort_cols_.end());
+  return std::vector<absl::flat_hash_set<std::string>>{required};
+}
+
+Status SortIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_sort_op();
+  op->set_op_type(planpb::SORT_OPERATOR);
+  DCHECK_EQ(parents().size(), 1UL);
+
+  DCHECK(parents()[0]->is_type_resolved());
+  auto parent_table_type = parents()[0]->resolved_table_type();
+  auto parent_id = parents()[0]->id();
+
+  for (const auto& [i, col_name] : Enumerate(sort_cols_)) {
+    planpb::Column* col_pb = pb->add_sort_columns();
+    col_pb->set_node(parent_id);
+    DCHECK(parent_table_type->HasColumn(col_name));
+    col_pb->set_index(parent_table_type->GetColumnIndex(col_name));
+    pb->add_ascending(ascending_[i]);
+  }
+
+  DCHECK(is_type_resolved());
+  for (const std::string& col_name : resolved_table_type()->ColumnNames()) {
+    planpb::Column* col_pb = pb->add_columns();
+    col_pb->set_node(parent_id);
+    DCHECK(parent_table_type->HasColumn(col_name));
+    col_pb->set_index(parent_table_type->GetColumnIndex(col_name));
+  }
+  pb->set_limit(limit_);
+  return Status::OK();
+}
+
+Status SortIR::CopyFromNodeImpl(const IRNode* node, absl::flat_hash_map<const IRNode*, IRNode*>*) {
+  const SortIR* sort = static_cast<const SortIR*>(node);
+  sort_cols_ = sort->sort_cols_;
+  ascending_ = sort->ascending_;
+  limit_ = sort->limit_;
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -88,13 +88,20 @@ StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
         new planner::PluginConfig{logical_state.plugin_config().start_time_ns()});
   }
   // Create a CompilerState obj using the relation map and grabbing the current time.
-  return std::make_unique<planner::CompilerState>(
+  auto compiler_state = std::make_unique<planner::CompilerState>(
       std::move(rel_map), sensitive_columns, registry_info, px::CurrentTimeNS(),
       max_output_rows_per_table, logical_state.result_address(),
       logical_state.result_ssl_targetname(),
       // TODO(philkuz) add an endpoint config to logical_state and pass that in here.
       RedactionOptionsFromPb(logical_state.redaction_options()), std::move(otel_endpoint_config),
       std::move(plugin_config));
+  if (logical_state.has_result_cache_config()) {
+    const auto& config = logical_state.result_cache_config();
+    compiler_state->set_result_cache_config(
+        std::unique_ptr<planner::ResultCacheConfig>(new planner::ResultCacheConfig{
+            config.cached_start_ns(), config.cached_end_ns(), config.allowed_lateness_ns()}));
+  }
+  return compiler_state;
 }
 
 StatusOr<std::unique_ptr<LogicalPlanner>> LogicalPlanner::Create(const udfspb::UDFInfo& udf_info) {
@@ -255,6 +255,30 @@ StatusOr<QLObjectPtr> LimitHandler(IR* graph, OperatorIR* op, const pypa::AstPtr
   return Dataframe::Create(limit_op, visitor);
 }
 
+// Handles the sort() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(IR* graph, OperatorIR* op, const pypa::AstPtr& ast,
+                                  const ParsedArgs& args, ASTVisitor* visitor) {
+  PL_ASSIGN_OR_RETURN(std::vector<std::string> sort_cols,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  PL_ASSIGN_OR_RETURN(std::vector<BoolIR*> ascending_irs,
+                      ParseAsListOf<BoolIR>(args.GetArg("ascending"), "ascending"));
+  PL_ASSIGN_OR_RETURN(IntIR * n, GetArgAs<IntIR>(ast, args, "n"));
+
+  std::vector<bool> ascending;
+  if (ascending_irs.size() == 1) {
+    // A single value applies to every sort column.
+    ascending.assign(sort_cols.size(), ascending_irs[0]->val());
+  } else {
+    for (BoolIR* ascending_ir : ascending_irs) {
+      ascending.push_back(ascending_ir->val());
+    }
+  }
+
+  PL_ASSIGN_OR_RETURN(SortIR * sort_op,
+                      graph->CreateNode<SortIR>(ast, op, sort_cols, ascending, n->val()));
+  return Dataframe::Create(sort_op, visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -484,6 +508,22 @@ Status Dataframe::Init() {
   PL_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort(self, by, ascending=True, n=0):
+   *     ...
+   */
+  PL_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(kSortOpID, {"by", "ascending", "n"}, {{"ascending", "True"}, {"n", "0"}},
+                         /* has_variable_len_args */ false,
+                         /* has_variable_len_kwargs */ false,
+                         std::bind(&SortHandler, graph(), op(), std::placeholders::_1,
+                                   std::placeholders::_2, std::placeholders::_3),
+                         ast_visitor()));
+  PL_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
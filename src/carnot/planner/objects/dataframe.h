@@ -275,6 +275,32 @@ class Dataframe : public QLObject {
     px.DataFrame: DataFrame with the first n rows.
   )doc";
 
+  inline static constexpr char kSortOpID[] = "sort";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sorts the rows by the given columns.
+
+  Returns a DataFrame with the rows ordered by the `by` columns, in order of precedence. Rows that
+  compare equal keep their input order. When n is set, only the first n rows are kept, which is
+  much cheaper than sorting everything and calling head() afterwards.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # The 10 slowest http requests.
+    df = df.sort('latency', ascending=False, n=10)
+
+  Args:
+    by (string, List[string]): The column(s) to sort by.
+    ascending (bool, List[bool]): Whether to sort in ascending order, either one value for all of
+      the columns or one value per column. Defaults to True.
+    n (int): The number of rows to keep. If not set, keeps all of the rows.
+
+  Returns:
+    px.DataFrame: DataFrame with the rows in sorted order.
+  )doc";
+
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
   Merges the input DataFrame with this one using a database-style join.
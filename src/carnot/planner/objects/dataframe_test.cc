@@ -232,6 +232,36 @@ TEST_F(DataframeTest, LimitNonIntArgument) {
               HasCompilerError("Expected arg 'n' as type 'Int', received 'String'"));
 }
 
+TEST_F(DataframeTest, CreateSort) {
+  ASSERT_OK(ParseScript(var_table, "sort = df.sort(['foo', 'bar'], ascending=[False, True])"));
+  auto var = var_table->Lookup("sort");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto sort_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(sort_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(sort_obj->op());
+  EXPECT_EQ(sort->sort_cols(), std::vector<std::string>({"foo", "bar"}));
+  EXPECT_EQ(sort->ascending(), std::vector<bool>({false, true}));
+  EXPECT_FALSE(sort->has_limit());
+}
+
+TEST_F(DataframeTest, CreateTopK) {
+  ASSERT_OK(ParseScript(var_table, "topk = df.sort('foo', ascending=False, n=10)"));
+  auto var = var_table->Lookup("topk");
+  auto sort_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(sort_obj->op(), Sort());
+  SortIR* sort = static_cast<SortIR*>(sort_obj->op());
+  EXPECT_EQ(sort->sort_cols(), std::vector<std::string>({"foo"}));
+  EXPECT_EQ(sort->ascending(), std::vector<bool>({false}));
+  EXPECT_EQ(sort->limit(), 10);
+}
+
+TEST_F(DataframeTest, SortMismatchedAscending) {
+  EXPECT_THAT(ParseScript(var_table, "df.sort(['foo', 'bar'], ascending=[True, False, True])"),
+              HasCompilerError("sort expects one ascending value per column, got 3 for 2 columns"));
+}
+
 TEST_F(DataframeTest, SubscriptFilterRows) {
   ASSERT_OK(ParseScript(var_table, "filter = df[df.service == 'blah']"));
   auto var = var_table->Lookup("filter");
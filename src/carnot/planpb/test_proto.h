@@ -324,6 +324,69 @@ columns {
 }
 )";
 
+constexpr char kSortOperator1[] = R"(
+sort_columns {
+  node: 1
+  index: 1
+}
+ascending: true
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 1
+}
+)";
+
+constexpr char kRollingOperator1[] = R"(
+window_column {
+  node: 6
+  index: 0
+}
+window_size: 10
+allowed_lateness_ns: 5
+values {
+  name: "testUda"
+  args {
+    constant {
+      data_type: BOOLEAN,
+      bool_value: false
+    }
+  }
+  args_data_types: BOOLEAN
+}
+groups {
+  node: 6
+  index: 1
+}
+group_names: "group1"
+value_names: "value1"
+)";
+
+constexpr char kTopKOperator1[] = R"(
+sort_columns {
+  node: 1
+  index: 1
+}
+sort_columns {
+  node: 1
+  index: 0
+}
+ascending: false
+ascending: true
+limit: 3
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 1
+}
+)";
+
 constexpr char kLimitDropOperator1[] = R"(
 limit: 10
 columns {
@@ -1470,6 +1533,30 @@ planpb::Operator CreateTestLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestSort1PB() {
+  planpb::Operator op;
+  auto op_proto =
+      absl::Substitute(kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op", kSortOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
+planpb::Operator CreateTestRolling1PB() {
+  planpb::Operator op;
+  auto op_proto =
+      absl::Substitute(kOperatorProtoTmpl, "ROLLING_OPERATOR", "rolling_op", kRollingOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
+planpb::Operator CreateTestTopK1PB() {
+  planpb::Operator op;
+  auto op_proto =
+      absl::Substitute(kOperatorProtoTmpl, "SORT_OPERATOR", "sort_op", kTopKOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestDropLimit1PB() {
   planpb::Operator op;
   auto op_proto =
@@ -29,7 +29,9 @@
 
 #include <absl/strings/str_format.h>
 #include "src/carnot/udf/udf.h"
+#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 
 namespace px {
@@ -87,10 +89,14 @@ class UDFTester {
    * Execute the UDF on the given arguments and store the result to be checked by Expect.
    * Arguments must be of a type that can usually be passed into the UDF's Exec function,
    * or else there will be an error.
+   * If the UDF implements ExecBatch, it is also run on the arguments and must agree with Exec.
    */
   template <typename... Args>
   UDFTester& ForInput(Args... args) {
     res_ = udf_.Exec(function_ctx_.get(), args...);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      ExpectExecBatchMatches(std::make_index_sequence<sizeof...(Args)>{}, args...);
+    }
 
     return *this;
   }
@@ -108,6 +114,28 @@ class UDFTester {
   typename types::DataTypeTraits<udf_data_type>::value_type Result() { return res_; }
 
  private:
+  template <std::size_t... I, typename... Args>
+  void ExpectExecBatchMatches(std::index_sequence<I...>, Args... args) {
+    constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+    std::vector<std::shared_ptr<arrow::Array>> inputs = {types::ToArrow(
+        std::vector<typename types::DataTypeTraits<exec_argument_types[I]>::value_type>{
+            typename types::DataTypeTraits<exec_argument_types[I]>::value_type(args)},
+        arrow::default_memory_pool())...};
+    std::vector<arrow::Array*> raw_inputs;
+    for (const auto& input : inputs) {
+      raw_inputs.push_back(input.get());
+    }
+
+    auto builder = types::MakeArrowBuilder(udf_data_type, arrow::default_memory_pool());
+    EXPECT_OK(ScalarUDFWrapper<TUDF>::ExecBatchArrow(&udf_, function_ctx_.get(), raw_inputs,
+                                                     builder.get(), 1));
+    std::shared_ptr<arrow::Array> out;
+    EXPECT_OK(builder->Finish(&out));
+    ASSERT_EQ(1, out->length());
+    internal::ExpectEquality(res_, typename types::DataTypeTraits<udf_data_type>::value_type(
+                                       types::GetValueFromArrowArray<udf_data_type>(out.get(), 0)));
+  }
+
   TUDF udf_;
   std::unique_ptr<udf::FunctionContext> function_ctx_ = nullptr;
   typename types::DataTypeTraits<udf_data_type>::value_type res_;
@@ -17,6 +17,7 @@
  */
 
 #pragma once
+#include <arrow/array.h>
 #include <arrow/builder.h>
 #include <arrow/type.h>
 
@@ -25,6 +26,8 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -74,6 +77,13 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * It may also implement a batch form of Exec:
+ *      Status ExecBatch(FunctionContext *ctx, const arrow::Array&... values,
+ *                       arrow::ArrayBuilder* out) {}
+ *  When present this is used instead of Exec to evaluate arrow batches. It takes one array per
+ *  Exec argument and must append exactly one value per input row to out, which is a builder of
+ *  the Exec return type. It should produce the same values as Exec.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -188,6 +198,51 @@ static constexpr types::DataType ReturnTypeHelper(ReturnType (TUDF::*)(Types...)
   return types::ValueTypeTraits<ReturnType>::data_type;
 }
 
+/**
+ * Checks to see if a valid looking ExecBatch function exists.
+ */
+template <typename ReturnType, typename TUDF, typename... Types>
+static constexpr bool IsValidExecBatchFn(ReturnType (TUDF::*)(Types...)) {
+  return false;
+}
+
+template <typename TUDF, typename... Types>
+static constexpr bool IsValidExecBatchFn(Status (TUDF::*)(FunctionContext*, Types...)) {
+  if constexpr (sizeof...(Types) < 2) {
+    return false;
+  } else {
+    using TOutput = std::tuple_element_t<sizeof...(Types) - 1, std::tuple<Types...>>;
+    constexpr size_t num_arrays =
+        (static_cast<size_t>(std::is_same_v<Types, const arrow::Array&>) + ...);
+    return std::is_same_v<TOutput, arrow::ArrayBuilder*> && num_arrays == sizeof...(Types) - 1;
+  }
+}
+
+template <typename ReturnType, typename TUDF, typename... Types>
+static constexpr size_t ExecBatchArity(ReturnType (TUDF::*)(FunctionContext*, Types...)) {
+  return sizeof...(Types) - 1;
+}
+
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {
+  static_assert(IsValidExecBatchFn(&T::ExecBatch),
+                "If an ExecBatch function exists, it must have the form: Status "
+                "ExecBatch(FunctionContext*, const arrow::Array&..., arrow::ArrayBuilder*)");
+};
+
+template <typename T, typename = void>
+struct check_exec_batch_fn {};
+
+template <typename T>
+struct check_exec_batch_fn<T, typename std::enable_if_t<has_udf_exec_batch_fn<T>::value>> {
+  static_assert(ExecBatchArity(&T::ExecBatch) == GetArgumentTypesHelper(&T::Exec).size(),
+                "ExecBatch must take one arrow::Array for each argument of Exec");
+};
+
 template <typename T, typename = void>
 struct check_init_fn {};
 
@@ -228,6 +283,12 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has a batch native ExecBatch function.
+   * @return true if it has an ExecBatch function.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
@@ -247,6 +308,7 @@ class ScalarUDFTraits {
    private:
     static constexpr check_init_fn<T> check_init_{};
     static constexpr check_executor_fn<T> check_executor_{};
+    static constexpr check_exec_batch_fn<T> check_exec_batch_{};
   } check_;
 };
 
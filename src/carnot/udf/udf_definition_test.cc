@@ -20,6 +20,8 @@
 #include <arrow/pretty_print.h>
 
 #include <algorithm>
+#include <string_view>
+#include <vector>
 
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/testing/testing.h"
@@ -51,6 +53,35 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class AddWithExecBatchUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  Status ExecBatch(FunctionContext*, const arrow::Array& v1, const arrow::Array& v2,
+                   arrow::ArrayBuilder* out) {
+    ++exec_batch_calls;
+    return ExecBatchElementwise<types::Int64Value>(
+        out, [](int64_t a, int64_t b) { return a + b; },
+        ArrowValueReader<types::Int64Value>(v1), ArrowValueReader<types::Int64Value>(v2));
+  }
+
+  int exec_batch_calls = 0;
+};
+
+class StrEqualWithExecBatchUDF : public ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::StringValue v1, types::StringValue v2) {
+    return v1 == v2;
+  }
+  Status ExecBatch(FunctionContext*, const arrow::Array& v1, const arrow::Array& v2,
+                   arrow::ArrayBuilder* out) {
+    return ExecBatchElementwise<types::BoolValue>(
+        out, [](std::string_view a, std::string_view b) { return a == b; },
+        ArrowValueReader<types::StringValue>(v1), ArrowValueReader<types::StringValue>(v2));
+  }
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -136,6 +167,55 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, arrow_write_exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  // Longer than a single ExecBatchElementwise chunk.
+  std::vector<types::Int64Value> v1(2500);
+  std::vector<types::Int64Value> v2(2500);
+  for (size_t i = 0; i < v1.size(); ++i) {
+    v1[i] = i;
+    v2[i] = 3 * i;
+  }
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  ScalarUDFDefinition def("add");
+  EXPECT_OK(def.Init<AddWithExecBatchUDF>());
+  auto u = def.Make();
+  auto output_builder = std::make_shared<arrow::Int64Builder>();
+  EXPECT_OK(def.ExecBatchArrow(u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(),
+                               v1.size()));
+  EXPECT_EQ(1, static_cast<AddWithExecBatchUDF*>(u.get())->exec_batch_calls);
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_OK(output_builder->Finish(&res));
+  ASSERT_EQ(2500, res->length());
+  auto* res_arr = static_cast<arrow::Int64Array*>(res.get());
+  EXPECT_EQ(0, res_arr->Value(0));
+  EXPECT_EQ(4096, res_arr->Value(1024));
+  EXPECT_EQ(9996, res_arr->Value(2499));
+}
+
+TEST(UDFDefinition, arrow_write_exec_batch_strings) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::StringValue> v1 = {"abc", "def", ""};
+  std::vector<types::StringValue> v2 = {"abc", "de", ""};
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto u = std::make_shared<StrEqualWithExecBatchUDF>();
+  auto output_builder = std::make_shared<arrow::BooleanBuilder>();
+  EXPECT_OK(ScalarUDFWrapper<StrEqualWithExecBatchUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 3));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_OK(output_builder->Finish(&res));
+  auto* res_arr = static_cast<arrow::BooleanArray*>(res.get());
+  EXPECT_TRUE(res_arr->Value(0));
+  EXPECT_FALSE(res_arr->Value(1));
+  EXPECT_TRUE(res_arr->Value(2));
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
@@ -19,6 +19,7 @@
 #include <benchmark/benchmark.h>
 
 #include <random>
+#include <string_view>
 #include <vector>
 
 #include "src/carnot/udf/registry.h"
@@ -31,11 +32,14 @@
 #include "src/shared/types/types.h"
 
 using px::Status;
+using px::carnot::udf::ArrowValueReader;
+using px::carnot::udf::ExecBatchElementwise;
 using px::carnot::udf::FunctionContext;
 using px::carnot::udf::ScalarUDF;
 using px::carnot::udf::ScalarUDFDefinition;
 using px::carnot::udf::ScalarUDFWrapper;
 using px::types::BaseValueType;
+using px::types::BoolValue;
 using px::types::Int64Value;
 using px::types::Int64ValueColumnWrapper;
 using px::types::StringValue;
@@ -57,6 +61,40 @@ class AddUDF : public ScalarUDF {
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
 };
 
+// AddUDF with the batch native interface.
+class AddBatchUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  Status ExecBatch(FunctionContext*, const arrow::Array& v1, const arrow::Array& v2,
+                   arrow::ArrayBuilder* out) {
+    return ExecBatchElementwise<Int64Value>(
+        out, [](int64_t a, int64_t b) { return a + b; }, ArrowValueReader<Int64Value>(v1),
+        ArrowValueReader<Int64Value>(v2));
+  }
+};
+
+class ContainsUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, StringValue v1, StringValue v2) {
+    return v1.find(v2) != std::string::npos;
+  }
+};
+
+// ContainsUDF with the batch native interface.
+class ContainsBatchUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, StringValue v1, StringValue v2) {
+    return v1.find(v2) != std::string::npos;
+  }
+  Status ExecBatch(FunctionContext*, const arrow::Array& v1, const arrow::Array& v2,
+                   arrow::ArrayBuilder* out) {
+    return ExecBatchElementwise<BoolValue>(
+        out,
+        [](std::string_view a, std::string_view b) { return a.find(b) != std::string_view::npos; },
+        ArrowValueReader<StringValue>(v1), ArrowValueReader<StringValue>(v2));
+  }
+};
+
 class SubStrUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue v1) { return v1.substr(1, 2); }
@@ -126,14 +164,16 @@ static void BM_SubStr(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * width * vec1.size());
 }
 
-// Benchmark adding two integers using arrow as the interface.
+// Benchmark adding two integers using arrow as the interface. AddUDF is executed one row at a
+// time, AddBatchUDF through its ExecBatch.
+template <typename TUDF>
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddTwoInt64sArrow(benchmark::State& state) {
   size_t size = state.range(0);
   auto arr1 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
   auto arr2 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
 
-  auto u = std::make_shared<AddUDF>();
+  auto u = std::make_shared<TUDF>();
   std::shared_ptr<arrow::Array> out;
   // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
   for (auto _ : state) {
@@ -141,8 +181,8 @@ static void BM_AddTwoInt64sArrow(benchmark::State& state) {
       out.reset();
     }
     auto output_builder = std::make_shared<arrow::Int64Builder>();
-    auto res = ScalarUDFWrapper<AddUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
-                                                        output_builder.get(), size);
+    auto res = ScalarUDFWrapper<TUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
+                                                      output_builder.get(), size);
     CHECK(res.ok());
     CHECK(output_builder->Finish(&out).ok());
     benchmark::DoNotOptimize(out);
@@ -159,6 +199,42 @@ static void BM_AddTwoInt64sArrow(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(int64_t) * 2 * size);
 }
 
+// Benchmark checking whether 10 char wide strings contain a 2 char string using arrow as the
+// interface. ContainsUDF is executed one row at a time, ContainsBatchUDF through its ExecBatch.
+template <typename TUDF>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ContainsArrow(benchmark::State& state) {
+  int width = 10;
+  size_t size = state.range(0);
+  auto data = GenerateStringValueVector(size, width);
+  auto needles = GenerateStringValueVector(size, 2);
+  auto arr1 = ToArrow(data, arrow::default_memory_pool());
+  auto arr2 = ToArrow(needles, arrow::default_memory_pool());
+
+  auto u = std::make_shared<TUDF>();
+  std::shared_ptr<arrow::Array> out;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    if (out) {
+      out.reset();
+    }
+    auto output_builder = std::make_shared<arrow::BooleanBuilder>();
+    auto res = ScalarUDFWrapper<TUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
+                                                      output_builder.get(), size);
+    CHECK(res.ok());
+    CHECK(output_builder->Finish(&out).ok());
+    benchmark::DoNotOptimize(out);
+  }
+
+  // Check results.
+  auto out_casted = static_cast<arrow::BooleanArray*>(out.get());
+  for (size_t idx = 0; idx < size; ++idx) {
+    CHECK((data[idx].find(needles[idx]) != std::string::npos) == out_casted->Value(idx));
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * (width + 2) * size);
+}
+
 // Benchmark converting Int64 to Arrow.
 // NOLINTNEXTLINE : runtime/references.
 static void BM_ConvertToArrowInt64(benchmark::State& state) {
@@ -245,11 +321,15 @@ static void BM_SubStrArrow(benchmark::State& state) {
 }
 
 BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
-BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, AddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, AddBatchUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
 
 BENCHMARK(BM_ConvertToArrowString)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
 
+BENCHMARK_TEMPLATE(BM_ContainsArrow, ContainsUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_ContainsArrow, ContainsBatchUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+
 BENCHMARK(BM_SubStrArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_SubStr)->RangeMultiplier(2)->Range(1, 1 << 16);
@@ -43,12 +43,40 @@ class ScalarUDF1WithInit : ScalarUDF {
   types::Int64Value Exec(FunctionContext*, types::BoolValue, types::BoolValue) { return 0; }
 };
 
+class ScalarUDF1WithExecBatch : ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::BoolValue, types::Int64Value) { return 0; }
+  Status ExecBatch(FunctionContext*, const arrow::Array&, const arrow::Array&,
+                   arrow::ArrayBuilder*) {
+    return Status::OK();
+  }
+};
+
+class UDFWithBadExecBatch {
+ public:
+  Status ExecBatch(FunctionContext*, const arrow::Array&, arrow::Array*) { return Status::OK(); }
+  Status ExecBatchNoOutput(FunctionContext*, const arrow::Array&) { return Status::OK(); }
+  types::Int64Value ExecBatchReturnsValue(FunctionContext*, const arrow::Array&,
+                                          arrow::ArrayBuilder*) {
+    return 0;
+  }
+};
+
 TEST(ScalarUDF, basic_tests) {
   EXPECT_EQ(types::DataType::INT64, ScalarUDFTraits<ScalarUDF1>::ReturnType());
   EXPECT_THAT(ScalarUDFTraits<ScalarUDF1>::ExecArguments(),
               ElementsAre(types::DataType::BOOLEAN, types::DataType::INT64));
   EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasInit());
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithExecBatch>::HasExecBatch());
+}
+
+TEST(ScalarUDF, exec_batch_fn) {
+  EXPECT_TRUE(IsValidExecBatchFn(&ScalarUDF1WithExecBatch::ExecBatch));
+  EXPECT_FALSE(IsValidExecBatchFn(&UDFWithBadExecBatch::ExecBatch));
+  EXPECT_FALSE(IsValidExecBatchFn(&UDFWithBadExecBatch::ExecBatchNoOutput));
+  EXPECT_FALSE(IsValidExecBatchFn(&UDFWithBadExecBatch::ExecBatchReturnsValue));
 }
 
 TEST(UDFDataTypes, valid_tests) {
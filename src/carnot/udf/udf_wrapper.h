@@ -20,8 +20,13 @@
 
 #include <arrow/array.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/udf/udf.h"
@@ -132,6 +137,105 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+/**
+ * This is the inner wrapper for UDFs that implement ExecBatch. It expands the input arrays
+ * and hands them, together with the output builder, to the UDF in a single call.
+ */
+template <typename TUDF, std::size_t... I>
+Status ExecBatchNativeWrapper(TUDF* udf, FunctionContext* ctx,
+                              const std::vector<arrow::Array*>& args, arrow::ArrayBuilder* out,
+                              std::index_sequence<I...>) {
+  return udf->ExecBatch(ctx, *args[I]..., out);
+}
+
+// The number of results ExecBatchElementwise computes before appending them to the builder.
+constexpr int64_t kExecBatchChunkRows = 1024;
+
+/**
+ * Provides indexed access to the values of an arrow array holding TValue's, for use in
+ * ExecBatch implementations. Fixed width values are read straight from the arrow buffer and
+ * strings are returned as string_views, so no per row copies are made.
+ *
+ * @tparam TValue The UDF value type of the array.
+ */
+template <typename TValue>
+class ArrowValueReader {
+  static constexpr types::DataType kDataType = types::ValueTypeTraits<TValue>::data_type;
+  static constexpr bool kHasRawValues =
+      kDataType == types::INT64 || kDataType == types::FLOAT64 || kDataType == types::TIME64NS;
+  using ArrayType = typename types::DataTypeTraits<kDataType>::arrow_array_type;
+  using NativeType = typename types::ValueTypeTraits<TValue>::native_type;
+
+ public:
+  explicit ArrowValueReader(const arrow::Array& arr) : arr_(static_cast<const ArrayType&>(arr)) {
+    if constexpr (kHasRawValues) {
+      raw_values_ = arr_.raw_values();
+    }
+  }
+
+  int64_t length() const { return arr_.length(); }
+
+  auto operator[](int64_t idx) const {
+    if constexpr (kHasRawValues) {
+      return raw_values_[idx];
+    } else if constexpr (kDataType == types::STRING) {
+      auto view = arr_.GetView(idx);
+      return std::string_view(view.data(), view.size());
+    } else if constexpr (kDataType == types::BOOLEAN) {
+      return arr_.Value(idx);
+    } else {
+      return TValue(types::GetValue(&arr_, idx)).val;
+    }
+  }
+
+ private:
+  const ArrayType& arr_;
+  const NativeType* raw_values_ = nullptr;
+};
+
+/**
+ * Evaluates fn on each row of the inputs and appends the results to output, which must be a
+ * builder for TReturn. Fixed width results are computed a chunk at a time into a local buffer
+ * and appended with a single call, which lets the compiler vectorize simple fns.
+ *
+ * @tparam TReturn The UDF value type of the result.
+ * @param output The output builder.
+ * @param fn Called with the native value (or string_view) of each input at a row.
+ * @param inputs ArrowValueReaders for each input, all of the same length.
+ * @return Status of execution.
+ */
+template <typename TReturn, typename TFn, typename... TReaders>
+Status ExecBatchElementwise(arrow::ArrayBuilder* output, TFn fn, const TReaders&... inputs) {
+  static_assert(sizeof...(TReaders) > 0, "ExecBatchElementwise needs at least one input");
+  constexpr types::DataType return_type = types::ValueTypeTraits<TReturn>::data_type;
+  static_assert(return_type != types::UINT128, "UINT128 results are not supported");
+  using TBuilder = typename types::DataTypeTraits<return_type>::arrow_builder_type;
+  auto* builder = static_cast<TBuilder*>(output);
+
+  const int64_t count = std::get<0>(std::forward_as_tuple(inputs...)).length();
+  PL_RETURN_IF_ERROR(builder->Reserve(count));
+  // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+  if constexpr (return_type == types::STRING) {
+    for (int64_t idx = 0; idx < count; ++idx) {
+      std::string_view res = fn(inputs[idx]...);
+      PL_RETURN_IF_ERROR(builder->Append(res.data(), static_cast<int32_t>(res.size())));
+    }
+  } else {
+    // Arrow takes booleans as one byte per value.
+    using TStored = std::conditional_t<return_type == types::BOOLEAN, uint8_t,
+                                       typename types::ValueTypeTraits<TReturn>::native_type>;
+    TStored chunk[kExecBatchChunkRows];
+    for (int64_t start = 0; start < count; start += kExecBatchChunkRows) {
+      const int64_t n = std::min(kExecBatchChunkRows, count - start);
+      for (int64_t i = 0; i < n; ++i) {
+        chunk[i] = static_cast<TStored>(fn(inputs[start + i]...));
+      }
+      PL_RETURN_IF_ERROR(builder->AppendValues(chunk, n));
+    }
+  }
+  return Status::OK();
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -177,6 +281,9 @@ struct ScalarUDFWrapper {
    * type. This function is unsafe and will perform unsafe casts and using an incorrect
    * type will result in a crash!
    *
+   * If the UDF implements ExecBatch the whole batch is passed to it, otherwise Exec is
+   * called once per row.
+   *
    * @note This function and underlying templates are fully expanded at compile time.
    *
    * @param udf a pointer to the UDF.
@@ -197,13 +304,19 @@ struct ScalarUDFWrapper {
     // Check that the arity is correct.
     DCHECK(inputs.size() == ScalarUDFTraits<TUDF>::ExecArguments().size());
 
-    // The outer wrapper just casts the output type and UDF type. We then pass in
-    // the inputs with a sequence based on the number of arguments to iterate through and
-    // cast the inputs.
-    return ExecWrapperArrow<TUDF>(
-        static_cast<TUDF*>(udf), ctx, count,
-        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
-        inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      DCHECK(inputs.empty() || inputs[0]->length() == count);
+      return ExecBatchNativeWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, inputs, output,
+                                          std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      // The outer wrapper just casts the output type and UDF type. We then pass in
+      // the inputs with a sequence based on the number of arguments to iterate through and
+      // cast the inputs.
+      return ExecWrapperArrow<TUDF>(
+          static_cast<TUDF*>(udf), ctx, count,
+          static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
+          inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/perf/perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <array>
+
+namespace px {
+
+namespace {
+
+constexpr std::array<uint64_t, 4> kEvents = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+/**
+ * The counters of the calling thread, opened as one perf event group so that they are read with
+ * a single syscall.
+ */
+class ThreadCounterGroup {
+ public:
+  ThreadCounterGroup() {
+    for (size_t i = 0; i < kEvents.size(); ++i) {
+      struct perf_event_attr attr = {};
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = kEvents[i];
+      attr.read_format =
+          PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      int group_fd = i == 0 ? -1 : fds_[0];
+      // pid 0 and cpu -1 count the calling thread on any CPU.
+      fds_[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+      if (fds_[i] < 0) {
+        VLOG(1) << "Hardware perf counters are not available on this thread.";
+        CloseAll();
+        return;
+      }
+    }
+    if (ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) < 0) {
+      CloseAll();
+    }
+  }
+
+  ~ThreadCounterGroup() { CloseAll(); }
+
+  bool ok() const { return fds_[0] >= 0; }
+
+  bool Read(PerfCounterValues* values, uint64_t* time_enabled, uint64_t* time_running) const {
+    if (!ok()) {
+      return false;
+    }
+    // With PERF_FORMAT_GROUP, the read returns the number of events and the times the group was
+    // enabled and running, followed by the values of the events.
+    struct {
+      uint64_t nr;
+      uint64_t time_enabled;
+      uint64_t time_running;
+      uint64_t values[kEvents.size()];
+    } data;
+    if (read(fds_[0], &data, sizeof(data)) != sizeof(data) || data.nr != kEvents.size()) {
+      return false;
+    }
+    values->cycles = data.values[0];
+    values->instructions = data.values[1];
+    values->cache_misses = data.values[2];
+    values->branch_misses = data.values[3];
+    *time_enabled = data.time_enabled;
+    *time_running = data.time_running;
+    return true;
+  }
+
+ private:
+  void CloseAll() {
+    for (int& fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+      fd = -1;
+    }
+  }
+
+  std::array<int, kEvents.size()> fds_ = {-1, -1, -1, -1};
+};
+
+ThreadCounterGroup& CurrentThreadCounters() {
+  thread_local ThreadCounterGroup counters;
+  return counters;
+}
+
+uint64_t Scale(uint64_t count, double ratio) {
+  return static_cast<uint64_t>(static_cast<double>(count) * ratio);
+}
+
+}  // namespace
+
+bool PerfCounters::Available() { return CurrentThreadCounters().ok(); }
+
+void PerfCounters::Resume() {
+  DCHECK(!running_) << "Counters already running";
+  running_ = CurrentThreadCounters().Read(&start_, &start_time_enabled_, &start_time_running_);
+}
+
+void PerfCounters::Stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+  PerfCounterValues end;
+  uint64_t time_enabled = 0;
+  uint64_t time_running = 0;
+  if (!CurrentThreadCounters().Read(&end, &time_enabled, &time_running)) {
+    return;
+  }
+  PerfCounterValues diff = end - start_;
+  uint64_t enabled = time_enabled - start_time_enabled_;
+  uint64_t counting = time_running - start_time_running_;
+  if (counting < enabled) {
+    // The counters only counted for part of the interval, so extrapolate the counts to the whole
+    // interval. If they didn't count at all, there is nothing to extrapolate from.
+    double ratio = counting == 0 ? 0 : static_cast<double>(enabled) / counting;
+    diff.cycles = Scale(diff.cycles, ratio);
+    diff.instructions = Scale(diff.instructions, ratio);
+    diff.cache_misses = Scale(diff.cache_misses, ratio);
+    diff.branch_misses = Scale(diff.branch_misses, ratio);
+    diff.multiplexed = true;
+  }
+  values_ += diff;
+}
+
+}  // namespace px
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "src/common/base/base.h"
+
+namespace px {
+
+/**
+ * Hardware event counts of a thread, as read from perf_event_open. Only user space events are
+ * counted, so that it works with the default perf_event_paranoid setting.
+ */
+struct PerfCounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t cache_misses = 0;
+  uint64_t branch_misses = 0;
+  // Whether the kernel multiplexed the counters with other events while they were counting, in
+  // which case the counts are scaled estimates rather than exact counts.
+  bool multiplexed = false;
+
+  PerfCounterValues& operator+=(const PerfCounterValues& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cache_misses += other.cache_misses;
+    branch_misses += other.branch_misses;
+    multiplexed |= other.multiplexed;
+    return *this;
+  }
+  // The difference saturates at 0, since the counts of a node's children can exceed the node's
+  // own counts when the counters are scaled or the thread migrates between CPUs.
+  PerfCounterValues operator-(const PerfCounterValues& other) const {
+    PerfCounterValues diff;
+    diff.cycles = SaturatingSub(cycles, other.cycles);
+    diff.instructions = SaturatingSub(instructions, other.instructions);
+    diff.cache_misses = SaturatingSub(cache_misses, other.cache_misses);
+    diff.branch_misses = SaturatingSub(branch_misses, other.branch_misses);
+    diff.multiplexed = multiplexed || other.multiplexed;
+    return diff;
+  }
+
+ private:
+  static uint64_t SaturatingSub(uint64_t a, uint64_t b) { return a > b ? a - b : 0; }
+};
+
+/**
+ * Hardware event counter that can be started and stopped, like ElapsedTimer.
+ *
+ * The events are counted on the calling thread, so Resume and Stop must be called on the same
+ * thread. The counters of each thread are opened the first time they are used. If that fails,
+ * e.g. because perf events are disallowed in the container, Available() returns false and the
+ * counts stay at 0. When the kernel multiplexes the counters, the counts are scaled by the time
+ * they were enabled over the time they were counting, and marked as multiplexed.
+ */
+class PerfCounters : public NotCopyable {
+ public:
+  /**
+   * @return whether the hardware counters can be read on the calling thread.
+   */
+  static bool Available();
+
+  /**
+   * Resume counting.
+   */
+  void Resume();
+
+  /**
+   * Stop counting, and add the events since the last Resume to the counts.
+   */
+  void Stop();
+
+  /**
+   * Reset the counts.
+   */
+  void Reset() {
+    running_ = false;
+    values_ = PerfCounterValues();
+  }
+
+  /**
+   * @return the events counted while running.
+   */
+  const PerfCounterValues& values() const { return values_; }
+
+ private:
+  bool running_ = false;
+  PerfCounterValues start_;
+  // The time the counters were enabled and actually counting at the last Resume, used to scale
+  // the counts when they are multiplexed.
+  uint64_t start_time_enabled_ = 0;
+  uint64_t start_time_running_ = 0;
+  PerfCounterValues values_;
+};
+
+}  // namespace px
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/common/perf/perf_counters.h"
+
+namespace px {
+
+namespace {
+
+uint64_t Spin(int n) {
+  volatile uint64_t sum = 0;
+  for (int i = 0; i < n; ++i) {
+    sum = sum + i;
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST(perf_counters, counts_while_running) {
+  PerfCounters counters;
+  counters.Resume();
+  Spin(100000);
+  counters.Stop();
+  uint64_t instructions = counters.values().instructions;
+
+  // Nothing is counted while stopped.
+  Spin(100000);
+  EXPECT_EQ(instructions, counters.values().instructions);
+
+  if (!PerfCounters::Available()) {
+    // The counters can't be opened in some sandboxes, in which case they stay at 0.
+    EXPECT_EQ(0U, instructions);
+    return;
+  }
+  EXPECT_GT(instructions, 100000U);
+  EXPECT_GT(counters.values().cycles, 0U);
+
+  counters.Resume();
+  Spin(100000);
+  counters.Stop();
+  EXPECT_GT(counters.values().instructions, instructions);
+
+  counters.Reset();
+  EXPECT_EQ(0U, counters.values().instructions);
+}
+
+TEST(perf_counters, difference_saturates_at_zero) {
+  PerfCounterValues total;
+  total.cycles = 100;
+  total.instructions = 50;
+  PerfCounterValues children;
+  children.cycles = 40;
+  children.instructions = 60;
+  children.multiplexed = true;
+
+  PerfCounterValues self = total - children;
+  EXPECT_EQ(60U, self.cycles);
+  EXPECT_EQ(0U, self.instructions);
+  EXPECT_TRUE(self.multiplexed);
+}
+
+}  // namespace px
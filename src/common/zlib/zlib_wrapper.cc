@@ -60,5 +60,36 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+StatusOr<std::string> Deflate(std::string_view in, int level) {
+  z_stream zs = {};
+
+  if (deflateInit2(&zs, level, Z_DEFLATED, MAX_WBITS + 16, /* memLevel */ 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    return error::Internal("deflateInit2 failed while compressing.");
+  }
+
+  // Setup input buffer.
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+
+  // deflateBound gives an upper bound on the compressed size, so a single call to deflate suffices.
+  std::string out;
+  out.resize(deflateBound(&zs, in.size()));
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = out.size();
+
+  int ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+
+  deflateEnd(&zs);
+
+  if (ret != Z_STREAM_END) {
+    return error::Internal("Exception during zlib compression: $0",
+                           zs.msg == nullptr ? "unknown error" : zs.msg);
+  }
+
+  return out;
+}
+
 }  // namespace zlib
 }  // namespace px
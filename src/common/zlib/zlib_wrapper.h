@@ -35,5 +35,16 @@ namespace zlib {
  */
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
 
+/**
+ * @brief Deflates (gzip) a source buffer and returns the compressed content as a string. The output
+ * can be decompressed with Inflate().
+ *
+ * @param in A view into the source buffer.
+ * @param level The zlib compression level, from 1 (fastest) to 9 (smallest output). -1 selects the
+ *        zlib default.
+ * @return Status or the compressed content as a string.
+ */
+StatusOr<std::string> Deflate(std::string_view in, int level = -1);
+
 }  // namespace zlib
 }  // namespace px
@@ -46,4 +46,17 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+TEST_F(ZlibTest, deflate_inflate_test) {
+  std::string input;
+  for (int i = 0; i < 1000; ++i) {
+    input += GetExpectedResult();
+  }
+  ASSERT_OK_AND_ASSIGN(std::string compressed, px::zlib::Deflate(input));
+  EXPECT_LT(compressed.size(), input.size());
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), input);
+
+  ASSERT_OK_AND_ASSIGN(compressed, px::zlib::Deflate(""));
+  EXPECT_OK_AND_EQ(px::zlib::Inflate(compressed), "");
+}
+
 }  // namespace px
@@ -270,6 +270,60 @@ inline SharedColumnWrapper ColumnWrapper::Make(DataType data_type, size_t size)
 #undef TYPE_CASE
 }
 
+namespace internal {
+
+/**
+ * An arrow::Buffer that points into the values of a ColumnWrapper, and keeps the column alive for
+ * as long as the buffer is referenced.
+ */
+class ColumnWrapperBuffer : public arrow::Buffer {
+ public:
+  ColumnWrapperBuffer(SharedColumnWrapper col, const uint8_t* data, int64_t size)
+      : arrow::Buffer(data, size), col_(std::move(col)) {}
+
+ private:
+  SharedColumnWrapper col_;
+};
+
+template <DataType TDataType>
+inline std::shared_ptr<arrow::Array> ShareFixedSizeColumnAsArrow(
+    const SharedColumnWrapper& col, std::shared_ptr<arrow::DataType> arrow_type) {
+  using ValueType = typename DataTypeTraits<TDataType>::value_type;
+  using NativeType = typename DataTypeTraits<TDataType>::native_type;
+  // The values are only shared if they're laid out exactly like the arrow values.
+  static_assert(sizeof(ValueType) == sizeof(NativeType));
+  const auto* data = static_cast<const ValueType*>(col->UnsafeRawData());
+  auto buffer = std::make_shared<ColumnWrapperBuffer>(
+      col, reinterpret_cast<const uint8_t*>(data), col->Size() * sizeof(ValueType));
+  return arrow::MakeArray(arrow::ArrayData::Make(std::move(arrow_type), col->Size(),
+                                                 {nullptr, std::move(buffer)}, /*null_count*/ 0));
+}
+
+}  // namespace internal
+
+/**
+ * Converts a column to arrow. Unlike ConvertToArrow, INT64, FLOAT64 and TIME64NS values aren't
+ * copied: the array points into the column and holds a reference to it, so the column must not be
+ * modified afterwards. Other types are copied with ConvertToArrow.
+ * @param col the column to convert.
+ * @param mem_pool the memory pool to allocate copied arrays from.
+ * @return the arrow array.
+ */
+inline std::shared_ptr<arrow::Array> ShareColumnAsArrow(const SharedColumnWrapper& col,
+                                                        arrow::MemoryPool* mem_pool) {
+  switch (col->data_type()) {
+    case DataType::INT64:
+      return internal::ShareFixedSizeColumnAsArrow<DataType::INT64>(col, arrow::int64());
+    case DataType::FLOAT64:
+      return internal::ShareFixedSizeColumnAsArrow<DataType::FLOAT64>(col, arrow::float64());
+    case DataType::TIME64NS:
+      return internal::ShareFixedSizeColumnAsArrow<DataType::TIME64NS>(
+          col, arrow::time64(arrow::TimeUnit::NANO));
+    default:
+      return col->ConvertToArrow(mem_pool);
+  }
+}
+
 template <class TValueType>
 inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
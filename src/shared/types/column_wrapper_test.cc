@@ -283,5 +283,31 @@ TEST(ColumnWrapperTest, MoveIndexes) {
   }
 }
 
+TEST(ColumnWrapper, ShareColumnAsArrow) {
+  std::shared_ptr<arrow::Array> shared_arr;
+  const BaseValueType* col_data = nullptr;
+  {
+    auto col = ColumnWrapper::Make(DataType::TIME64NS, 0);
+    col->AppendFromVector(std::vector<Time64NSValue>{5, 8, 1});
+    col_data = col->UnsafeRawData();
+    shared_arr = ShareColumnAsArrow(col, arrow::default_memory_pool());
+  }
+  // The array points into the column, which it keeps alive.
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(col_data), shared_arr->data()->buffers[1]->data());
+  EXPECT_TRUE(shared_arr->Equals(
+      ToArrow(std::vector<Time64NSValue>{5, 8, 1}, arrow::default_memory_pool())));
+
+  auto float_col = ColumnWrapper::Make(DataType::FLOAT64, 0);
+  float_col->AppendFromVector(std::vector<Float64Value>{1.5, -2});
+  EXPECT_TRUE(ShareColumnAsArrow(float_col, arrow::default_memory_pool())
+                  ->Equals(float_col->ConvertToArrow(arrow::default_memory_pool())));
+
+  // Strings are copied.
+  auto string_col = ColumnWrapper::Make(DataType::STRING, 0);
+  string_col->AppendFromVector(std::vector<StringValue>{"abc", "de"});
+  EXPECT_TRUE(ShareColumnAsArrow(string_col, arrow::default_memory_pool())
+                  ->Equals(string_col->ConvertToArrow(arrow::default_memory_pool())));
+}
+
 }  // namespace types
 }  // namespace px
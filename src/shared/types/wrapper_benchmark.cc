@@ -22,6 +22,7 @@
 #include <vector>
 #include "src/common/benchmark/benchmark.h"
 #include "src/common/datagen/datagen.h"
+#include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 
 using px::types::Int64Value;
@@ -65,3 +66,24 @@ static void BM_Int64Vector(benchmark::State& state) {  // NOLINT
 
 BENCHMARK_TEMPLATE(BM_Int64Vector, int64_t)->Arg(10000);
 BENCHMARK_TEMPLATE(BM_Int64Vector, Int64Value)->Arg(10000);
+
+static void BM_ColumnWrapperConvertToArrow(benchmark::State& state) {  // NOLINT
+  auto col = px::types::ColumnWrapper::Make(px::types::DataType::INT64, state.range(0));
+  for (auto _ : state) {
+    auto arr = col->ConvertToArrow(arrow::default_memory_pool());
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * col->Bytes());
+}
+
+static void BM_ColumnWrapperShareAsArrow(benchmark::State& state) {  // NOLINT
+  auto col = px::types::ColumnWrapper::Make(px::types::DataType::INT64, state.range(0));
+  for (auto _ : state) {
+    auto arr = px::types::ShareColumnAsArrow(col, arrow::default_memory_pool());
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * col->Bytes());
+}
+
+BENCHMARK(BM_ColumnWrapperConvertToArrow)->Arg(10000);
+BENCHMARK(BM_ColumnWrapperShareAsArrow)->Arg(10000);
@@ -18,6 +18,7 @@
 
 #include <arrow/array.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -120,13 +121,15 @@ constexpr const auto& GetPBDataColumn(const table_store::schemapb::Column& data_
 }
 
 template <DataType T>
-void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column) {
+void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column,
+                      const std::vector<int64_t>* selection) {
   CHECK_NOTNULL(input_column);
   CHECK_NOTNULL(output_column);
 
-  size_t col_length = input_column->length();
+  size_t col_length = selection == nullptr ? input_column->length() : selection->size();
   auto casted_output_data = GetMutablePBDataColumn<T>(output_column);
-  for (size_t i = 0; i < col_length; ++i) {
+  for (size_t row = 0; row < col_length; ++row) {
+    int64_t i = selection == nullptr ? row : (*selection)[row];
     if constexpr (T == DataType::UINT128) {
       auto out_datum = casted_output_data->add_data();
       auto val = types::GetValueFromArrowArray<DataType::UINT128>(input_column, i);
@@ -144,7 +147,7 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
   CHECK_NOTNULL(output_column);
 
   auto builder = MakeArrowBuilder(T, arrow::default_memory_pool());
-  auto input_data = GetPBDataColumn<T>(input_column);
+  const auto& input_data = GetPBDataColumn<T>(input_column);
   PL_RETURN_IF_ERROR(builder->Reserve(input_data.data_size()));
 
   for (const auto& datum : input_data.data()) {
@@ -158,8 +161,138 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
   return Status::OK();
 }
 
+// PL_CARNOT_UPDATE_FOR_NEW_TYPES
+template <DataType T>
+void CopyIntoPackedPB(table_store::schemapb::PackedColumn* output_column,
+                      const arrow::Array* input_column, const std::vector<int64_t>* selection) {
+  CHECK_NOTNULL(input_column);
+  CHECK_NOTNULL(output_column);
+
+  output_column->set_data_type(T);
+  int64_t num_rows = selection == nullptr ? input_column->length() : selection->size();
+  auto row_at = [selection](int64_t row) { return selection == nullptr ? row : (*selection)[row]; };
+  std::string* data = output_column->mutable_data();
+
+  if constexpr (T == DataType::STRING) {
+    const auto* str_arr = static_cast<const arrow::StringArray*>(input_column);
+    std::string* offsets = output_column->mutable_offsets();
+    offsets->resize((num_rows + 1) * sizeof(int32_t));
+    int32_t offset = 0;
+    std::memcpy(offsets->data(), &offset, sizeof(int32_t));
+    if (selection == nullptr && num_rows > 0) {
+      // The strings of a dense column are already contiguous, so they're copied at once.
+      int32_t begin = str_arr->value_offset(0);
+      data->assign(reinterpret_cast<const char*>(str_arr->value_data()->data()) + begin,
+                   str_arr->value_offset(num_rows) - begin);
+      for (int64_t row = 0; row < num_rows; ++row) {
+        offset = str_arr->value_offset(row + 1) - begin;
+        std::memcpy(offsets->data() + (row + 1) * sizeof(int32_t), &offset, sizeof(int32_t));
+      }
+      return;
+    }
+    for (int64_t row = 0; row < num_rows; ++row) {
+      auto value = types::GetStringViewFromArrowArray(input_column, row_at(row));
+      data->append(value.data(), value.size());
+      offset = data->size();
+      std::memcpy(offsets->data() + (row + 1) * sizeof(int32_t), &offset, sizeof(int32_t));
+    }
+  } else if constexpr (T == DataType::BOOLEAN) {
+    data->resize(num_rows);
+    for (int64_t row = 0; row < num_rows; ++row) {
+      (*data)[row] = types::GetValueFromArrowArray<T>(input_column, row_at(row)) ? 1 : 0;
+    }
+  } else if constexpr (T == DataType::UINT128) {
+    data->resize(num_rows * 2 * sizeof(uint64_t));
+    for (int64_t row = 0; row < num_rows; ++row) {
+      auto val = types::GetValueFromArrowArray<T>(input_column, row_at(row));
+      uint64_t words[2] = {absl::Uint128Low64(val), absl::Uint128High64(val)};
+      std::memcpy(data->data() + row * sizeof(words), words, sizeof(words));
+    }
+  } else {
+    using NativeType = typename types::DataTypeTraits<T>::native_type;
+    using ArrayType = typename types::DataTypeTraits<T>::arrow_array_type;
+    const auto* values = static_cast<const ArrayType*>(input_column)->raw_values();
+    if (selection == nullptr) {
+      data->assign(reinterpret_cast<const char*>(values), num_rows * sizeof(NativeType));
+      return;
+    }
+    data->resize(num_rows * sizeof(NativeType));
+    for (int64_t row = 0; row < num_rows; ++row) {
+      std::memcpy(data->data() + row * sizeof(NativeType), &values[(*selection)[row]],
+                  sizeof(NativeType));
+    }
+  }
+}
+
+// The number of bytes each value of a fixed width type takes in a PackedColumn.
+template <DataType T>
+constexpr size_t PackedValueWidth() {
+  if constexpr (T == DataType::BOOLEAN) {
+    return 1;
+  } else if constexpr (T == DataType::UINT128) {
+    return 2 * sizeof(uint64_t);
+  } else {
+    return sizeof(typename types::DataTypeTraits<T>::native_type);
+  }
+}
+
+template <DataType T>
+Status CopyFromPackedPB(std::shared_ptr<arrow::Array>* output_column,
+                        const table_store::schemapb::PackedColumn& input_column,
+                        int64_t num_rows) {
+  CHECK_NOTNULL(output_column);
+
+  const std::string& data = input_column.data();
+  auto builder = MakeArrowBuilder(T, arrow::default_memory_pool());
+  PL_RETURN_IF_ERROR(builder->Reserve(num_rows));
+
+  if constexpr (T == DataType::STRING) {
+    const std::string& offsets = input_column.offsets();
+    if (offsets.size() != (num_rows + 1) * sizeof(int32_t)) {
+      return error::InvalidArgument("Packed string column has $0 bytes of offsets for $1 rows",
+                                    offsets.size(), num_rows);
+    }
+    auto* typed_builder = static_cast<arrow::StringBuilder*>(builder.get());
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(data.size()));
+    int32_t begin = 0;
+    std::memcpy(&begin, offsets.data(), sizeof(int32_t));
+    for (int64_t row = 0; row < num_rows; ++row) {
+      int32_t end = 0;
+      std::memcpy(&end, offsets.data() + (row + 1) * sizeof(int32_t), sizeof(int32_t));
+      if (begin < 0 || end < begin || static_cast<size_t>(end) > data.size()) {
+        return error::InvalidArgument("Packed string column has invalid offsets [$0, $1)", begin,
+                                      end);
+      }
+      PL_RETURN_IF_ERROR(typed_builder->Append(data.data() + begin, end - begin));
+      begin = end;
+    }
+  } else {
+    constexpr size_t kWidth = PackedValueWidth<T>();
+    if (data.size() != num_rows * kWidth) {
+      return error::InvalidArgument("Packed column has $0 bytes for $1 rows of $2 bytes",
+                                    data.size(), num_rows, kWidth);
+    }
+    for (int64_t row = 0; row < num_rows; ++row) {
+      const char* value = data.data() + row * kWidth;
+      if constexpr (T == DataType::BOOLEAN) {
+        PL_RETURN_IF_ERROR(CopyValue<T>(builder.get(), *value != 0));
+      } else if constexpr (T == DataType::UINT128) {
+        uint64_t words[2];
+        std::memcpy(words, value, sizeof(words));
+        PL_RETURN_IF_ERROR(CopyValue<T>(builder.get(), absl::MakeUint128(words[1], words[0])));
+      } else {
+        typename types::DataTypeTraits<T>::native_type native_value;
+        std::memcpy(&native_value, value, kWidth);
+        PL_RETURN_IF_ERROR(CopyValue<T>(builder.get(), native_value));
+      }
+    }
+  }
+  PL_RETURN_IF_ERROR(builder->Finish(output_column));
+  return Status::OK();
+}
+
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
-  proto->set_num_rows(num_rows_);
+  proto->set_num_rows(num_selected_rows());
   proto->set_eow(eow_);
   proto->set_eos(eos_);
 
@@ -168,7 +301,7 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
     auto output_col_data = proto->add_cols();
     auto dt = desc_.type(col_idx);
 
-#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col);
+#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col, selection_.get());
     PL_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
   }
@@ -176,6 +309,23 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
   return Status::OK();
 }
 
+Status RowBatch::ToPackedProto(table_store::schemapb::RowBatchData* proto) const {
+  proto->set_num_rows(num_selected_rows());
+  proto->set_eow(eow_);
+  proto->set_eos(eos_);
+
+  for (auto col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    auto input_col = ColumnAt(col_idx).get();
+    auto output_col_data = proto->add_cols()->mutable_packed_data();
+
+#define TYPE_CASE(_dt_) CopyIntoPackedPB<_dt_>(output_col_data, input_col, selection_.get());
+    PL_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  return Status::OK();
+}
+
 // PL_CARNOT_UPDATE_FOR_NEW_TYPES
 StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
   switch (proto.col_data_case()) {
@@ -191,6 +341,19 @@ StatusOr<DataType> ProtoDataType(const table_store::schemapb::Column& proto) {
       return DataType::FLOAT64;
     case table_store::schemapb::Column::kStringData:
       return DataType::STRING;
+    case table_store::schemapb::Column::kPackedData:
+      switch (proto.packed_data().data_type()) {
+        case DataType::BOOLEAN:
+        case DataType::INT64:
+        case DataType::UINT128:
+        case DataType::TIME64NS:
+        case DataType::FLOAT64:
+        case DataType::STRING:
+          return proto.packed_data().data_type();
+        default:
+          return error::Internal("Received unknown packed column data type '$0'",
+                                 magic_enum::enum_name(proto.packed_data().data_type()));
+      }
     default:
       return error::Internal("Received unknown column data type '$0' in ProtoDataType",
                              magic_enum::enum_name(proto.col_data_case()));
@@ -206,6 +369,14 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::FromProto(
     PL_ASSIGN_OR_RETURN(types[i], ProtoDataType(proto.cols(i)));
     std::shared_ptr<arrow::Array> output_array;
 
+    if (proto.cols(i).has_packed_data()) {
+#define TYPE_CASE(_dt_)                                                         \
+  PL_RETURN_IF_ERROR(CopyFromPackedPB<_dt_>(&data_columns[i], proto.cols(i).packed_data(), \
+                                            proto.num_rows()));
+      PL_SWITCH_FOREACH_DATATYPE(types[i], TYPE_CASE);
+#undef TYPE_CASE
+      continue;
+    }
 #define TYPE_CASE(_dt_) PL_RETURN_IF_ERROR(CopyFromInputPB<_dt_>(&data_columns[i], proto.cols(i)));
     PL_SWITCH_FOREACH_DATATYPE(types[i], TYPE_CASE);
 #undef TYPE_CASE
@@ -253,6 +424,7 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::WithZeroRows(const RowDescriptor&
 }
 
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t length) const {
+  DCHECK(!has_selection()) << "Materialize a row batch with a selection before slicing it";
   if (offset + length > num_rows() || offset < 0) {
     return error::InvalidArgument("Slice(offset=$0, length=$1) on rowbatch of length $2 is invalid",
                                   offset, length, num_rows());
@@ -265,6 +437,39 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
   return output_rb;
 }
 
+template <DataType T>
+Status CopySelectedValues(const arrow::Array* input_col, const std::vector<int64_t>& selection,
+                          arrow::MemoryPool* mem_pool, std::shared_ptr<arrow::Array>* output_col) {
+  auto builder = MakeArrowBuilder(T, mem_pool);
+  PL_RETURN_IF_ERROR(builder->Reserve(selection.size()));
+  for (int64_t row : selection) {
+    PL_RETURN_IF_ERROR(
+        CopyValue<T>(builder.get(), types::GetValueFromArrowArray<T>(input_col, row)));
+  }
+  PL_RETURN_IF_ERROR(builder->Finish(output_col));
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Materialize(arrow::MemoryPool* mem_pool) const {
+  auto output_rb = std::make_unique<RowBatch>(desc(), num_selected_rows());
+  for (int64_t col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    if (!has_selection()) {
+      PL_RETURN_IF_ERROR(output_rb->AddColumn(ColumnAt(col_idx)));
+      continue;
+    }
+    std::shared_ptr<arrow::Array> output_col;
+#define TYPE_CASE(_dt_)                                                                       \
+  PL_RETURN_IF_ERROR(CopySelectedValues<_dt_>(ColumnAt(col_idx).get(), *selection_, mem_pool, \
+                                              &output_col));
+    PL_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+  }
+  output_rb->set_eow(eow_);
+  output_rb->set_eos(eos_);
+  return output_rb;
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <arrow/array.h>
+#include <arrow/memory_pool.h>
 #include <arrow/type.h>
 #include <map>
 #include <memory>
@@ -50,6 +51,11 @@ class RowBatch {
   }
 
   Status ToProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
+  /**
+   * Serializes the row batch with PackedColumn columns, which hold the contiguous bytes of each
+   * column's values instead of a repeated field entry per value. FromProto reads both encodings.
+   */
+  Status ToPackedProto(table_store::schemapb::RowBatchData* row_batch_proto) const;
   static StatusOr<std::unique_ptr<RowBatch>> FromProto(
       const table_store::schemapb::RowBatchData& row_batch_proto);
 
@@ -76,6 +82,33 @@ class RowBatch {
    */
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
+  /**
+   * Restricts the row batch to a subset of its rows without copying the columns. The columns keep
+   * all num_rows() rows, but only the rows in the selection belong to the row batch. The
+   * selection holds row indices in increasing order, without duplicates.
+   *
+   * Only operators that accept selections may be sent a row batch that has one (see
+   * ExecNode::AcceptsSelection), everything else expects dense columns.
+   */
+  void set_selection(std::shared_ptr<const std::vector<int64_t>> selection) {
+    selection_ = std::move(selection);
+  }
+  bool has_selection() const { return selection_ != nullptr; }
+  const std::shared_ptr<const std::vector<int64_t>>& selection() const { return selection_; }
+
+  /**
+   * @ return the number of rows that belong to the row batch, after applying the selection.
+   */
+  int64_t num_selected_rows() const {
+    return has_selection() ? static_cast<int64_t>(selection_->size()) : num_rows_;
+  }
+
+  /**
+   * Copies the selected rows into new columns.
+   * @ return a row batch with the same rows and no selection.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Materialize(arrow::MemoryPool* mem_pool) const;
+
   /**
    * Adds the given column to the row batch, given that it correctly fits the schema.
    * param col ptr to the arrow array that should be added to the row batch.
@@ -126,6 +159,8 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+  // The rows that belong to the row batch, or nullptr if all of them do.
+  std::shared_ptr<const std::vector<int64_t>> selection_;
 };
 
 // Append a scalar value to an arrow::Array.
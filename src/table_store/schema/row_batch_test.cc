@@ -19,6 +19,7 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <memory>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -179,6 +180,52 @@ TEST_F(RowBatchTest, to_from_proto) {
   EXPECT_TRUE(differ.Compare(input_proto, output_proto));
 }
 
+TEST_F(RowBatchTest, to_from_packed_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  auto rb = RowBatch::FromProto(input_proto).ConsumeValueOrDie();
+
+  table_store::schemapb::RowBatchData packed_proto;
+  EXPECT_OK(rb->ToPackedProto(&packed_proto));
+  EXPECT_EQ(3, packed_proto.cols_size());
+  EXPECT_TRUE(packed_proto.cols(2).has_packed_data());
+
+  auto packed_rb = RowBatch::FromProto(packed_proto).ConsumeValueOrDie();
+  EXPECT_TRUE(packed_rb->eow());
+  EXPECT_FALSE(packed_rb->eos());
+  table_store::schemapb::RowBatchData output_proto;
+  EXPECT_OK(packed_rb->ToProto(&output_proto));
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(input_proto, output_proto));
+
+  // Slices only pack their own rows.
+  ASSERT_OK_AND_ASSIGN(auto sliced_rb, rb->Slice(1, 2));
+  table_store::schemapb::RowBatchData sliced_proto;
+  EXPECT_OK(sliced_rb->ToPackedProto(&sliced_proto));
+  auto unpacked_slice = RowBatch::FromProto(sliced_proto).ConsumeValueOrDie();
+  EXPECT_EQ(sliced_rb->DebugString(), unpacked_slice->DebugString());
+}
+
+TEST_F(RowBatchTest, packed_proto_selection) {
+  rb_->set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+  ASSERT_OK_AND_ASSIGN(auto dense_rb, rb_->Materialize(arrow::default_memory_pool()));
+
+  table_store::schemapb::RowBatchData packed_proto;
+  EXPECT_OK(rb_->ToPackedProto(&packed_proto));
+  auto unpacked_rb = RowBatch::FromProto(packed_proto).ConsumeValueOrDie();
+  EXPECT_EQ(2, unpacked_rb->num_rows());
+  EXPECT_EQ(dense_rb->DebugString(), unpacked_rb->DebugString());
+}
+
+TEST_F(RowBatchTest, packed_proto_size_mismatch) {
+  table_store::schemapb::RowBatchData packed_proto;
+  EXPECT_OK(rb_->ToPackedProto(&packed_proto));
+  packed_proto.mutable_cols(1)->mutable_packed_data()->mutable_data()->resize(5);
+  auto rb_or_error = RowBatch::FromProto(packed_proto);
+  ASSERT_NOT_OK(rb_or_error);
+  EXPECT_EQ("Packed column has 5 bytes for 3 rows of 8 bytes", rb_or_error.msg());
+}
+
 TEST_F(RowBatchTest, with_zero_rows) {
   bool eow = true;
   bool eos = false;
@@ -231,6 +278,31 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, selection) {
+  rb_->set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+  rb_->set_eow(true);
+  EXPECT_TRUE(rb_->has_selection());
+  EXPECT_EQ(3, rb_->num_rows());
+  EXPECT_EQ(2, rb_->num_selected_rows());
+
+  ASSERT_OK_AND_ASSIGN(auto dense_rb, rb_->Materialize(arrow::default_memory_pool()));
+  EXPECT_FALSE(dense_rb->has_selection());
+  EXPECT_EQ(2, dense_rb->num_rows());
+  EXPECT_TRUE(dense_rb->eow());
+  EXPECT_EQ(
+      "RowBatch(eow=1, eos=0):\n  [\n  true,\n  true\n]\n  [\n  3,\n  5\n]\n  [\n  "
+      "3.3,\n  5.6\n]\n",
+      dense_rb->DebugString());
+
+  // Only the selected rows are serialized.
+  table_store::schemapb::RowBatchData selected_proto;
+  EXPECT_OK(rb_->ToProto(&selected_proto));
+  table_store::schemapb::RowBatchData dense_proto;
+  EXPECT_OK(dense_rb->ToProto(&dense_proto));
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(dense_proto, selected_proto));
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
@@ -15,6 +15,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -153,9 +154,18 @@ void BatchSizeAccountant::ExpireHotBatch() {
   }
 }
 
-void BatchSizeAccountant::ExpireColdBatch() {
-  cold_bytes_ -= cold_batch_bytes_.front();
+uint64_t BatchSizeAccountant::ExpireColdBatch() {
+  auto bytes = cold_batch_bytes_.front();
+  cold_bytes_ -= bytes;
   cold_batch_bytes_.pop_front();
+  return bytes;
+}
+
+void BatchSizeAccountant::ShrinkColdBatch(size_t cold_batch_idx, uint64_t bytes) {
+  DCHECK_LT(cold_batch_idx, cold_batch_bytes_.size());
+  bytes = std::min(bytes, cold_batch_bytes_[cold_batch_idx]);
+  cold_batch_bytes_[cold_batch_idx] -= bytes;
+  cold_bytes_ -= bytes;
 }
 
 bool BatchSizeAccountant::CompactedBatchReady() const {
@@ -170,13 +180,18 @@ const BatchSizeAccountant::CompactedBatchSpec& BatchSizeAccountant::GetNextCompa
 }
 
 uint64_t BatchSizeAccountant::FinishCompactedBatch() {
+  DCHECK(CompactedBatchReady());
+  return FinishCompactedBatch(compacted_batch_specs_.front().bytes);
+}
+
+uint64_t BatchSizeAccountant::FinishCompactedBatch(uint64_t cold_batch_bytes) {
   DCHECK(CompactedBatchReady());
   auto spec = std::move(compacted_batch_specs_.front());
   compacted_batch_specs_.pop_front();
 
   hot_bytes_ -= spec.bytes;
-  cold_bytes_ += spec.bytes;
-  cold_batch_bytes_.push_back(spec.bytes);
+  cold_bytes_ += cold_batch_bytes;
+  cold_batch_bytes_.push_back(cold_batch_bytes);
 
   if (spec.hot_slices.back().last_slice_for_batch) {
     // If the last slice in the compacted batch was the last slice for the corresponding hot batch,
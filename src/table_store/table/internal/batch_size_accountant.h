@@ -111,8 +111,17 @@ class BatchSizeAccountant {
   /**
    * ExpireColdBatch notifies the BatchSizeAccountant that a cold batch is being expired, and so it
    * should update its accounting accordingly.
+   * @return the number of bytes the expired batch was accounted for.
    */
-  void ExpireColdBatch();
+  uint64_t ExpireColdBatch();
+  /**
+   * ShrinkColdBatch notifies the BatchSizeAccountant that a cold batch now takes up fewer bytes
+   * than when it was compacted (eg. because it was frozen), and so it should update its accounting
+   * accordingly.
+   * @param cold_batch_idx Index of the batch in the cold store, relative to the first cold batch.
+   * @param bytes Number of bytes by which the batch shrunk. A batch never shrinks below 0 bytes.
+   */
+  void ShrinkColdBatch(size_t cold_batch_idx, uint64_t bytes);
   /**
    * CompactedBatchReady returns whether there is enough data in the hot store to create a full
    * compacted batch.
@@ -134,6 +143,14 @@ class BatchSizeAccountant {
    * into the cold store via CompactedBatchSpec.
    */
   uint64_t FinishCompactedBatch();
+  /**
+   * Same as FinishCompactedBatch() above, but accounts the compacted batch in the cold store as
+   * `cold_batch_bytes` instead of the size of its hot slices. This should be used when the cold
+   * representation of the batch is smaller than the hot one (eg. due to dictionary encoding).
+   * @param cold_batch_bytes Size in bytes of the compacted batch in the cold store.
+   * @return Number of rows to remove from the front of the hot store.
+   */
+  uint64_t FinishCompactedBatch(uint64_t cold_batch_bytes);
   /**
    * @return the number of bytes stored in the hot store.
    */
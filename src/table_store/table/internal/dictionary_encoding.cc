@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+StatusOr<int64_t> MaybeDictionaryEncodeColumn(int64_t col_idx, arrow::MemoryPool* mem_pool,
+                                              ColdBatch* batch) {
+  const arrow::Array* arr = batch->columns[col_idx].get();
+  const int64_t arr_length = arr->length();
+  DCHECK_EQ(arr->type_id(), arrow::Type::STRING);
+  DCHECK(!batch->IsDictionaryEncoded(col_idx));
+
+  absl::flat_hash_map<std::string_view, int16_t> codes_by_value;
+  std::vector<std::string_view> dictionary_values;
+  int64_t data_bytes = 0;
+  int64_t dictionary_data_bytes = 0;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      continue;
+    }
+    auto value = types::GetStringViewFromArrowArray(arr, i);
+    data_bytes += value.size();
+    if (codes_by_value.contains(value)) {
+      continue;
+    }
+    if (static_cast<int64_t>(dictionary_values.size()) >= kMaxDictionarySize) {
+      return 0;
+    }
+    codes_by_value.emplace(value, dictionary_values.size());
+    dictionary_values.push_back(value);
+    dictionary_data_bytes += value.size();
+  }
+
+  int64_t plain_bytes = data_bytes + arr->length() * sizeof(uint32_t);
+  int64_t encoded_bytes = arr->length() * sizeof(int16_t) + dictionary_data_bytes +
+                          dictionary_values.size() * sizeof(uint32_t);
+  if (encoded_bytes >= plain_bytes) {
+    return 0;
+  }
+
+  arrow::StringBuilder dictionary_builder(mem_pool);
+  PL_RETURN_IF_ERROR(dictionary_builder.Reserve(dictionary_values.size()));
+  PL_RETURN_IF_ERROR(dictionary_builder.ReserveData(dictionary_data_bytes));
+  for (const auto& value : dictionary_values) {
+    dictionary_builder.UnsafeAppend(value.data(), value.size());
+  }
+
+  arrow::Int16Builder codes_builder(mem_pool);
+  PL_RETURN_IF_ERROR(codes_builder.Reserve(arr->length()));
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      PL_RETURN_IF_ERROR(codes_builder.AppendNull());
+      continue;
+    }
+    codes_builder.UnsafeAppend(codes_by_value[types::GetStringViewFromArrowArray(arr, i)]);
+  }
+
+  ArrowArrayPtr dictionary;
+  PL_RETURN_IF_ERROR(dictionary_builder.Finish(&dictionary));
+  ArrowArrayPtr codes;
+  PL_RETURN_IF_ERROR(codes_builder.Finish(&codes));
+
+  // The dictionary values are views into the plain column, so it can only be released now.
+  batch->columns[col_idx] = std::move(codes);
+  batch->dictionaries[col_idx] = std::move(dictionary);
+
+  // BatchSizeAccountant charges the per-row offsets of a STRING column as a fixed cost that it
+  // never gives back, so only the string data it charged can be saved. The codes and the
+  // dictionary replace that data.
+  int64_t accounted_encoded_bytes =
+      arr_length * static_cast<int64_t>(sizeof(int16_t)) + dictionary_data_bytes;
+  return std::max<int64_t>(0, data_bytes - accounted_encoded_bytes);
+}
+
+StatusOr<ArrowArrayPtr> DecodeDictionarySlice(const arrow::Array* codes,
+                                              const arrow::Array* dictionary, int64_t offset,
+                                              int64_t length, arrow::MemoryPool* mem_pool) {
+  DCHECK_EQ(codes->type_id(), arrow::Type::INT16);
+  DCHECK_EQ(dictionary->type_id(), arrow::Type::STRING);
+  DCHECK_LE(offset + length, codes->length());
+  const auto* typed_codes = static_cast<const arrow::Int16Array*>(codes);
+
+  int64_t data_bytes = 0;
+  for (int64_t i = offset; i < offset + length; ++i) {
+    if (!typed_codes->IsNull(i)) {
+      data_bytes += types::GetStringViewFromArrowArray(dictionary, typed_codes->Value(i)).size();
+    }
+  }
+
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+  PL_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    if (typed_codes->IsNull(i)) {
+      PL_RETURN_IF_ERROR(builder.AppendNull());
+      continue;
+    }
+    auto value = types::GetStringViewFromArrowArray(dictionary, typed_codes->Value(i));
+    builder.UnsafeAppend(value.data(), value.size());
+  }
+  ArrowArrayPtr out;
+  PL_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <limits>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+// Codes are stored in an arrow::Int16Array, which bounds the number of values in a dictionary.
+constexpr int64_t kMaxDictionarySize = std::numeric_limits<int16_t>::max();
+
+/**
+ * Dictionary encodes the STRING column at `col_idx` of the given cold batch in place, if doing so
+ * makes the column smaller. Columns like `req_method` or `service` typically have only a handful of
+ * distinct values per batch, so a dictionary plus an Int16 code per row is much smaller than the
+ * strings themselves. The returned savings are measured the way BatchSizeAccountant measures
+ * sizes, so they never exceed the bytes it charged for the column.
+ * @param col_idx index of the STRING column to encode.
+ * @param mem_pool arrow MemoryPool to allocate the codes and dictionary from.
+ * @param batch the cold batch to encode the column of.
+ * @return the number of accounted bytes saved by encoding the column. This is 0 if the column was
+ * left as is, and can be 0 for an encoded column of very short strings.
+ */
+StatusOr<int64_t> MaybeDictionaryEncodeColumn(int64_t col_idx, arrow::MemoryPool* mem_pool,
+                                              ColdBatch* batch);
+
+/**
+ * Decodes a slice of a dictionary encoded column into a plain arrow::StringArray.
+ * @param codes the Int16 codes of the encoded column.
+ * @param dictionary the StringArray dictionary of the encoded column.
+ * @param offset the first row of the slice.
+ * @param length the number of rows in the slice.
+ * @param mem_pool arrow MemoryPool to allocate the decoded array from.
+ * @return the decoded StringArray.
+ */
+StatusOr<ArrowArrayPtr> DecodeDictionarySlice(const arrow::Array* codes,
+                                              const arrow::Array* dictionary, int64_t offset,
+                                              int64_t length, arrow::MemoryPool* mem_pool);
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
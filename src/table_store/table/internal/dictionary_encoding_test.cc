@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+ColdBatch MakeBatch(const std::vector<types::StringValue>& strings) {
+  return ColdBatch(
+      std::vector<ArrowArrayPtr>{types::ToArrow(strings, arrow::default_memory_pool())});
+}
+
+std::vector<std::string> Decode(const ColdBatch& batch, int64_t offset, int64_t length) {
+  auto decoded_or_s = DecodeDictionarySlice(batch.columns[0].get(), batch.dictionaries[0].get(),
+                                            offset, length, arrow::default_memory_pool());
+  EXPECT_OK(decoded_or_s);
+  auto decoded = decoded_or_s.ConsumeValueOrDie();
+  std::vector<std::string> out;
+  for (int64_t i = 0; i < decoded->length(); ++i) {
+    out.push_back(types::GetValueFromArrowArray<types::DataType::STRING>(decoded.get(), i));
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(DictionaryEncodingTest, EncodesRepetitiveColumn) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(i % 3 == 0 ? "GET" : "POST");
+  }
+  auto batch = MakeBatch(values);
+
+  // Accounted: (34 * 3 + 66 * 4) bytes of data, the offsets are a fixed cost.
+  // Encoded: 200 bytes of codes + 7 bytes of data.
+  ASSERT_OK_AND_ASSIGN(auto bytes_saved,
+                       MaybeDictionaryEncodeColumn(0, arrow::default_memory_pool(), &batch));
+  EXPECT_EQ(34 * 3 + 66 * 4 - (200 + 7), bytes_saved);
+  ASSERT_TRUE(batch.IsDictionaryEncoded(0));
+  EXPECT_EQ(arrow::Type::INT16, batch.columns[0]->type_id());
+  EXPECT_EQ(2, batch.dictionaries[0]->length());
+  EXPECT_EQ(100, batch.Length());
+
+  auto decoded = Decode(batch, 0, 100);
+  ASSERT_EQ(100, decoded.size());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i], decoded[i]);
+  }
+}
+
+TEST(DictionaryEncodingTest, ShortStringsSaveNoAccountedBytes) {
+  std::vector<types::StringValue> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(i % 2 == 0 ? "a" : "b");
+  }
+  auto batch = MakeBatch(values);
+
+  // Encoding still shrinks the column in memory, since the offsets are gone. But the 2 byte codes
+  // are larger than the 1 byte strings that were accounted for.
+  ASSERT_OK_AND_ASSIGN(auto bytes_saved,
+                       MaybeDictionaryEncodeColumn(0, arrow::default_memory_pool(), &batch));
+  EXPECT_EQ(0, bytes_saved);
+  ASSERT_TRUE(batch.IsDictionaryEncoded(0));
+  EXPECT_THAT(Decode(batch, 998, 2), ::testing::ElementsAre("a", "b"));
+}
+
+TEST(DictionaryEncodingTest, LeavesUniqueColumnAsIs) {
+  auto batch = MakeBatch({"a", "b", "c", "d"});
+  ASSERT_OK_AND_ASSIGN(auto bytes_saved,
+                       MaybeDictionaryEncodeColumn(0, arrow::default_memory_pool(), &batch));
+  EXPECT_EQ(0, bytes_saved);
+  EXPECT_FALSE(batch.IsDictionaryEncoded(0));
+  EXPECT_EQ(arrow::Type::STRING, batch.columns[0]->type_id());
+}
+
+TEST(DictionaryEncodingTest, DecodesSlice) {
+  auto batch = MakeBatch({"service_a", "service_b", "service_a", "service_a", "service_b"});
+  ASSERT_OK_AND_ASSIGN(auto bytes_saved,
+                       MaybeDictionaryEncodeColumn(0, arrow::default_memory_pool(), &batch));
+  EXPECT_LT(0, bytes_saved);
+  ASSERT_TRUE(batch.IsDictionaryEncoded(0));
+
+  EXPECT_THAT(Decode(batch, 1, 3),
+              ::testing::ElementsAre("service_b", "service_a", "service_a"));
+  EXPECT_THAT(Decode(batch, 4, 1), ::testing::ElementsAre("service_b"));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
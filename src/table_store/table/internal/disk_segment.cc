@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "src/common/base/file.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+#include "src/table_store/table/internal/disk_segment.h"
+#include "src/table_store/table/internal/frozen_column.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+ public:
+  static StatusOr<std::shared_ptr<const MappedFile>> Open(const std::filesystem::path& path,
+                                                    int64_t size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return error::Internal("Failed to open $0: $1", path.string(), std::strerror(errno));
+    }
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file descriptor is closed.
+    close(fd);
+    if (addr == MAP_FAILED) {
+      return error::Internal("Failed to mmap $0: $1", path.string(), std::strerror(errno));
+    }
+    return std::shared_ptr<const MappedFile>(new MappedFile(addr, size));
+  }
+
+  ~MappedFile() { munmap(addr_, size_); }
+
+  std::string_view View(int64_t offset, int64_t size) const {
+    DCHECK_LE(offset + size, size_);
+    return std::string_view(static_cast<const char*>(addr_) + offset, size);
+  }
+
+ private:
+  MappedFile(void* addr, int64_t size) : addr_(addr), size_(size) {}
+
+  void* addr_;
+  int64_t size_;
+};
+
+}  // namespace
+
+StatusOr<DiskSegment> DiskSegment::Write(const std::filesystem::path& path,
+                                         const schema::Relation& rel, int64_t time_col_idx,
+                                         const ColdBatch& batch) {
+  DiskSegment segment;
+  segment.length_ = batch.Length();
+
+  std::string contents;
+  for (const auto& [col_idx, col_type] : Enumerate(rel.col_types())) {
+    std::shared_ptr<const FrozenColumn> frozen = batch.frozen_columns[col_idx];
+    if (frozen == nullptr) {
+      ArrowArrayPtr arr = batch.columns[col_idx];
+      if (batch.IsDictionaryEncoded(col_idx)) {
+        PL_ASSIGN_OR_RETURN(arr, DecodeDictionarySlice(arr.get(), batch.dictionaries[col_idx].get(),
+                                                       0, batch.Length(),
+                                                       arrow::default_memory_pool()));
+      }
+      if (arr->null_count() > 0) {
+        return error::Unimplemented("Can't write column $0 with null values to disk.",
+                                    rel.GetColumnName(col_idx));
+      }
+      if (static_cast<int64_t>(col_idx) == time_col_idx) {
+        constexpr auto kTimeType = types::DataType::TIME64NS;
+        segment.first_time_ = types::GetValueFromArrowArray<kTimeType>(arr.get(), 0);
+        segment.last_time_ = types::GetValueFromArrowArray<kTimeType>(arr.get(), arr->length() - 1);
+      }
+      PL_ASSIGN_OR_RETURN(auto frozen_column, FreezeColumn(col_type, arr.get()));
+      frozen = std::make_shared<const FrozenColumn>(std::move(frozen_column));
+    }
+    segment.columns_.push_back(ColumnLocation{col_type, static_cast<int64_t>(contents.size()),
+                                              frozen->Bytes(), frozen->uncompressed_bytes});
+    contents.append(frozen->compressed_values);
+  }
+
+  PL_RETURN_IF_ERROR(WriteFileFromString(path, contents, std::ios_base::out |
+                                                             std::ios_base::binary));
+  segment.path_ = path;
+  segment.bytes_ = contents.size();
+  return segment;
+}
+
+DiskSegment::DiskSegment(DiskSegment&& other) noexcept { *this = std::move(other); }
+
+DiskSegment& DiskSegment::operator=(DiskSegment&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  RemoveFile();
+  path_ = std::move(other.path_);
+  // Make sure the moved from segment doesn't remove the file.
+  other.path_.clear();
+  columns_ = std::move(other.columns_);
+  length_ = other.length_;
+  bytes_ = other.bytes_;
+  first_time_ = other.first_time_;
+  last_time_ = other.last_time_;
+  return *this;
+}
+
+DiskSegment::~DiskSegment() { RemoveFile(); }
+
+void DiskSegment::RemoveFile() {
+  if (path_.empty()) {
+    return;
+  }
+  std::error_code ec;
+  if (!std::filesystem::remove(path_, ec)) {
+    LOG(WARNING) << absl::Substitute("Failed to remove table store segment $0: $1",
+                                     path_.string(), ec.message());
+  }
+  path_.clear();
+}
+
+StatusOr<std::vector<ArrowArrayPtr>> DiskSegment::ReadColumns(const std::vector<int64_t>& cols,
+                                                              arrow::MemoryPool* mem_pool) const {
+  PL_ASSIGN_OR_RETURN(auto readers, MapColumns(cols));
+  std::vector<ArrowArrayPtr> out;
+  out.reserve(readers.size());
+  for (const auto& reader : readers) {
+    PL_ASSIGN_OR_RETURN(auto arr, reader(mem_pool));
+    out.push_back(std::move(arr));
+  }
+  return out;
+}
+
+StatusOr<std::vector<DiskSegment::ColumnReader>> DiskSegment::MapColumns(
+    const std::vector<int64_t>& cols) const {
+  PL_ASSIGN_OR_RETURN(auto file, MappedFile::Open(path_, bytes_));
+  std::vector<ColumnReader> readers;
+  readers.reserve(cols.size());
+  for (auto col_idx : cols) {
+    readers.push_back([file, col = columns_[col_idx],
+                       length = length_](arrow::MemoryPool* mem_pool) -> StatusOr<ArrowArrayPtr> {
+      return ThawColumn(col.data_type, length, col.uncompressed_bytes,
+                        file->View(col.offset, col.compressed_bytes), mem_pool);
+    });
+  }
+  return readers;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * DiskSegment is a cold batch that was spilled to a file on local disk, once it was expired from
+ * memory. Every column is compressed the same way as a frozen column (see frozen_column.h) and the
+ * compressed columns are stored back to back in the file. Only the location of each column and the
+ * time range of the segment are kept in memory, columns are read back by memory mapping the file.
+ * The file is removed when the segment is destroyed.
+ */
+class DiskSegment {
+ public:
+  using ColumnReader = std::function<StatusOr<ArrowArrayPtr>(arrow::MemoryPool*)>;
+
+  /**
+   * Writes the given cold batch to a new file at `path`.
+   * @param path the path of the file to create.
+   * @param rel the relation of the table the batch belongs to.
+   * @param time_col_idx index of the time column in the relation, or -1 if there is none.
+   * @param batch the batch to write.
+   * @return the DiskSegment backed by the file at `path`. Batches with null values are not
+   * supported.
+   */
+  static StatusOr<DiskSegment> Write(const std::filesystem::path& path, const schema::Relation& rel,
+                                     int64_t time_col_idx, const ColdBatch& batch);
+
+  // An empty segment, not backed by any file. Only needed to return segments in a StatusOr.
+  DiskSegment() = default;
+  DiskSegment(DiskSegment&& other) noexcept;
+  DiskSegment& operator=(DiskSegment&& other) noexcept;
+  DiskSegment(const DiskSegment&) = delete;
+  DiskSegment& operator=(const DiskSegment&) = delete;
+  ~DiskSegment();
+
+  /**
+   * Reads the given columns back from disk.
+   * @param cols indices of the columns to read.
+   * @param mem_pool arrow MemoryPool to allocate the columns from.
+   * @return the columns, in the same order as `cols`.
+   */
+  StatusOr<std::vector<ArrowArrayPtr>> ReadColumns(const std::vector<int64_t>& cols,
+                                                   arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * Maps the file into memory and returns a reader for each of the given columns. Mapping the file
+   * is cheap, the columns are only decompressed when their reader is called. The readers share the
+   * mapping, so they stay valid after the segment and its file are removed, and can be called
+   * without holding the locks that guard the segment.
+   * @param cols indices of the columns to read.
+   * @return the column readers, in the same order as `cols`.
+   */
+  StatusOr<std::vector<ColumnReader>> MapColumns(const std::vector<int64_t>& cols) const;
+
+  int64_t Length() const { return length_; }
+  // Size of the file on disk.
+  int64_t Bytes() const { return bytes_; }
+  // The first and last times of the segment, or -1 if the table has no time column.
+  Time FirstTime() const { return first_time_; }
+  Time LastTime() const { return last_time_; }
+
+ private:
+  struct ColumnLocation {
+    types::DataType data_type;
+    int64_t offset;
+    int64_t compressed_bytes;
+    int64_t uncompressed_bytes;
+  };
+
+  void RemoveFile();
+
+  std::filesystem::path path_;
+  std::vector<ColumnLocation> columns_;
+  int64_t length_ = 0;
+  int64_t bytes_ = 0;
+  Time first_time_ = -1;
+  Time last_time_ = -1;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
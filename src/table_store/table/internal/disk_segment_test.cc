@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+#include "src/table_store/table/internal/disk_segment.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class DiskSegmentTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::INT64,
+                                     types::DataType::STRING},
+        std::vector<std::string>{"time_", "resp_status", "req_method"});
+  }
+
+  std::unique_ptr<schema::Relation> rel_;
+  std::vector<types::Time64NSValue> times_ = {1, 2, 3, 4};
+  std::vector<types::Int64Value> ints_ = {200, 404, 200, 500};
+  std::vector<types::StringValue> strings_ = {"GET", "GET", "POST", "GET"};
+  px::testing::TempDir temp_dir_;
+};
+
+TEST_F(DiskSegmentTest, WriteAndReadColumns) {
+  ColdBatch batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(times_, arrow::default_memory_pool()),
+      types::ToArrow(ints_, arrow::default_memory_pool()),
+      types::ToArrow(strings_, arrow::default_memory_pool()),
+  });
+  auto path = temp_dir_.path() / "0.segment";
+  {
+    ASSERT_OK_AND_ASSIGN(auto segment, DiskSegment::Write(path, *rel_, 0, batch));
+    EXPECT_TRUE(std::filesystem::exists(path));
+    EXPECT_EQ(4, segment.Length());
+    EXPECT_EQ(1, segment.FirstTime());
+    EXPECT_EQ(4, segment.LastTime());
+    EXPECT_EQ(static_cast<int64_t>(std::filesystem::file_size(path)), segment.Bytes());
+
+    ASSERT_OK_AND_ASSIGN(auto cols,
+                         segment.ReadColumns({2, 0}, arrow::default_memory_pool()));
+    ASSERT_EQ(2, cols.size());
+    EXPECT_TRUE(cols[0]->Equals(types::ToArrow(strings_, arrow::default_memory_pool())));
+    EXPECT_TRUE(cols[1]->Equals(types::ToArrow(times_, arrow::default_memory_pool())));
+  }
+  // The file is removed with the segment.
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(DiskSegmentTest, DictionaryEncodedColumn) {
+  ColdBatch batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(times_, arrow::default_memory_pool()),
+      types::ToArrow(ints_, arrow::default_memory_pool()),
+      types::ToArrow(strings_, arrow::default_memory_pool()),
+  });
+  ASSERT_OK(MaybeDictionaryEncodeColumn(2, arrow::default_memory_pool(), &batch));
+  ASSERT_TRUE(batch.IsDictionaryEncoded(2));
+
+  ASSERT_OK_AND_ASSIGN(auto segment,
+                       DiskSegment::Write(temp_dir_.path() / "0.segment", *rel_, 0, batch));
+  ASSERT_OK_AND_ASSIGN(auto cols, segment.ReadColumns({2}, arrow::default_memory_pool()));
+  EXPECT_TRUE(cols[0]->Equals(types::ToArrow(strings_, arrow::default_memory_pool())));
+}
+
+TEST_F(DiskSegmentTest, MovedSegmentKeepsFile) {
+  ColdBatch batch(std::vector<ArrowArrayPtr>{
+      types::ToArrow(times_, arrow::default_memory_pool()),
+      types::ToArrow(ints_, arrow::default_memory_pool()),
+      types::ToArrow(strings_, arrow::default_memory_pool()),
+  });
+  auto path = temp_dir_.path() / "0.segment";
+  ASSERT_OK_AND_ASSIGN(auto segment, DiskSegment::Write(path, *rel_, 0, batch));
+  {
+    DiskSegment moved_from = std::move(segment);
+    segment = std::move(moved_from);
+  }
+  EXPECT_TRUE(std::filesystem::exists(path));
+  ASSERT_OK_AND_ASSIGN(auto cols, segment.ReadColumns({1}, arrow::default_memory_pool()));
+  EXPECT_TRUE(cols[0]->Equals(types::ToArrow(ints_, arrow::default_memory_pool())));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/table/internal/frozen_column.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// Fast compression is preferred, since frozen batches may be thawed by every query that reads them.
+constexpr int kCompressionLevel = 1;
+
+template <typename T>
+void AppendRaw(const T& val, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <typename T>
+Status ReadRaw(std::string_view* in, T* val) {
+  if (in->size() < sizeof(T)) {
+    return error::Internal("Frozen column is truncated.");
+  }
+  std::memcpy(val, in->data(), sizeof(T));
+  in->remove_prefix(sizeof(T));
+  return Status::OK();
+}
+
+template <types::DataType T>
+std::string SerializeValues(const arrow::Array* arr) {
+  std::string out;
+  if constexpr (T == types::DataType::STRING) {
+    out.reserve(types::GetArrowArrayBytes<T>(arr) + arr->length() * sizeof(uint32_t));
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      auto val = types::GetStringViewFromArrowArray(arr, i);
+      AppendRaw(static_cast<uint32_t>(val.size()), &out);
+      out.append(val);
+    }
+  } else {
+    using NativeType = typename types::DataTypeTraits<T>::native_type;
+    out.reserve(arr->length() * sizeof(NativeType));
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      AppendRaw(static_cast<NativeType>(types::GetValueFromArrowArray<T>(arr, i)), &out);
+    }
+  }
+  return out;
+}
+
+template <types::DataType T>
+StatusOr<ArrowArrayPtr> DeserializeValues(std::string_view in, int64_t length,
+                                          arrow::MemoryPool* mem_pool) {
+  using BuilderType = typename types::DataTypeTraits<T>::arrow_builder_type;
+  auto builder = types::GetArrowBuilder<T>(mem_pool);
+  auto typed_builder = static_cast<BuilderType*>(builder.get());
+  PL_RETURN_IF_ERROR(typed_builder->Reserve(length));
+  if constexpr (T == types::DataType::STRING) {
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(in.size() - length * sizeof(uint32_t)));
+  }
+  for (int64_t i = 0; i < length; ++i) {
+    if constexpr (T == types::DataType::STRING) {
+      uint32_t size;
+      PL_RETURN_IF_ERROR(ReadRaw(&in, &size));
+      if (in.size() < size) {
+        return error::Internal("Frozen column is truncated.");
+      }
+      typed_builder->UnsafeAppend(in.data(), size);
+      in.remove_prefix(size);
+    } else {
+      typename types::DataTypeTraits<T>::native_type val;
+      PL_RETURN_IF_ERROR(ReadRaw(&in, &val));
+      typed_builder->UnsafeAppend(val);
+    }
+  }
+  ArrowArrayPtr out;
+  PL_RETURN_IF_ERROR(typed_builder->Finish(&out));
+  return out;
+}
+
+}  // namespace
+
+StatusOr<FrozenColumn> FreezeColumn(types::DataType data_type, const arrow::Array* arr) {
+  DCHECK_EQ(arr->null_count(), 0);
+  std::string serialized;
+#define TYPE_CASE(_dt_) serialized = SerializeValues<_dt_>(arr)
+  PL_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+
+  FrozenColumn frozen;
+  frozen.data_type = data_type;
+  frozen.length = arr->length();
+  frozen.uncompressed_bytes = serialized.size();
+  PL_ASSIGN_OR_RETURN(frozen.compressed_values, zlib::Deflate(serialized, kCompressionLevel));
+  return frozen;
+}
+
+StatusOr<ArrowArrayPtr> ThawColumn(const FrozenColumn& frozen, arrow::MemoryPool* mem_pool) {
+  return ThawColumn(frozen.data_type, frozen.length, frozen.uncompressed_bytes,
+                    frozen.compressed_values, mem_pool);
+}
+
+StatusOr<ArrowArrayPtr> ThawColumn(types::DataType data_type, int64_t length,
+                                   int64_t uncompressed_bytes, std::string_view compressed_values,
+                                   arrow::MemoryPool* mem_pool) {
+  // Inflate grows its output in blocks, so use a block size that fits the whole column at once.
+  PL_ASSIGN_OR_RETURN(std::string serialized,
+                      zlib::Inflate(compressed_values, uncompressed_bytes + 1));
+  if (static_cast<int64_t>(serialized.size()) != uncompressed_bytes) {
+    return error::Internal("Frozen column has $0 bytes, expected $1.", serialized.size(),
+                           uncompressed_bytes);
+  }
+#define TYPE_CASE(_dt_) return DeserializeValues<_dt_>(serialized, length, mem_pool)
+  PL_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+ThawCache::Entry& ThawCache::Touch(BatchID batch_id, size_t num_columns) {
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [&](const Entry& entry) { return entry.batch_id == batch_id; });
+  if (it == entries_.end()) {
+    if (entries_.size() >= kMaxBatches) {
+      bytes_ -= entries_.front().bytes;
+      entries_.pop_front();
+    }
+    entries_.push_back(Entry{batch_id, std::vector<ArrowArrayPtr>(num_columns)});
+  } else if (std::next(it) != entries_.end()) {
+    // Move the batch to the back, so that the least recently read batch is evicted first.
+    auto entry = std::move(*it);
+    entries_.erase(it);
+    entries_.push_back(std::move(entry));
+  }
+  return entries_.back();
+}
+
+StatusOr<ArrowArrayPtr> ThawCache::GetOrThaw(BatchID batch_id, size_t num_columns,
+                                             int64_t col_idx, const FrozenColumn& frozen) {
+  {
+    absl::base_internal::SpinLockHolder lock(&lock_);
+    auto& entry = Touch(batch_id, num_columns);
+    if (entry.columns[col_idx] != nullptr) {
+      return entry.columns[col_idx];
+    }
+  }
+
+  PL_ASSIGN_OR_RETURN(auto col, ThawColumn(frozen, arrow::default_memory_pool()));
+
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  auto& entry = Touch(batch_id, num_columns);
+  if (entry.columns[col_idx] != nullptr) {
+    // Another reader thawed the column in the meantime.
+    return entry.columns[col_idx];
+  }
+  // Evict the least recently read batches to stay within the cache size.
+  while (bytes_ + frozen.uncompressed_bytes > max_bytes_ && entries_.size() > 1) {
+    bytes_ -= entries_.front().bytes;
+    entries_.pop_front();
+  }
+  if (bytes_ + frozen.uncompressed_bytes <= max_bytes_) {
+    auto& back = entries_.back();
+    back.columns[col_idx] = col;
+    back.bytes += frozen.uncompressed_bytes;
+    bytes_ += frozen.uncompressed_bytes;
+  }
+  return col;
+}
+
+void ThawCache::EraseBefore(BatchID first_batch_id) {
+  absl::base_internal::SpinLockHolder lock(&lock_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->batch_id < first_batch_id) {
+      bytes_ -= it->bytes;
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/base/internal/spinlock.h>
+#include <absl/base/thread_annotations.h>
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * FrozenColumn is a compressed copy of a column of a cold batch. Values are serialized back to back
+ * (strings are prefixed with their uint32 length), which matches the way BatchSizeAccountant
+ * measures the size of a column, and the result is compressed with zlib.
+ */
+struct FrozenColumn {
+  types::DataType data_type;
+  int64_t length;
+  // Size of the serialized values, before compression.
+  int64_t uncompressed_bytes;
+  std::string compressed_values;
+
+  int64_t Bytes() const { return compressed_values.size(); }
+};
+
+/**
+ * Compresses the given column.
+ * @param data_type the type of the column.
+ * @param arr the column to compress. It must not contain nulls.
+ * @return the compressed column.
+ */
+StatusOr<FrozenColumn> FreezeColumn(types::DataType data_type, const arrow::Array* arr);
+
+/**
+ * Decompresses a column created by FreezeColumn.
+ * @param frozen the compressed column.
+ * @param mem_pool arrow MemoryPool to allocate the decompressed column from.
+ * @return the decompressed column.
+ */
+StatusOr<ArrowArrayPtr> ThawColumn(const FrozenColumn& frozen, arrow::MemoryPool* mem_pool);
+
+/**
+ * Same as ThawColumn(FrozenColumn) above, but for a column whose compressed values live elsewhere
+ * (eg. in a memory mapped file).
+ */
+StatusOr<ArrowArrayPtr> ThawColumn(types::DataType data_type, int64_t length,
+                                   int64_t uncompressed_bytes, std::string_view compressed_values,
+                                   arrow::MemoryPool* mem_pool);
+
+/**
+ * ThawCache is a cache of the decompressed columns of recently read frozen batches, bounded by the
+ * serialized size of the cached columns. Columns are thawed without holding the cache's lock, which
+ * is only taken to look up and to publish a column, so that a read of a frozen batch never blocks
+ * the store's writers on decompression. Two concurrent readers of the same column may both thaw
+ * it, in which case the first one to publish wins.
+ */
+class ThawCache {
+ public:
+  explicit ThawCache(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  void set_max_bytes(int64_t max_bytes) {
+    absl::base_internal::SpinLockHolder lock(&lock_);
+    max_bytes_ = max_bytes;
+  }
+
+  int64_t bytes() const {
+    absl::base_internal::SpinLockHolder lock(&lock_);
+    return bytes_;
+  }
+
+  /**
+   * GetOrThaw returns the decompressed column of a frozen batch, from the cache if it was recently
+   * read, thawing and caching it otherwise. The column is returned uncached if it doesn't fit in
+   * the cache on its own.
+   * @param batch_id the batch the column belongs to.
+   * @param num_columns the number of columns of the batch.
+   * @param col_idx the index of the column in the batch.
+   * @param frozen the compressed column.
+   * @return the decompressed column.
+   */
+  StatusOr<ArrowArrayPtr> GetOrThaw(BatchID batch_id, size_t num_columns, int64_t col_idx,
+                                    const FrozenColumn& frozen);
+
+  /**
+   * EraseBefore drops the cached columns of batches before the given batch, once they're expired.
+   */
+  void EraseBefore(BatchID first_batch_id);
+
+ private:
+  static constexpr size_t kMaxBatches = 4;
+  struct Entry {
+    BatchID batch_id;
+    std::vector<ArrowArrayPtr> columns;
+    // The serialized size of the cached columns.
+    int64_t bytes = 0;
+  };
+  // Moves the entry of the given batch to the back of the cache, creating it if needed.
+  Entry& Touch(BatchID batch_id, size_t num_columns) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable absl::base_internal::SpinLock lock_;
+  // The most recently read batch is last.
+  std::deque<Entry> entries_ ABSL_GUARDED_BY(lock_);
+  int64_t bytes_ ABSL_GUARDED_BY(lock_) = 0;
+  int64_t max_bytes_ ABSL_GUARDED_BY(lock_);
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/frozen_column.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+template <typename TValue>
+void ExpectRoundTrip(types::DataType data_type, const std::vector<TValue>& values) {
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto frozen, FreezeColumn(data_type, arr.get()));
+  EXPECT_EQ(static_cast<int64_t>(values.size()), frozen.length);
+  ASSERT_OK_AND_ASSIGN(auto thawed, ThawColumn(frozen, arrow::default_memory_pool()));
+  EXPECT_TRUE(thawed->Equals(arr));
+}
+
+TEST(FrozenColumnTest, RoundTrip) {
+  ExpectRoundTrip<types::BoolValue>(types::DataType::BOOLEAN, {true, false, false, true});
+  ExpectRoundTrip<types::Int64Value>(types::DataType::INT64, {1, -2, 3, 1 << 30});
+  ExpectRoundTrip<types::UInt128Value>(types::DataType::UINT128,
+                                       {types::UInt128Value(1, 2), types::UInt128Value(3, 4)});
+  ExpectRoundTrip<types::Float64Value>(types::DataType::FLOAT64, {1.5, -2.25});
+  ExpectRoundTrip<types::Time64NSValue>(types::DataType::TIME64NS, {10, 20, 30});
+  ExpectRoundTrip<types::StringValue>(types::DataType::STRING, {"GET", "", "/healthz"});
+  ExpectRoundTrip<types::StringValue>(types::DataType::STRING, {});
+}
+
+TEST(FrozenColumnTest, CompressesRepetitiveColumn) {
+  std::vector<types::StringValue> values(1000, "{\"status\": \"ok\"}");
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto frozen, FreezeColumn(types::DataType::STRING, arr.get()));
+  EXPECT_EQ(1000 * (16 + sizeof(uint32_t)), static_cast<size_t>(frozen.uncompressed_bytes));
+  EXPECT_LT(frozen.Bytes(), frozen.uncompressed_bytes / 10);
+}
+
+TEST(FrozenColumnTest, CorruptColumn) {
+  std::vector<types::Int64Value> values = {1, 2, 3};
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto frozen, FreezeColumn(types::DataType::INT64, arr.get()));
+  frozen.uncompressed_bytes++;
+  EXPECT_FALSE(ThawColumn(frozen, arrow::default_memory_pool()).ok());
+}
+
+TEST(ThawCacheTest, CachesWithinMaxBytes) {
+  std::vector<types::Int64Value> values(100, 7);
+  auto arr = types::ToArrow(values, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto frozen, FreezeColumn(types::DataType::INT64, arr.get()));
+
+  ThawCache cache(2 * frozen.uncompressed_bytes);
+  ASSERT_OK_AND_ASSIGN(auto first, cache.GetOrThaw(/*batch_id*/ 0, 2, 0, frozen));
+  EXPECT_TRUE(first->Equals(arr));
+  EXPECT_EQ(frozen.uncompressed_bytes, cache.bytes());
+  // A second read is served from the cache.
+  ASSERT_OK_AND_ASSIGN(auto second, cache.GetOrThaw(/*batch_id*/ 0, 2, 0, frozen));
+  EXPECT_EQ(first.get(), second.get());
+
+  ASSERT_OK(cache.GetOrThaw(/*batch_id*/ 1, 2, 0, frozen).status());
+  EXPECT_EQ(2 * frozen.uncompressed_bytes, cache.bytes());
+  // The least recently read batch is evicted to make room for a third column.
+  ASSERT_OK(cache.GetOrThaw(/*batch_id*/ 2, 2, 1, frozen).status());
+  EXPECT_EQ(2 * frozen.uncompressed_bytes, cache.bytes());
+  ASSERT_OK_AND_ASSIGN(auto reread, cache.GetOrThaw(/*batch_id*/ 0, 2, 0, frozen));
+  EXPECT_NE(first.get(), reread.get());
+
+  cache.EraseBefore(3);
+  EXPECT_EQ(0, cache.bytes());
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
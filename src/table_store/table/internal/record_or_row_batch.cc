@@ -103,41 +103,101 @@ Time RecordOrRowBatch::GetTimeValue(int64_t time_col_idx, int64_t row_idx) const
                     batch_);
 }
 
+absl::uint128 RecordOrRowBatch::GetUInt128Value(int64_t col_idx, int64_t row_idx) const {
+  row_idx += row_offset_;
+  return std::visit(overloaded{
+                        [col_idx, row_idx](const RecordBatchWithCache& record_batch_w_cache) {
+                          auto col = (*record_batch_w_cache.record_batch)[col_idx];
+                          return col->template Get<types::UInt128Value>(row_idx).val;
+                        },
+                        [col_idx, row_idx](const schema::RowBatch& row_batch) {
+                          return types::GetValueFromArrowArray<types::DataType::UINT128>(
+                              row_batch.ColumnAt(col_idx).get(), row_idx);
+                        },
+                    },
+                    batch_);
+}
+
 void RecordOrRowBatch::RemovePrefix(size_t num_rows) { row_offset_ += num_rows; }
 
 Status RecordOrRowBatch::AddBatchSliceToRowBatch(size_t row_start, size_t batch_size,
                                                  const std::vector<int64_t>& cols,
                                                  schema::RowBatch* output_rb) const {
+  RowBatchSlice slice(output_rb->desc(), batch_size);
+  AddBatchSliceToRowBatchSlice(row_start, batch_size, cols, &slice);
+  PL_ASSIGN_OR_RETURN(auto rb, slice.Materialize(arrow::default_memory_pool()));
+  for (int64_t i = 0; i < rb->num_columns(); ++i) {
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(rb->ColumnAt(i)));
+  }
+  return Status::OK();
+}
+
+void RecordOrRowBatch::AddBatchSliceToRowBatchSlice(size_t row_start, size_t batch_size,
+                                                    const std::vector<int64_t>& cols,
+                                                    RowBatchSlice* slice) const {
   row_start += row_offset_;
-  return std::visit(
+  std::visit(
       overloaded{
-          [row_start, batch_size, cols,
-           output_rb](const RecordBatchWithCache& record_batch_w_cache) {
+          [row_start, batch_size, &cols, slice](const RecordBatchWithCache& record_batch_w_cache) {
             for (auto col_idx : cols) {
-              if (!record_batch_w_cache.cache_validity[col_idx]) {
-                // Arrow array wasn't in cache, convert it to arrow and then add
-                // to cache.
-                auto arr = (*record_batch_w_cache.record_batch)[col_idx]->ConvertToArrow(
-                    arrow::default_memory_pool());
-                record_batch_w_cache.arrow_cache[col_idx] = arr;
-                record_batch_w_cache.cache_validity[col_idx] = true;
+              auto cached = record_batch_w_cache.arrow_cache->Get(col_idx);
+              if (cached != nullptr) {
+                slice->AddColumn(cached->Slice(row_start, batch_size));
+                continue;
               }
-              auto arr = record_batch_w_cache.arrow_cache[col_idx]->Slice(row_start, batch_size);
-              PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+              // The arrow array isn't in the cache yet. Convert it when the slice is materialized,
+              // ie. outside of the table locks, and then publish it to the cache. The cached array
+              // outlives the read, so it's always allocated from the default memory pool. Fixed
+              // size columns aren't copied, the array shares the memory of the hot column.
+              slice->AddDeferredColumn(
+                  [col = (*record_batch_w_cache.record_batch)[col_idx],
+                   cache = record_batch_w_cache.arrow_cache, col_idx, row_start,
+                   batch_size](arrow::MemoryPool*) -> StatusOr<ArrowArrayPtr> {
+                    auto arr = cache->Get(col_idx);
+                    if (arr == nullptr) {
+                      arr = types::ShareColumnAsArrow(col, arrow::default_memory_pool());
+                      cache->Set(col_idx, arr);
+                    }
+                    return arr->Slice(row_start, batch_size);
+                  });
             }
-            return Status::OK();
           },
-          [row_start, batch_size, cols, output_rb](const schema::RowBatch& row_batch) {
+          [row_start, batch_size, &cols, slice](const schema::RowBatch& row_batch) {
             for (auto col_idx : cols) {
-              auto arr = row_batch.ColumnAt(col_idx)->Slice(row_start, batch_size);
-              PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+              slice->AddColumn(row_batch.ColumnAt(col_idx)->Slice(row_start, batch_size));
             }
-            return Status::OK();
           },
       },
       batch_);
 }
 
+std::optional<std::vector<ArrowArrayPtr>> RecordOrRowBatch::ShareColumns() const {
+  if (row_offset_ > 0) {
+    return std::nullopt;
+  }
+  std::vector<ArrowArrayPtr> columns;
+  std::visit(overloaded{
+                 [&columns](const RecordBatchWithCache& record_batch_w_cache) {
+                   const auto& record_batch = *record_batch_w_cache.record_batch;
+                   for (const auto& [col_idx, col] : Enumerate(record_batch)) {
+                     auto arr = record_batch_w_cache.arrow_cache->Get(col_idx);
+                     if (arr == nullptr) {
+                       arr = types::ShareColumnAsArrow(col, arrow::default_memory_pool());
+                       record_batch_w_cache.arrow_cache->Set(col_idx, arr);
+                     }
+                     columns.push_back(std::move(arr));
+                   }
+                 },
+                 [&columns](const schema::RowBatch& row_batch) {
+                   for (int64_t col_idx = 0; col_idx < row_batch.num_columns(); ++col_idx) {
+                     columns.push_back(row_batch.ColumnAt(col_idx));
+                   }
+                 },
+             },
+             batch_);
+  return columns;
+}
+
 void RecordOrRowBatch::UnsafeAppendColumnToBuilder(types::TypeErasedArrowBuilder* builder,
                                                    types::DataType data_type, int64_t col_idx,
                                                    size_t start_row, size_t end_row) const {
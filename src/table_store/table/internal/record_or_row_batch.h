@@ -18,11 +18,15 @@
 
 #pragma once
 
+#include <absl/numeric/int128.h>
+
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/row_batch_slice.h"
 #include "src/table_store/table/internal/types.h"
 
 namespace px {
@@ -78,6 +82,13 @@ class RecordOrRowBatch {
    * @return the time value at the given row index.
    */
   Time GetTimeValue(int64_t time_col_idx, int64_t row_idx) const;
+  /**
+   * GetUInt128Value returns the value of a UINT128 column at the given row index.
+   * @param col_idx, the index of the UINT128 column to get the value from.
+   * @param row_idx, the index of the row to get.
+   * @return the value at the given row index.
+   */
+  absl::uint128 GetUInt128Value(int64_t col_idx, int64_t row_idx) const;
   /**
    * RemovePrefix removes the given number of rows from the start of this record or row batch. To
    * avoid reallocations, RecordOrRowBatch stores a `row_offset_` that is incremented by the number
@@ -100,6 +111,28 @@ class RecordOrRowBatch {
                                  const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const;
 
+  /**
+   * AddBatchSliceToRowBatchSlice adds a slice of this record or row batch to the given output
+   * RowBatchSlice. Columns that still have to be converted to arrow are added as deferred columns,
+   * which share ownership of the underlying column wrappers, so the conversion can happen after
+   * the table locks are released.
+   * @param row_start, row index within this batch to start the output slice at.
+   * @param batch_size, size of the output slice.
+   * @param cols, a vector of column indices to include in the output slice.
+   * @param slice, a pointer to the RowBatchSlice to add the columns to.
+   */
+  void AddBatchSliceToRowBatchSlice(size_t row_start, size_t batch_size,
+                                    const std::vector<int64_t>& cols, RowBatchSlice* slice) const;
+
+  /**
+   * ShareColumns returns the columns of this batch as arrow arrays, without copying the fixed size
+   * columns of a record batch (see types::ShareColumnAsArrow) or any column of a row batch. The
+   * arrays are published to the arrow cache, so reads of this batch share them as well.
+   * @return the arrow array of each column, or std::nullopt if rows have been removed from the
+   * start of this batch.
+   */
+  std::optional<std::vector<ArrowArrayPtr>> ShareColumns() const;
+
   /**
    * UnsafeAppendColumnToBuilder appends a slice of a column of this record or row batch to the
    * given arrow array builder. This method expects that the given builder already has the space
@@ -157,6 +157,26 @@ TEST_P(RecordOrRowBatchTest, RemovePrefix_AddBatchSliceToRowBatch) {
       rb1.ColumnAt(2)->Equals(types::ToArrow(strings_, arrow::default_memory_pool())->Slice(2, 1)));
 }
 
+TEST_P(RecordOrRowBatchTest, AddBatchSliceToRowBatchSlice_OutlivesBatch) {
+  rb_->RemovePrefix(1);
+
+  RowBatchSlice slice(schema::RowDescriptor(rel_->col_types()), 2);
+  rb_->AddBatchSliceToRowBatchSlice(1, 2, {0, 1, 2}, &slice);
+  EXPECT_EQ(3, slice.num_columns());
+  // The slice shares ownership of the data it references, so it can be materialized after the
+  // batch is gone.
+  rb_.reset();
+
+  ASSERT_OK_AND_ASSIGN(auto rb, slice.Materialize(arrow::default_memory_pool()));
+  EXPECT_EQ(2, rb->num_rows());
+  EXPECT_TRUE(
+      rb->ColumnAt(0)->Equals(types::ToArrow(times_, arrow::default_memory_pool())->Slice(2, 2)));
+  EXPECT_TRUE(
+      rb->ColumnAt(1)->Equals(types::ToArrow(bools_, arrow::default_memory_pool())->Slice(2, 2)));
+  EXPECT_TRUE(
+      rb->ColumnAt(2)->Equals(types::ToArrow(strings_, arrow::default_memory_pool())->Slice(2, 2)));
+}
+
 TEST_P(RecordOrRowBatchTest, UnsafeAppendColumnToBuilder) {
   auto time_builder =
       types::MakeTypeErasedArrowBuilder(types::DataType::TIME64NS, arrow::default_memory_pool());
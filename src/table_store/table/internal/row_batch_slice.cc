@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+
+#include "src/table_store/table/internal/row_batch_slice.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+StatusOr<std::unique_ptr<schema::RowBatch>> RowBatchSlice::Materialize(
+    arrow::MemoryPool* mem_pool) const {
+  if (num_rows_ == 0) {
+    return schema::RowBatch::WithZeroRows(desc_, /* eow */ false, /* eos */ false);
+  }
+  DCHECK_EQ(columns_.size(), desc_.size());
+  auto output_rb = std::make_unique<schema::RowBatch>(desc_, num_rows_);
+  for (const auto& column : columns_) {
+    ArrowArrayPtr arr;
+    if (std::holds_alternative<ArrowArrayPtr>(column)) {
+      arr = std::get<ArrowArrayPtr>(column);
+    } else {
+      PL_ASSIGN_OR_RETURN(arr, std::get<DeferredColumn>(column)(mem_pool));
+    }
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
+  return output_rb;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * RowBatchSlice describes the output of a single read from a table store. It's built while the
+ * table locks are held, but any expensive work (converting hot columns to arrow, decoding
+ * dictionaries) is deferred until Materialize is called, after the locks are released. All
+ * columns share ownership of the data they reference, so a slice stays valid even if the batch it
+ * was read from is compacted or expired before it is materialized.
+ */
+class RowBatchSlice {
+ public:
+  using DeferredColumn = std::function<StatusOr<ArrowArrayPtr>(arrow::MemoryPool*)>;
+
+  RowBatchSlice(schema::RowDescriptor desc, int64_t num_rows)
+      : desc_(std::move(desc)), num_rows_(num_rows) {}
+
+  /**
+   * AddColumn adds a column that is already an arrow array of `num_rows()` rows.
+   */
+  void AddColumn(ArrowArrayPtr arr) { columns_.emplace_back(std::move(arr)); }
+
+  /**
+   * AddDeferredColumn adds a column that is only produced when the slice is materialized. The
+   * function must return an array of `num_rows()` rows, and must only capture data that it owns
+   * or shares ownership of.
+   */
+  void AddDeferredColumn(DeferredColumn column) { columns_.emplace_back(std::move(column)); }
+
+  int64_t num_rows() const { return num_rows_; }
+  size_t num_columns() const { return columns_.size(); }
+
+  /**
+   * Materialize builds the output RowBatch, running any deferred column work. Slices with no rows
+   * (eg. when all batches were skipped by a zone map filter) produce a 0-row batch.
+   * @param mem_pool, the memory pool to allocate the deferred columns in.
+   * @return the RowBatch or an error if producing one of the columns failed.
+   */
+  StatusOr<std::unique_ptr<schema::RowBatch>> Materialize(arrow::MemoryPool* mem_pool) const;
+
+ private:
+  schema::RowDescriptor desc_;
+  int64_t num_rows_;
+  std::vector<std::variant<ArrowArrayPtr, DeferredColumn>> columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
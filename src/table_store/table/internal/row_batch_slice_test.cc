@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/row_batch_slice.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(RowBatchSliceTest, Materialize) {
+  std::vector<types::Int64Value> ints = {1, 2, 3, 4};
+  std::vector<types::Float64Value> floats = {0.5, 1.5, 2.5, 3.5};
+  auto floats_arr = types::ToArrow(floats, arrow::default_memory_pool());
+
+  schema::RowDescriptor desc({types::DataType::INT64, types::DataType::FLOAT64});
+  RowBatchSlice slice(desc, 2);
+  slice.AddDeferredColumn([ints](arrow::MemoryPool* mem_pool) -> StatusOr<ArrowArrayPtr> {
+    return types::ToArrow(ints, mem_pool)->Slice(1, 2);
+  });
+  slice.AddColumn(floats_arr->Slice(1, 2));
+
+  ASSERT_OK_AND_ASSIGN(auto rb, slice.Materialize(arrow::default_memory_pool()));
+  EXPECT_EQ(2, rb->num_rows());
+  ASSERT_EQ(2, rb->num_columns());
+  EXPECT_TRUE(
+      rb->ColumnAt(0)->Equals(types::ToArrow(ints, arrow::default_memory_pool())->Slice(1, 2)));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(floats_arr->Slice(1, 2)));
+}
+
+TEST(RowBatchSliceTest, MaterializeZeroRows) {
+  schema::RowDescriptor desc({types::DataType::INT64, types::DataType::STRING});
+  RowBatchSlice slice(desc, 0);
+
+  ASSERT_OK_AND_ASSIGN(auto rb, slice.Materialize(arrow::default_memory_pool()));
+  EXPECT_EQ(0, rb->num_rows());
+  EXPECT_EQ(2, rb->num_columns());
+  EXPECT_FALSE(rb->eow());
+  EXPECT_FALSE(rb->eos());
+}
+
+TEST(RowBatchSliceTest, DeferredColumnError) {
+  schema::RowDescriptor desc({types::DataType::INT64});
+  RowBatchSlice slice(desc, 1);
+  slice.AddDeferredColumn([](arrow::MemoryPool*) -> StatusOr<ArrowArrayPtr> {
+    return error::Internal("decode failed");
+  });
+
+  EXPECT_FALSE(slice.Materialize(arrow::default_memory_pool()).ok());
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
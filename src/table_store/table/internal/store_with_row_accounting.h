@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -28,7 +29,12 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+#include "src/table_store/table/internal/disk_segment.h"
+#include "src/table_store/table/internal/frozen_column.h"
+#include "src/table_store/table/internal/row_batch_slice.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -48,18 +54,41 @@ inline bool TimeIntervalComparatorUpperBound(Time val, const TimeInterval& inter
   return val < interval.second;
 }
 
+/**
+ * DiskSegmentTimeSearch is the segment that a time lookup on the `Disk` store landed in. Reading
+ * the segment's time column is deferred to Find, so that it can run without holding the lock
+ * guarding the store.
+ */
+struct DiskSegmentTimeSearch {
+  RowID first_row_id;
+  DiskSegment::ColumnReader time_column;
+
+  /**
+   * Find returns the RowID of the first row of the segment with a time greater than (or equal to,
+   * if `inclusive`) the given time.
+   */
+  StatusOr<RowID> Find(Time time, bool inclusive) const {
+    PL_ASSIGN_OR_RETURN(auto times, time_column(arrow::default_memory_pool()));
+    constexpr auto kTimeType = types::DataType::TIME64NS;
+    int64_t row_offset =
+        inclusive ? types::SearchArrowArrayGreaterThanOrEqual<kTimeType>(times.get(), time)
+                  : types::SearchArrowArrayLessThanOrEqual<kTimeType>(times.get(), time) + 1;
+    return first_row_id + row_offset;
+  }
+};
+
 template <bool always_false = false>
 void constexpr_else_static_assert_false() {
   static_assert(always_false, "constexpr else block reached");
 }
 
 /**
- * StoreWithRowTimeAccounting stores a deque of batches (hot or cold) and keeps track of the first
- * and last unique RowID's for each batch, as well as the first and last times for each batch (if
- * there is a time column in the table). The template parameter specifies whether this is the Hot or
- * Cold store. Since the logic between the Hot and Cold stores is roughly identical, this class
- * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot or Cold
- * batch methods.
+ * StoreWithRowTimeAccounting stores a deque of batches (hot, cold or on disk) and keeps track of
+ * the first and last unique RowID's for each batch, as well as the first and last times for each
+ * batch (if there is a time column in the table). The template parameter specifies whether this is
+ * the Hot, Cold or Disk store. Since the logic between the stores is roughly identical, this class
+ * deduplicates that logic while allowing the explicit batch accesses to use the correct Hot, Cold
+ * or Disk batch methods.
  *
  * Times are used to find row batch's within a given time
  * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
@@ -76,7 +105,9 @@ class StoreWithRowTimeAccounting {
       : rel_(rel), time_col_idx_(time_col_idx) {}
 
   /**
-   * GetNextRowBatch returns the next row batch in this store after the given unique row id.
+   * GetNextRowBatchSlice returns a slice of the next row batch in this store after the given unique
+   * row id. The slice shares ownership of the batch's data, so it can be materialized into a
+   * RowBatch after the lock guarding this store has been released.
    * @param last_read_row_id, pointer to the unique RowID of the last read row. The outputted batch
    * should include only rows with a RowID greater than this RowID. After determining the output
    * batch, this pointer is updated to point to the RowID of the last row in the outputted batch.
@@ -87,15 +118,19 @@ class StoreWithRowTimeAccounting {
    * @param stop_row_id, an optional unique RowID to stop the batch at. If provided, the batch will
    * be sliced such that no rows are included with `RowID >= stop_row_id.value()`.
    * @param cols, a vector of column indices to include in the outputted row batch.
-   * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
-   * match the parameters above. On error returns a Status.
+   * @param zone_map_filter, an optional filter used to skip batches that can't match. Only
+   * supported for the `Cold` store (the `Hot` store ignores it). Skipped batches are treated as
+   * read, ie. `last_read_row_id` is advanced past them. If the filter skips all batches up to the
+   * `stop_row_id`, a 0-row slice is returned.
+   * @return a unique_ptr to the RowBatchSlice or nullptr if there are no more rows in this store
+   * that match the parameters above. On error returns a Status.
    */
-  StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
+  StatusOr<std::unique_ptr<RowBatchSlice>> GetNextRowBatchSlice(
       RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
-      const std::vector<int64_t>& cols) const {
+      const std::vector<int64_t>& cols, ZoneMapFilter* zone_map_filter = nullptr) const {
     auto start_row_id = *last_read_row_id + 1;
     if (batches_.empty() || start_row_id < FirstRowID() || start_row_id > LastRowID()) {
-      return std::unique_ptr<schema::RowBatch>(nullptr);
+      return std::unique_ptr<RowBatchSlice>(nullptr);
     }
     if (DCHECK_IS_ON() && stop_row_id.has_value()) {
       DCHECK_LT(start_row_id, stop_row_id.value());
@@ -108,8 +143,51 @@ class StoreWithRowTimeAccounting {
       batch_id = FindBatchIDFromRowID(start_row_id);
     }
 
-    const auto& batch = GetBatchFromBatchID(batch_id);
+    // Get column types for row descriptor.
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      DCHECK(static_cast<size_t>(col_idx) < rel_.NumColumns());
+      col_types.push_back(rel_.col_types()[col_idx]);
+    }
+
+    if constexpr (TStoreType == StoreType::Cold) {
+      if (zone_map_filter != nullptr && !zone_map_filter->empty()) {
+        while (!zone_map_filter->MayMatch(zone_maps_[batch_id - first_batch_id_])) {
+          RowID skip_until = BatchLastRowID(batch_id);
+          if (stop_row_id.has_value() && skip_until >= stop_row_id.value() - 1) {
+            skip_until = stop_row_id.value() - 1;
+          }
+          zone_map_filter->batches_skipped++;
+          zone_map_filter->rows_skipped += skip_until - start_row_id + 1;
+          *last_read_row_id = skip_until;
+          start_row_id = skip_until + 1;
+          batch_id++;
+          if (hints != nullptr) {
+            hints->batch_id = batch_id;
+            hints->hint_type = TStoreType;
+          }
+
+          if (stop_row_id.has_value() && start_row_id >= stop_row_id.value()) {
+            return std::make_unique<RowBatchSlice>(schema::RowDescriptor(col_types), 0);
+          }
+          if (batch_id > LastBatchID()) {
+            return std::unique_ptr<RowBatchSlice>(nullptr);
+          }
+        }
+      }
+    }
+
     RowID batch_first_row_id = BatchFirstRowID(batch_id);
+    if (start_row_id < batch_first_row_id) {
+      // The disk store can have gaps, where batches failed to be written or were expired from the
+      // hot store. Those rows are gone, so skip to the next batch.
+      if (stop_row_id.has_value() && batch_first_row_id >= stop_row_id.value()) {
+        *last_read_row_id = stop_row_id.value() - 1;
+        return std::make_unique<RowBatchSlice>(schema::RowDescriptor(col_types), 0);
+      }
+      start_row_id = batch_first_row_id;
+    }
+    const auto& batch = GetBatchFromBatchID(batch_id);
     RowID batch_last_row_id = BatchLastRowID(batch_id);
     size_t row_offset = start_row_id - batch_first_row_id;
     size_t batch_size = batch_last_row_id - start_row_id + 1;
@@ -118,16 +196,9 @@ class StoreWithRowTimeAccounting {
       batch_size -= (batch_last_row_id - stop_row_id.value()) + 1;
     }
 
-    // Get column types for row descriptor.
-    std::vector<types::DataType> col_types;
-    for (int64_t col_idx : cols) {
-      DCHECK(static_cast<size_t>(col_idx) < rel_.NumColumns());
-      col_types.push_back(rel_.col_types()[col_idx]);
-    }
-    auto output_rb =
-        std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
+    auto slice = std::make_unique<RowBatchSlice>(schema::RowDescriptor(col_types), batch_size);
     PL_RETURN_IF_ERROR(
-        AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, output_rb.get()));
+        AddBatchSliceToRowBatchSlice(batch_id, batch, row_offset, batch_size, cols, slice.get()));
 
     // Update the ptr to the last read row.
     *last_read_row_id = start_row_id + batch_size - 1;
@@ -136,7 +207,7 @@ class StoreWithRowTimeAccounting {
     // exist, as the next call will ignore the hints if that's the case.
     hints->batch_id = batch_id + 1;
     hints->hint_type = TStoreType;
-    return output_rb;
+    return slice;
   }
 
   /**
@@ -164,6 +235,11 @@ class StoreWithRowTimeAccounting {
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
+    if constexpr (TStoreType == StoreType::Cold) {
+      zone_maps_.pop_front();
+      first_unfrozen_batch_id_ = std::max(first_unfrozen_batch_id_, first_batch_id_);
+      thaw_cache_->EraseBefore(first_batch_id_);
+    }
 
     auto&& front = std::move(batches_.front());
     batches_.pop_front();
@@ -182,13 +258,94 @@ class StoreWithRowTimeAccounting {
 
     row_ids_.emplace_back(first_row_id, first_row_id + BatchLength(batch) - 1);
     if (time_col_idx_ != -1) {
-      auto first_time = GetTimeValue(batch, 0);
-      auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
-      times_.emplace_back(first_time, last_time);
+      if constexpr (std::is_same_v<TBatch, DiskSegment>) {
+        // Disk segments keep their time range in memory, so that the file isn't read here.
+        times_.emplace_back(batch.FirstTime(), batch.LastTime());
+      } else {
+        auto first_time = GetTimeValue(batch, 0);
+        auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
+        times_.emplace_back(first_time, last_time);
+      }
+    }
+    if constexpr (TStoreType == StoreType::Cold) {
+      zone_maps_.push_back(ComputeBatchZoneMap(rel_, batch));
     }
     return batch;
   }
 
+  /**
+   * FreezeNextBatch compresses the columns of the oldest batch in the store that isn't frozen yet,
+   * if all of its rows have a time before `freeze_before`. The time column, dictionary encoded
+   * columns, columns with nulls and columns that don't compress are left as is. Frozen columns are
+   * decompressed on demand by GetNextRowBatchSlice, and the decompressed columns of the last few
+   * batches read are cached. This method is only valid for the `Cold` store, and fails to compile
+   * if called on the `Hot` store. Frozen batches are always a prefix of the store.
+   * @param freeze_before, time before which all rows of a batch must be for it to be frozen.
+   * @return the number of bytes saved by freezing the batch, measured the way BatchSizeAccountant
+   * measures sizes, or std::nullopt if there was no batch to freeze.
+   */
+  StatusOr<std::optional<int64_t>> FreezeNextBatch(Time freeze_before) {
+    if constexpr (TStoreType == StoreType::Cold) {
+      if (time_col_idx_ == -1 || first_unfrozen_batch_id_ > LastBatchID() ||
+          times_[first_unfrozen_batch_id_ - first_batch_id_].second >= freeze_before) {
+        return std::optional<int64_t>();
+      }
+      auto& batch = GetBatchFromBatchID(first_unfrozen_batch_id_);
+      int64_t bytes_saved = 0;
+      for (const auto& [col_idx, col_type] : Enumerate(rel_.col_types())) {
+        const auto& arr = batch.columns[col_idx];
+        if (static_cast<int64_t>(col_idx) == time_col_idx_ || batch.IsDictionaryEncoded(col_idx) ||
+            arr->null_count() > 0) {
+          continue;
+        }
+        PL_ASSIGN_OR_RETURN(auto frozen, FreezeColumn(col_type, arr.get()));
+        if (frozen.Bytes() >= frozen.uncompressed_bytes) {
+          continue;
+        }
+        // The serialized strings are prefixed with their lengths, but BatchSizeAccountant charges
+        // the offsets of a STRING column as a fixed cost that it never gives back. So only the
+        // compressed string data counts against the data that it charged.
+        int64_t accounted_bytes = frozen.uncompressed_bytes;
+        if (col_type == types::DataType::STRING) {
+          accounted_bytes -= frozen.length * static_cast<int64_t>(sizeof(uint32_t));
+        }
+        bytes_saved += std::max<int64_t>(0, accounted_bytes - frozen.Bytes());
+        batch.frozen_columns[col_idx] = std::make_shared<const FrozenColumn>(std::move(frozen));
+        batch.columns[col_idx].reset();
+      }
+      first_unfrozen_batch_id_++;
+      return std::optional<int64_t>(bytes_saved);
+    } else {
+      constexpr_else_static_assert_false();
+    }
+  }
+
+  /**
+   * Sets the most bytes of decompressed columns that are cached for reads of frozen batches. This
+   * method is only valid for the `Cold` store.
+   * @param max_thawed_bytes the size of the cache in bytes.
+   */
+  void set_max_thawed_bytes(int64_t max_thawed_bytes) {
+    if constexpr (TStoreType == StoreType::Cold) {
+      thaw_cache_->set_max_bytes(max_thawed_bytes);
+    } else {
+      constexpr_else_static_assert_false();
+    }
+  }
+
+  /**
+   * ThawedBytes returns the bytes of decompressed columns cached for reads of frozen batches.
+   * @return size of the cache in bytes.
+   */
+  int64_t ThawedBytes() const { return thaw_cache_->bytes(); }
+
+  /**
+   * NumFrozenBatches returns the number of batches at the front of the store that were frozen by
+   * FreezeNextBatch.
+   * @return number of frozen batches.
+   */
+  size_t NumFrozenBatches() const { return first_unfrozen_batch_id_ - first_batch_id_; }
+
   /**
    * FirstRowID returns the RowID of the first row in the store.
    * @return RowID of the first row in the store.
@@ -249,6 +406,37 @@ class StoreWithRowTimeAccounting {
     return row_ids_[batch_index].first + row_offset;
   }
 
+  /**
+   * FindSegmentFromTime finds the segment with the first row whose time is greater than (or equal
+   * to, if `inclusive`) the given time. This method is only valid for the `Disk` store, and fails
+   * to compile if called on the other stores.
+   * @param time, time to search for.
+   * @param inclusive, whether rows with the given time match.
+   * @return the segment to search with DiskSegmentTimeSearch::Find, or std::nullopt if no segment
+   * has a matching row. On error returns a Status.
+   */
+  StatusOr<std::optional<DiskSegmentTimeSearch>> FindSegmentFromTime(Time time,
+                                                                     bool inclusive) const {
+    if constexpr (TStoreType == StoreType::Disk) {
+      if (time_col_idx_ == -1) {
+        return std::optional<DiskSegmentTimeSearch>();
+      }
+      auto it = inclusive ? std::lower_bound(times_.begin(), times_.end(), time,
+                                             TimeIntervalComparatorLowerBound)
+                          : std::upper_bound(times_.begin(), times_.end(), time,
+                                             TimeIntervalComparatorUpperBound);
+      if (it == times_.end()) {
+        return std::optional<DiskSegmentTimeSearch>();
+      }
+      size_t batch_index = std::distance(times_.begin(), it);
+      PL_ASSIGN_OR_RETURN(auto readers, batches_[batch_index].MapColumns({time_col_idx_}));
+      return std::optional<DiskSegmentTimeSearch>(
+          DiskSegmentTimeSearch{row_ids_[batch_index].first, std::move(readers[0])});
+    } else {
+      constexpr_else_static_assert_false();
+    }
+  }
+
   /**
    * RemovePrefix removes the given number of rows from the first batch in the store. This method is
    * only valid for the `Hot` store, and fails to compile if called on the `Cold` store. Note that
@@ -284,6 +472,19 @@ class StoreWithRowTimeAccounting {
     return times_.front().first;
   }
 
+  /**
+   * MaxTime returns the maximum time in the store. Since the store is assumed to be time-sorted,
+   * this is equivalent to returning the time of the last row in the store.
+   * @return maximum time in the store, or -1 if there are no rows in the store or there is no time
+   * column.
+   */
+  int64_t MaxTime() const {
+    if (time_col_idx_ == -1 || times_.empty()) {
+      return -1;
+    }
+    return times_.back().second;
+  }
+
  private:
   BatchID LastBatchID() const { return first_batch_id_ + batches_.size() - 1; }
 
@@ -330,9 +531,11 @@ class StoreWithRowTimeAccounting {
 
   size_t BatchLength(const TBatch& batch) const {
     if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
+      return batch.Length();
     } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
       return batch.Length();
+    } else if constexpr (std::is_same_v<DiskSegment, TBatch>) {
+      return batch.Length();
     } else {
       constexpr_else_static_assert_false();
     }
@@ -341,10 +544,11 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+          batch.columns[time_col_idx_].get(), time);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
     } else {
+      // The Disk store is searched with FindSegmentFromTime.
       constexpr_else_static_assert_false();
     }
   }
@@ -352,19 +556,20 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
+                 batch.columns[time_col_idx_].get(), time) +
              1;
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
     } else {
+      // The Disk store is searched with FindSegmentFromTime.
       constexpr_else_static_assert_false();
     }
   }
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+          batch.columns[time_col_idx_].get(), row_idx);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.GetTimeValue(time_col_idx_, row_idx);
     } else {
@@ -372,17 +577,54 @@ class StoreWithRowTimeAccounting {
     }
   }
 
-  Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
-                                 const std::vector<int64_t>& cols,
-                                 schema::RowBatch* output_rb) const {
+  Status AddBatchSliceToRowBatchSlice(BatchID batch_id, const TBatch& batch, size_t row_offset,
+                                      size_t batch_size, const std::vector<int64_t>& cols,
+                                      RowBatchSlice* slice) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
-        PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+        if (batch.IsFrozen(col_idx)) {
+          // Frozen columns are decompressed once the store's lock has been released. The lock of
+          // the thaw cache is only held to look up and publish the decompressed column.
+          slice->AddDeferredColumn(
+              [cache = thaw_cache_, frozen = batch.frozen_columns[col_idx], batch_id,
+               num_columns = batch.columns.size(), col_idx, row_offset,
+               batch_size](arrow::MemoryPool*) -> StatusOr<ArrowArrayPtr> {
+                PL_ASSIGN_OR_RETURN(auto arr,
+                                    cache->GetOrThaw(batch_id, num_columns, col_idx, *frozen));
+                return arr->Slice(row_offset, batch_size);
+              });
+          continue;
+        }
+        if (batch.IsDictionaryEncoded(col_idx)) {
+          // Dictionary encoded columns are decoded lazily, only for the rows being read, and only
+          // once the store's lock has been released.
+          slice->AddDeferredColumn(
+              [codes = batch.columns[col_idx], dictionary = batch.dictionaries[col_idx],
+               row_offset, batch_size](arrow::MemoryPool* mem_pool) {
+                return DecodeDictionarySlice(codes.get(), dictionary.get(), row_offset,
+                                             batch_size, mem_pool);
+              });
+          continue;
+        }
+        slice->AddColumn(batch.columns[col_idx]->Slice(row_offset, batch_size));
       }
       return Status::OK();
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
-      return batch.AddBatchSliceToRowBatch(row_offset, batch_size, cols, output_rb);
+      batch.AddBatchSliceToRowBatchSlice(row_offset, batch_size, cols, slice);
+      return Status::OK();
+    } else if constexpr (std::is_same_v<TBatch, DiskSegment>) {
+      // Only the file is mapped here. The columns are decompressed when the slice is materialized,
+      // after the store's lock has been released.
+      PL_ASSIGN_OR_RETURN(auto readers, batch.MapColumns(cols));
+      for (auto& reader : readers) {
+        slice->AddDeferredColumn(
+            [reader = std::move(reader), row_offset,
+             batch_size](arrow::MemoryPool* mem_pool) -> StatusOr<ArrowArrayPtr> {
+              PL_ASSIGN_OR_RETURN(auto arr, reader(mem_pool));
+              return arr->Slice(row_offset, batch_size);
+            });
+      }
+      return Status::OK();
     } else {
       constexpr_else_static_assert_false();
     }
@@ -394,6 +636,13 @@ class StoreWithRowTimeAccounting {
   std::deque<TBatch> batches_;
   std::deque<RowIDInterval> row_ids_;
   std::deque<TimeInterval> times_;
+  // Only populated for the Cold store.
+  std::deque<BatchZoneMap> zone_maps_;
+  // Frozen batch state, only used by the Cold store.
+  static constexpr int64_t kDefaultMaxThawedBytes = 16 * 1024 * 1024;
+  BatchID first_unfrozen_batch_id_ = 0;
+  // Shared with the deferred columns of slices of frozen batches, which may outlive the store.
+  std::shared_ptr<ThawCache> thaw_cache_ = std::make_shared<ThawCache>(kDefaultMaxThawedBytes);
 };
 
 }  // namespace internal
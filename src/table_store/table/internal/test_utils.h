@@ -81,8 +81,7 @@ class RecordOrRowBatchParamTest : public ::testing::TestWithParam<std::vector<bo
     auto rb_w_cache = std::make_unique<RecordBatchWithCache>();
     rb_w_cache->record_batch = std::move(record_batch);
     size_t num_cols = 3;
-    rb_w_cache->cache_validity = std::vector<bool>(num_cols, false);
-    rb_w_cache->arrow_cache = std::vector<ArrowArrayPtr>(num_cols, nullptr);
+    rb_w_cache->arrow_cache = std::make_shared<ArrowColumnCache>(num_cols);
     return rb_w_cache;
   }
 
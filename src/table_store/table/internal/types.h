@@ -20,6 +20,7 @@
 
 #include <arrow/array.h>
 
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <utility>
@@ -42,17 +43,42 @@ using RowID = int64_t;
 using RowIDInterval = std::pair<RowID, RowID>;
 using BatchID = int64_t;
 
+/**
+ * ArrowColumnCache stores the arrow arrays that the columns of a hot batch have been converted to.
+ * Readers convert columns after releasing the table locks, so entries are read and published
+ * atomically, and the cache is shared between the batch and any reads of it that are in flight.
+ */
+class ArrowColumnCache {
+ public:
+  explicit ArrowColumnCache(size_t num_cols) : columns_(num_cols) {}
+
+  /**
+   * Get returns the cached arrow array for the given column, or nullptr if it hasn't been cached.
+   */
+  ArrowArrayPtr Get(size_t col_idx) const { return std::atomic_load(&columns_[col_idx]); }
+
+  /**
+   * Set publishes the arrow array for the given column.
+   */
+  void Set(size_t col_idx, ArrowArrayPtr arr) {
+    std::atomic_store(&columns_[col_idx], std::move(arr));
+  }
+
+ private:
+  std::vector<ArrowArrayPtr> columns_;
+};
+
 struct RecordBatchWithCache {
   RecordBatchPtr record_batch;
   // Whenever we have to convert a hot batch to an arrow array, we store the arrow array in
   // this cache. Compaction will eventually take these arrow arrays and move them into cold.
-  mutable std::vector<ArrowArrayPtr> arrow_cache;
-  mutable std::vector<bool> cache_validity;
+  std::shared_ptr<ArrowColumnCache> arrow_cache;
 };
 
 enum StoreType {
   Hot,
   Cold,
+  Disk,
 };
 
 struct BatchHints {
@@ -61,8 +87,35 @@ struct BatchHints {
 };
 
 class RecordOrRowBatch;
+class DiskSegment;
 
-using ColdBatch = std::vector<ArrowArrayPtr>;
+struct FrozenColumn;
+
+/**
+ * ColdBatch stores the compacted columns of a batch in the cold store. STRING columns can be
+ * dictionary encoded at compaction time (see dictionary_encoding.h), in which case
+ * `columns[col_idx]` holds an arrow::Int16Array of codes into `dictionaries[col_idx]`. For columns
+ * that aren't encoded, `dictionaries[col_idx]` is nullptr.
+ * Once a batch is old enough it can be frozen (see frozen_column.h), in which case
+ * `columns[col_idx]` is released and `frozen_columns[col_idx]` holds a compressed copy of it.
+ */
+struct ColdBatch {
+  ColdBatch() = default;
+  explicit ColdBatch(std::vector<ArrowArrayPtr> cols)
+      : columns(std::move(cols)),
+        dictionaries(columns.size()),
+        frozen_columns(columns.size()),
+        num_rows(columns[0]->length()) {}
+
+  bool IsDictionaryEncoded(int64_t col_idx) const { return dictionaries[col_idx] != nullptr; }
+  bool IsFrozen(int64_t col_idx) const { return frozen_columns[col_idx] != nullptr; }
+  int64_t Length() const { return num_rows; }
+
+  std::vector<ArrowArrayPtr> columns;
+  std::vector<ArrowArrayPtr> dictionaries;
+  std::vector<std::shared_ptr<const FrozenColumn>> frozen_columns;
+  int64_t num_rows = 0;
+};
 
 template <StoreType type>
 struct StoreTypeTraits {};
@@ -74,6 +127,10 @@ template <>
 struct StoreTypeTraits<StoreType::Cold> {
   using batch_type = ColdBatch;
 };
+template <>
+struct StoreTypeTraits<StoreType::Disk> {
+  using batch_type = DiskSegment;
+};
 
 }  // namespace internal
 }  // namespace table_store
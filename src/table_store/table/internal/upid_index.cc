@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "src/table_store/table/internal/upid_index.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+std::vector<UPIDIndex::Run> UPIDIndex::ComputeRuns(const RecordOrRowBatch& batch,
+                                                   int64_t upid_col_idx) {
+  std::vector<Run> runs;
+  auto length = static_cast<int64_t>(batch.Length());
+  for (int64_t row_idx = 0; row_idx < length; ++row_idx) {
+    auto upid = batch.GetUInt128Value(upid_col_idx, row_idx);
+    if (!runs.empty() && runs.back().upid == upid) {
+      runs.back().end_row = row_idx;
+      continue;
+    }
+    runs.push_back(Run{upid, row_idx, row_idx});
+  }
+  return runs;
+}
+
+void UPIDIndex::AddRuns(RowID first_row_id, const std::vector<Run>& runs) {
+  for (const auto& run : runs) {
+    RowIDInterval interval{first_row_id + run.start_row, first_row_id + run.end_row};
+    auto& upid_intervals = intervals_[run.upid];
+    if (!upid_intervals.empty() &&
+        interval.first - upid_intervals.back().second <= kMaxMergeGapRows) {
+      upid_intervals.back().second = interval.second;
+      continue;
+    }
+    upid_intervals.push_back(interval);
+    num_intervals_++;
+  }
+}
+
+void UPIDIndex::ExpireBefore(RowID first_row_id) {
+  for (auto it = intervals_.begin(); it != intervals_.end();) {
+    auto& upid_intervals = it->second;
+    while (!upid_intervals.empty() && upid_intervals.front().second < first_row_id) {
+      upid_intervals.pop_front();
+      num_intervals_--;
+    }
+    if (upid_intervals.empty()) {
+      intervals_.erase(it++);
+      continue;
+    }
+    upid_intervals.front().first = std::max(upid_intervals.front().first, first_row_id);
+    ++it;
+  }
+}
+
+std::optional<RowIDInterval> UPIDIndex::NextInterval(
+    const absl::flat_hash_set<absl::uint128>& upids, RowID row_id) const {
+  std::optional<RowIDInterval> next;
+  for (const auto& upid : upids) {
+    auto it = intervals_.find(upid);
+    if (it == intervals_.end()) {
+      continue;
+    }
+    const auto& upid_intervals = it->second;
+    // Find the first interval that ends at or after `row_id`.
+    auto interval_it = std::lower_bound(
+        upid_intervals.begin(), upid_intervals.end(), row_id,
+        [](const RowIDInterval& interval, RowID id) { return interval.second < id; });
+    if (interval_it == upid_intervals.end()) {
+      continue;
+    }
+    RowIDInterval interval{std::max(interval_it->first, row_id), interval_it->second};
+    if (!next.has_value() || interval.first < next->first) {
+      next = interval;
+    }
+  }
+  return next;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/numeric/int128.h>
+
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * UPIDIndex maps each UPID in a table to the ranges of RowIDs that contain it, so that reads
+ * filtered on a UPID can skip straight to the rows of that UPID instead of scanning the table.
+ *
+ * Ranges of the same UPID that are less than `kMaxMergeGapRows` rows apart are merged, to bound
+ * the size of the index when rows of different UPIDs are interleaved. As a result a range can
+ * contain rows of other UPIDs, so the index is a pre-filter only, and readers still have to
+ * filter the rows they get back.
+ *
+ * RowIDs don't change when batches are compacted, so the index only needs to be updated when rows
+ * are written or expired.
+ */
+class UPIDIndex {
+ public:
+  static constexpr int64_t kMaxMergeGapRows = 1024;
+
+  /**
+   * Run is a range of consecutive rows within a batch that have the same UPID. Rows are relative to
+   * the start of the batch.
+   */
+  struct Run {
+    absl::uint128 upid;
+    int64_t start_row;
+    int64_t end_row;
+  };
+
+  /**
+   * ComputeRuns returns the runs of consecutive rows with the same UPID in the given batch, in row
+   * order. This doesn't touch the index, so it can be called before taking the table's locks.
+   * @param batch the batch to compute runs for.
+   * @param upid_col_idx the index of the UINT128 UPID column.
+   * @return the runs in the batch.
+   */
+  static std::vector<Run> ComputeRuns(const RecordOrRowBatch& batch, int64_t upid_col_idx);
+
+  /**
+   * AddRuns adds the runs of a newly written batch to the index.
+   * @param first_row_id the RowID of the first row in the batch.
+   * @param runs the batch's runs, as returned by ComputeRuns.
+   */
+  void AddRuns(RowID first_row_id, const std::vector<Run>& runs);
+
+  /**
+   * ExpireBefore removes all rows with a RowID less than the given RowID from the index.
+   */
+  void ExpireBefore(RowID first_row_id);
+
+  /**
+   * NextInterval returns the first range of rows, at or after the given RowID, that may contain
+   * one of the given UPIDs.
+   * @param upids the UPIDs to look up.
+   * @param row_id the RowID to start looking at.
+   * @return the inclusive range of RowIDs, or std::nullopt if none of the UPIDs occur at or after
+   * `row_id`.
+   */
+  std::optional<RowIDInterval> NextInterval(const absl::flat_hash_set<absl::uint128>& upids,
+                                            RowID row_id) const;
+
+  /**
+   * NumIntervals returns the total number of row ranges stored in the index.
+   */
+  int64_t NumIntervals() const { return num_intervals_; }
+
+ private:
+  // The row ranges of each UPID, in RowID order.
+  absl::flat_hash_map<absl::uint128, std::deque<RowIDInterval>> intervals_;
+  int64_t num_intervals_ = 0;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/upid_index.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+RecordOrRowBatch MakeUPIDBatch(const std::vector<types::UInt128Value>& upids) {
+  schema::RowBatch rb(schema::RowDescriptor({types::DataType::UINT128}), upids.size());
+  PL_CHECK_OK(rb.AddColumn(types::ToArrow(upids, arrow::default_memory_pool())));
+  return RecordOrRowBatch(rb);
+}
+
+}  // namespace
+
+TEST(UPIDIndexTest, ComputeRuns) {
+  auto batch = MakeUPIDBatch({{0, 1}, {0, 1}, {0, 2}, {0, 1}, {0, 1}, {0, 1}});
+  auto runs = UPIDIndex::ComputeRuns(batch, 0);
+  ASSERT_EQ(3, runs.size());
+  EXPECT_EQ(absl::MakeUint128(0, 1), runs[0].upid);
+  EXPECT_EQ(0, runs[0].start_row);
+  EXPECT_EQ(1, runs[0].end_row);
+  EXPECT_EQ(absl::MakeUint128(0, 2), runs[1].upid);
+  EXPECT_EQ(2, runs[1].start_row);
+  EXPECT_EQ(2, runs[1].end_row);
+  EXPECT_EQ(absl::MakeUint128(0, 1), runs[2].upid);
+  EXPECT_EQ(3, runs[2].start_row);
+  EXPECT_EQ(5, runs[2].end_row);
+
+  // Runs are relative to the start of the batch, even after a prefix has been removed.
+  batch.RemovePrefix(3);
+  runs = UPIDIndex::ComputeRuns(batch, 0);
+  ASSERT_EQ(1, runs.size());
+  EXPECT_EQ(0, runs[0].start_row);
+  EXPECT_EQ(2, runs[0].end_row);
+}
+
+TEST(UPIDIndexTest, NextInterval) {
+  auto upid_a = absl::MakeUint128(0, 1);
+  auto upid_b = absl::MakeUint128(0, 2);
+  auto upid_c = absl::MakeUint128(0, 3);
+
+  UPIDIndex index;
+  index.AddRuns(0, {{upid_a, 0, 9}, {upid_b, 10, 19}});
+  // Far enough away from the first run of `upid_a` that it isn't merged with it.
+  index.AddRuns(5000, {{upid_a, 0, 9}});
+  EXPECT_EQ(3, index.NumIntervals());
+
+  EXPECT_EQ(RowIDInterval(0, 9), index.NextInterval({upid_a}, 0));
+  EXPECT_EQ(RowIDInterval(5, 9), index.NextInterval({upid_a}, 5));
+  EXPECT_EQ(RowIDInterval(5000, 5009), index.NextInterval({upid_a}, 10));
+  EXPECT_EQ(std::nullopt, index.NextInterval({upid_a}, 5010));
+  EXPECT_EQ(RowIDInterval(10, 19), index.NextInterval({upid_b}, 0));
+  EXPECT_EQ(RowIDInterval(10, 19), index.NextInterval({upid_a, upid_b}, 10));
+  EXPECT_EQ(std::nullopt, index.NextInterval({upid_c}, 0));
+}
+
+TEST(UPIDIndexTest, MergesNearbyRuns) {
+  auto upid_a = absl::MakeUint128(0, 1);
+  auto upid_b = absl::MakeUint128(0, 2);
+
+  UPIDIndex index;
+  index.AddRuns(0, {{upid_a, 0, 0}, {upid_b, 1, 1}, {upid_a, 2, 2}});
+  index.AddRuns(3, {{upid_b, 0, 0}, {upid_a, 1, 1}});
+  EXPECT_EQ(2, index.NumIntervals());
+  EXPECT_EQ(RowIDInterval(0, 4), index.NextInterval({upid_a}, 0));
+  EXPECT_EQ(RowIDInterval(1, 3), index.NextInterval({upid_b}, 0));
+}
+
+TEST(UPIDIndexTest, ExpireBefore) {
+  auto upid_a = absl::MakeUint128(0, 1);
+  auto upid_b = absl::MakeUint128(0, 2);
+
+  UPIDIndex index;
+  index.AddRuns(0, {{upid_a, 0, 9}, {upid_b, 10, 4999}});
+  index.AddRuns(5000, {{upid_a, 0, 9}});
+
+  index.ExpireBefore(20);
+  EXPECT_EQ(2, index.NumIntervals());
+  EXPECT_EQ(RowIDInterval(5000, 5009), index.NextInterval({upid_a}, 0));
+  EXPECT_EQ(RowIDInterval(20, 4999), index.NextInterval({upid_b}, 0));
+
+  index.ExpireBefore(5000);
+  EXPECT_EQ(1, index.NumIntervals());
+  EXPECT_EQ(std::nullopt, index.NextInterval({upid_b}, 0));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
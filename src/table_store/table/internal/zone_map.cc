@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+template <types::DataType T>
+auto GetZoneMapValueFromArrowArray(const arrow::Array* arr, int64_t idx) {
+  if constexpr (T == types::DataType::STRING) {
+    // Avoid the copy of GetValueFromArrowArray, the views only need to live as long as `arr`.
+    return types::GetStringViewFromArrowArray(arr, idx);
+  } else {
+    return types::GetValueFromArrowArray<T>(arr, idx);
+  }
+}
+
+template <types::DataType T>
+ColumnZoneMap ComputeColumnZoneMap(const arrow::Array* arr) {
+  using ValueType = decltype(GetZoneMapValueFromArrowArray<T>(arr, 0));
+
+  ColumnZoneMap zone_map;
+  zone_map.null_count = arr->null_count();
+
+  bool initialized = false;
+  bool has_nan = false;
+  ValueType min{};
+  ValueType max{};
+  absl::flat_hash_set<ValueType> distinct_values;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    if (arr->IsNull(i)) {
+      continue;
+    }
+    auto val = GetZoneMapValueFromArrowArray<T>(arr, i);
+    if constexpr (T == types::DataType::FLOAT64) {
+      if (std::isnan(val)) {
+        has_nan = true;
+        continue;
+      }
+    }
+    if (!initialized) {
+      min = val;
+      max = val;
+      initialized = true;
+    } else if (val < min) {
+      min = val;
+    } else if (max < val) {
+      max = val;
+    }
+    if (static_cast<int64_t>(distinct_values.size()) <= ColumnZoneMap::kMaxTrackedDistinctValues) {
+      distinct_values.insert(val);
+    }
+  }
+
+  zone_map.distinct_count = distinct_values.size();
+  // NaNs aren't ordered, so we can't produce a useful range for columns that contain them.
+  zone_map.has_min_max = initialized && !has_nan;
+  if (zone_map.has_min_max) {
+    if constexpr (T == types::DataType::STRING) {
+      zone_map.min = std::string(min);
+      zone_map.max = std::string(max);
+    } else if constexpr (T == types::DataType::TIME64NS) {
+      zone_map.min = static_cast<int64_t>(min);
+      zone_map.max = static_cast<int64_t>(max);
+    } else {
+      zone_map.min = min;
+      zone_map.max = max;
+    }
+  }
+  return zone_map;
+}
+
+}  // namespace
+
+bool ColumnZoneMap::MayMatch(ColumnPredicate::Op op, const ZoneMapValue& value) const {
+  // Without a valid range, or with a mismatched type, we can't rule anything out.
+  if (!has_min_max || value.index() != min.index()) {
+    return true;
+  }
+  switch (op) {
+    case ColumnPredicate::kEqual:
+      return !(value < min) && !(max < value);
+    case ColumnPredicate::kNotEqual:
+      return !(min == value && max == value);
+    case ColumnPredicate::kLessThan:
+      return min < value;
+    case ColumnPredicate::kLessThanEqual:
+      return !(value < min);
+    case ColumnPredicate::kGreaterThan:
+      return value < max;
+    case ColumnPredicate::kGreaterThanEqual:
+      return !(max < value);
+  }
+  return true;
+}
+
+BatchZoneMap ComputeBatchZoneMap(const schema::Relation& rel, const ColdBatch& batch) {
+  BatchZoneMap zone_map;
+  zone_map.reserve(batch.columns.size());
+  for (const auto& [col_idx, arr] : Enumerate(batch.columns)) {
+    if (batch.IsDictionaryEncoded(col_idx)) {
+      // Every dictionary value is used by at least one row, so the dictionary has the same range
+      // and distinct values as the column. Only nulls need to be counted on the codes.
+      auto column_zone_map =
+          ComputeColumnZoneMap<types::DataType::STRING>(batch.dictionaries[col_idx].get());
+      column_zone_map.null_count = arr->null_count();
+      zone_map.push_back(std::move(column_zone_map));
+      continue;
+    }
+#define TYPE_CASE(_dt_) zone_map.push_back(ComputeColumnZoneMap<_dt_>(arr.get()))
+    PL_SWITCH_FOREACH_DATATYPE(rel.GetColumnType(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return zone_map;
+}
+
+bool ZoneMapFilter::MayMatch(const BatchZoneMap& zone_map) const {
+  for (const auto& predicate : predicates) {
+    if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(zone_map.size())) {
+      continue;
+    }
+    if (!zone_map[predicate.col_idx].MayMatch(predicate.op, predicate.value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
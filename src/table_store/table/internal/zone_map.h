@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/numeric/int128.h>
+
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ZoneMapValue holds a single value of any of the column types supported by the table store.
+ * TIME64NS values are stored as int64_t, so a TIME64NS column can be compared against INT64
+ * literals.
+ * Comparisons between values holding different alternatives are never performed, see
+ * ColumnZoneMap::MayMatch.
+ */
+using ZoneMapValue = std::variant<bool, int64_t, absl::uint128, double, std::string>;
+
+/**
+ * ColumnPredicate is a simple `column <op> literal` comparison that can be checked against the
+ * zone map of a batch. A batch whose zone map can't satisfy the predicate can be skipped entirely.
+ */
+struct ColumnPredicate {
+  enum Op {
+    kEqual,
+    kNotEqual,
+    kLessThan,
+    kLessThanEqual,
+    kGreaterThan,
+    kGreaterThanEqual,
+  };
+  // Index of the column in the table's relation.
+  int64_t col_idx;
+  Op op;
+  ZoneMapValue value;
+};
+
+/**
+ * ColumnZoneMap summarizes the values of a single column in a single batch.
+ */
+struct ColumnZoneMap {
+  // Distinct values are tracked exactly up to this many values. Past that, distinct_count is set to
+  // kMaxTrackedDistinctValues + 1 and should be read as "many".
+  static constexpr int64_t kMaxTrackedDistinctValues = 256;
+
+  // Whether min/max are valid. This is false if every value in the column is null.
+  bool has_min_max = false;
+  ZoneMapValue min;
+  ZoneMapValue max;
+  int64_t null_count = 0;
+  int64_t distinct_count = 0;
+
+  /**
+   * Returns false only if no value in the column can satisfy the given predicate. Predicates with a
+   * value type that doesn't match the zone map type always return true.
+   */
+  bool MayMatch(ColumnPredicate::Op op, const ZoneMapValue& value) const;
+};
+
+/**
+ * BatchZoneMap stores a ColumnZoneMap for each column of a batch.
+ */
+using BatchZoneMap = std::vector<ColumnZoneMap>;
+
+/**
+ * Computes the zone map for each column in the given cold batch.
+ * @param rel the relation of the table the batch belongs to.
+ * @param batch the batch to compute zone maps for.
+ * @return zone maps for each column in the batch.
+ */
+BatchZoneMap ComputeBatchZoneMap(const schema::Relation& rel, const ColdBatch& batch);
+
+/**
+ * ZoneMapFilter holds a conjunction of ColumnPredicates, as well as counters of how much data has
+ * been skipped because of them. It's owned by a Table::Cursor and passed to the cold store on every
+ * read.
+ */
+struct ZoneMapFilter {
+  std::vector<ColumnPredicate> predicates;
+  int64_t batches_skipped = 0;
+  int64_t rows_skipped = 0;
+
+  bool empty() const { return predicates.empty(); }
+
+  /**
+   * Returns false if any of the predicates can't be satisfied by the batch with the given zone map.
+   */
+  bool MayMatch(const BatchZoneMap& zone_map) const;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
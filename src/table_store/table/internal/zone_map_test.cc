@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+class ZoneMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::INT64,
+                                     types::DataType::STRING},
+        std::vector<std::string>{"time_", "resp_status", "req_path"});
+  }
+
+  ColdBatch MakeBatch(const std::vector<types::Time64NSValue>& times,
+                      const std::vector<types::Int64Value>& ints,
+                      const std::vector<types::StringValue>& strings) {
+    return ColdBatch(std::vector<ArrowArrayPtr>{
+        types::ToArrow(times, arrow::default_memory_pool()),
+        types::ToArrow(ints, arrow::default_memory_pool()),
+        types::ToArrow(strings, arrow::default_memory_pool()),
+    });
+  }
+
+  std::unique_ptr<schema::Relation> rel_;
+};
+
+TEST_F(ZoneMapTest, ComputeBatchZoneMap) {
+  auto batch = MakeBatch({1, 2, 3, 4}, {200, 404, 200, 500}, {"/b", "/a", "/c", "/a"});
+  auto zone_map = ComputeBatchZoneMap(*rel_, batch);
+  ASSERT_EQ(3, zone_map.size());
+
+  EXPECT_TRUE(zone_map[0].has_min_max);
+  EXPECT_EQ(ZoneMapValue(int64_t{1}), zone_map[0].min);
+  EXPECT_EQ(ZoneMapValue(int64_t{4}), zone_map[0].max);
+  EXPECT_EQ(4, zone_map[0].distinct_count);
+
+  EXPECT_EQ(ZoneMapValue(int64_t{200}), zone_map[1].min);
+  EXPECT_EQ(ZoneMapValue(int64_t{500}), zone_map[1].max);
+  EXPECT_EQ(3, zone_map[1].distinct_count);
+  EXPECT_EQ(0, zone_map[1].null_count);
+
+  EXPECT_EQ(ZoneMapValue(std::string("/a")), zone_map[2].min);
+  EXPECT_EQ(ZoneMapValue(std::string("/c")), zone_map[2].max);
+  EXPECT_EQ(3, zone_map[2].distinct_count);
+}
+
+TEST_F(ZoneMapTest, ColumnMayMatch) {
+  auto batch = MakeBatch({1, 2, 3}, {200, 300, 400}, {"a", "b", "b"});
+  auto zone_map = ComputeBatchZoneMap(*rel_, batch);
+  const auto& ints = zone_map[1];
+
+  EXPECT_TRUE(ints.MayMatch(ColumnPredicate::kEqual, int64_t{300}));
+  EXPECT_FALSE(ints.MayMatch(ColumnPredicate::kEqual, int64_t{100}));
+  EXPECT_FALSE(ints.MayMatch(ColumnPredicate::kEqual, int64_t{500}));
+  EXPECT_TRUE(ints.MayMatch(ColumnPredicate::kNotEqual, int64_t{200}));
+  EXPECT_FALSE(ints.MayMatch(ColumnPredicate::kLessThan, int64_t{200}));
+  EXPECT_TRUE(ints.MayMatch(ColumnPredicate::kLessThanEqual, int64_t{200}));
+  EXPECT_FALSE(ints.MayMatch(ColumnPredicate::kGreaterThan, int64_t{400}));
+  EXPECT_TRUE(ints.MayMatch(ColumnPredicate::kGreaterThanEqual, int64_t{400}));
+  // Mismatched types can't be ruled out.
+  EXPECT_TRUE(ints.MayMatch(ColumnPredicate::kEqual, std::string("abc")));
+
+  batch = MakeBatch({1, 2}, {200, 200}, {"a", "a"});
+  zone_map = ComputeBatchZoneMap(*rel_, batch);
+  EXPECT_FALSE(zone_map[2].MayMatch(ColumnPredicate::kNotEqual, std::string("a")));
+  EXPECT_TRUE(zone_map[2].MayMatch(ColumnPredicate::kNotEqual, std::string("b")));
+}
+
+TEST_F(ZoneMapTest, FilterIsConjunction) {
+  auto batch = MakeBatch({1, 2, 3}, {200, 300, 400}, {"a", "b", "c"});
+  auto zone_map = ComputeBatchZoneMap(*rel_, batch);
+
+  ZoneMapFilter filter;
+  EXPECT_TRUE(filter.MayMatch(zone_map));
+
+  filter.predicates.push_back({1, ColumnPredicate::kGreaterThanEqual, int64_t{400}});
+  EXPECT_TRUE(filter.MayMatch(zone_map));
+
+  filter.predicates.push_back({2, ColumnPredicate::kEqual, std::string("d")});
+  EXPECT_FALSE(filter.MayMatch(zone_map));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/rollup.h"
+
+#include <absl/container/flat_hash_set.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+// The compression of the latency sketches, the same as px.quantiles.
+constexpr double kDigestCompression = 1000;
+
+bool IsNumeric(types::DataType data_type) {
+  return data_type == types::DataType::INT64 || data_type == types::DataType::TIME64NS ||
+         data_type == types::DataType::FLOAT64;
+}
+
+int64_t GetInt64Value(const types::ColumnWrapper& col, size_t row) {
+  if (col.data_type() == types::DataType::TIME64NS) {
+    return col.Get<types::Time64NSValue>(row).val;
+  }
+  return col.Get<types::Int64Value>(row).val;
+}
+
+template <types::DataType TDataType>
+void AppendGroupKey(const types::ColumnWrapper& col, size_t row, std::string* key) {
+  using ValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  if constexpr (TDataType == types::DataType::STRING) {
+    auto value = col.GetView(row);
+    absl::StrAppend(key, value.size(), ":", value);
+  } else {
+    auto value = col.Get<ValueType>(row).val;
+    key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+}
+
+template <types::DataType TDataType>
+void AppendGroupValue(const types::ColumnWrapper& col, size_t row, types::ColumnWrapper* out) {
+  using ValueType = typename types::DataTypeTraits<TDataType>::value_type;
+  out->Append<ValueType>(col.Get<ValueType>(row));
+}
+
+std::string QuantilesToJSON(tdigest::TDigest* digest) {
+  rapidjson::Document d;
+  d.SetObject();
+  d.AddMember("p01", digest->quantile(0.01), d.GetAllocator());
+  d.AddMember("p10", digest->quantile(0.10), d.GetAllocator());
+  d.AddMember("p25", digest->quantile(0.25), d.GetAllocator());
+  d.AddMember("p50", digest->quantile(0.50), d.GetAllocator());
+  d.AddMember("p75", digest->quantile(0.75), d.GetAllocator());
+  d.AddMember("p90", digest->quantile(0.90), d.GetAllocator());
+  d.AddMember("p99", digest->quantile(0.99), d.GetAllocator());
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  d.Accept(writer);
+  return sb.GetString();
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<Rollup>> Rollup::Create(const RollupSpec& spec,
+                                                 const schema::Relation& source_relation,
+                                                 int64_t max_table_size) {
+  if (spec.bucket_ns <= 0) {
+    return error::InvalidArgument("Rollup '$0' has a non-positive bucket size ($1).", spec.name,
+                                  spec.bucket_ns);
+  }
+  if (!source_relation.HasColumn("time_") ||
+      source_relation.GetColumnType("time_") != types::DataType::TIME64NS) {
+    return error::InvalidArgument("Rollup '$0' requires a time_ column in table '$1'.", spec.name,
+                                  spec.source_table);
+  }
+  int64_t time_col_idx = source_relation.GetColumnIndex("time_");
+
+  std::vector<types::DataType> col_types = {types::DataType::TIME64NS};
+  std::vector<std::string> col_names = {"time_"};
+  absl::flat_hash_set<std::string> output_names = {"time_"};
+
+  std::vector<int64_t> group_by_col_idxs;
+  for (const auto& col_name : spec.group_by_cols) {
+    if (!source_relation.HasColumn(col_name)) {
+      return error::InvalidArgument("Rollup '$0' groups by '$1', which isn't in table '$2'.",
+                                    spec.name, col_name, spec.source_table);
+    }
+    if (!output_names.insert(col_name).second) {
+      return error::InvalidArgument("Rollup '$0' has a duplicate column '$1'.", spec.name,
+                                    col_name);
+    }
+    group_by_col_idxs.push_back(source_relation.GetColumnIndex(col_name));
+    col_types.push_back(source_relation.GetColumnType(col_name));
+    col_names.push_back(col_name);
+  }
+
+  std::vector<AggInput> agg_inputs;
+  for (const auto& agg : spec.aggregates) {
+    if (!output_names.insert(agg.output_col).second) {
+      return error::InvalidArgument("Rollup '$0' has a duplicate column '$1'.", spec.name,
+                                    agg.output_col);
+    }
+    if (agg.type == RollupAggType::kCount) {
+      agg_inputs.push_back({agg.type, -1, types::DataType::INT64});
+      col_types.push_back(types::DataType::INT64);
+      col_names.push_back(agg.output_col);
+      continue;
+    }
+    if (!source_relation.HasColumn(agg.input_col) ||
+        !IsNumeric(source_relation.GetColumnType(agg.input_col))) {
+      return error::InvalidArgument(
+          "Rollup '$0' aggregates '$1', which isn't a numeric column of table '$2'.", spec.name,
+          agg.input_col, spec.source_table);
+    }
+    auto data_type = source_relation.GetColumnType(agg.input_col);
+    agg_inputs.push_back({agg.type, source_relation.GetColumnIndex(agg.input_col), data_type});
+    if (agg.type == RollupAggType::kQuantiles) {
+      col_types.push_back(types::DataType::STRING);
+    } else if (data_type == types::DataType::FLOAT64) {
+      col_types.push_back(types::DataType::FLOAT64);
+    } else {
+      col_types.push_back(types::DataType::INT64);
+    }
+    col_names.push_back(agg.output_col);
+  }
+
+  schema::Relation relation(std::move(col_types), std::move(col_names));
+  // Create naked pointer, because std::make_unique() cannot access the private ctor.
+  return std::unique_ptr<Rollup>(new Rollup(spec, std::move(relation), time_col_idx,
+                                            std::move(group_by_col_idxs), std::move(agg_inputs),
+                                            max_table_size));
+}
+
+Rollup::Rollup(const RollupSpec& spec, schema::Relation relation, int64_t time_col_idx,
+               std::vector<int64_t> group_by_col_idxs, std::vector<AggInput> agg_inputs,
+               int64_t max_table_size)
+    : spec_(spec),
+      relation_(std::move(relation)),
+      time_col_idx_(time_col_idx),
+      allowed_lateness_ns_(spec.allowed_lateness_ns < 0 ? spec.bucket_ns
+                                                        : spec.allowed_lateness_ns),
+      group_by_col_idxs_(std::move(group_by_col_idxs)),
+      agg_inputs_(std::move(agg_inputs)),
+      table_(std::make_shared<Table>(spec.name, relation_, max_table_size)) {}
+
+Rollup::Bucket* Rollup::GetOrCreateBucket(int64_t bucket_start) {
+  auto [it, inserted] = buckets_.try_emplace(bucket_start);
+  if (inserted) {
+    // The group by columns follow the time_ column in the rollup relation.
+    for (size_t i = 0; i < group_by_col_idxs_.size(); ++i) {
+      it->second.group_values.push_back(
+          types::ColumnWrapper::Make(relation_.GetColumnType(1 + i), 0));
+    }
+    it->second.agg_states.resize(agg_inputs_.size());
+  }
+  return &it->second;
+}
+
+void Rollup::UpdateAggState(const AggInput& input, const types::ColumnWrapper& col, size_t row,
+                            AggState* state) {
+  int64_t int_value = 0;
+  double float_value = 0;
+  if (input.data_type == types::DataType::FLOAT64) {
+    float_value = col.Get<types::Float64Value>(row).val;
+  } else {
+    int_value = GetInt64Value(col, row);
+    float_value = static_cast<double>(int_value);
+  }
+
+  switch (input.type) {
+    case RollupAggType::kCount:
+      break;
+    case RollupAggType::kSum:
+      state->int_value += int_value;
+      state->float_value += float_value;
+      break;
+    case RollupAggType::kMin:
+      state->int_value = std::min(state->int_value, int_value);
+      state->float_value = std::min(state->float_value, float_value);
+      break;
+    case RollupAggType::kMax:
+      state->int_value = std::max(state->int_value, int_value);
+      state->float_value = std::max(state->float_value, float_value);
+      break;
+    case RollupAggType::kQuantiles:
+      state->digest->add(float_value);
+      break;
+  }
+}
+
+Status Rollup::Update(const types::ColumnWrapperRecordBatch& record_batch) {
+  const auto& time_col = *record_batch[time_col_idx_];
+  int64_t num_rows = time_col.Size();
+  for (int64_t row = 0; row < num_rows; ++row) {
+    int64_t time = time_col.Get<types::Time64NSValue>(row).val;
+    int64_t bucket_start = time - time % spec_.bucket_ns;
+    if (bucket_start < watermark_) {
+      late_rows_dropped_++;
+      continue;
+    }
+    max_time_ = std::max(max_time_, time);
+    Bucket* bucket = GetOrCreateBucket(bucket_start);
+
+    std::string key;
+    for (auto col_idx : group_by_col_idxs_) {
+      const auto& col = *record_batch[col_idx];
+#define TYPE_CASE(_dt_) AppendGroupKey<_dt_>(col, row, &key)
+      PL_SWITCH_FOREACH_DATATYPE(col.data_type(), TYPE_CASE);
+#undef TYPE_CASE
+    }
+
+    auto [group_it, new_group] = bucket->group_idx.try_emplace(key, bucket->counts.size());
+    int64_t group = group_it->second;
+    if (new_group) {
+      for (const auto& [i, col_idx] : Enumerate(group_by_col_idxs_)) {
+        const auto& col = *record_batch[col_idx];
+        auto* out = bucket->group_values[i].get();
+#define TYPE_CASE(_dt_) AppendGroupValue<_dt_>(col, row, out)
+        PL_SWITCH_FOREACH_DATATYPE(col.data_type(), TYPE_CASE);
+#undef TYPE_CASE
+      }
+      bucket->counts.push_back(0);
+    }
+    bucket->counts[group]++;
+
+    for (const auto& [i, input] : Enumerate(agg_inputs_)) {
+      auto& states = bucket->agg_states[i];
+      if (input.type == RollupAggType::kCount) {
+        continue;
+      }
+      const auto& col = *record_batch[input.col_idx];
+      if (new_group) {
+        states.emplace_back();
+        auto& state = states.back();
+        if (input.type == RollupAggType::kQuantiles) {
+          state.digest = std::make_unique<tdigest::TDigest>(kDigestCompression);
+        } else if (input.type != RollupAggType::kSum) {
+          // Min and max start from the first value of the group.
+          if (input.data_type == types::DataType::FLOAT64) {
+            state.float_value = col.Get<types::Float64Value>(row).val;
+          } else {
+            state.int_value = GetInt64Value(col, row);
+          }
+        }
+      }
+      UpdateAggState(input, col, row, &states[group]);
+    }
+  }
+
+  return WriteClosedBuckets();
+}
+
+Status Rollup::AdvanceTime(int64_t time_ns) {
+  max_time_ = std::max(max_time_, time_ns);
+  return WriteClosedBuckets();
+}
+
+Status Rollup::WriteClosedBuckets() {
+  // Write out the buckets that are too old to receive more rows.
+  while (!buckets_.empty()) {
+    auto it = buckets_.begin();
+    int64_t bucket_end = it->first + spec_.bucket_ns;
+    if (bucket_end + allowed_lateness_ns_ > max_time_) {
+      break;
+    }
+    PL_RETURN_IF_ERROR(WriteBucket(it->first, &it->second));
+    watermark_ = bucket_end;
+    buckets_.erase(it);
+  }
+  return Status::OK();
+}
+
+Status Rollup::Flush() {
+  for (auto& [bucket_start, bucket] : buckets_) {
+    PL_RETURN_IF_ERROR(WriteBucket(bucket_start, &bucket));
+    watermark_ = bucket_start + spec_.bucket_ns;
+  }
+  buckets_.clear();
+  return Status::OK();
+}
+
+Status Rollup::WriteBucket(int64_t bucket_start, Bucket* bucket) {
+  size_t num_groups = bucket->counts.size();
+  if (num_groups == 0) {
+    return Status::OK();
+  }
+  auto record_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(num_groups);
+  for (size_t group = 0; group < num_groups; ++group) {
+    (*time_col)[group] = bucket_start;
+  }
+  record_batch->push_back(std::move(time_col));
+  for (auto& group_values : bucket->group_values) {
+    record_batch->push_back(std::move(group_values));
+  }
+
+  for (const auto& [i, input] : Enumerate(agg_inputs_)) {
+    const auto& states = bucket->agg_states[i];
+    if (input.type == RollupAggType::kCount) {
+      auto col = std::make_shared<types::Int64ValueColumnWrapper>(num_groups);
+      for (size_t group = 0; group < num_groups; ++group) {
+        (*col)[group] = bucket->counts[group];
+      }
+      record_batch->push_back(std::move(col));
+    } else if (input.type == RollupAggType::kQuantiles) {
+      auto col = std::make_shared<types::StringValueColumnWrapper>(num_groups);
+      for (size_t group = 0; group < num_groups; ++group) {
+        (*col)[group] = QuantilesToJSON(states[group].digest.get());
+      }
+      record_batch->push_back(std::move(col));
+    } else if (input.data_type == types::DataType::FLOAT64) {
+      auto col = std::make_shared<types::Float64ValueColumnWrapper>(num_groups);
+      for (size_t group = 0; group < num_groups; ++group) {
+        (*col)[group] = states[group].float_value;
+      }
+      record_batch->push_back(std::move(col));
+    } else {
+      auto col = std::make_shared<types::Int64ValueColumnWrapper>(num_groups);
+      for (size_t group = 0; group < num_groups; ++group) {
+        (*col)[group] = states[group].int_value;
+      }
+      record_batch->push_back(std::move(col));
+    }
+  }
+  return table_->TransferRecordBatch(std::move(record_batch));
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/table.h"
+#include "tdigest/tdigest.h"
+
+namespace px {
+namespace table_store {
+
+enum class RollupAggType {
+  kCount,
+  kSum,
+  kMin,
+  kMax,
+  // A latency sketch, finalized into the same JSON quantiles that px.quantiles returns.
+  kQuantiles,
+};
+
+struct RollupAggregate {
+  RollupAggType type;
+  // The source column to aggregate. Unused for kCount.
+  std::string input_col;
+  std::string output_col;
+};
+
+/**
+ * RollupSpec defines a pre-aggregated view of a table: the rows of the source table are grouped
+ * into time buckets of `bucket_ns` and by the `group_by_cols`, and each group is reduced with
+ * `aggregates`.
+ */
+struct RollupSpec {
+  // The name of the table holding the rollup.
+  std::string name;
+  std::string source_table;
+  int64_t bucket_ns;
+  std::vector<std::string> group_by_cols;
+  std::vector<RollupAggregate> aggregates;
+  // How long after the end of a bucket rows for it are still accepted. Defaults to one bucket.
+  int64_t allowed_lateness_ns = -1;
+};
+
+/**
+ * Rollup incrementally maintains a rollup table from the batches written to its source table.
+ *
+ * Buckets stay open until the newest time seen in the source table is `allowed_lateness_ns` past
+ * their end, they are then written to the rollup table as one row per group. The `time_` column of
+ * the rollup table holds the start of each bucket, followed by the group by columns and the
+ * aggregates. Rows that arrive for buckets that were already written out are dropped.
+ *
+ * A Rollup isn't thread-safe, TableStore serializes its updates. Reads go through the rollup table,
+ * which is safe to read concurrently.
+ */
+class Rollup : public NotCopyable {
+ public:
+  /**
+   * Create validates the spec against the relation of the source table and creates the rollup
+   * table.
+   * @param spec the rollup definition.
+   * @param source_relation the relation of the source table.
+   * @param max_table_size the maximum size of the rollup table.
+   * @return the rollup or an error if the spec doesn't match the source table.
+   */
+  static StatusOr<std::unique_ptr<Rollup>> Create(const RollupSpec& spec,
+                                                  const schema::Relation& source_relation,
+                                                  int64_t max_table_size);
+
+  /**
+   * Update adds the rows of a batch written to the source table to the rollup, and writes the
+   * buckets that can no longer change to the rollup table.
+   * @param record_batch a batch of the source table.
+   * @return error if writing to the rollup table fails.
+   */
+  Status Update(const types::ColumnWrapperRecordBatch& record_batch);
+
+  /**
+   * AdvanceTime writes the buckets that ended more than the allowed lateness before the given time,
+   * as if a row with that time had been written to the source table. This closes the buckets of a
+   * source table that stopped receiving data.
+   * @param time_ns the current time, in the same clock as the time_ column of the source table.
+   * @return error if writing to the rollup table fails.
+   */
+  Status AdvanceTime(int64_t time_ns);
+
+  /**
+   * Flush writes all open buckets to the rollup table, regardless of whether they can still
+   * change.
+   */
+  Status Flush();
+
+  const RollupSpec& spec() const { return spec_; }
+  const schema::Relation& relation() const { return relation_; }
+  std::shared_ptr<Table> table() const { return table_; }
+  int64_t late_rows_dropped() const { return late_rows_dropped_; }
+
+ private:
+  struct AggInput {
+    RollupAggType type;
+    // The index of the input column in the source relation, -1 for kCount.
+    int64_t col_idx;
+    types::DataType data_type;
+  };
+
+  struct AggState {
+    int64_t int_value = 0;
+    double float_value = 0;
+    std::unique_ptr<tdigest::TDigest> digest;
+  };
+
+  struct Bucket {
+    // Maps the encoded group by values to the index of the group.
+    absl::flat_hash_map<std::string, int64_t> group_idx;
+    // The group by values of each group, one column per group by column.
+    types::ColumnWrapperRecordBatch group_values;
+    std::vector<int64_t> counts;
+    // The state of each aggregate, indexed by aggregate then group.
+    std::vector<std::vector<AggState>> agg_states;
+  };
+
+  Rollup(const RollupSpec& spec, schema::Relation relation, int64_t time_col_idx,
+         std::vector<int64_t> group_by_col_idxs, std::vector<AggInput> agg_inputs,
+         int64_t max_table_size);
+
+  Bucket* GetOrCreateBucket(int64_t bucket_start);
+  static void UpdateAggState(const AggInput& input, const types::ColumnWrapper& col, size_t row,
+                             AggState* state);
+  Status WriteBucket(int64_t bucket_start, Bucket* bucket);
+  Status WriteClosedBuckets();
+
+  const RollupSpec spec_;
+  const schema::Relation relation_;
+  const int64_t time_col_idx_;
+  const int64_t allowed_lateness_ns_;
+  const std::vector<int64_t> group_by_col_idxs_;
+  const std::vector<AggInput> agg_inputs_;
+  std::shared_ptr<Table> table_;
+
+  // Open buckets by their start time.
+  std::map<int64_t, Bucket> buckets_;
+  // Everything before this time has been written to the rollup table.
+  int64_t watermark_ = 0;
+  int64_t max_time_ = 0;
+  int64_t late_rows_dropped_ = 0;
+};
+
+}  // namespace table_store
+}  // namespace px
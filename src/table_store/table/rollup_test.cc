@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/rollup.h"
+
+namespace px {
+namespace table_store {
+
+class RollupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    source_rel_ = schema::Relation(
+        {types::DataType::TIME64NS, types::DataType::STRING, types::DataType::INT64},
+        {"time_", "service", "latency"});
+    spec_.name = "rollup";
+    spec_.source_table = "source";
+    spec_.bucket_ns = 10;
+    spec_.group_by_cols = {"service"};
+    spec_.aggregates = {{RollupAggType::kCount, "", "count"},
+                        {RollupAggType::kSum, "latency", "latency_sum"},
+                        {RollupAggType::kMin, "latency", "latency_min"},
+                        {RollupAggType::kMax, "latency", "latency_max"},
+                        {RollupAggType::kQuantiles, "latency", "latency_quantiles"}};
+  }
+
+  std::unique_ptr<types::ColumnWrapperRecordBatch> MakeBatch(
+      const std::vector<types::Time64NSValue>& times,
+      const std::vector<types::StringValue>& services,
+      const std::vector<types::Int64Value>& latencies) {
+    auto batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    batch->push_back(types::ColumnWrapper::FromArrow(
+        types::DataType::TIME64NS, types::ToArrow(times, arrow::default_memory_pool())));
+    batch->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(services, arrow::default_memory_pool())));
+    batch->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(latencies, arrow::default_memory_pool())));
+    return batch;
+  }
+
+  schema::Relation source_rel_;
+  RollupSpec spec_;
+};
+
+TEST_F(RollupTest, relation) {
+  ASSERT_OK_AND_ASSIGN(auto rollup, Rollup::Create(spec_, source_rel_, 1024 * 1024));
+  EXPECT_EQ(rollup->relation(),
+            schema::Relation({types::DataType::TIME64NS, types::DataType::STRING,
+                              types::DataType::INT64, types::DataType::INT64,
+                              types::DataType::INT64, types::DataType::INT64,
+                              types::DataType::STRING},
+                             {"time_", "service", "count", "latency_sum", "latency_min",
+                              "latency_max", "latency_quantiles"}));
+}
+
+TEST_F(RollupTest, invalid_specs) {
+  auto spec = spec_;
+  spec.bucket_ns = 0;
+  EXPECT_NOT_OK(Rollup::Create(spec, source_rel_, 1024));
+
+  spec = spec_;
+  spec.group_by_cols = {"missing"};
+  EXPECT_NOT_OK(Rollup::Create(spec, source_rel_, 1024));
+
+  spec = spec_;
+  spec.aggregates = {{RollupAggType::kSum, "service", "service_sum"}};
+  EXPECT_NOT_OK(Rollup::Create(spec, source_rel_, 1024));
+
+  spec = spec_;
+  spec.aggregates = {{RollupAggType::kCount, "", "service"}};
+  EXPECT_NOT_OK(Rollup::Create(spec, source_rel_, 1024));
+
+  schema::Relation no_time_rel({types::DataType::STRING, types::DataType::INT64},
+                               {"service", "latency"});
+  EXPECT_NOT_OK(Rollup::Create(spec_, no_time_rel, 1024));
+}
+
+TEST_F(RollupTest, aggregates_closed_buckets) {
+  ASSERT_OK_AND_ASSIGN(auto rollup, Rollup::Create(spec_, source_rel_, 1024 * 1024));
+  EXPECT_OK(rollup->Update(*MakeBatch({1, 2, 5, 12}, {"a", "b", "a", "a"}, {10, 20, 30, 40})));
+  // The first bucket is still open, rows for it may arrive late.
+  EXPECT_EQ(0, rollup->table()->GetTableStats().num_batches);
+
+  EXPECT_OK(rollup->Update(*MakeBatch({8, 21}, {"a", "b"}, {50, 60})));
+  Table::Cursor cursor(rollup->table().get());
+  ASSERT_OK_AND_ASSIGN(auto rb, cursor.GetNextRowBatch({0, 1, 2, 3, 4, 5}));
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Time64NSValue>{0, 0},
+                                                     arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(
+      types::ToArrow(std::vector<types::StringValue>{"a", "b"}, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(2)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{3, 1}, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(3)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{90, 20}, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(4)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{10, 20}, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(5)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{50, 20}, arrow::default_memory_pool())));
+  EXPECT_TRUE(cursor.Done());
+
+  // Rows for buckets that were written out are dropped.
+  EXPECT_OK(rollup->Update(*MakeBatch({3}, {"a"}, {70})));
+  EXPECT_EQ(1, rollup->late_rows_dropped());
+
+  EXPECT_OK(rollup->Flush());
+  EXPECT_EQ(3, rollup->table()->GetTableStats().num_batches);
+}
+
+TEST_F(RollupTest, advance_time_closes_idle_buckets) {
+  ASSERT_OK_AND_ASSIGN(auto rollup, Rollup::Create(spec_, source_rel_, 1024 * 1024));
+  EXPECT_OK(rollup->Update(*MakeBatch({1, 12}, {"a", "a"}, {10, 20})));
+  // No more rows arrive, the buckets are still written once they can no longer change.
+  EXPECT_OK(rollup->AdvanceTime(19));
+  EXPECT_EQ(0, rollup->table()->GetTableStats().num_batches);
+  EXPECT_OK(rollup->AdvanceTime(20));
+  EXPECT_EQ(1, rollup->table()->GetTableStats().num_batches);
+  EXPECT_OK(rollup->AdvanceTime(30));
+  EXPECT_EQ(2, rollup->table()->GetTableStats().num_batches);
+
+  // Time going backwards doesn't reopen the written buckets.
+  EXPECT_OK(rollup->AdvanceTime(5));
+  EXPECT_OK(rollup->Update(*MakeBatch({15}, {"a"}, {30})));
+  EXPECT_EQ(1, rollup->late_rows_dropped());
+}
+
+TEST_F(RollupTest, quantiles) {
+  spec_.aggregates = {{RollupAggType::kQuantiles, "latency", "latency_quantiles"}};
+  ASSERT_OK_AND_ASSIGN(auto rollup, Rollup::Create(spec_, source_rel_, 1024 * 1024));
+  EXPECT_OK(rollup->Update(*MakeBatch({1}, {"a"}, {10})));
+  EXPECT_OK(rollup->Flush());
+
+  Table::Cursor cursor(rollup->table().get());
+  ASSERT_OK_AND_ASSIGN(auto rb, cursor.GetNextRowBatch({2}));
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{
+          "{\"p01\":10.0,\"p10\":10.0,\"p25\":10.0,\"p50\":10.0,\"p75\":10.0,\"p90\":10.0,"
+          "\"p99\":10.0}"},
+      arrow::default_memory_pool())));
+}
+
+}  // namespace table_store
+}  // namespace px
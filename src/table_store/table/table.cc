@@ -16,7 +16,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <signal.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -26,16 +32,23 @@
 #include <variant>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/str_replace.h>
+#include <absl/strings/str_split.h>
 #include "internal/store_with_row_accounting.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
+#include "src/common/fs/fs_wrapper.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/dictionary_encoding.h"
+#include "src/table_store/table/internal/disk_segment.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/upid_index.h"
 #include "src/table_store/table/table.h"
 
 // Note: this value is not used in most cases.
@@ -45,11 +58,73 @@ DEFINE_int32(table_store_table_size_limit,
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
 
+DEFINE_bool(table_store_dictionary_encode_strings,
+            gflags::BoolFromEnv("PL_TABLE_STORE_DICTIONARY_ENCODE_STRINGS", true),
+            "Whether to dictionary encode STRING columns with few distinct values, when batches "
+            "are compacted into the cold store.");
+
+DEFINE_bool(table_store_upid_index, gflags::BoolFromEnv("PL_TABLE_STORE_UPID_INDEX", true),
+            "Whether to maintain an index from UPID to row ranges for tables with a UINT128 `upid` "
+            "column, so that reads filtered on a UPID only read the rows of that UPID.");
+
+DEFINE_int64(table_store_cold_freeze_age_seconds,
+             gflags::Int64FromEnv("PL_TABLE_STORE_COLD_FREEZE_AGE_SECONDS", -1),
+             "Cold batches whose rows are all older than this many seconds, relative to the newest "
+             "row in the cold store, are compressed and decompressed on demand when read. A "
+             "negative value disables freezing.");
+
+DEFINE_string(table_store_disk_tier_path,
+              gflags::StringFromEnv("PL_TABLE_STORE_DISK_TIER_PATH", ""),
+              "Directory to write cold batches to when they are expired from memory, so that they "
+              "can still be queried. The disk tier is disabled if this is empty. Batches with null "
+              "values aren't supported by the disk tier, they are dropped when expired.");
+
+DEFINE_int64(table_store_disk_tier_table_size_limit,
+             gflags::Int64FromEnv("PL_TABLE_STORE_DISK_TIER_TABLE_SIZE_LIMIT", 1024 * 1024 * 1024),
+             "The maximal number of bytes each table can write to the disk tier. When the size "
+             "grows beyond this limit, the oldest data on disk will be discarded.");
+
 namespace px {
 namespace table_store {
 
+namespace {
+
+// The disk tier directories of the tables of this process that haven't been destroyed yet.
+struct LiveDiskTierDirs {
+  absl::Mutex lock;
+  absl::flat_hash_set<std::string> dirs ABSL_GUARDED_BY(lock);
+};
+
+LiveDiskTierDirs& GetLiveDiskTierDirs() {
+  static auto* live_dirs = new LiveDiskTierDirs();
+  return *live_dirs;
+}
+
+// Returns whether the given directory of the disk tier belongs to a table that no longer exists.
+// Directories are named `<table>-<pid>-<table id>`, see Table::InitDiskTier.
+bool IsStaleDiskTierDir(const std::filesystem::path& dir,
+                        const absl::flat_hash_set<std::string>& live_dirs) {
+  std::vector<std::string_view> parts = absl::StrSplit(dir.filename().string(), '-');
+  int pid;
+  int64_t table_id;
+  if (parts.size() < 3 || !absl::SimpleAtoi(parts[parts.size() - 2], &pid) ||
+      !absl::SimpleAtoi(parts.back(), &table_id)) {
+    // Not created by a table, leave it alone.
+    return false;
+  }
+  if (pid == getpid()) {
+    // A restarted container usually gets the same pid as the process that ran before it.
+    return !live_dirs.contains(dir.string());
+  }
+  // Directories of other processes that are still running are left for them to clean up.
+  return kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+}  // namespace
+
 Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
     : table_(table), hints_(internal::BatchHints{}) {
+  table_->RecordRead(start);
   AdvanceToStart(start);
   StopStateFromSpec(std::move(stop));
 }
@@ -57,7 +132,10 @@ Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
 void Table::Cursor::AdvanceToStart(const StartSpec& start) {
   switch (start.type) {
     case StartSpec::StartType::StartAtTime: {
-      last_read_row_id_ = table_->FindRowIDFromTimeFirstGreaterThanOrEqual(start.start_time) - 1;
+      PL_ASSIGN_OR(auto row_id, table_->FindRowIDFromTimeFirstGreaterThanOrEqual(start.start_time),
+                   status_ = __s__.status();
+                   last_read_row_id_ = -1; break);
+      last_read_row_id_ = row_id - 1;
       break;
     }
     case StartSpec::StartType::CurrentStartOfTable: {
@@ -85,7 +163,10 @@ void Table::Cursor::StopStateFromSpec(StopSpec&& stop) {
     case StopSpec::StopType::StopAtTime: {
       // TODO(james): this needs to be changed to support stopping at the provided time regardless
       // of what's currently in the table.
-      stop_.stop_row_id = table_->FindRowIDFromTimeFirstGreaterThan(stop_.spec.stop_time);
+      PL_ASSIGN_OR(stop_.stop_row_id,
+                   table_->FindRowIDFromTimeFirstGreaterThan(stop_.spec.stop_time),
+                   status_ = __s__.status();
+                   stop_.stop_row_id = -1; break);
       break;
     }
     default:
@@ -104,6 +185,10 @@ bool Table::Cursor::NextBatchReady() {
 }
 
 bool Table::Cursor::Done() {
+  if (!status_.ok()) {
+    // Not done, so that the caller goes on to GetNextRowBatch, which returns the error.
+    return false;
+  }
   if (stop_.spec.type == StopSpec::StopType::Infinite) {
     return false;
   }
@@ -117,6 +202,30 @@ internal::RowID* Table::Cursor::LastReadRowID() { return &last_read_row_id_; }
 
 internal::BatchHints* Table::Cursor::Hints() { return &hints_; }
 
+internal::ZoneMapFilter* Table::Cursor::Filter() { return &zone_map_filter_; }
+
+void Table::Cursor::SetZoneMapPredicates(std::vector<ColumnPredicate> predicates) {
+  zone_map_filter_.predicates = std::move(predicates);
+  // Equality predicates on the UPID column can also be served by the table's UPID index.
+  for (const auto& predicate : zone_map_filter_.predicates) {
+    if (predicate.col_idx != table_->upid_col_idx_ || predicate.op != ColumnPredicate::kEqual ||
+        !std::holds_alternative<absl::uint128>(predicate.value)) {
+      continue;
+    }
+    SetUPIDFilter({std::get<absl::uint128>(predicate.value)});
+    break;
+  }
+}
+
+void Table::Cursor::SetUPIDFilter(std::vector<absl::uint128> upids) {
+  upid_filter_.clear();
+  upid_filter_.insert(upids.begin(), upids.end());
+}
+
+const absl::flat_hash_set<absl::uint128>& Table::Cursor::UPIDFilter() const {
+  return upid_filter_;
+}
+
 std::optional<internal::RowID> Table::Cursor::StopRowID() const {
   if (stop_.spec.type == StopSpec::StopType::Infinite) {
     return std::nullopt;
@@ -126,6 +235,8 @@ std::optional<internal::RowID> Table::Cursor::StopRowID() const {
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
     const std::vector<int64_t>& cols) {
+  // Looking up the start or stop of the cursor can fail, if the disk tier can't be read.
+  PL_RETURN_IF_ERROR(status_);
   return table_->GetNextRowBatch(this, cols);
 }
 
@@ -137,18 +248,90 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       compacted_batch_size_(compacted_batch_size),
       // TODO(james): move mem_pool into constructor.
       compactor_(rel_, arrow::default_memory_pool()) {
+  metrics_.max_table_size_gauge.Set(max_table_size);
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   for (const auto& [i, col_name] : Enumerate(rel_.col_names())) {
     if (col_name == "time_" && rel_.GetColumnType(i) == types::DataType::TIME64NS) {
       time_col_idx_ = i;
     }
+    if (col_name == "upid" && rel_.GetColumnType(i) == types::DataType::UINT128) {
+      upid_col_idx_ = i;
+    }
+  }
+  if (FLAGS_table_store_upid_index && upid_col_idx_ != -1) {
+    upid_index_ = std::make_unique<internal::UPIDIndex>();
   }
   batch_size_accountant_ = internal::BatchSizeAccountant::Create(rel_, compacted_batch_size_);
   hot_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>>(
       rel_, time_col_idx_);
   cold_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Cold>>(
       rel_, time_col_idx_);
+  if (!FLAGS_table_store_disk_tier_path.empty()) {
+    InitDiskTier(table_name);
+  }
+}
+
+Table::~Table() {
+  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  if (disk_store_ == nullptr) {
+    return;
+  }
+  // Destroying the segments removes their files.
+  disk_store_.reset();
+  auto s = fs::RemoveAll(disk_tier_dir_);
+  if (!s.ok()) {
+    LOG(WARNING) << absl::Substitute("Failed to remove disk tier directory: $0", s.msg());
+  }
+  auto& live_dirs = GetLiveDiskTierDirs();
+  absl::MutexLock lock(&live_dirs.lock);
+  live_dirs.dirs.erase(disk_tier_dir_.string());
+}
+
+void Table::RemoveStaleDiskTierDirs() {
+  if (FLAGS_table_store_disk_tier_path.empty()) {
+    return;
+  }
+  std::error_code ec;
+  std::filesystem::directory_iterator it(FLAGS_table_store_disk_tier_path, ec);
+  std::vector<std::filesystem::path> stale_dirs;
+  {
+    auto& live_dirs = GetLiveDiskTierDirs();
+    absl::MutexLock lock(&live_dirs.lock);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+      if (it->is_directory(ec) && IsStaleDiskTierDir(it->path(), live_dirs.dirs)) {
+        stale_dirs.push_back(it->path());
+      }
+    }
+  }
+  for (const auto& dir : stale_dirs) {
+    LOG(INFO) << absl::Substitute("Removing stale disk tier directory $0", dir.string());
+    auto s = fs::RemoveAll(dir);
+    if (!s.ok()) {
+      LOG(WARNING) << absl::Substitute("Failed to remove disk tier directory: $0", s.msg());
+    }
+  }
+}
+
+void Table::InitDiskTier(std::string_view table_name) {
+  // Several tables (eg. tablets) can share a name, so each table gets a unique directory.
+  static std::atomic<int64_t> next_table_id = 0;
+  disk_tier_dir_ =
+      std::filesystem::path(FLAGS_table_store_disk_tier_path) /
+      absl::StrCat(absl::StrReplaceAll(table_name, {{"/", "_"}, {".", "_"}}), "-", getpid(), "-",
+                   next_table_id++);
+  auto s = fs::CreateDirectories(disk_tier_dir_);
+  if (!s.ok()) {
+    LOG(WARNING) << absl::Substitute("Disabling disk tier for table $0: $1", table_name, s.msg());
+    return;
+  }
+  {
+    auto& live_dirs = GetLiveDiskTierDirs();
+    absl::MutexLock lock(&live_dirs.lock);
+    live_dirs.dirs.insert(disk_tier_dir_.string());
+  }
+  disk_store_ = std::make_unique<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>>(
+      rel_, time_col_idx_);
 }
 
 Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
@@ -174,52 +357,147 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
     Cursor* cursor, const std::vector<int64_t>& cols) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  PL_ASSIGN_OR_RETURN(auto slice, GetNextRowBatchSlice(cursor, cols));
+  // The slice shares ownership of the data it references, so the expensive part of the read
+  // (converting hot columns to arrow, decoding dictionaries) happens without holding the table
+  // locks, and doesn't hold up writers or compaction.
+  return slice->Materialize(arrow::default_memory_pool());
+}
+
+StatusOr<std::unique_ptr<internal::RowBatchSlice>> Table::GetNextRowBatchSlice(
+    Cursor* cursor, const std::vector<int64_t>& cols) const {
+  auto initial_last_read_row_id = *cursor->LastReadRowID();
+  auto zero_row_slice = [&]() {
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      col_types.push_back(rel_.col_types()[col_idx]);
+    }
+    return std::make_unique<internal::RowBatchSlice>(schema::RowDescriptor(col_types), 0);
+  };
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  PL_ASSIGN_OR_RETURN(auto rb,
-                      cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
-  if (rb == nullptr) {
+  auto stop_row_id = cursor->StopRowID();
+  if (!cursor->UPIDFilter().empty()) {
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    if (upid_index_ != nullptr) {
+      // Skip ahead to the next rows that may contain one of the UPIDs, and stop the read at the end
+      // of them.
+      auto start_row_id = *cursor->LastReadRowID() + 1;
+      auto end_row_id = stop_row_id.value_or(next_row_id_);
+      auto interval = upid_index_->NextInterval(cursor->UPIDFilter(), start_row_id);
+      auto skip_until = interval.has_value() ? std::min(interval->first, end_row_id) : end_row_id;
+      if (skip_until > start_row_id) {
+        cursor->Filter()->rows_skipped += skip_until - start_row_id;
+        *cursor->LastReadRowID() = skip_until - 1;
+      }
+      if (!interval.has_value() || interval->first >= end_row_id) {
+        return zero_row_slice();
+      }
+      stop_row_id = std::min(end_row_id, interval->second + 1);
+    }
+  }
+  // The rows before the disk or cold store can be gone, eg. because they expired or failed to be
+  // written to disk. Skips the cursor to the given row if it points before it, and returns whether
+  // that moved the cursor past its stop.
+  auto skip_gap_until = [&](RowID first_row_id) {
+    if (*cursor->LastReadRowID() + 1 >= first_row_id) {
+      return false;
+    }
+    if (stop_row_id.has_value() && first_row_id >= stop_row_id.value()) {
+      *cursor->LastReadRowID() = stop_row_id.value() - 1;
+      return true;
+    }
+    *cursor->LastReadRowID() = first_row_id - 1;
+    return false;
+  };
+  std::unique_ptr<internal::RowBatchSlice> slice;
+  if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+    if (skip_gap_until(disk_store_->FirstRowID())) {
+      return zero_row_slice();
+    }
+    PL_ASSIGN_OR_RETURN(slice,
+                        disk_store_->GetNextRowBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                          stop_row_id, cols));
+  }
+  if (slice == nullptr && cold_store_->Size() > 0) {
+    if (skip_gap_until(cold_store_->FirstRowID())) {
+      return zero_row_slice();
+    }
+    PL_ASSIGN_OR_RETURN(slice,
+                        cold_store_->GetNextRowBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                          stop_row_id, cols, cursor->Filter()));
+  }
+  if (slice == nullptr) {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    PL_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
-    if (rb == nullptr && hot_store_->Size() > 0) {
+    PL_ASSIGN_OR_RETURN(slice,
+                        hot_store_->GetNextRowBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                         stop_row_id, cols));
+    if (slice == nullptr && hot_store_->Size() > 0) {
       // If the cursor was pointing to an expired row batch, update the cursor to point to the start
       // of the table, then try to get the next row batch.
       *cursor->LastReadRowID() = hot_store_->FirstRowID() - 1;
-      if (!cursor->Done()) {
-        PL_ASSIGN_OR_RETURN(rb,
-                            hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
+      if (!stop_row_id.has_value() || *cursor->LastReadRowID() + 1 < stop_row_id.value()) {
+        PL_ASSIGN_OR_RETURN(
+            slice, hot_store_->GetNextRowBatchSlice(cursor->LastReadRowID(), cursor->Hints(),
+                                                    stop_row_id, cols));
       }
     }
   }
-  if (rb == nullptr) {
+  if (slice == nullptr && *cursor->LastReadRowID() != initial_last_read_row_id) {
+    // The zone map filter skipped the rest of the cold store and there's no hot data yet. Return an
+    // empty batch so that the cursor's progress isn't reported as an error.
+    return zero_row_slice();
+  }
+  if (slice == nullptr) {
     return error::InvalidArgument("Data after Cursor is not in the table.");
   }
-  return rb;
+  return slice;
 }
 
 Status Table::ExpireRowBatches(int64_t row_batch_size) {
   if (row_batch_size > max_table_size_) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
-                                  row_batch_size, max_table_size_);
+                                  row_batch_size, max_table_size_.load());
   }
+  // Cold batches waiting to be written to disk count against the budget. The batches that this call
+  // expires into the queue only count from the next call on, so that writes never wait on the disk.
+  int64_t pending_spill_bytes;
   int64_t bytes;
   {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    DropPendingSpillsUnlocked(max_table_size_ / 2);
+    pending_spill_bytes = total_pending_spill_bytes_;
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+    bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes() +
+            pending_spill_bytes;
   }
+  bool expired = false;
   while (bytes + row_batch_size > max_table_size_) {
-    PL_RETURN_IF_ERROR(ExpireBatch());
+    auto s = ExpireBatch();
+    if (!s.ok()) {
+      if (pending_spill_bytes == 0) {
+        return s;
+      }
+      // Only batches waiting to be written to disk are left, so they are dropped to make room.
+      absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+      DropPendingSpillsUnlocked(/*max_pending_bytes*/ 0);
+      pending_spill_bytes = 0;
+    }
+    expired = true;
     {
       absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-      bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes();
+      bytes = batch_size_accountant_->HotBytes() + batch_size_accountant_->ColdBytes() +
+              pending_spill_bytes;
     }
     {
       absl::base_internal::SpinLockHolder lock(&stats_lock_);
       batches_expired_++;
     }
   }
+  if (expired && upid_index_ != nullptr) {
+    auto first_row_id = FirstRowID();
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    upid_index_->ExpireBefore(first_row_id == -1 ? next_row_id_ : first_row_id);
+  }
   return Status::OK();
 }
 
@@ -244,8 +522,7 @@ Status Table::TransferRecordBatch(
 
   auto record_batch_w_cache = internal::RecordBatchWithCache{
       std::move(record_batch),
-      std::vector<ArrowArrayPtr>(rel_.NumColumns()),
-      std::vector<bool>(rel_.NumColumns(), false),
+      std::make_shared<internal::ArrowColumnCache>(rel_.NumColumns()),
   };
   internal::RecordOrRowBatch record_or_row_batch(std::move(record_batch_w_cache));
 
@@ -259,21 +536,35 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
   auto batch_stats = internal::BatchSizeAccountant::CalcBatchStats(
       ABSL_TS_UNCHECKED_READ(batch_size_accountant_)->NonMutableState(), record_or_row_batch);
 
-  PL_RETURN_IF_ERROR(ExpireRowBatches(batch_stats.bytes));
+  auto batch_bytes = batch_stats.bytes;
+  PL_RETURN_IF_ERROR(ExpireRowBatches(batch_bytes));
+
+  // Find the UPID runs before taking the lock, so that indexing doesn't hold up readers.
+  std::vector<internal::UPIDIndex::Run> upid_runs;
+  if (upid_index_ != nullptr) {
+    upid_runs = internal::UPIDIndex::ComputeRuns(record_or_row_batch, upid_col_idx_);
+  }
 
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   auto batch_length = record_or_row_batch.Length();
+  if (upid_index_ != nullptr) {
+    upid_index_->AddRuns(next_row_id_, upid_runs);
+  }
   batch_size_accountant_->NewHotBatch(std::move(batch_stats));
   hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
   next_row_id_ += batch_length;
 
   absl::base_internal::SpinLockHolder lock(&stats_lock_);
   ++batches_added_;
+  bytes_added_ += batch_bytes;
   return Status::OK();
 }
 
 Table::RowID Table::FirstRowID() const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+  if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+    return disk_store_->FirstRowID();
+  }
   if (cold_store_->Size() > 0) {
     return cold_store_->FirstRowID();
   }
@@ -293,35 +584,45 @@ Table::RowID Table::LastRowID() const {
   if (cold_store_->Size() > 0) {
     return cold_store_->LastRowID();
   }
+  if (disk_store_ != nullptr && disk_store_->Size() > 0) {
+    return disk_store_->LastRowID();
+  }
   return -1;
 }
 
-Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
-  if (optional_row_id.has_value()) {
-    return optional_row_id.value();
-  }
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
-  if (optional_row_id.has_value()) {
-    return optional_row_id.value();
-  }
-  return next_row_id_;
+StatusOr<Table::RowID> Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
+  return FindRowIDFromTime(time, /*inclusive*/ true);
 }
 
-Table::RowID Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
-  if (optional_row_id.has_value()) {
-    return optional_row_id.value();
-  }
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  optional_row_id = hot_store_->FindRowIDFromTimeFirstGreaterThan(time);
-  if (optional_row_id.has_value()) {
-    return optional_row_id.value();
+StatusOr<Table::RowID> Table::FindRowIDFromTimeFirstGreaterThan(Time time) const {
+  return FindRowIDFromTime(time, /*inclusive*/ false);
+}
+
+StatusOr<Table::RowID> Table::FindRowIDFromTime(Time time, bool inclusive) const {
+  std::optional<internal::DiskSegmentTimeSearch> disk_search;
+  {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (disk_store_ != nullptr) {
+      PL_ASSIGN_OR_RETURN(disk_search, disk_store_->FindSegmentFromTime(time, inclusive));
+    }
+    if (!disk_search.has_value()) {
+      std::optional<RowID> optional_row_id =
+          inclusive ? cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time)
+                    : cold_store_->FindRowIDFromTimeFirstGreaterThan(time);
+      if (optional_row_id.has_value()) {
+        return optional_row_id.value();
+      }
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      optional_row_id = inclusive ? hot_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time)
+                                  : hot_store_->FindRowIDFromTimeFirstGreaterThan(time);
+      if (optional_row_id.has_value()) {
+        return optional_row_id.value();
+      }
+      return next_row_id_;
+    }
   }
-  return next_row_id_;
+  // Reading the segment's time column from disk doesn't need the lock.
+  return disk_search->Find(time, inclusive);
 }
 
 schema::Relation Table::GetRelation() const { return rel_; }
@@ -332,14 +633,26 @@ TableStats Table::GetTableStats() const {
   int64_t num_batches = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t disk_bytes = 0;
+  int64_t thawed_bytes = 0;
   {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-    min_time = cold_store_->MinTime();
+    if (disk_store_ != nullptr) {
+      min_time = disk_store_->MinTime();
+      disk_bytes = disk_bytes_;
+    }
+    if (min_time == -1) {
+      min_time = cold_store_->MinTime();
+    }
     num_batches += cold_store_->Size();
+    thawed_bytes = cold_store_->ThawedBytes();
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     num_batches += hot_store_->Size();
     hot_bytes = batch_size_accountant_->HotBytes();
-    cold_bytes = batch_size_accountant_->ColdBytes();
+    // The decompressed columns cached for reads of frozen batches and the batches waiting to be
+    // written to disk aren't in the accountant's budget, but they are still memory held by the cold
+    // store.
+    cold_bytes = batch_size_accountant_->ColdBytes() + thawed_bytes + total_pending_spill_bytes_;
     if (min_time == -1) {
       min_time = hot_store_->MinTime();
     }
@@ -351,36 +664,110 @@ TableStats Table::GetTableStats() const {
   info.num_batches = num_batches;
   info.bytes = hot_bytes + cold_bytes;
   info.cold_bytes = cold_bytes;
+  info.disk_bytes = disk_bytes;
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
+  info.bytes_added = bytes_added_;
+  info.compaction_lag_ns = compaction_lag_ns_;
   info.min_time = min_time;
 
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
-  const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
+void Table::RecordRead(const Cursor::StartSpec& start) const {
+  int64_t requested_retention_ns = 0;
+  if (start.type == Cursor::StartSpec::StartAtTime) {
+    int64_t max_time = -1;
+    {
+      absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+      absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+      max_time = hot_store_->MaxTime();
+      if (max_time == -1) {
+        max_time = cold_store_->MaxTime();
+      }
+      if (max_time == -1 && disk_store_ != nullptr) {
+        max_time = disk_store_->MaxTime();
+      }
+    }
+    requested_retention_ns = std::max<int64_t>(0, max_time - start.start_time);
+  }
+
+  absl::base_internal::SpinLockHolder lock(&stats_lock_);
+  read_stats_.num_reads++;
+  if (start.type == Cursor::StartSpec::CurrentStartOfTable) {
+    read_stats_.full_table_read = true;
+  }
+  read_stats_.max_requested_retention_ns =
+      std::max(read_stats_.max_requested_retention_ns, requested_retention_ns);
+  metrics_.reads_counter.Increment();
+}
+
+TableReadStats Table::ConsumeReadStats() {
+  absl::base_internal::SpinLockHolder lock(&stats_lock_);
+  TableReadStats read_stats = read_stats_;
+  read_stats_ = TableReadStats{};
+  return read_stats;
+}
 
-  PL_RETURN_IF_ERROR(
-      compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+Status Table::SetMaxTableSize(int64_t max_table_size) {
+  max_table_size_ = max_table_size;
+  metrics_.max_table_size_gauge.Set(max_table_size);
+  return ExpireRowBatches(0);
+}
+
+Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool) {
+  const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
 
   RowID first_row_id = -1;
-  for (auto hot_slice : compaction_spec.hot_slices) {
-    if (first_row_id == -1) {
-      first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+  std::optional<std::vector<ArrowArrayPtr>> out_columns;
+  if (compaction_spec.hot_slices.size() == 1) {
+    // A hot batch that becomes a cold batch as a whole doesn't need to be copied, the cold batch
+    // shares its columns.
+    const auto& hot_slice = compaction_spec.hot_slices.front();
+    if (hot_slice.start_row == 0 && hot_slice.end_row == hot_store_->front().Length()) {
+      out_columns = hot_store_->front().ShareColumns();
     }
-
-    compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row, hot_slice.end_row);
-    if (hot_slice.last_slice_for_batch) {
+    if (out_columns.has_value()) {
+      first_row_id = hot_store_->FirstRowID();
+      DCHECK(hot_slice.last_slice_for_batch);
       hot_store_->PopFront();
     }
   }
+  if (!out_columns.has_value()) {
+    PL_RETURN_IF_ERROR(
+        compactor_.Reserve(compaction_spec.num_rows, compaction_spec.variable_col_bytes));
+    for (auto hot_slice : compaction_spec.hot_slices) {
+      if (first_row_id == -1) {
+        first_row_id = hot_store_->FirstRowID() + hot_slice.start_row;
+      }
+
+      compactor_.UnsafeAppendBatchSlice(hot_store_->front(), hot_slice.start_row,
+                                        hot_slice.end_row);
+      if (hot_slice.last_slice_for_batch) {
+        hot_store_->PopFront();
+      }
+    }
+    PL_ASSIGN_OR_RETURN(out_columns, compactor_.Finish());
+  }
+  ColdBatch cold_batch(std::move(out_columns.value()));
 
-  PL_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
+  int64_t cold_batch_bytes = compaction_spec.bytes;
+  if (FLAGS_table_store_dictionary_encode_strings) {
+    for (const auto& [col_idx, col_type] : Enumerate(rel_.col_types())) {
+      if (col_type != types::DataType::STRING) {
+        continue;
+      }
+      PL_ASSIGN_OR_RETURN(auto bytes_saved,
+                          internal::MaybeDictionaryEncodeColumn(col_idx, mem_pool, &cold_batch));
+      cold_batch_bytes -= bytes_saved;
+    }
+  }
+  DCHECK_GE(cold_batch_bytes, 0);
+  cold_batch_bytes = std::max<int64_t>(cold_batch_bytes, 0);
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(cold_batch_bytes);
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
@@ -393,36 +780,168 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
 }
 
 Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
+  return CompactHotToCold(mem_pool, std::chrono::steady_clock::time_point::max());
+}
+
+Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool,
+                               std::chrono::steady_clock::time_point deadline) {
+  auto start = std::chrono::steady_clock::now();
   bool next_ready = false;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
-  while (next_ready) {
+  if (next_ready) {
+    absl::base_internal::SpinLockHolder lock(&stats_lock_);
+    if (!compaction_ready_since_.has_value()) {
+      compaction_ready_since_ = start;
+    }
+  }
+  while (next_ready && std::chrono::steady_clock::now() < deadline) {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     // We have to check CompactedBatchReady() again, in case hot batches were expired since the last
     // check.
     if (!batch_size_accountant_->CompactedBatchReady()) {
+      next_ready = false;
       break;
     }
     PL_RETURN_IF_ERROR(CompactSingleBatchUnlocked(mem_pool));
     next_ready = batch_size_accountant_->CompactedBatchReady();
   }
+  if (FLAGS_table_store_cold_freeze_age_seconds >= 0 &&
+      std::chrono::steady_clock::now() < deadline) {
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
+    PL_RETURN_IF_ERROR(FreezeColdUnlocked());
+  }
+  SpillPendingColdBatches(deadline);
+
+  auto end = std::chrono::steady_clock::now();
+  int64_t compaction_lag_ns = 0;
+  {
+    absl::base_internal::SpinLockHolder lock(&stats_lock_);
+    if (!next_ready) {
+      compaction_ready_since_.reset();
+    } else {
+      compaction_lag_ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - *compaction_ready_since_)
+              .count();
+    }
+    compaction_lag_ns_ = compaction_lag_ns;
+  }
+  metrics_.compaction_lag_seconds_gauge.Set(compaction_lag_ns / 1e9);
+  metrics_.compaction_seconds_counter.Increment(std::chrono::duration<double>(end - start).count());
+  return Status::OK();
+}
+
+Status Table::FreezeColdUnlocked() {
+  auto max_time = cold_store_->MaxTime();
+  if (max_time == -1) {
+    return Status::OK();
+  }
+  auto freeze_before =
+      max_time - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::seconds(FLAGS_table_store_cold_freeze_age_seconds))
+                     .count();
+  while (true) {
+    auto batch_idx = cold_store_->NumFrozenBatches();
+    PL_ASSIGN_OR_RETURN(auto bytes_saved, cold_store_->FreezeNextBatch(freeze_before));
+    if (!bytes_saved.has_value()) {
+      break;
+    }
+    // Batches waiting to be spilled are at the front of the cold store, and are no longer in the
+    // accountant.
+    if (batch_idx < pending_spill_bytes_.size()) {
+      auto saved = std::min(bytes_saved.value(), pending_spill_bytes_[batch_idx]);
+      pending_spill_bytes_[batch_idx] -= saved;
+      total_pending_spill_bytes_ -= saved;
+    } else {
+      batch_size_accountant_->ShrinkColdBatch(batch_idx - pending_spill_bytes_.size(),
+                                              bytes_saved.value());
+    }
+  }
   return Status::OK();
 }
 
 StatusOr<bool> Table::ExpireCold() {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  if (cold_store_->Size() == 0) {
+  if (cold_store_->Size() == pending_spill_bytes_.size()) {
     return false;
   }
-  cold_store_->PopFront();
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  batch_size_accountant_->ExpireColdBatch();
+  int64_t bytes = batch_size_accountant_->ExpireColdBatch();
+  if (disk_store_ == nullptr) {
+    cold_store_->PopFront();
+    return true;
+  }
+  // Writing the batch to disk is left to the compaction timer (see SpillPendingColdBatches), so
+  // that writers never wait on compression or disk I/O. Until then, the batch stays readable in the
+  // cold store and its bytes still count against the table's budget.
+  pending_spill_bytes_.push_back(bytes);
+  total_pending_spill_bytes_ += bytes;
   return true;
 }
 
+void Table::SpillPendingColdBatches(std::chrono::steady_clock::time_point deadline) {
+  // Only one batch is spilled at a time, so that the front cold batch stays the same while it's
+  // written to disk without holding cold_lock_, unless the write path drops it in the meantime.
+  absl::MutexLock spill_lock(&spill_lock_);
+  while (std::chrono::steady_clock::now() < deadline) {
+    std::optional<internal::ColdBatch> spilled_batch;
+    RowID spilled_first_row_id;
+    std::filesystem::path spill_path;
+    {
+      absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+      if (pending_spill_bytes_.empty()) {
+        return;
+      }
+      // The copy shares the batch's columns, the data isn't copied.
+      spilled_batch = cold_store_->front();
+      spilled_first_row_id = cold_store_->FirstRowID();
+      spill_path = disk_tier_dir_ / absl::StrCat(next_disk_segment_id_++, ".segment");
+    }
+
+    // Compressing and writing the batch is slow, so it happens without the lock. Readers can still
+    // read the batch from the cold store in the meantime.
+    auto segment_or_s =
+        internal::DiskSegment::Write(spill_path, rel_, time_col_idx_, spilled_batch.value());
+
+    absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
+    if (pending_spill_bytes_.empty() || cold_store_->FirstRowID() != spilled_first_row_id) {
+      // The batch was dropped by DropPendingSpillsUnlocked while it was being written. The segment
+      // removes its file when it goes out of scope.
+      continue;
+    }
+    if (segment_or_s.ok()) {
+      AddDiskSegmentUnlocked(spilled_first_row_id, segment_or_s.ConsumeValueOrDie());
+    } else {
+      // Only the rows of this batch are lost, the rest of the disk store stays readable.
+      LOG(WARNING) << absl::Substitute("Failed to write cold batch to disk: $0",
+                                       segment_or_s.msg());
+    }
+    cold_store_->PopFront();
+    total_pending_spill_bytes_ -= pending_spill_bytes_.front();
+    pending_spill_bytes_.pop_front();
+  }
+}
+
+void Table::DropPendingSpillsUnlocked(int64_t max_pending_bytes) {
+  int64_t dropped = 0;
+  while (total_pending_spill_bytes_ > max_pending_bytes) {
+    cold_store_->PopFront();
+    total_pending_spill_bytes_ -= pending_spill_bytes_.front();
+    pending_spill_bytes_.pop_front();
+    dropped++;
+  }
+  if (dropped > 0) {
+    LOG(WARNING) << absl::Substitute(
+        "Dropped $0 cold batches that were waiting to be written to disk, to make room for new "
+        "writes to the table.",
+        dropped);
+  }
+}
+
 Status Table::ExpireHot() {
   absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
   if (hot_store_->Size() == 0) {
@@ -433,6 +952,15 @@ Status Table::ExpireHot() {
   return Status::OK();
 }
 
+void Table::AddDiskSegmentUnlocked(RowID first_row_id, internal::DiskSegment segment) {
+  disk_bytes_ += segment.Bytes();
+  disk_store_->EmplaceBack(first_row_id, std::move(segment));
+  while (disk_bytes_ > FLAGS_table_store_disk_tier_table_size_limit) {
+    disk_bytes_ -= disk_store_->front().Bytes();
+    disk_store_->PopFront();
+  }
+}
+
 Status Table::ExpireBatch() {
   PL_ASSIGN_OR_RETURN(auto expired_cold, ExpireCold());
   if (expired_cold) {
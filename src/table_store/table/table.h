@@ -22,7 +22,10 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <filesystem>
 #include <memory>
 #include <optional>
 #include <string>
@@ -32,6 +35,8 @@
 #include <vector>
 
 #include <absl/base/internal/spinlock.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/numeric/int128.h>
 #include <absl/strings/str_format.h>
 #include "src/common/base/base.h"
 #include "src/common/metrics/metrics.h"
@@ -44,26 +49,50 @@
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
+#include "src/table_store/table/internal/row_batch_slice.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/upid_index.h"
+#include "src/table_store/table/internal/zone_map.h"
 #include "src/table_store/table/table_metrics.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_bool(table_store_dictionary_encode_strings);
+DECLARE_bool(table_store_upid_index);
+DECLARE_int64(table_store_cold_freeze_age_seconds);
+DECLARE_string(table_store_disk_tier_path);
+DECLARE_int64(table_store_disk_tier_table_size_limit);
 
 namespace px {
 namespace table_store {
 
 using RecordBatchSPtr = std::shared_ptr<arrow::RecordBatch>;
+using ColumnPredicate = internal::ColumnPredicate;
 
 struct TableStats {
   int64_t bytes;
   int64_t cold_bytes;
+  int64_t disk_bytes;
   int64_t num_batches;
   int64_t batches_added;
   int64_t batches_expired;
   int64_t compacted_batches;
   int64_t max_table_size;
   int64_t min_time;
+  int64_t bytes_added;
+  // How long the table has had data ready for compaction that compaction didn't get to.
+  int64_t compaction_lag_ns;
+};
+
+/**
+ * TableReadStats summarizes the cursors opened on a table since the stats were last consumed.
+ */
+struct TableReadStats {
+  int64_t num_reads = 0;
+  // Whether any cursor started at the start of the table, ie. asked for all of its data.
+  bool full_table_read = false;
+  // The longest time range, ending at the newest row in the table, that a cursor started in.
+  int64_t max_requested_retention_ns = 0;
 };
 
 /**
@@ -81,7 +110,20 @@ struct TableStats {
  * Compaction Scheme:
  * Hot batches are compacted into batches of size roughly `compacted_batch_size_` +/- the size of a
  * single row.  The compaction routine should be called periodically but that is not the
- * responsibility of this class.
+ * responsibility of this class. When compacting, STRING columns with few distinct values are
+ * dictionary encoded (see `internal/dictionary_encoding.h`) and decoded lazily on read, and the
+ * cold store accounts for their encoded size. Cold batches whose data is older than
+ * `--table_store_cold_freeze_age_seconds` are frozen: their columns are compressed, and
+ * decompressed on demand when a cursor reaches them.
+ *
+ * Disk Tier:
+ * If `--table_store_disk_tier_path` is set, cold batches that are expired from memory are written
+ * to a segment file on local disk instead of being dropped (see `internal::DiskSegment`). Segments
+ * are kept in a third `StoreWithRowTimeAccounting`, so cursors read through the disk, cold and hot
+ * stores in order. The oldest segments are removed once the table's segments exceed
+ * `--table_store_disk_tier_table_size_limit` bytes. The disk store is synchronized by the cold
+ * lock. Expired batches are written to disk by the compaction timer rather than by the write that
+ * expired them, they stay in the cold store and count against the table's budget until then.
  *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored in
@@ -176,6 +218,28 @@ class Table : public NotCopyable {
     // Change the StopSpec of the cursor.
     void UpdateStopSpec(StopSpec stop);
 
+    /**
+     * Set predicates that all rows returned by the cursor should satisfy. Cold batches whose zone
+     * maps show that no row can satisfy all the predicates are skipped. This is purely an
+     * optimization: batches that can't be ruled out are returned in full, so the caller is still
+     * responsible for filtering the returned rows.
+     * @param predicates conjunction of predicates, with column indices into the table's relation.
+     */
+    void SetZoneMapPredicates(std::vector<ColumnPredicate> predicates);
+    // Number of batches skipped due to the zone map predicates.
+    int64_t BatchesSkipped() const { return zone_map_filter_.batches_skipped; }
+    // Number of rows skipped due to the zone map predicates or the UPID index.
+    int64_t RowsSkipped() const { return zone_map_filter_.rows_skipped; }
+
+    /**
+     * Restrict the cursor to the rows that the table's UPID index maps to one of the given UPIDs.
+     * Like the zone map predicates, this is an optimization only: the returned batches can contain
+     * rows of other UPIDs, and tables without a UPID index return all rows. Equality predicates on
+     * the `upid` column passed to SetZoneMapPredicates set this filter as well.
+     * @param upids the UPIDs to read the rows of.
+     */
+    void SetUPIDFilter(std::vector<absl::uint128> upids);
+
    private:
     void AdvanceToStart(const StartSpec& start);
     void StopStateFromSpec(StopSpec&& stop);
@@ -183,6 +247,8 @@ class Table : public NotCopyable {
     // The following methods are made private so that they are only accessible from Table.
     internal::RowID* LastReadRowID();
     internal::BatchHints* Hints();
+    internal::ZoneMapFilter* Filter();
+    const absl::flat_hash_set<absl::uint128>& UPIDFilter() const;
     std::optional<internal::RowID> StopRowID() const;
 
     struct StopState {
@@ -193,6 +259,10 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    internal::ZoneMapFilter zone_map_filter_;
+    absl::flat_hash_set<absl::uint128> upid_filter_;
+    // Error from looking up the start or stop of the cursor, returned by GetNextRowBatch.
+    Status status_;
 
     friend class Table;
   };
@@ -212,8 +282,19 @@ class Table : public NotCopyable {
   Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
         size_t compacted_batch_size_);
 
+  ~Table();
+
+  /**
+   * Removes the directories of the disk tier left behind by tables that no longer exist, eg. by a
+   * previous run of the process that crashed. Directories of tables that still exist, in this or in
+   * another running process, are kept.
+   */
+  static void RemoveStaleDiskTierDirs();
+
   /**
-   * Get a RowBatch of data corresponding to the next data after the given cursor.
+   * Get a RowBatch of data corresponding to the next data after the given cursor. The table locks
+   * are only held while locating the data, copying or converting it happens without blocking
+   * concurrent writes.
    * @param cursor the Table::Cursor to get the next row batch after.
    * @param cols a vector of column indices to get data for.
    * @return a unique ptr to a RowBatch with the requested data.
@@ -239,17 +320,19 @@ class Table : public NotCopyable {
    * Find the unique identifier of the first row for which its corresponding time is greater than or
    * equal to the given time.
    * @param time the time to search for.
-   * @return unique identifier of the first row with time greater than or equal to the given time.
+   * @return unique identifier of the first row with time greater than or equal to the given time,
+   * or an error if the disk tier couldn't be read.
    */
-  RowID FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const;
+  StatusOr<RowID> FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const;
 
   /**
    * Find the unique identifier of the first row for which its corresponding time is greater than
    * the given time.
    * @param time the time to search for.
-   * @return unique identifier of the first row with time greater than the given time.
+   * @return unique identifier of the first row with time greater than the given time, or an error
+   * if the disk tier couldn't be read.
    */
-  RowID FindRowIDFromTimeFirstGreaterThan(Time time) const;
+  StatusOr<RowID> FindRowIDFromTimeFirstGreaterThan(Time time) const;
 
   /**
    * Writes a row batch to the table.
@@ -277,6 +360,19 @@ class Table : public NotCopyable {
 
   TableStats GetTableStats() const;
 
+  /**
+   * ConsumeReadStats returns the read stats accumulated since the last call, and resets them.
+   */
+  TableReadStats ConsumeReadStats();
+
+  /**
+   * SetMaxTableSize changes the maximum number of bytes the table can hold. If the table is larger
+   * than the new size, the oldest batches are expired right away.
+   * @param max_table_size the new maximum size in bytes.
+   * @return error if expiring batches fails.
+   */
+  Status SetMaxTableSize(int64_t max_table_size);
+
   /**
    * Compacts hot batches into compacted_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
@@ -284,6 +380,15 @@ class Table : public NotCopyable {
    */
   Status CompactHotToCold(arrow::MemoryPool* mem_pool);
 
+  /**
+   * Same as above, but stops compacting once `deadline` has passed. The remaining hot batches are
+   * compacted by later calls, the table's compaction lag measures how long they've been waiting.
+   * @param mem_pool arrow MemoryPool to be used for creating new cold batches.
+   * @param deadline the time after which no more batches are compacted.
+   */
+  Status CompactHotToCold(arrow::MemoryPool* mem_pool,
+                          std::chrono::steady_clock::time_point deadline);
+
  private:
   TableMetrics metrics_;
 
@@ -295,7 +400,13 @@ class Table : public NotCopyable {
   int64_t hot_bytes_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
-  int64_t max_table_size_ = 0;
+  int64_t bytes_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
+  mutable TableReadStats read_stats_ ABSL_GUARDED_BY(stats_lock_);
+  // When compaction first found a batch ready to compact that it hasn't compacted yet.
+  std::optional<std::chrono::steady_clock::time_point> compaction_ready_since_
+      ABSL_GUARDED_BY(stats_lock_);
+  int64_t compaction_lag_ns_ ABSL_GUARDED_BY(stats_lock_) = 0;
+  std::atomic<int64_t> max_table_size_ = 0;
   const int64_t compacted_batch_size_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
@@ -306,19 +417,56 @@ class Table : public NotCopyable {
       ABSL_GUARDED_BY(cold_lock_);
   std::deque<int64_t> cold_batch_bytes_ ABSL_GUARDED_BY(cold_lock_);
 
+  // Serializes writing cold batches to disk, see SpillPendingColdBatches.
+  absl::Mutex spill_lock_;
+  // The accounted bytes of the cold batches that were expired but not written to disk yet. These
+  // are always the first batches of the cold store.
+  std::deque<int64_t> pending_spill_bytes_ ABSL_GUARDED_BY(cold_lock_);
+  int64_t total_pending_spill_bytes_ ABSL_GUARDED_BY(cold_lock_) = 0;
+  // The disk store is only created if the disk tier is enabled. Its batches can have gaps between
+  // them, where a batch failed to be written to disk or hot batches expired without being spilled.
+  // Reads skip over the gaps.
+  std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Disk>> disk_store_
+      ABSL_GUARDED_BY(cold_lock_);
+  std::filesystem::path disk_tier_dir_;
+  int64_t disk_bytes_ ABSL_GUARDED_BY(cold_lock_) = 0;
+  int64_t next_disk_segment_id_ ABSL_GUARDED_BY(cold_lock_) = 0;
+
   // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
   // accessed on a hot write.
   int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
   int64_t time_col_idx_ = -1;
 
+  // The UPID index is only created if it's enabled and the table has a UINT128 `upid` column.
+  int64_t upid_col_idx_ = -1;
+  std::unique_ptr<internal::UPIDIndex> upid_index_ ABSL_PT_GUARDED_BY(hot_lock_);
+
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
+  // Records a cursor being opened at the given start, for the read stats.
+  void RecordRead(const Cursor::StartSpec& start) const;
+  // Finds the next batch after the cursor and advances the cursor past it. Only this part of a read
+  // holds the table locks, GetNextRowBatch materializes the returned slice after releasing them.
+  StatusOr<std::unique_ptr<internal::RowBatchSlice>> GetNextRowBatchSlice(
+      Cursor* cursor, const std::vector<int64_t>& cols) const;
 
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
+  // Writes the cold batches expired by ExpireCold to the disk tier, until the deadline.
+  void SpillPendingColdBatches(std::chrono::steady_clock::time_point deadline);
+  // Drops the oldest batches waiting to be written to disk until they take up at most the given
+  // bytes, for when the disk can't keep up with the writes to the table.
+  void DropPendingSpillsUnlocked(int64_t max_pending_bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
   Status ExpireRowBatches(int64_t row_batch_size);
   Status CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  Status FreezeColdUnlocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  void InitDiskTier(std::string_view table_name) ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
+  void AddDiskSegmentUnlocked(RowID first_row_id, internal::DiskSegment segment)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
+  StatusOr<RowID> FindRowIDFromTime(Time time, bool inclusive) const;
 
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
@@ -19,11 +19,13 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <numeric>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "src/shared/types/types.h"
 #include "src/table_store/table/table.h"
@@ -360,6 +362,65 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Measures the read throughput of concurrent readers, each reading the full table, while a writer
+// continuously pushes batches into the table (like Stirling does) and compaction runs in the
+// background. The number of reader threads is given by the benchmark argument.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableConcurrentReadUnderWriteLoad(benchmark::State& state) {
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t num_read_threads = state.range(0);
+  auto table = MakeTable(table_size, compaction_size);
+  int64_t time_counter = FillTableHot(table.get(), table_size, batch_length);
+
+  absl::Notification done;
+  std::atomic<int64_t> batches_written = 0;
+  std::thread writer_thread([&]() {
+    while (!done.HasBeenNotified()) {
+      PL_CHECK_OK(table->TransferRecordBatch(MakeHotBatch(batch_length, &time_counter)));
+      batches_written++;
+    }
+  });
+  std::thread compaction_thread([&]() {
+    while (!done.WaitForNotificationWithTimeout(absl::Milliseconds(10))) {
+      PL_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+    }
+  });
+
+  std::atomic<int64_t> rows_read = 0;
+  for (auto _ : state) {
+    auto barrier = std::make_shared<absl::Barrier>(num_read_threads);
+    std::vector<std::thread> reader_threads;
+    for (int64_t i = 0; i < num_read_threads; ++i) {
+      reader_threads.emplace_back([&table, &rows_read, barrier]() {
+        barrier->Block();
+        Table::Cursor cursor(table.get());
+        while (!cursor.Done()) {
+          auto batch_or_s = cursor.GetNextRowBatch({0, 1});
+          if (batch_or_s.ok()) {
+            rows_read += batch_or_s.ConsumeValueOrDie()->num_rows();
+          }
+        }
+      });
+    }
+    for (auto& reader_thread : reader_threads) {
+      reader_thread.join();
+    }
+  }
+
+  int64_t writes_during_reads = batches_written;
+  done.Notify();
+  writer_thread.join();
+  compaction_thread.join();
+
+  int64_t row_size = sizeof(int64_t) + sizeof(double);
+  state.SetItemsProcessed(rows_read);
+  state.SetBytesProcessed(rows_read * row_size);
+  state.counters["WriteBatches"] =
+      benchmark::Counter(writes_during_reads, benchmark::Counter::kIsRate);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
@@ -368,5 +429,6 @@ BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableConcurrentReadUnderWriteLoad)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
 
 }  // namespace px::table_store
@@ -60,4 +60,20 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                                .Name("table_max_table_size")
                                .Help("The table size")
                                .Register(*registry)
-                               .Add({{"name", table_name}})) {}
+                               .Add({{"name", table_name}})),
+      reads_counter(prometheus::BuildCounter()
+                        .Name("table_reads")
+                        .Help("Total number of cursors opened on the table")
+                        .Register(*registry)
+                        .Add({{"name", table_name}})),
+      compaction_lag_seconds_gauge(
+          prometheus::BuildGauge()
+              .Name("table_compaction_lag_seconds")
+              .Help("How long the table has had data ready for compaction that wasn't compacted")
+              .Register(*registry)
+              .Add({{"name", table_name}})),
+      compaction_seconds_counter(prometheus::BuildCounter()
+                                     .Name("table_compaction_seconds")
+                                     .Help("Total time spent compacting the table")
+                                     .Register(*registry)
+                                     .Add({{"name", table_name}})) {}
@@ -33,4 +33,7 @@ struct TableMetrics {
   prometheus::Counter& batches_expired_counter;
   prometheus::Counter& compacted_batches_counter;
   prometheus::Gauge& max_table_size_gauge;
+  prometheus::Counter& reads_counter;
+  prometheus::Gauge& compaction_lag_seconds_gauge;
+  prometheus::Counter& compaction_seconds_counter;
 };
@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/container/flat_hash_set.h>
+
 #include <algorithm>
 #include <utility>
 #include <vector>
@@ -25,6 +27,9 @@
 namespace px {
 namespace table_store {
 
+// Tables of a previous run of the process can have left data behind in the disk tier.
+TableStore::TableStore() { Table::RemoveStaleDiskTierDirs(); }
+
 std::unique_ptr<std::unordered_map<std::string, schema::Relation>> TableStore::GetRelationMap() {
   auto map = std::make_unique<RelationMap>();
   map->reserve(name_to_relation_map_.size());
@@ -62,9 +67,58 @@ Status TableStore::AppendData(uint64_t table_id, types::TabletID tablet_id,
   if (table == nullptr) {
     PL_ASSIGN_OR_RETURN(table, CreateNewTablet(table_id, tablet_id));
   }
+  {
+    absl::MutexLock lock(&rollups_lock_);
+    auto rollups_it = rollups_.empty() ? rollups_.end() : rollups_.find(GetTableName(table_id));
+    if (rollups_it != rollups_.end()) {
+      for (const auto& rollup : rollups_it->second) {
+        // The rollup is derived data, the source table is still written if it fails.
+        auto s = rollup->Update(*record_batch);
+        LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to update rollup $0: $1",
+                                                   rollup->spec().name, s.msg());
+      }
+    }
+  }
   return table->TransferRecordBatch(std::move(record_batch));
 }
 
+Status TableStore::AddRollup(const RollupSpec& spec, int64_t max_table_size) {
+  auto relation_it = name_to_relation_map_.find(spec.source_table);
+  if (relation_it == name_to_relation_map_.end()) {
+    return error::NotFound("Rollup '$0' is of table '$1', which doesn't exist.", spec.name,
+                           spec.source_table);
+  }
+  if (name_to_relation_map_.contains(spec.name)) {
+    return error::AlreadyExists("Can't add rollup '$0', a table with that name already exists.",
+                                spec.name);
+  }
+  PL_ASSIGN_OR_RETURN(auto rollup, Rollup::Create(spec, relation_it->second, max_table_size));
+  AddTable(rollup->table(), spec.name);
+  absl::MutexLock lock(&rollups_lock_);
+  rollups_[spec.source_table].push_back(std::move(rollup));
+  return Status::OK();
+}
+
+Status TableStore::FlushRollups() {
+  absl::MutexLock lock(&rollups_lock_);
+  for (const auto& [source_table, rollups] : rollups_) {
+    for (const auto& rollup : rollups) {
+      PL_RETURN_IF_ERROR(rollup->Flush());
+    }
+  }
+  return Status::OK();
+}
+
+Status TableStore::CloseRollupBuckets(int64_t time_ns) {
+  absl::MutexLock lock(&rollups_lock_);
+  for (const auto& [source_table, rollups] : rollups_) {
+    for (const auto& rollup : rollups) {
+      PL_RETURN_IF_ERROR(rollup->AdvanceTime(time_ns));
+    }
+  }
+  return Status::OK();
+}
+
 table_store::Table* TableStore::GetTable(const std::string& table_name,
                                          const types::TabletID& tablet_id) const {
   auto name_to_table_iter = name_to_table_map_.find(NameTablet{table_name, tablet_id});
@@ -159,8 +213,160 @@ std::vector<uint64_t> TableStore::GetTableIDs() const {
 }
 
 Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
-  for (const auto& it : name_to_table_map_) {
-    PL_RETURN_IF_ERROR(it.second->CompactHotToCold(mem_pool));
+  return RunCompaction(mem_pool, std::chrono::steady_clock::time_point::max());
+}
+
+Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool,
+                                 std::chrono::steady_clock::time_point deadline) {
+  std::vector<std::pair<int64_t, Table*>> tables_by_hot_bytes;
+  for (auto* table : UniqueTables()) {
+    auto stats = table->GetTableStats();
+    tables_by_hot_bytes.emplace_back(stats.bytes - stats.cold_bytes, table);
+  }
+  std::stable_sort(tables_by_hot_bytes.begin(), tables_by_hot_bytes.end(),
+                   [](const auto& a, const auto& b) { return a.first > b.first; });
+  for (const auto& [hot_bytes, table] : tables_by_hot_bytes) {
+    // Tables that don't get a turn still need to update their compaction lag.
+    PL_RETURN_IF_ERROR(table->CompactHotToCold(mem_pool, deadline));
+  }
+  return Status::OK();
+}
+
+std::vector<Table*> TableStore::UniqueTables() const {
+  std::vector<Table*> tables;
+  absl::flat_hash_set<Table*> seen;
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    if (seen.insert(table.get()).second) {
+      tables.push_back(table.get());
+    }
+  }
+  return tables;
+}
+
+std::vector<int64_t> ComputeTableBudgets(int64_t total_bytes,
+                                         const std::vector<TableBudgetDemand>& tables) {
+  std::vector<int64_t> budgets;
+  int64_t remaining = total_bytes;
+  for (const auto& table : tables) {
+    budgets.push_back(table.min_bytes);
+    remaining -= table.min_bytes;
+  }
+  auto unmet = [&](size_t i) {
+    return !tables[i].demand_bytes.has_value() || budgets[i] < tables[i].demand_bytes.value();
+  };
+
+  // Water-fill the unmet demands, weighted by the configured budgets. Every pass either meets at
+  // least one more demand or hands out all of the remaining memory.
+  while (remaining > 0) {
+    int64_t unmet_weight = 0;
+    for (size_t i = 0; i < tables.size(); ++i) {
+      if (unmet(i)) {
+        unmet_weight += tables[i].configured_bytes;
+      }
+    }
+    if (unmet_weight == 0) {
+      break;
+    }
+    int64_t granted = 0;
+    for (size_t i = 0; i < tables.size(); ++i) {
+      if (!unmet(i)) {
+        continue;
+      }
+      auto share = static_cast<int64_t>(static_cast<double>(remaining) *
+                                        tables[i].configured_bytes / unmet_weight);
+      if (tables[i].demand_bytes.has_value()) {
+        share = std::min(share, tables[i].demand_bytes.value() - budgets[i]);
+      }
+      budgets[i] += share;
+      granted += share;
+    }
+    remaining -= granted;
+    if (granted == 0) {
+      break;
+    }
+  }
+
+  // Split what's left once all demands are met in proportion to the configured budgets.
+  int64_t total_weight = 0;
+  for (const auto& table : tables) {
+    total_weight += table.configured_bytes;
+  }
+  if (remaining > 0 && total_weight > 0) {
+    int64_t leftover = remaining;
+    for (size_t i = 0; i < tables.size(); ++i) {
+      budgets[i] += static_cast<int64_t>(static_cast<double>(leftover) *
+                                         tables[i].configured_bytes / total_weight);
+    }
+  }
+  return budgets;
+}
+
+Status TableStore::RebalanceTableBudgets(std::chrono::steady_clock::time_point now) {
+  std::optional<double> elapsed_seconds;
+  if (last_rebalance_.has_value()) {
+    elapsed_seconds = std::chrono::duration<double>(now - last_rebalance_.value()).count();
+  }
+  last_rebalance_ = now;
+
+  std::vector<Table*> tables = UniqueTables();
+
+  std::vector<TableBudgetDemand> demands;
+  std::vector<int64_t> current_budgets;
+  int64_t total_bytes = 0;
+  bool all_tables_known = true;
+  for (auto* table : tables) {
+    auto stats = table->GetTableStats();
+    auto read_stats = table->ConsumeReadStats();
+    auto [it, inserted] = budget_states_.try_emplace(table);
+    auto& state = it->second;
+    if (inserted) {
+      state.configured_bytes = stats.max_table_size;
+      state.last_bytes_added = stats.bytes_added;
+      all_tables_known = false;
+    } else if (elapsed_seconds.has_value() && elapsed_seconds.value() > 0) {
+      double write_rate = (stats.bytes_added - state.last_bytes_added) / elapsed_seconds.value();
+      state.write_bytes_per_sec = (state.write_bytes_per_sec + write_rate) / 2;
+      state.last_bytes_added = stats.bytes_added;
+    }
+    state.read_history.push_back(read_stats);
+    if (state.read_history.size() > kReadHistoryPeriods) {
+      state.read_history.pop_front();
+    }
+
+    TableReadStats recent_reads;
+    for (const auto& period : state.read_history) {
+      recent_reads.num_reads += period.num_reads;
+      recent_reads.full_table_read |= period.full_table_read;
+      recent_reads.max_requested_retention_ns =
+          std::max(recent_reads.max_requested_retention_ns, period.max_requested_retention_ns);
+    }
+
+    TableBudgetDemand demand;
+    demand.configured_bytes = state.configured_bytes;
+    demand.min_bytes = static_cast<int64_t>(state.configured_bytes * kMinBudgetFraction);
+    if (recent_reads.num_reads == 0) {
+      // Unread tables only keep their minimum, unless there is memory that no one else needs.
+      demand.demand_bytes = demand.min_bytes;
+    } else if (!recent_reads.full_table_read) {
+      double retention_seconds = recent_reads.max_requested_retention_ns / 1e9;
+      demand.demand_bytes = std::max(
+          demand.min_bytes, static_cast<int64_t>(state.write_bytes_per_sec * retention_seconds *
+                                                 kRetentionHeadroom));
+    }
+    demands.push_back(demand);
+    current_budgets.push_back(stats.max_table_size);
+    total_bytes += state.configured_bytes;
+  }
+  // Write rates are only known once every table has been seen twice.
+  if (!all_tables_known || !elapsed_seconds.has_value()) {
+    return Status::OK();
+  }
+
+  auto budgets = ComputeTableBudgets(total_bytes, demands);
+  for (const auto& [i, table] : Enumerate(tables)) {
+    if (budgets[i] != current_budgets[i]) {
+      PL_RETURN_IF_ERROR(table->SetMaxTableSize(budgets[i]));
+    }
   }
   return Status::OK();
 }
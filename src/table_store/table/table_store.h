@@ -18,19 +18,24 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
 #include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/hash_utils.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/schema.h"
+#include "src/table_store/table/rollup.h"
 #include "src/table_store/table/table.h"
 #include "src/table_store/table/tablets_group.h"
 
@@ -73,6 +78,33 @@ struct TableInfo {
   schema::Relation relation;
 };
 
+/**
+ * TableBudgetDemand describes how much memory a table should get when the memory of the table store
+ * is rebalanced between its tables.
+ */
+struct TableBudgetDemand {
+  // The budget the table was created with. Memory that isn't needed to meet demands, and memory
+  // that is short of meeting them, is split in proportion to it.
+  int64_t configured_bytes;
+  // The table never gets less than this.
+  int64_t min_bytes;
+  // The bytes the table needs to serve the queries made against it, or std::nullopt if it can make
+  // use of any amount of memory.
+  std::optional<int64_t> demand_bytes;
+};
+
+/**
+ * ComputeTableBudgets splits `total_bytes` between tables. Every table first gets its minimum.
+ * The rest is handed out in proportion to the configured budgets of the tables whose demand isn't
+ * met yet, without giving any table more than its demand, until either the memory runs out or all
+ * demands are met. Whatever is left after that is split in proportion to the configured budgets.
+ * @param total_bytes the memory to split.
+ * @param tables the demand of each table.
+ * @return the budget of each table, in the same order as `tables`.
+ */
+std::vector<int64_t> ComputeTableBudgets(int64_t total_bytes,
+                                         const std::vector<TableBudgetDemand>& tables);
+
 /**
  * TableStore keeps track of the tables in our system.
  */
@@ -80,7 +112,7 @@ class TableStore {
  public:
   using RelationMap = std::unordered_map<std::string, schema::Relation>;
 
-  TableStore() = default;
+  TableStore();
 
   /**
    * Get table IDs returns a list of table ids available in the table store.
@@ -154,6 +186,29 @@ class TableStore {
 
   Status SchemaAsProto(schemapb::Schema* schema) const;
 
+  /**
+   * AddRollup registers a rollup of an existing table. The rollup is maintained as data is appended
+   * to the source table, and can be queried as a regular table named after the rollup. Failing to
+   * update a rollup is logged, it doesn't fail the append to the source table.
+   * @param spec the rollup definition.
+   * @param max_table_size the maximum size of the rollup table.
+   * @return error if the source table doesn't exist or doesn't match the spec.
+   */
+  Status AddRollup(const RollupSpec& spec, int64_t max_table_size);
+
+  /**
+   * FlushRollups writes the open buckets of all rollups to their tables.
+   */
+  Status FlushRollups();
+
+  /**
+   * CloseRollupBuckets writes the buckets of all rollups that can no longer receive rows at the
+   * given time, see Rollup::AdvanceTime. Called periodically, so that the buckets of tables that
+   * stopped receiving data are still written out.
+   * @param time_ns the current time.
+   */
+  Status CloseRollupBuckets(int64_t time_ns);
+
   /**
    * GetTableName returns the table name if the ID is found, else empty string.
    */
@@ -167,7 +222,46 @@ class TableStore {
 
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * RunCompaction compacts the tables with the most hot data first, until either all tables are
+   * compacted or `deadline` passes. Tables that weren't fully compacted are picked up by later
+   * calls, their wait is exported as their compaction lag.
+   * @param mem_pool the memory pool to allocate the compacted batches from.
+   * @param deadline the time after which compaction stops.
+   * @return error if compacting a table fails.
+   */
+  Status RunCompaction(arrow::MemoryPool* mem_pool,
+                       std::chrono::steady_clock::time_point deadline);
+
+  /**
+   * RebalanceTableBudgets redistributes the memory of the table store between its tables, based on
+   * their write rates and on the cursors opened on them over the last few calls. The memory that
+   * is split is the sum of the budgets the tables were created with. Tables that haven't been read
+   * recently shrink to a fraction of their configured budget, in favor of tables that are read and
+   * need more memory to hold the time range their queries ask for. Budgets are only changed from
+   * the second call onwards, the first call only records the state of the tables.
+   * @param now the current time, used to compute write rates.
+   * @return error if resizing a table fails.
+   */
+  Status RebalanceTableBudgets(
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
  private:
+  // The number of rebalances that a table's reads are taken into account for.
+  static constexpr size_t kReadHistoryPeriods = 10;
+  // The fraction of its configured budget that a table never goes below.
+  static constexpr double kMinBudgetFraction = 0.1;
+  // Extra room given on top of the memory needed to hold the requested time range.
+  static constexpr double kRetentionHeadroom = 1.25;
+
+  struct TableBudgetState {
+    int64_t configured_bytes = 0;
+    int64_t last_bytes_added = 0;
+    double write_bytes_per_sec = 0;
+    // Read stats of the last kReadHistoryPeriods rebalances, the most recent last.
+    std::deque<TableReadStats> read_history;
+  };
+
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
                          std::shared_ptr<table_store::Table> table);
@@ -184,6 +278,9 @@ class TableStore {
    */
   StatusOr<Table*> CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id);
 
+  // Returns every table once, including tablets, even if they are registered under several names.
+  std::vector<Table*> UniqueTables() const;
+
   // The default value for tablets, when tablet is not specified.
   inline static types::TabletID kDefaultTablet = "";
   // Map a name to a table.
@@ -197,6 +294,14 @@ class TableStore {
   absl::flat_hash_map<std::string, schema::Relation> name_to_relation_map_;
   // Mapping from id to name and relation pair for adding new tablets.
   absl::flat_hash_map<uint64_t, TableInfo> id_to_table_info_map_;
+  // Rollups by the name of their source table. They are updated by the data push thread, and closed
+  // by the agent's timer.
+  absl::Mutex rollups_lock_;
+  absl::flat_hash_map<std::string, std::vector<std::unique_ptr<Rollup>>> rollups_
+      ABSL_GUARDED_BY(rollups_lock_);
+  // Usage of each table, for rebalancing their budgets.
+  absl::flat_hash_map<Table*, TableBudgetState> budget_states_;
+  std::optional<std::chrono::steady_clock::time_point> last_rebalance_;
 };
 
 }  // namespace table_store
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/table/table_store.h"
@@ -276,6 +277,90 @@ TEST_F(TableStoreTabletsTest, add_tablet_on_append_data) {
   EXPECT_EQ(tablet2->GetTableStats().batches_added, 0);
 }
 
+TEST(ComputeTableBudgetsTest, fills_demands_in_proportion) {
+  // The unbounded table takes everything the bounded tables don't need.
+  auto budgets =
+      ComputeTableBudgets(1000, {{500, 50, 100}, {250, 25, std::nullopt}, {250, 25, 25}});
+  EXPECT_THAT(budgets, ::testing::ElementsAre(100, 875, 25));
+
+  // When memory is short, the unmet demands share it by their configured budgets.
+  budgets = ComputeTableBudgets(1000, {{500, 0, 2000}, {500, 0, 2000}});
+  EXPECT_THAT(budgets, ::testing::ElementsAre(500, 500));
+  budgets = ComputeTableBudgets(1000, {{750, 0, 2000}, {250, 0, 100}});
+  EXPECT_THAT(budgets, ::testing::ElementsAre(900, 100));
+
+  // Memory left once every demand is met goes back in proportion to the configured budgets.
+  budgets = ComputeTableBudgets(1000, {{500, 50, 50}, {500, 50, 150}});
+  EXPECT_THAT(budgets, ::testing::ElementsAre(450, 550));
+}
+
+TEST_F(TableStoreTest, rebalance_table_budgets) {
+  auto read_table = std::make_shared<Table>("read_table", rel1, 1000);
+  auto unread_table = std::make_shared<Table>("unread_table", rel1, 1000);
+  auto table_store = TableStore();
+  table_store.AddTable(read_table, "read_table");
+  table_store.AddTable(unread_table, "unread_table");
+
+  auto now = std::chrono::steady_clock::now();
+  EXPECT_OK(table_store.RebalanceTableBudgets(now));
+  // Without reads, the tables keep the budgets they were configured with.
+  now += std::chrono::seconds(1);
+  EXPECT_OK(table_store.RebalanceTableBudgets(now));
+  EXPECT_EQ(1000, read_table->GetTableStats().max_table_size);
+  EXPECT_EQ(1000, unread_table->GetTableStats().max_table_size);
+
+  // A read of the whole table moves the memory of the unread table to it.
+  Table::Cursor cursor(read_table.get());
+  now += std::chrono::seconds(1);
+  EXPECT_OK(table_store.RebalanceTableBudgets(now));
+  EXPECT_EQ(1900, read_table->GetTableStats().max_table_size);
+  EXPECT_EQ(100, unread_table->GetTableStats().max_table_size);
+}
+
+TEST_F(TableStoreTest, rollup) {
+  constexpr uint64_t kTableID = 1;
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "value"});
+  auto table_store = TableStore();
+  table_store.AddTable(Table::Create("source", rel), "source", kTableID);
+
+  RollupSpec spec;
+  spec.name = "source_rollup";
+  spec.source_table = "source";
+  spec.bucket_ns = 100;
+  spec.aggregates = {{RollupAggType::kSum, "value", "value_sum"}};
+  EXPECT_OK(table_store.AddRollup(spec, 1024 * 1024));
+  // Rollups need an existing source table and their own name.
+  EXPECT_NOT_OK(table_store.AddRollup(spec, 1024 * 1024));
+  spec.name = "other_rollup";
+  spec.source_table = "missing";
+  EXPECT_NOT_OK(table_store.AddRollup(spec, 1024 * 1024));
+
+  auto lookup = table_store.GetRelationMap();
+  EXPECT_EQ(schema::Relation({types::DataType::TIME64NS, types::DataType::INT64},
+                             {"time_", "value_sum"}),
+            lookup->at("source_rollup"));
+
+  for (int64_t time : {10, 20, 150}) {
+    auto batch = std::make_unique<ColumnWrapperRecordBatch>();
+    auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(1);
+    (*time_col)[0] = time;
+    auto value_col = std::make_shared<types::Int64ValueColumnWrapper>(1);
+    (*value_col)[0] = time;
+    batch->push_back(time_col);
+    batch->push_back(value_col);
+    EXPECT_OK(table_store.AppendData(kTableID, "", std::move(batch)));
+  }
+  EXPECT_OK(table_store.FlushRollups());
+
+  Table::Cursor cursor(table_store.GetTable("source_rollup"));
+  ASSERT_OK_AND_ASSIGN(auto rb, cursor.GetNextRowBatch({1}));
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{30}, arrow::default_memory_pool())));
+  ASSERT_OK_AND_ASSIGN(rb, cursor.GetNextRowBatch({1}));
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{150}, arrow::default_memory_pool())));
+}
+
 using TableStoreTabletsDeathTest = TableStoreTabletsTest;
 TEST_F(TableStoreTabletsDeathTest, tablet_test) {
   auto table_store = TableStore();
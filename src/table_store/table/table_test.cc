@@ -16,13 +16,19 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <absl/strings/str_cat.h>
 #include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <unistd.h>
+#include <filesystem>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "src/common/testing/temp_dir.h"
 #include "src/common/testing/testing.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/table_store/schema/relation.h"
@@ -498,6 +504,466 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, compaction_deadline) {
+  schema::Relation rel({types::DataType::BOOLEAN, types::DataType::INT64}, {"col1", "col2"});
+  int64_t rb_size = 2 * sizeof(bool) + 2 * sizeof(int64_t);
+  Table table("test_table", rel, 128 * 1024, rb_size);
+  for (int64_t i = 0; i < 3; ++i) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(std::vector<types::BoolValue>{true, false}, arrow::default_memory_pool())));
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(std::vector<types::Int64Value>{i, i}, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+
+  // Nothing is compacted after the deadline, and the table starts lagging.
+  auto deadline = std::chrono::steady_clock::now();
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool(), deadline));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool(), deadline));
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.compacted_batches);
+  EXPECT_LT(0, stats.compaction_lag_ns);
+
+  // Catching up resets the lag.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  stats = table.GetTableStats();
+  EXPECT_EQ(3, stats.compacted_batches);
+  EXPECT_EQ(0, stats.compaction_lag_ns);
+}
+
+TEST(TableTest, compaction_shares_whole_hot_batches) {
+  schema::Relation rel({types::DataType::INT64}, {"col1"});
+  int64_t rb_size = 2 * sizeof(int64_t);
+  Table table("test_table", rel, 128 * 1024, rb_size);
+  auto col1 = std::make_shared<types::Int64ValueColumnWrapper>(2);
+  (*col1)[0] = 1;
+  (*col1)[1] = 2;
+  const auto* col1_data = col1->UnsafeRawData();
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(col1);
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(1, table.GetTableStats().compacted_batches);
+
+  // The cold batch points into the column that was written to the table.
+  Table::Cursor cursor(&table);
+  auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+  auto arr = std::static_pointer_cast<arrow::Int64Array>(rb->ColumnAt(0));
+  EXPECT_EQ(reinterpret_cast<const int64_t*>(col1_data), arr->raw_values());
+  EXPECT_TRUE(arr->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{1, 2}, arrow::default_memory_pool())));
+}
+
+TEST(TableTest, zone_map_predicates_skip_cold_batches) {
+  schema::Relation rel({types::DataType::BOOLEAN, types::DataType::INT64}, {"col1", "col2"});
+  int64_t rb_size = 2 * sizeof(bool) + 2 * sizeof(int64_t);
+  Table table("test_table", rel, 128 * 1024, rb_size);
+
+  std::vector<types::BoolValue> col1 = {true, false};
+  std::vector<std::vector<types::Int64Value>> col2_batches = {{1, 2}, {10, 11}, {20, 21}};
+  for (const auto& col2 : col2_batches) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(3, table.GetTableStats().compacted_batches);
+
+  Table::Cursor cursor(&table);
+  cursor.SetZoneMapPredicates({{1, ColumnPredicate::kEqual, int64_t{10}}});
+
+  auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(
+      rb->ColumnAt(1)->Equals(types::ToArrow(col2_batches[1], arrow::default_memory_pool())));
+  EXPECT_EQ(1, cursor.BatchesSkipped());
+  EXPECT_EQ(2, cursor.RowsSkipped());
+  ASSERT_FALSE(cursor.Done());
+
+  // The last batch can't match either, so the cursor is exhausted with an empty batch.
+  rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_EQ(0, rb->num_rows());
+  EXPECT_EQ(2, cursor.BatchesSkipped());
+  EXPECT_EQ(4, cursor.RowsSkipped());
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, dictionary_encoded_cold_batches) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  std::vector<types::Int64Value> col1 = {1, 2, 3, 4, 5, 6};
+  std::vector<types::StringValue> col2 = {"GET", "POST", "GET", "GET", "POST", "GET"};
+  int64_t rb_size = 6 * sizeof(int64_t) + 20 * sizeof(char) + 6 * sizeof(uint32_t);
+  // The dictionary encoded column has 6 int16 codes, and a dictionary of "GET" and "POST".
+  int64_t encoded_rb_size =
+      6 * sizeof(int64_t) + 6 * sizeof(int16_t) + 7 * sizeof(char) + 2 * sizeof(uint32_t);
+  Table table("test_table", rel, 128 * 1024, rb_size);
+
+  auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+  rb_wrapper->push_back(
+      types::ColumnWrapper::FromArrow(types::ToArrow(col2, arrow::default_memory_pool())));
+  EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  EXPECT_EQ(rb_size, table.GetTableStats().bytes);
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(1, table.GetTableStats().compacted_batches);
+  EXPECT_EQ(encoded_rb_size, table.GetTableStats().cold_bytes);
+  EXPECT_EQ(encoded_rb_size, table.GetTableStats().bytes);
+
+  // Readers still see a plain string column.
+  Table::Cursor cursor(&table);
+  auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(col2, arrow::default_memory_pool())));
+  EXPECT_TRUE(cursor.Done());
+}
+
+TEST(TableTest, frozen_cold_batches) {
+  auto freeze_age_seconds = FLAGS_table_store_cold_freeze_age_seconds;
+  FLAGS_table_store_cold_freeze_age_seconds = 50;
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "payload"});
+  std::string payload_prefix(200, 'a');
+  std::vector<std::vector<types::Time64NSValue>> time_batches = {
+      {1'000'000'000, 2'000'000'000},
+      {100'000'000'000, 101'000'000'000},
+      {200'000'000'000, 201'000'000'000},
+  };
+  std::vector<std::vector<types::StringValue>> payload_batches;
+  for (size_t i = 0; i < time_batches.size(); ++i) {
+    payload_batches.push_back({payload_prefix + "0", payload_prefix + "1"});
+  }
+  int64_t rb_size = 2 * sizeof(int64_t) + 2 * 201 * sizeof(char) + 2 * sizeof(uint32_t);
+  Table table("test_table", rel, 128 * 1024, rb_size);
+
+  for (size_t i = 0; i < time_batches.size(); ++i) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(payload_batches[i], arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(3, table.GetTableStats().compacted_batches);
+  // The first two batches are more than 50s older than the last one, so their payloads are
+  // compressed to well under 100 bytes each.
+  int64_t max_frozen_rb_size = 2 * sizeof(int64_t) + 100;
+  int64_t frozen_cold_bytes = table.GetTableStats().cold_bytes;
+  EXPECT_LT(frozen_cold_bytes, 2 * max_frozen_rb_size + rb_size);
+  // The string offsets are a fixed cost in the accounting, so they are never freed by freezing.
+  EXPECT_GE(frozen_cold_bytes,
+            static_cast<int64_t>(3 * 2 * (sizeof(int64_t) + sizeof(uint32_t))));
+
+  // Frozen batches are decompressed when read.
+  Table::Cursor cursor(&table);
+  for (size_t i = 0; i < time_batches.size(); ++i) {
+    ASSERT_FALSE(cursor.Done());
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    EXPECT_TRUE(
+        rb->ColumnAt(0)->Equals(types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+    EXPECT_TRUE(
+        rb->ColumnAt(1)->Equals(types::ToArrow(payload_batches[i], arrow::default_memory_pool())));
+  }
+  EXPECT_TRUE(cursor.Done());
+  // The decompressed payloads are cached, and counted as cold bytes while they are.
+  EXPECT_EQ(frozen_cold_bytes + static_cast<int64_t>(2 * 2 * (201 + sizeof(uint32_t))),
+            table.GetTableStats().cold_bytes);
+
+  FLAGS_table_store_cold_freeze_age_seconds = freeze_age_seconds;
+}
+
+TEST(TableTest, disk_tier) {
+  px::testing::TempDir disk_tier_dir;
+  auto disk_tier_path = FLAGS_table_store_disk_tier_path;
+  FLAGS_table_store_disk_tier_path = disk_tier_dir.path().string();
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  int64_t rb_size = 2 * sizeof(int64_t) + 2 * sizeof(int64_t);
+  std::vector<std::vector<types::Time64NSValue>> time_batches;
+  std::vector<std::vector<types::Int64Value>> col1_batches;
+  for (int64_t i = 0; i < 6; ++i) {
+    time_batches.push_back({10 * i, 10 * i + 1});
+    col1_batches.push_back({i, -i});
+  }
+  {
+    // Only 3 batches fit in memory, the older ones are spilled to disk.
+    Table table("test_table", rel, 3 * rb_size, rb_size);
+    for (size_t i = 0; i < time_batches.size(); ++i) {
+      auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+      rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+          types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+      rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+          types::ToArrow(col1_batches[i], arrow::default_memory_pool())));
+      EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+      EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+    }
+    auto stats = table.GetTableStats();
+    EXPECT_EQ(3 * rb_size, stats.bytes);
+    EXPECT_LT(0, stats.disk_bytes);
+    EXPECT_EQ(0, stats.min_time);
+
+    // Cursors read through the disk and memory stores in order.
+    Table::Cursor cursor(&table);
+    for (size_t i = 0; i < time_batches.size(); ++i) {
+      ASSERT_FALSE(cursor.Done());
+      auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+      EXPECT_TRUE(
+          rb->ColumnAt(0)->Equals(types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+      EXPECT_TRUE(
+          rb->ColumnAt(1)->Equals(types::ToArrow(col1_batches[i], arrow::default_memory_pool())));
+    }
+    EXPECT_TRUE(cursor.Done());
+
+    // The time index covers the disk store.
+    Table::Cursor::StartSpec start_spec;
+    start_spec.type = Table::Cursor::StartSpec::StartAtTime;
+    start_spec.start_time = 11;
+    Table::Cursor time_cursor(&table, start_spec, Table::Cursor::StopSpec{});
+    auto rb = time_cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(
+        types::ToArrow(std::vector<types::Time64NSValue>{11}, arrow::default_memory_pool())));
+  }
+  // The table removes its segments when it's destroyed.
+  EXPECT_TRUE(std::filesystem::is_empty(disk_tier_dir.path()));
+
+  FLAGS_table_store_disk_tier_path = disk_tier_path;
+}
+
+TEST(TableTest, disk_tier_spills_on_compaction) {
+  px::testing::TempDir disk_tier_dir;
+  auto disk_tier_path = FLAGS_table_store_disk_tier_path;
+  FLAGS_table_store_disk_tier_path = disk_tier_dir.path().string();
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  int64_t rb_size = 2 * sizeof(int64_t) + 2 * sizeof(int64_t);
+  Table table("test_table", rel, 3 * rb_size, rb_size);
+  auto write_batch = [&](int64_t i) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(types::ToArrow(
+        std::vector<types::Time64NSValue>{10 * i, 10 * i + 1}, arrow::default_memory_pool())));
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(std::vector<types::Int64Value>{i, -i}, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  };
+  for (int64_t i = 0; i < 3; ++i) {
+    write_batch(i);
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  // The write expires the first cold batch, but leaves writing it to disk to compaction. Until
+  // then it's still read from memory and counts against the table's budget.
+  write_batch(3);
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(0, stats.disk_bytes);
+  EXPECT_EQ(4 * rb_size, stats.bytes);
+  EXPECT_EQ(0, stats.min_time);
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  stats = table.GetTableStats();
+  EXPECT_LT(0, stats.disk_bytes);
+  EXPECT_EQ(3 * rb_size, stats.bytes);
+  EXPECT_EQ(0, stats.min_time);
+
+  // Cursors read through the spilled batch on disk, the batch waiting to be spilled and the rest.
+  write_batch(4);
+  Table::Cursor cursor(&table);
+  for (int64_t i = 0; i < 5; ++i) {
+    ASSERT_FALSE(cursor.Done());
+    auto rb = cursor.GetNextRowBatch({1}).ConsumeValueOrDie();
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(
+        types::ToArrow(std::vector<types::Int64Value>{i, -i}, arrow::default_memory_pool())));
+  }
+  EXPECT_TRUE(cursor.Done());
+
+  FLAGS_table_store_disk_tier_path = disk_tier_path;
+}
+
+TEST(TableTest, disk_tier_write_failure) {
+  px::testing::TempDir disk_tier_dir;
+  auto disk_tier_path = FLAGS_table_store_disk_tier_path;
+  FLAGS_table_store_disk_tier_path = disk_tier_dir.path().string();
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  int64_t rb_size = 2 * sizeof(int64_t) + 2 * sizeof(int64_t);
+  std::vector<std::vector<types::Time64NSValue>> time_batches;
+  std::vector<std::vector<types::Int64Value>> col1_batches;
+  for (int64_t i = 0; i < 6; ++i) {
+    time_batches.push_back({10 * i, 10 * i + 1});
+    col1_batches.push_back({i, -i});
+  }
+  Table table("test_table", rel, 3 * rb_size, rb_size);
+  // Block the path of the second segment, so that only the second batch fails to be written.
+  auto table_dir = std::filesystem::directory_iterator(disk_tier_dir.path())->path();
+  ASSERT_TRUE(std::filesystem::create_directory(table_dir / "1.segment"));
+  for (size_t i = 0; i < time_batches.size(); ++i) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(col1_batches[i], arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  // The batches written before and after the failed one are still read.
+  Table::Cursor cursor(&table);
+  for (size_t i : {0, 2, 3, 4, 5}) {
+    ASSERT_FALSE(cursor.Done());
+    auto rb = cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+    EXPECT_TRUE(
+        rb->ColumnAt(0)->Equals(types::ToArrow(time_batches[i], arrow::default_memory_pool())));
+  }
+  EXPECT_TRUE(cursor.Done());
+
+  // Times in the gap start the cursor at the next batch on disk.
+  Table::Cursor::StartSpec start_spec;
+  start_spec.type = Table::Cursor::StartSpec::StartAtTime;
+  start_spec.start_time = 11;
+  Table::Cursor time_cursor(&table, start_spec, Table::Cursor::StopSpec{});
+  auto rb = time_cursor.GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+  EXPECT_TRUE(
+      rb->ColumnAt(0)->Equals(types::ToArrow(time_batches[2], arrow::default_memory_pool())));
+  EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(11).ConsumeValueOrDie());
+
+  FLAGS_table_store_disk_tier_path = disk_tier_path;
+}
+
+TEST(TableTest, remove_stale_disk_tier_dirs) {
+  px::testing::TempDir disk_tier_dir;
+  auto disk_tier_path = FLAGS_table_store_disk_tier_path;
+  FLAGS_table_store_disk_tier_path = disk_tier_dir.path().string();
+
+  // A directory of a table of this process that no longer exists, eg. from before a restart.
+  auto stale_dir = disk_tier_dir.path() / absl::StrCat("stale_table-", getpid(), "-1000000");
+  ASSERT_TRUE(std::filesystem::create_directory(stale_dir));
+  // Directories that weren't created by a table are left alone.
+  auto other_dir = disk_tier_dir.path() / "other";
+  ASSERT_TRUE(std::filesystem::create_directory(other_dir));
+  {
+    schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+    Table table("test_table", rel, 1024);
+
+    Table::RemoveStaleDiskTierDirs();
+    EXPECT_FALSE(std::filesystem::exists(stale_dir));
+    EXPECT_TRUE(std::filesystem::exists(other_dir));
+    // The directory of the live table is kept.
+    std::vector<std::filesystem::path> dirs;
+    for (const auto& entry : std::filesystem::directory_iterator(disk_tier_dir.path())) {
+      dirs.push_back(entry.path());
+    }
+    EXPECT_EQ(2U, dirs.size());
+  }
+
+  FLAGS_table_store_disk_tier_path = disk_tier_path;
+}
+
+TEST(TableTest, read_stats_and_resize) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  int64_t rb_size = 2 * sizeof(int64_t) + 2 * sizeof(int64_t);
+  Table table("test_table", rel, 4 * rb_size, rb_size);
+  for (int64_t i = 0; i < 4; ++i) {
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(types::ToArrow(
+        std::vector<types::Time64NSValue>{10 * i, 10 * i + 1}, arrow::default_memory_pool())));
+    rb_wrapper->push_back(types::ColumnWrapper::FromArrow(
+        types::ToArrow(std::vector<types::Int64Value>{i, -i}, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+  EXPECT_EQ(4 * rb_size, table.GetTableStats().bytes_added);
+
+  Table::Cursor::StartSpec start_spec;
+  start_spec.type = Table::Cursor::StartSpec::StartAtTime;
+  start_spec.start_time = 11;
+  Table::Cursor time_cursor(&table, start_spec, Table::Cursor::StopSpec{});
+  auto read_stats = table.ConsumeReadStats();
+  EXPECT_EQ(1, read_stats.num_reads);
+  EXPECT_FALSE(read_stats.full_table_read);
+  EXPECT_EQ(31 - 11, read_stats.max_requested_retention_ns);
+
+  Table::Cursor cursor(&table);
+  read_stats = table.ConsumeReadStats();
+  EXPECT_EQ(1, read_stats.num_reads);
+  EXPECT_TRUE(read_stats.full_table_read);
+  // Consuming the stats resets them.
+  EXPECT_EQ(0, table.ConsumeReadStats().num_reads);
+
+  // Shrinking the table expires the oldest batches right away.
+  EXPECT_OK(table.SetMaxTableSize(2 * rb_size));
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(2 * rb_size, stats.max_table_size);
+  EXPECT_EQ(2 * rb_size, stats.bytes);
+  EXPECT_EQ(20, stats.min_time);
+}
+
+TEST(TableTest, upid_index) {
+  schema::Relation rel({types::DataType::UINT128, types::DataType::INT64}, {"upid", "col1"});
+  int64_t row_size = sizeof(absl::uint128) + sizeof(int64_t);
+  Table table("test_table", rel, 128 * 1024 * 1024, 1000 * row_size);
+
+  types::UInt128Value upid_a(1, 1);
+  types::UInt128Value upid_b(1, 2);
+  // Batches of `upid_a` are far enough apart that the index keeps them as separate ranges.
+  std::vector<std::pair<types::UInt128Value, int64_t>> batches = {
+      {upid_b, 2000}, {upid_a, 10}, {upid_b, 2000}, {upid_a, 10}, {upid_b, 500}};
+  int64_t row_id = 0;
+  for (const auto& [upid, num_rows] : batches) {
+    std::vector<types::UInt128Value> upids(num_rows, upid);
+    std::vector<types::Int64Value> col1;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      col1.push_back(row_id++);
+    }
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(upids, arrow::default_memory_pool())));
+    rb_wrapper->push_back(
+        types::ColumnWrapper::FromArrow(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+  }
+
+  auto read_upid_a = [&table](Table::Cursor* cursor) {
+    std::vector<int64_t> rows;
+    while (!cursor->Done()) {
+      auto rb = cursor->GetNextRowBatch({0, 1}).ConsumeValueOrDie();
+      for (int64_t i = 0; i < rb->num_rows(); ++i) {
+        auto upid =
+            types::GetValueFromArrowArray<types::DataType::UINT128>(rb->ColumnAt(0).get(), i);
+        EXPECT_EQ(absl::MakeUint128(1, 1), upid);
+        rows.push_back(
+            types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(1).get(), i));
+      }
+    }
+    return rows;
+  };
+  std::vector<int64_t> expected_rows;
+  for (int64_t i = 0; i < 10; ++i) {
+    expected_rows.push_back(2000 + i);
+  }
+  for (int64_t i = 0; i < 10; ++i) {
+    expected_rows.push_back(4010 + i);
+  }
+
+  // Only the rows of `upid_a` are read, from the hot store.
+  Table::Cursor cursor(&table);
+  cursor.SetUPIDFilter({upid_a.val});
+  EXPECT_EQ(expected_rows, read_upid_a(&cursor));
+  EXPECT_EQ(4500, cursor.RowsSkipped());
+
+  // The index still applies after the rows are compacted into the cold store, and is also used for
+  // equality predicates on the upid column.
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_LT(0, table.GetTableStats().compacted_batches);
+  Table::Cursor cold_cursor(&table);
+  cold_cursor.SetZoneMapPredicates({{0, ColumnPredicate::kEqual, upid_a.val}});
+  EXPECT_EQ(expected_rows, read_upid_a(&cold_cursor));
+  EXPECT_EQ(4500, cold_cursor.RowsSkipped());
+}
+
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
@@ -553,25 +1019,25 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal) {
   wrapper_batch->push_back(col_wrapper);
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
 
-  EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0));
+  EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0).ConsumeValueOrDie());
 
-  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5));
+  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5).ConsumeValueOrDie());
 
-  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6));
+  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6).ConsumeValueOrDie());
 
-  EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8));
+  EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8).ConsumeValueOrDie());
 
-  EXPECT_EQ(9, table.FindRowIDFromTimeFirstGreaterThanOrEqual(10));
+  EXPECT_EQ(9, table.FindRowIDFromTimeFirstGreaterThanOrEqual(10).ConsumeValueOrDie());
 
-  EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13));
+  EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13).ConsumeValueOrDie());
 
-  EXPECT_EQ(13, table.FindRowIDFromTimeFirstGreaterThanOrEqual(21));
+  EXPECT_EQ(13, table.FindRowIDFromTimeFirstGreaterThanOrEqual(21).ConsumeValueOrDie());
 
   // If the time is not in the table it returns the RowID after the end of the table (which is the
   // number of rows that have been added to the table).
   EXPECT_EQ(time_batch_1.size() + time_batch_2.size() + time_batch_3.size() + time_batch_4.size() +
                 time_batch_5.size() + time_batch_6.size(),
-            table.FindRowIDFromTimeFirstGreaterThanOrEqual(24));
+            table.FindRowIDFromTimeFirstGreaterThanOrEqual(24).ConsumeValueOrDie());
 }
 
 TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction) {
@@ -596,8 +1062,8 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
 
   // Run Compaction.
   EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
-  EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0));
-  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5));
+  EXPECT_EQ(0, table.FindRowIDFromTimeFirstGreaterThanOrEqual(0).ConsumeValueOrDie());
+  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(5).ConsumeValueOrDie());
 
   wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
   col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(3);
@@ -615,11 +1081,11 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
 
   // Run Compaction.
   EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
-  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6));
+  EXPECT_EQ(3, table.FindRowIDFromTimeFirstGreaterThanOrEqual(6).ConsumeValueOrDie());
 
-  EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8));
+  EXPECT_EQ(4, table.FindRowIDFromTimeFirstGreaterThanOrEqual(8).ConsumeValueOrDie());
 
-  EXPECT_EQ(9, table.FindRowIDFromTimeFirstGreaterThanOrEqual(10));
+  EXPECT_EQ(9, table.FindRowIDFromTimeFirstGreaterThanOrEqual(10).ConsumeValueOrDie());
 
   wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
   col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(3);
@@ -644,15 +1110,15 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
   // Run Compaction.
   EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
 
-  EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13));
+  EXPECT_EQ(10, table.FindRowIDFromTimeFirstGreaterThanOrEqual(13).ConsumeValueOrDie());
 
-  EXPECT_EQ(13, table.FindRowIDFromTimeFirstGreaterThanOrEqual(21));
+  EXPECT_EQ(13, table.FindRowIDFromTimeFirstGreaterThanOrEqual(21).ConsumeValueOrDie());
 
   // If the time is not in the table it returns the RowID after the end of the table (which is the
   // number of rows that have been added to the table).
   EXPECT_EQ(time_batch_1.size() + time_batch_2.size() + time_batch_3.size() + time_batch_4.size() +
                 time_batch_5.size() + time_batch_6.size(),
-            table.FindRowIDFromTimeFirstGreaterThanOrEqual(24));
+            table.FindRowIDFromTimeFirstGreaterThanOrEqual(24).ConsumeValueOrDie());
 }
 
 TEST(TableTest, ToProto) {
@@ -63,6 +63,16 @@ DEFINE_string(vizier_id, gflags::StringFromEnv("PL_VIZIER_ID", ""), "The ID of t
 DEFINE_string(vizier_name, gflags::StringFromEnv("PL_VIZIER_NAME", ""),
               "The name of the cluster according to vizier.");
 
+DEFINE_int32(table_store_compaction_period_ms,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_PERIOD_MS", 60 * 1000),
+             "How often the table store compacts hot data into cold batches.");
+
+DEFINE_int32(table_store_compaction_budget_ms,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_BUDGET_MS", 0),
+             "The maximum time a single table store compaction may take, tables with the most hot "
+             "data are compacted first. Unlimited (0) by default. Use with a shorter "
+             "table_store_compaction_period_ms to spread compaction out evenly.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -322,13 +332,20 @@ Status Manager::PostRegisterHook(uint32_t asid) {
     // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
     // will need to figure out how to use the correct memory pool here, but for now we can just use
     // the default pool.
-    auto status = table_store()->RunCompaction(arrow::default_memory_pool());
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (FLAGS_table_store_compaction_budget_ms > 0) {
+      deadline = std::chrono::steady_clock::now() +
+                 std::chrono::milliseconds(FLAGS_table_store_compaction_budget_ms);
+    }
+    auto status = table_store()->RunCompaction(arrow::default_memory_pool(), deadline);
     LOG_IF(ERROR, !status.ok()) << status.msg();
     if (tablestore_compaction_timer_) {
-      tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
+      tablestore_compaction_timer_->EnableTimer(
+          std::chrono::milliseconds(FLAGS_table_store_compaction_period_ms));
     }
   });
-  tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
+  tablestore_compaction_timer_->EnableTimer(
+      std::chrono::milliseconds(FLAGS_table_store_compaction_period_ms));
 
   memory_metrics_timer_ = dispatcher()->CreateTimer([this]() {
     memory_metrics_.MeasureMemory();
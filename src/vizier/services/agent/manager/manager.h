@@ -60,8 +60,6 @@ constexpr auto kChanCacheCleanupChansionPeriod = std::chrono::minutes(5);
  */
 constexpr auto kChanIdleGracePeriod = std::chrono::minutes(1);
 
-constexpr auto kTableStoreCompactionPeriod = std::chrono::minutes(1);
-
 constexpr auto kMemoryMetricsCollectPeriod = std::chrono::minutes(1);
 
 /**
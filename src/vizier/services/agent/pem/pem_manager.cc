@@ -34,6 +34,19 @@ DEFINE_int32(table_store_http_events_percent,
              "The percent of the table store data limit that should be devoted to the http_events "
              "table. Defaults to 40%.");
 
+DEFINE_int32(table_store_rebalance_period_seconds,
+             gflags::Int32FromEnv("PL_TABLE_STORE_REBALANCE_PERIOD_SECONDS", 0),
+             "How often to redistribute the table store data limit between tables, based on how "
+             "the tables are written and queried. Disabled (0) by default, in which case tables "
+             "keep the sizes they were created with.");
+
+DEFINE_int32(table_store_http_events_rollup_seconds,
+             gflags::Int32FromEnv("PL_TABLE_STORE_HTTP_EVENTS_ROLLUP_SECONDS", 0),
+             "If positive, maintain an http_events_rollup table with the number of requests and "
+             "the latency quantiles of each process and response status, in buckets of this many "
+             "seconds. It retains the aggregates for longer than http_events retains the "
+             "requests. Disabled (0) by default.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -56,6 +69,7 @@ Status PEMManager::PostRegisterHookImpl() {
       std::bind(&px::md::AgentMetadataStateManager::CurrentAgentMetadataState, mds_manager()));
 
   PL_RETURN_IF_ERROR(InitSchemas());
+  PL_RETURN_IF_ERROR(InitTableBudgetRebalancing());
   PL_RETURN_IF_ERROR(stirling_->RunAsThread());
 
   auto execute_query_handler = std::make_shared<ExecuteQueryMessageHandler>(
@@ -103,7 +117,9 @@ Status PEMManager::InitSchemas() {
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);
     PL_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(relation_info));
   }
-  return Status::OK();
+  // The rollup only keeps one row per process and status for each bucket, so it gets the share of
+  // a regular table.
+  return InitRollups(other_table_size);
 }
 
 Status PEMManager::InitClockConverters() {
@@ -119,6 +135,62 @@ Status PEMManager::InitClockConverters() {
   return Status::OK();
 }
 
+Status PEMManager::InitTableBudgetRebalancing() {
+  if (FLAGS_table_store_rebalance_period_seconds <= 0) {
+    return Status::OK();
+  }
+  auto period = std::chrono::seconds(FLAGS_table_store_rebalance_period_seconds);
+  table_budget_timer_ = dispatcher()->CreateTimer([this, period]() {
+    auto status = table_store()->RebalanceTableBudgets();
+    LOG_IF(ERROR, !status.ok()) << status.msg();
+    if (table_budget_timer_) {
+      table_budget_timer_->EnableTimer(period);
+    }
+  });
+  table_budget_timer_->EnableTimer(period);
+  return Status::OK();
+}
+
+Status PEMManager::InitRollups(int64_t rollup_table_size) {
+  if (FLAGS_table_store_http_events_rollup_seconds <= 0) {
+    return Status::OK();
+  }
+  if (table_store()->GetTable("http_events") == nullptr) {
+    LOG(WARNING) << "Not maintaining http_events_rollup, the http_events table doesn't exist.";
+    return Status::OK();
+  }
+  auto period = std::chrono::seconds(FLAGS_table_store_http_events_rollup_seconds);
+  table_store::RollupSpec spec;
+  spec.name = "http_events_rollup";
+  spec.source_table = "http_events";
+  spec.bucket_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(period).count();
+  spec.group_by_cols = {"upid", "resp_status"};
+  spec.aggregates = {
+      {table_store::RollupAggType::kCount, "", "num_requests"},
+      {table_store::RollupAggType::kQuantiles, "latency", "latency_quantiles"},
+  };
+  PL_RETURN_IF_ERROR(table_store()->AddRollup(spec, rollup_table_size));
+  // Announce the rollup like the Stirling tables, so that queries can read it. Stirling numbers its
+  // tables from 0, the rollup's ID is out of their range.
+  constexpr uint64_t kRollupTableID = uint64_t{1} << 32;
+  PL_RETURN_IF_ERROR(relation_info_manager()->AddRelationInfo(
+      RelationInfo(spec.name, kRollupTableID,
+                   "Number of requests and latency quantiles of http_events by process and status",
+                   table_store()->GetTable(spec.name)->GetRelation())));
+
+  // Buckets are normally written out by the rows that arrive after them. The timer writes them out
+  // when http_events stops receiving data.
+  rollup_timer_ = dispatcher()->CreateTimer([this, period]() {
+    auto status = table_store()->CloseRollupBuckets(CurrentTimeNS());
+    LOG_IF(ERROR, !status.ok()) << status.msg();
+    if (rollup_timer_) {
+      rollup_timer_->EnableTimer(period);
+    }
+  });
+  rollup_timer_->EnableTimer(period);
+  return Status::OK();
+}
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
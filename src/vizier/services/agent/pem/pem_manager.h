@@ -64,6 +64,8 @@ class PEMManager : public Manager {
  private:
   Status InitSchemas();
   Status InitClockConverters();
+  Status InitTableBudgetRebalancing();
+  Status InitRollups(int64_t rollup_table_size);
   static services::shared::agent::AgentCapabilities Capabilities() {
     services::shared::agent::AgentCapabilities capabilities;
     capabilities.set_collects_data(true);
@@ -75,6 +77,10 @@ class PEMManager : public Manager {
 
   // Timer for triggering ClockConverter polls.
   px::event::TimerUPtr clock_converter_timer_;
+  // Timer for redistributing the table store memory between tables.
+  px::event::TimerUPtr table_budget_timer_;
+  // Timer for writing out the buckets of the table store rollups.
+  px::event::TimerUPtr rollup_timer_;
 };
 
 }  // namespace agent
@@ -75,6 +75,7 @@ type QueryExecutorImpl struct {
 	mdconf              metadatapb.MetadataConfigServiceClient
 	resultForwarder     QueryResultForwarder
 	planner             Planner
+	resultCache         *ResultCacheTracker
 
 	eg *errgroup.Group
 
@@ -82,6 +83,17 @@ type QueryExecutorImpl struct {
 	startTime         time.Time
 	compilationTimeNs int64
 
+	// The key and the plan of the script in the result cache tracker, if the tracker is enabled.
+	resultCacheKey  string
+	resultCachePlan *distributedpb.DistributedPlan
+
+	// What's needed to plan and launch the script again, if its plan relied on cached buckets that
+	// Kelvin no longer has.
+	plannerReq    *plannerpb.QueryRequest
+	planOpts      *planpb.PlanOptions
+	tableIDMap    map[string]string
+	queryPlanOpts *QueryPlanOpts
+
 	mutationExecFactory MutationExecFactory
 }
 
@@ -97,6 +109,7 @@ func NewQueryExecutorFromServer(s *Server, mutExecFactory MutationExecFactory) Q
 		s.mdconf,
 		s.resultForwarder,
 		s.planner,
+		s.resultCache,
 		mutExecFactory,
 	)
 }
@@ -112,6 +125,7 @@ func NewQueryExecutor(
 	mdconf metadatapb.MetadataConfigServiceClient,
 	resultForwarder QueryResultForwarder,
 	planner Planner,
+	resultCache *ResultCacheTracker,
 	mutExecFactory MutationExecFactory,
 ) QueryExecutor {
 	return &QueryExecutorImpl{
@@ -124,6 +138,7 @@ func NewQueryExecutor(
 		mdconf:              mdconf,
 		resultForwarder:     resultForwarder,
 		planner:             planner,
+		resultCache:         resultCache,
 		mutationExecFactory: mutExecFactory,
 	}
 }
@@ -299,6 +314,13 @@ func (q *QueryExecutorImpl) compilePlan(ctx context.Context, resultCh chan<- *vi
 		OTelEndpointConfig:  otelConfig,
 		PluginConfig:        pluginConfig,
 	}
+	if q.resultCache != nil {
+		q.resultCacheKey, err = ResultCacheKey(req)
+		if err != nil {
+			return nil, err
+		}
+		plannerState.ResultCacheConfig = q.resultCache.Config(q.resultCacheKey)
+	}
 
 	// Compile the query plan.
 	start := time.Now()
@@ -307,6 +329,16 @@ func (q *QueryExecutorImpl) compilePlan(ctx context.Context, resultCh chan<- *vi
 		// send the compilation error and return nil.
 		return nil, err
 	}
+	if q.resultCache != nil && plannerResultPB.Status.ErrCode == statuspb.OK &&
+		!q.resultCache.Matches(q.resultCacheKey, plannerResultPB.Plan) {
+		// The plan changed since the buckets were cached, so Kelvin wouldn't find them. Plan the
+		// query again to read its whole time range.
+		plannerState.ResultCacheConfig = q.resultCache.Config(q.resultCacheKey)
+		plannerResultPB, err = q.planner.Plan(plannerState, req)
+		if err != nil {
+			return nil, err
+		}
+	}
 	q.compilationTimeNs = time.Since(start).Nanoseconds()
 
 	// When the status is not OK, this means it's a compilation error on the query passed in.
@@ -316,6 +348,9 @@ func (q *QueryExecutorImpl) compilePlan(ctx context.Context, resultCh chan<- *vi
 		}
 		return nil, StatusToError(plannerResultPB.Status)
 	}
+	if q.resultCache != nil {
+		q.resultCachePlan = plannerResultPB.Plan
+	}
 	return plannerResultPB.Plan, nil
 }
 
@@ -439,9 +474,88 @@ func (q *QueryExecutorImpl) prepareScript(ctx context.Context, resultCh chan<- *
 	if err != nil {
 		return err
 	}
+
+	q.plannerReq = convertedReq
+	q.planOpts = planOpts
+	q.tableIDMap = tableNameToIDMap
+	q.queryPlanOpts = queryPlanOpts
 	return nil
 }
 
+// relaunchScript plans the script again and launches it under a new query ID, since the agents may
+// still be tearing down the failed query under the old one.
+func (q *QueryExecutorImpl) relaunchScript(ctx context.Context, resultCh chan<- *vizierpb.ExecuteScriptResponse) (uuid.UUID, error) {
+	distributedState := q.agentsTracker.GetAgentInfo().DistributedState()
+	plan, err := q.compilePlan(ctx, resultCh, q.plannerReq, q.planOpts, &distributedState)
+	if err != nil {
+		return uuid.Nil, err
+	}
+	planMap, err := q.buildAgentPlanMap(plan)
+	if err != nil {
+		return uuid.Nil, err
+	}
+	queryPlanOpts := q.queryPlanOpts
+	if queryPlanOpts != nil {
+		queryPlanOpts = &QueryPlanOpts{
+			TableID: q.queryPlanOpts.TableID,
+			Plan:    plan,
+			PlanMap: planMap,
+		}
+	}
+
+	retryID, err := uuid.NewV4()
+	if err != nil {
+		return uuid.Nil, err
+	}
+	// Keep the table IDs, since the client already received the relations of the tables under them.
+	err = q.resultForwarder.RegisterQuery(retryID, q.tableIDMap, q.compilationTimeNs, queryPlanOpts)
+	if err != nil {
+		return uuid.Nil, err
+	}
+	err = LaunchQuery(retryID, q.natsConn, planMap, q.planOpts.Analyze)
+	if err != nil {
+		return uuid.Nil, err
+	}
+	return retryID, nil
+}
+
+// relayResults streams the results of the query launched as streamID to resultCh as results of the
+// script's query, and reports whether any row batch reached the client.
+func (q *QueryExecutorImpl) relayResults(ctx context.Context, streamID uuid.UUID, resultCh chan<- *vizierpb.ExecuteScriptResponse) (bool, error) {
+	relayCh := make(chan *vizierpb.ExecuteScriptResponse)
+	relayDone := make(chan struct{})
+	sentData := false
+	go func() {
+		defer close(relayDone)
+		for resp := range relayCh {
+			if data := resp.GetData(); data != nil && (data.Batch != nil || data.EncryptedBatch != nil) {
+				sentData = true
+			}
+			resp.QueryID = q.queryID.String()
+			// Keep draining relayCh once the client is gone, so that StreamResults doesn't block.
+			select {
+			case <-ctx.Done():
+			case resultCh <- resp:
+			}
+		}
+	}()
+
+	err := q.resultForwarder.StreamResults(ctx, streamID, relayCh)
+	close(relayCh)
+	<-relayDone
+	return sentData, err
+}
+
+// updateResultCache records the buckets that a successful run cached. If the run failed, the
+// buckets may be missing from Kelvin or only partly cached, so the script's buckets are forgotten.
+func (q *QueryExecutorImpl) updateResultCache(err error) {
+	if err != nil {
+		q.resultCache.Forget(q.resultCacheKey)
+		return
+	}
+	q.resultCache.Record(q.resultCacheKey, q.resultCachePlan)
+}
+
 func (q *QueryExecutorImpl) runScript(ctx context.Context, resultCh chan<- *vizierpb.ExecuteScriptResponse, req *vizierpb.ExecuteScriptRequest) error {
 	defer close(resultCh)
 	q.startTime = time.Now()
@@ -453,5 +567,29 @@ func (q *QueryExecutorImpl) runScript(ctx context.Context, resultCh chan<- *vizi
 		}
 	}
 
-	return q.resultForwarder.StreamResults(ctx, q.queryID, resultCh)
+	if q.resultCachePlan == nil {
+		return q.resultForwarder.StreamResults(ctx, q.queryID, resultCh)
+	}
+	if !UsesCachedBuckets(q.resultCachePlan) {
+		err := q.resultForwarder.StreamResults(ctx, q.queryID, resultCh)
+		q.updateResultCache(err)
+		return err
+	}
+
+	sentData, err := q.relayResults(ctx, q.queryID, resultCh)
+	if status.Code(err) != codes.NotFound || sentData {
+		q.updateResultCache(err)
+		return err
+	}
+	// Kelvin evicted buckets that the plan relied on before the query read them. Run the script
+	// again over its whole time range, which also caches the buckets anew.
+	log.WithField("query_id", q.queryID).WithError(err).Info("Cached buckets are missing, rerunning the script without them")
+	q.resultCache.Forget(q.resultCacheKey)
+	retryID, err := q.relaunchScript(ctx, resultCh)
+	if err != nil {
+		return err
+	}
+	_, err = q.relayResults(ctx, retryID, resultCh)
+	q.updateResultCache(err)
+	return err
 }
@@ -22,6 +22,7 @@ import (
 	"context"
 	"fmt"
 	"testing"
+	"time"
 
 	"github.com/gofrs/uuid"
 
@@ -33,10 +34,13 @@ import (
 	"github.com/golang/mock/gomock"
 	"github.com/stretchr/testify/assert"
 	"github.com/stretchr/testify/require"
+	"google.golang.org/grpc/codes"
+	"google.golang.org/grpc/status"
 
 	"px.dev/pixie/src/api/proto/vizierpb"
 	"px.dev/pixie/src/carnot/carnotpb"
 	"px.dev/pixie/src/carnot/planner/distributedpb"
+	"px.dev/pixie/src/carnot/planner/plannerpb"
 	"px.dev/pixie/src/carnot/planpb"
 	"px.dev/pixie/src/utils/testingutils"
 	"px.dev/pixie/src/vizier/services/query_broker/controllers"
@@ -404,7 +408,7 @@ func runTestCase(t *testing.T, test *queryExecTestCase) {
 	}
 
 	dp := &fakeDataPrivacy{}
-	queryExec := controllers.NewQueryExecutor("qb_address", "qb_hostname", at, dp, nc, nil, nil, rf, planner, test.MutExecFactory)
+	queryExec := controllers.NewQueryExecutor("qb_address", "qb_hostname", at, dp, nc, nil, nil, rf, planner, nil, test.MutExecFactory)
 	consumer := newTestConsumer(test.ConsumeErrs)
 
 	assert.Equal(t, test.QueryExecExpectedRunError, queryExec.Run(context.Background(), test.Req, consumer))
@@ -810,3 +814,139 @@ func buildMutationFailedQueryTestCase(t *testing.T) queryExecTestCase {
 		},
 	}
 }
+
+// withResultCache returns the expected planner result, with an aggregate on the first agent that
+// caches its time buckets.
+func withResultCache(t *testing.T, rangeStart, inputStart, closedBefore int64) *distributedpb.LogicalPlannerResult {
+	result := buildPlannerResult(t, expectedPlannerResult)
+	fragment := result.Plan.QbAddressToPlan[agent1ID].Nodes[0]
+	fragment.Nodes = append(fragment.Nodes, &planpb.PlanNode{
+		Id: 5,
+		Op: &planpb.Operator{
+			OpType: planpb.AGGREGATE_OPERATOR,
+			Op: &planpb.Operator_AggOp{
+				AggOp: &planpb.AggregateOperator{
+					ResultCache: &planpb.AggregateResultCache{
+						BucketSizeNs:   10,
+						RangeStartNs:   rangeStart,
+						InputStartNs:   inputStart,
+						ClosedBeforeNs: closedBefore,
+					},
+				},
+			},
+		},
+	})
+	return result
+}
+
+// evictedBucketsForwarder fails the first query it streams with NOT_FOUND, like Kelvin does when it
+// evicted the cached buckets that the plan relied on.
+type evictedBucketsForwarder struct {
+	fakeResultForwarder
+
+	registered []uuid.UUID
+	streamed   []uuid.UUID
+}
+
+func (f *evictedBucketsForwarder) RegisterQuery(queryID uuid.UUID, tableIDMap map[string]string,
+	compilationTimeNs int64,
+	queryPlanOpts *controllers.QueryPlanOpts) error {
+	f.registered = append(f.registered, queryID)
+	return f.fakeResultForwarder.RegisterQuery(queryID, tableIDMap, compilationTimeNs, queryPlanOpts)
+}
+
+func (f *evictedBucketsForwarder) StreamResults(ctx context.Context, queryID uuid.UUID,
+	resultCh chan<- *vizierpb.ExecuteScriptResponse) error {
+	f.streamed = append(f.streamed, queryID)
+	if len(f.streamed) == 1 {
+		return status.Error(codes.NotFound, "Aggregate 5 has no cached state for the bucket at 100")
+	}
+	return f.fakeResultForwarder.StreamResults(ctx, queryID, resultCh)
+}
+
+func TestQueryExecutor_RerunsWithoutEvictedBuckets(t *testing.T) {
+	nc, cleanup := testingutils.MustStartTestNATS(t)
+	defer cleanup()
+
+	ctrl := gomock.NewController(t)
+	defer ctrl.Finish()
+
+	plannerState := buildPlannerState(t, singleAgentDistributedState)
+	at := &fakeAgentsTracker{
+		agentsInfo: tracker.NewTestAgentsInfo(plannerState.DistributedState),
+	}
+
+	req := &vizierpb.ExecuteScriptRequest{
+		QueryStr: testQuery,
+	}
+	plannerReq, err := controllers.VizierQueryRequestToPlannerQueryRequest(req)
+	require.NoError(t, err)
+	key, err := controllers.ResultCacheKey(plannerReq)
+	require.NoError(t, err)
+	resultCache := controllers.NewResultCacheTracker(10 * time.Second)
+	resultCache.Record(key, withResultCache(t, 100, 100, 1000).Plan)
+
+	var configs []*distributedpb.ResultCacheConfig
+	planner := mock_controllers.NewMockPlanner(ctrl)
+	gomock.InOrder(
+		planner.EXPECT().
+			Plan(gomock.Any(), gomock.Any()).
+			DoAndReturn(func(state *distributedpb.LogicalPlannerState, _ *plannerpb.QueryRequest) (*distributedpb.LogicalPlannerResult, error) {
+				configs = append(configs, state.ResultCacheConfig)
+				return withResultCache(t, 100, 1000, 2000), nil
+			}),
+		planner.EXPECT().
+			Plan(gomock.Any(), gomock.Any()).
+			DoAndReturn(func(state *distributedpb.LogicalPlannerState, _ *plannerpb.QueryRequest) (*distributedpb.LogicalPlannerResult, error) {
+				configs = append(configs, state.ResultCacheConfig)
+				return withResultCache(t, 100, 100, 2000), nil
+			}),
+	)
+
+	fakeBatch := new(vizierpb.RowBatchData)
+	require.NoError(t, proto.UnmarshalText(rowBatchPb, fakeBatch))
+	rf := &evictedBucketsForwarder{
+		fakeResultForwarder: fakeResultForwarder{
+			ClientResultsToSend: []*vizierpb.ExecuteScriptResponse{
+				{
+					// The forwarder answers with the ID of the query that the agents ran.
+					QueryID: "rerun",
+					Result: &vizierpb.ExecuteScriptResponse_Data{
+						Data: &vizierpb.QueryData{
+							Batch: fakeBatch,
+						},
+					},
+				},
+			},
+		},
+	}
+
+	queryExec := controllers.NewQueryExecutor("qb_address", "qb_hostname", at, &fakeDataPrivacy{}, nc, nil, nil, rf, planner, resultCache, nil)
+	consumer := newTestConsumer(nil)
+	require.NoError(t, queryExec.Run(context.Background(), req, consumer))
+	require.NoError(t, queryExec.Wait())
+
+	// The rerun is planned without the cached buckets.
+	require.Equal(t, 2, len(configs))
+	assert.Equal(t, int64(1000), configs[0].CachedEndNs)
+	assert.Equal(t, int64(0), configs[1].CachedEndNs)
+
+	// The agents still know the failed query, so the rerun gets a new ID.
+	require.Equal(t, 2, len(rf.registered))
+	assert.Equal(t, queryExec.QueryID(), rf.registered[0])
+	assert.NotEqual(t, rf.registered[0], rf.registered[1])
+	assert.Equal(t, rf.registered, rf.streamed)
+
+	// The client only sees the results of the rerun, under the ID of its query.
+	numBatches := 0
+	for _, result := range consumer.results {
+		assert.Equal(t, queryExec.QueryID().String(), result.QueryID)
+		if result.GetData().GetBatch() != nil {
+			numBatches++
+		}
+	}
+	assert.Equal(t, 1, numBatches)
+
+	// The rerun cached its buckets again.
+	assert.Equal(t, int64(2000), resultCache.Config(key).CachedEndNs)
+}
@@ -179,6 +179,11 @@ func newActiveQuery(producerCtx context.Context, tableIDMap map[string]string,
 func (a *activeQuery) updateQueryState(msg *carnotpb.TransferResultChunkRequest) error {
 	queryIDStr := utils.UUIDFromProtoOrNil(msg.QueryID).String()
 
+	// The agent could not run its part of the query, so fail the query with the agent's error.
+	if execErr := msg.GetExecutionError(); execErr != nil {
+		return StatusToError(execErr)
+	}
+
 	// Mark down that we received the exec stats for this query.
 	if execStats := msg.GetExecutionAndTimingInfo(); execStats != nil {
 		if a.gotFinalExecStats {
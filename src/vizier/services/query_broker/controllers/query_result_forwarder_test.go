@@ -29,12 +29,15 @@ import (
 	"github.com/gogo/protobuf/proto"
 	"github.com/stretchr/testify/assert"
 	"github.com/stretchr/testify/require"
+	"google.golang.org/grpc/codes"
+	"google.golang.org/grpc/status"
 
 	"px.dev/pixie/src/api/proto/vizierpb"
 	"px.dev/pixie/src/carnot/carnotpb"
 	"px.dev/pixie/src/carnot/planner/distributedpb"
 	"px.dev/pixie/src/carnot/planpb"
 	"px.dev/pixie/src/carnot/queryresultspb"
+	"px.dev/pixie/src/common/base/statuspb"
 	"px.dev/pixie/src/table_store/schemapb"
 	"px.dev/pixie/src/utils"
 	"px.dev/pixie/src/vizier/services/query_broker/controllers"
@@ -539,6 +542,63 @@ func TestStreamResultsResultsBeforeInitialization(t *testing.T) {
 	assert.Equal(t, 0, len(results))
 }
 
+func TestStreamResultsExecutionError(t *testing.T) {
+	queryID := uuid.Must(uuid.NewV4())
+
+	f := controllers.NewQueryResultForwarderWithOptions(controllers.WithResultSinkTimeout(1 * time.Second))
+
+	var wg sync.WaitGroup
+	wg.Add(1)
+	expectedTables := make(map[string]string)
+	expectedTables["foo"] = "123"
+
+	var results []*vizierpb.ExecuteScriptResponse
+	resultCh := make(chan *vizierpb.ExecuteScriptResponse)
+
+	consumerCtx, cancelConsumer := context.WithCancel(context.Background())
+	defer cancelConsumer()
+	producerCtx, cancelProducer := context.WithCancel(context.Background())
+	defer cancelProducer()
+
+	go func() {
+		for {
+			select {
+			case msg := <-resultCh:
+				results = append(results, msg)
+			case <-consumerCtx.Done():
+				wg.Done()
+				return
+			}
+		}
+	}()
+	var err error
+
+	assert.Nil(t, f.RegisterQuery(queryID, expectedTables, 350, nil))
+
+	go func() {
+		err = f.StreamResults(consumerCtx, queryID, resultCh)
+		cancelConsumer()
+	}()
+
+	// The agent fails before it opens its result stream.
+	assert.Nil(t, f.ForwardQueryResult(producerCtx, &carnotpb.TransferResultChunkRequest{
+		Address: "foo",
+		QueryID: utils.ProtoFromUUID(queryID),
+		Result: &carnotpb.TransferResultChunkRequest_ExecutionError{
+			ExecutionError: &statuspb.Status{
+				ErrCode: statuspb.NOT_FOUND,
+				Msg:     "no cached state for the bucket",
+			},
+		},
+	}))
+	wg.Wait()
+
+	require.Error(t, err)
+	assert.Equal(t, codes.NotFound, status.Code(err))
+	assert.Equal(t, "no cached state for the bucket", status.Convert(err).Message())
+	assert.Equal(t, 0, len(results))
+}
+
 func TestStreamResultsNeverInitializedTable(t *testing.T) {
 	queryID := uuid.Must(uuid.NewV4())
 
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+package controllers
+
+import (
+	"crypto/sha256"
+	"encoding/hex"
+	"sync"
+	"time"
+
+	"github.com/gogo/protobuf/proto"
+	"github.com/spf13/pflag"
+	"github.com/spf13/viper"
+
+	"px.dev/pixie/src/carnot/planner/distributedpb"
+	"px.dev/pixie/src/carnot/planner/plannerpb"
+)
+
+func init() {
+	pflag.Bool("agg_result_cache", false, "Whether Kelvin caches the closed time buckets of aggregates across runs of the same script")
+	pflag.Duration("agg_result_cache_lateness", 10*time.Second, "How long after a time bucket ends all of its rows are assumed to be in the tables")
+}
+
+// The number of scripts whose cached buckets are tracked at once.
+const maxResultCacheEntries = 1024
+
+type resultCacheEntry struct {
+	// The plan of the run that cached the buckets, with its time ranges cleared. Kelvin only finds
+	// the buckets if the next plan is the same.
+	plan *distributedpb.DistributedPlan
+	// Every cached aggregate has its buckets in [cachedStartNs, cachedEndNs) cached.
+	cachedStartNs int64
+	cachedEndNs   int64
+	// Set once the plan of the script changed between runs, after which its buckets aren't reused.
+	unstable bool
+}
+
+// ResultCacheTracker remembers which time buckets of aggregates Kelvin cached for each script, so
+// that the next run of the script only reads the rows after them from the PEMs.
+type ResultCacheTracker struct {
+	allowedLateness time.Duration
+
+	mu      sync.Mutex
+	entries map[string]*resultCacheEntry
+}
+
+// NewResultCacheTracker creates a tracker for the result cache.
+func NewResultCacheTracker(allowedLateness time.Duration) *ResultCacheTracker {
+	return &ResultCacheTracker{
+		allowedLateness: allowedLateness,
+		entries:         make(map[string]*resultCacheEntry),
+	}
+}
+
+// NewResultCacheTrackerFromFlags creates a tracker for the result cache, or returns nil if it's disabled.
+func NewResultCacheTrackerFromFlags() *ResultCacheTracker {
+	if !viper.GetBool("agg_result_cache") {
+		return nil
+	}
+	return NewResultCacheTracker(viper.GetDuration("agg_result_cache_lateness"))
+}
+
+// ResultCacheKey returns the key of the script in the tracker, which covers the query and the
+// arguments of the functions it executes.
+func ResultCacheKey(req *plannerpb.QueryRequest) (string, error) {
+	h := sha256.New()
+	h.Write([]byte(req.QueryStr))
+	for _, f := range req.ExecFuncs {
+		b, err := f.Marshal()
+		if err != nil {
+			return "", err
+		}
+		h.Write(b)
+	}
+	return hex.EncodeToString(h.Sum(nil)), nil
+}
+
+// Config returns the result cache config to plan the next run of the script with.
+func (t *ResultCacheTracker) Config(key string) *distributedpb.ResultCacheConfig {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	config := &distributedpb.ResultCacheConfig{
+		AllowedLatenessNs: t.allowedLateness.Nanoseconds(),
+	}
+	if e, ok := t.entries[key]; ok && !e.unstable {
+		config.CachedStartNs = e.cachedStartNs
+		config.CachedEndNs = e.cachedEndNs
+	}
+	return config
+}
+
+// Matches returns false if the plan relies on cached buckets that were cached by a different plan.
+// The script is then marked as unstable, and later runs of it don't reuse cached buckets.
+func (t *ResultCacheTracker) Matches(key string, plan *distributedpb.DistributedPlan) bool {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	e, ok := t.entries[key]
+	if !ok || e.unstable || e.cachedEndNs == 0 {
+		return true
+	}
+	if normalizeResultCachePlan(plan).Equal(e.plan) {
+		return true
+	}
+	e.unstable = true
+	e.plan = nil
+	e.cachedStartNs = 0
+	e.cachedEndNs = 0
+	return false
+}
+
+// Record notes the buckets that a successful run of the script cached.
+func (t *ResultCacheTracker) Record(key string, plan *distributedpb.DistributedPlan) {
+	var start, end int64
+	found := false
+	for _, agentPlan := range plan.QbAddressToPlan {
+		for _, fragment := range agentPlan.Nodes {
+			for _, node := range fragment.Nodes {
+				cache := node.Op.GetAggOp().GetResultCache()
+				if cache == nil {
+					continue
+				}
+				if !found || cache.RangeStartNs > start {
+					start = cache.RangeStartNs
+				}
+				if !found || cache.ClosedBeforeNs < end {
+					end = cache.ClosedBeforeNs
+				}
+				found = true
+			}
+		}
+	}
+
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	if e, ok := t.entries[key]; ok && e.unstable {
+		return
+	}
+	if !found || end <= start {
+		delete(t.entries, key)
+		return
+	}
+	if _, ok := t.entries[key]; !ok && len(t.entries) >= maxResultCacheEntries {
+		// Drop an arbitrary script to make room.
+		for k := range t.entries {
+			delete(t.entries, k)
+			break
+		}
+	}
+	t.entries[key] = &resultCacheEntry{
+		plan:          normalizeResultCachePlan(plan),
+		cachedStartNs: start,
+		cachedEndNs:   end,
+	}
+}
+
+// Forget drops the cached buckets of the script, eg. because a run that relied on them failed.
+func (t *ResultCacheTracker) Forget(key string) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	if e, ok := t.entries[key]; ok && !e.unstable {
+		delete(t.entries, key)
+	}
+}
+
+// UsesCachedBuckets returns whether any aggregate in the plan merges buckets from Kelvin's cache
+// instead of reading their rows.
+func UsesCachedBuckets(plan *distributedpb.DistributedPlan) bool {
+	for _, agentPlan := range plan.QbAddressToPlan {
+		for _, fragment := range agentPlan.Nodes {
+			for _, node := range fragment.Nodes {
+				if cache := node.Op.GetAggOp().GetResultCache(); cache != nil && cache.InputStartNs > cache.RangeStartNs {
+					return true
+				}
+			}
+		}
+	}
+	return false
+}
+
+// normalizeResultCachePlan returns a copy of the plan without the fields that change between runs
+// of the same script. Kelvin ignores the same fields when it fingerprints the plan.
+func normalizeResultCachePlan(plan *distributedpb.DistributedPlan) *distributedpb.DistributedPlan {
+	normalized := proto.Clone(plan).(*distributedpb.DistributedPlan)
+	for _, agentPlan := range normalized.QbAddressToPlan {
+		for _, fragment := range agentPlan.Nodes {
+			for _, node := range fragment.Nodes {
+				if memSource := node.Op.GetMemSourceOp(); memSource != nil {
+					memSource.StartTime = nil
+					memSource.StopTime = nil
+					memSource.SkipStartTime = nil
+					memSource.SkipStopTime = nil
+				}
+				if cache := node.Op.GetAggOp().GetResultCache(); cache != nil {
+					cache.RangeStartNs = 0
+					cache.InputStartNs = 0
+					cache.ClosedBeforeNs = 0
+				}
+			}
+		}
+	}
+	return normalized
+}
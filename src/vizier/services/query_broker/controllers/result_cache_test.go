@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+package controllers_test
+
+import (
+	"testing"
+	"time"
+
+	"github.com/gogo/protobuf/types"
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+
+	"px.dev/pixie/src/carnot/planner/distributedpb"
+	"px.dev/pixie/src/carnot/planner/plannerpb"
+	"px.dev/pixie/src/carnot/planpb"
+	"px.dev/pixie/src/vizier/services/query_broker/controllers"
+)
+
+// makeCachedPlan returns a plan whose Kelvin aggregates the table by time buckets, and caches the
+// buckets in [rangeStart, closedBefore).
+func makeCachedPlan(table string, rangeStart, closedBefore int64) *distributedpb.DistributedPlan {
+	memSource := &planpb.Operator{
+		OpType: planpb.MEMORY_SOURCE_OPERATOR,
+		Op: &planpb.Operator_MemSourceOp{
+			MemSourceOp: &planpb.MemorySourceOperator{
+				Name:      table,
+				StartTime: &types.Int64Value{Value: rangeStart},
+				StopTime:  &types.Int64Value{Value: closedBefore + 5},
+			},
+		},
+	}
+	agg := &planpb.Operator{
+		OpType: planpb.AGGREGATE_OPERATOR,
+		Op: &planpb.Operator_AggOp{
+			AggOp: &planpb.AggregateOperator{
+				ResultCache: &planpb.AggregateResultCache{
+					BucketSizeNs:   10,
+					RangeStartNs:   rangeStart,
+					InputStartNs:   rangeStart,
+					ClosedBeforeNs: closedBefore,
+				},
+			},
+		},
+	}
+	return &distributedpb.DistributedPlan{
+		QbAddressToPlan: map[string]*planpb.Plan{
+			"kelvin": {
+				Nodes: []*planpb.PlanFragment{
+					{Nodes: []*planpb.PlanNode{{Id: 1, Op: memSource}, {Id: 2, Op: agg}}},
+				},
+			},
+		},
+	}
+}
+
+func TestResultCacheTracker_RecordAndReuse(t *testing.T) {
+	tracker := controllers.NewResultCacheTracker(5 * time.Second)
+	key, err := controllers.ResultCacheKey(&plannerpb.QueryRequest{QueryStr: "script"})
+	require.NoError(t, err)
+
+	config := tracker.Config(key)
+	assert.Equal(t, int64(5*time.Second), config.AllowedLatenessNs)
+	assert.Equal(t, int64(0), config.CachedEndNs)
+
+	tracker.Record(key, makeCachedPlan("http_events", 100, 200))
+	config = tracker.Config(key)
+	assert.Equal(t, int64(100), config.CachedStartNs)
+	assert.Equal(t, int64(200), config.CachedEndNs)
+
+	// Only the time ranges differ, so the buckets are reused.
+	next := makeCachedPlan("http_events", 150, 300)
+	memSource := next.QbAddressToPlan["kelvin"].Nodes[0].Nodes[0].Op.GetMemSourceOp()
+	memSource.SkipStartTime = &types.Int64Value{Value: 150}
+	memSource.SkipStopTime = &types.Int64Value{Value: 200}
+	assert.True(t, tracker.Matches(key, next))
+
+	// A failed run drops the buckets.
+	tracker.Forget(key)
+	assert.Equal(t, int64(0), tracker.Config(key).CachedEndNs)
+}
+
+func TestResultCacheTracker_PlanChanged(t *testing.T) {
+	tracker := controllers.NewResultCacheTracker(5 * time.Second)
+	key, err := controllers.ResultCacheKey(&plannerpb.QueryRequest{QueryStr: "script"})
+	require.NoError(t, err)
+
+	tracker.Record(key, makeCachedPlan("http_events", 100, 200))
+	assert.False(t, tracker.Matches(key, makeCachedPlan("conn_stats", 100, 300)))
+
+	// The script's plan isn't stable, so its buckets are never reused again.
+	tracker.Record(key, makeCachedPlan("conn_stats", 100, 300))
+	assert.Equal(t, int64(0), tracker.Config(key).CachedEndNs)
+}
+
+func TestResultCacheTracker_NothingCached(t *testing.T) {
+	tracker := controllers.NewResultCacheTracker(5 * time.Second)
+	key, err := controllers.ResultCacheKey(&plannerpb.QueryRequest{QueryStr: "script"})
+	require.NoError(t, err)
+
+	tracker.Record(key, &distributedpb.DistributedPlan{})
+	assert.Equal(t, int64(0), tracker.Config(key).CachedEndNs)
+	assert.True(t, tracker.Matches(key, makeCachedPlan("http_events", 100, 200)))
+}
@@ -85,6 +85,8 @@ type Server struct {
 	resultForwarder QueryResultForwarder
 
 	planner Planner
+	// Tracks the buckets of aggregates that Kelvin cached for each script, nil if disabled.
+	resultCache *ResultCacheTracker
 
 	queryExecFactory QueryExecutorFactory
 }
@@ -128,6 +130,7 @@ func NewServerWithForwarderAndPlanner(env querybrokerenv.QueryBrokerEnv,
 		mdtp:              mds,
 		mdconf:            mdconf,
 		planner:           planner,
+		resultCache:       NewResultCacheTrackerFromFlags(),
 		queryExecFactory:  queryExecFactory,
 		healthcheckQuitCh: make(chan struct{}),
 	}